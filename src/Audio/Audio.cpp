@@ -68,6 +68,7 @@ void Audio::Nullify()
 	state = AudioState::NOT_INITIALIZED;
 	audioStream = NULL;
 	absoluteVolume = 1.0f;
+	mixerVolume = 1.0f;
 
 #ifdef OPENAL
 	alSource = 0;
@@ -129,6 +130,8 @@ bool Audio::CreateALObjects()
 Audio::~Audio()
 {
 	delete[] buf;
+	if (masterMixer)
+		masterMixer->RemoveSource(this);
 
 #ifdef OPENAL
 	int error = 0;
@@ -440,32 +443,30 @@ void Audio::Update()
 	// Windows core driver?
 	if (audioDriver == AudioDriver::WindowsCoreAudio)
 	{
-		/// Calc requested buffer sizes
-		int samplesToBuffer = masterMixer->SamplesToBuffer(this);
-		int shortsToBuffer = samplesToBuffer;
-		int shortsToBufferInChars = shortsToBuffer * 2;
-		int bytesToBuffer = (bufSize < shortsToBufferInChars? bufSize : shortsToBufferInChars);	// Clamp it
-
-		// Buffer from stream.
-		int bytesBuffered = audioStream->BufferAudio((char*)buf, bytesToBuffer, this->repeat);
-		this->bytesBufferedTotal += bytesBuffered;
-		if (bytesBuffered <= 0)
+		/// Nothing more to decode once ending. What was buffered plays out from the mixer.
+		if (state != AudioState::PLAYING)
+			return;
+		int channels = audioStream->AudioChannels();
+		MixerSource * source = masterMixer->Source(this, channels, audioStream->AudioFrequency(), type);
+		if (!source)
+			return;
+		source->SetVolume(mixerVolume);
+		/// Decode straight into the free blocks of our source, which hands them to the mixer without copying.
+		int bytesPerFrame = channels * sizeof(short);
+		PCMBlock * block;
+		while ((block = source->AcquireBlock()) != NULL)
 		{
-			// End of stream.
-			if (state == AudioState::PLAYING)
+			int bytesBuffered = audioStream->BufferAudio((char*)block->samples, PCM_BLOCK_FRAMES * bytesPerFrame, this->repeat);
+			if (bytesBuffered <= 0)
 			{
+				// End of stream.
 				this->state = AudioState::ENDING;
 				std::cout<<"\nStream ending. Bytes buffered: "<<bytesBufferedTotal;
+				return;
 			}
-			return;
+			this->bytesBufferedTotal += bytesBuffered;
+			source->Submit(bytesBuffered / bytesPerFrame);
 		}
-
-		/// See how much we actually buffered
-		int samplesBuffered = bytesBuffered / 2;
-		int floatsToBuffer = samplesBuffered;
-		int floatsToBufferInChars = floatsToBuffer * 4;
-		// Send to mixer.
-		masterMixer->BufferPCMShort(this, (short*)buf, samplesBuffered, audioStream->AudioChannels(), absoluteVolume);
 	}
     return;
 }
@@ -538,6 +539,7 @@ void Audio::UpdateVolume()
 	float masterVol = AudioMan.ActiveMasterVolume();
 	float audioTypeVol = AudioMan.GetVolume(type);
 	absoluteVolume = distanceCompensatedVolume * audioTypeVol * masterVol;
+	mixerVolume = distanceCompensatedVolume;
 
 //	std::cout<<"\nUpdating volume: "<<absoluteVolume<<" for source "<<alSource;
 	/// Set volume in AL.
@@ -136,6 +136,8 @@ private:
 
 	/// Total volume as calculated with UpdateVolume. 
 	float absoluteVolume;
+	/// Volume without the category and master volumes, which the AudioMixer's buses apply instead.
+	float mixerVolume;
 	
     bool loaded;
 	//TODO: add .wav plaback variables/classes
@@ -654,12 +654,15 @@ void AudioManager::Update()
 			}
 			case AudioState::ENDING:
 			{
-				// Flag as ended after the audio marker in the mixer has been removed.
+				// Flag as ended after all it buffered in the mixer has been played.
 				if (usingMasterMixer)
 				{
-					ABM * abm = masterMixer->GetMarker(audio);
-					if (!abm || abm->pcmQueueIndex <= 0)
+					MixerSource * source = masterMixer->GetSource(audio);
+					if (!source || source->Drained())
+					{
+						masterMixer->RemoveSource(audio);
 						audio->state = AudioState::ENDED;
+					}
 				}
 				playingAudio++;
 				break;
@@ -681,7 +684,14 @@ void AudioManager::Update()
 	}
 	/// Send mixed audio to driver, if custom mixer enabled/driver requiring it
 	if (usingMasterMixer)
+	{
+		/// Category and master volumes are applied to the mixer's buses, and take effect without re-buffering anything.
+		for (int i = 0; i < AudioType::NUM_TYPES; ++i)
+			masterMixer->Bus(i)->volume = GetVolume(i);
+		masterMixer->volume = masterVolume;
+		masterMixer->muted = mute;
 		masterMixer->Update();
+	}
 }
 
 /// Pauses/resumes all depending on state change.
@@ -733,10 +743,10 @@ float AudioManager::GetVolume(int forAudioType)
 			return bgmVolume * (muteType[AudioType::BGM]? 0 : 1);
 		case AudioType::SFX:
 			return sfxVolume * (muteType[AudioType::SFX]? 0 : 1);
-		default:
-			std::cout<<"\nDefault -1 volume.";
 	}
-	return -1;
+	if (forAudioType < 0 || forAudioType >= categoryVolumes.Size())
+		return 1.f;
+	return categoryVolumes[forAudioType] * (muteType[forAudioType]? 0 : 1);
 }
 
 
@@ -7,26 +7,45 @@
 #include "DataTypes.h"
 #include "Windows/WindowsCoreAudio.h"
 #include "AudioManager.h"
+#include "PCMMix.h"
 #include "OS/Sleep.h"
 
 AudioMixer * masterMixer = NULL;
 
+AudioBus::AudioBus()
+{
+	volume = 1.f;
+	muted = false;
+	pcm = new float[AUDIO_MIX_FRAMES * PCM_MAX_CHANNELS];
+	active = false;
+	mixedVolume = 1.f;
+}
+
+AudioBus::~AudioBus()
+{
+	SAFE_DELETE_ARR(pcm);
+}
+
 AudioMixer::AudioMixer()
 {
-	// Default? 100k samples
-	queueSampleTotal = 1024 * 16;
-	pcmQueueF = new float[queueSampleTotal];
-	
-	/// Initialize buffah.
-	memset(pcmQueueF, 0, queueSampleTotal * sizeof(float));
+	/// Until the driver tells otherwise.
+	channels = 2;
+	sampleRate = 48000;
 	muted = false;
 	volume = 1.f;
+	mixedVolume = 1.f;
+	inputScratch = new float[(PCM_RESAMPLE_FRAMES + 1) * PCM_MAX_CHANNELS];
+	outputScratch = new float[AUDIO_MIX_FRAMES * PCM_MAX_CHANNELS];
+	output = new float[AUDIO_SEND_FRAMES * PCM_MAX_CHANNELS];
+	pendingFrames = 0;
 }
 
 AudioMixer::~AudioMixer()
 {
-	SAFE_DELETE_ARR(pcmQueueF);
-	markers.ClearAndDelete();
+	SAFE_DELETE_ARR(inputScratch);
+	SAFE_DELETE_ARR(outputScratch);
+	SAFE_DELETE_ARR(output);
+	sources.ClearAndDelete();
 }
 
 void AudioMixer::AllocateMaster()
@@ -44,87 +63,132 @@ void AudioMixer::BufferPCMFloat(Audio * audio, float * buffer, int samples, int
 {
 
 }
-/// Buffers short [-32768,32767]-based PCM data.
-void AudioMixer::BufferPCMShort(Audio * audio, short * buffer, int samples, int channels, float volume)
+
+/** Buffers short [-32768,32767]-based PCM data, copying it into the blocks of the audio's source.
+	Returns samples buffered, fewer if the source is full. Decoders can use Source to write straight into the blocks instead.
+	Mixed into the bus given when the source was created, or that of AudioType::NONE.
+*/
+int AudioMixer::BufferPCMShort(Audio * audio, short * buffer, int samples, int channels, int sampleRate, float volume)
 {
-	// Check starting point based on existing markers.
-	ABM * abm = GetMarker(audio);
-	// Add new marker if needed.
-	if (!abm)
+	MixerSource * source = Source(audio, channels, sampleRate, AudioType::NONE);
+	if (!source)
+		return 0;
+	source->SetVolume(volume);
+	int frames = samples / channels;
+	int framesBuffered = 0;
+	while (framesBuffered < frames)
 	{
-		abm = new ABM();
-		abm->audio = audio;
-		abm->pcmQueueIndex = 0;
-		markers.Add(abm);
+		PCMBlock * block = source->AcquireBlock();
+		if (!block)
+			break;
+		int blockFrames = frames - framesBuffered;
+		if (blockFrames > PCM_BLOCK_FRAMES)
+			blockFrames = PCM_BLOCK_FRAMES;
+		memcpy(block->samples, buffer + framesBuffered * channels, blockFrames * channels * sizeof(short));
+		source->Submit(blockFrames);
+		framesBuffered += blockFrames;
 	}
-	/// Check possible samples to buffer.
-	int possibleSamples = queueSampleTotal - abm->pcmQueueIndex;
-	assert(samples <= possibleSamples);
+	return framesBuffered * channels;
+}
 
-	if (debug == -22)
-		PrintQueue("At end of marker position before filling it", abm->pcmQueueIndex - 5, abm->pcmQueueIndex + 10 - 5);
+/** Returns the source of given audio, creating it with given format, mixed into the bus of given AudioType, if needed.
+	Returns NULL if the format is not supported.
+*/
+MixerSource * AudioMixer::Source(Audio * audio, int channels, int sampleRate, int audioType)
+{
+	MixerSource * source = GetSource(audio);
+	if (source && source->channels == channels && source->sampleRate == sampleRate)
+		return source;
+	if (channels <= 0 || channels > PCM_MAX_CHANNELS || sampleRate <= 0)
+		return NULL;
+	/// New format, e.g. from a new stream.
+	if (source)
+		RemoveSource(audio);
+	if (audioType < 0 || audioType >= AudioType::NUM_TYPES)
+		audioType = AudioType::NONE;
+	source = new MixerSource(audio, channels, sampleRate, audioType);
+	sources.AddItem(source);
+	return source;
+}
 
-//	abm->pcmQueueIndex = 0;
-//	memset(pcmQueueF, 0, queueSampleTotal * sizeof(float));
-	// For each sample they want to buffer...
-	for (int i = 0; i < samples; ++i)
+/// Returns the source of given audio, or NULL if it has none.
+MixerSource * AudioMixer::GetSource(Audio * forAudio)
+{
+	for (int i = 0; i < sources.Size(); ++i)
 	{
-		// Set 0 so we avoid some noise? No.
-		int floatsProcessed = 0;
-
-		// Debug
-		uchar * buf = (uchar*)buffer;
-		int sample1 = (uchar)buf[i * 2];
-		int sample2 = (uchar)buf[i * 2 + 1];
-
-		/// These 2 should hopefully be the same..
-		int sampleC =  sample1 | (sample2 << 8);
-		int sample = buffer[i];
-		short sampleCS = sampleC;
-		assert(sample == sampleCS);
-		// Convert to float.
-		float f;
-		/// 0 to 32767 is the same, over that and we go negative. -> simulate going from int to short.
-	//	int overHalf = (sample & (1 << 15)) ? 1 : 0;
-	//	int iSample = (sample % 32768) - 32768 * overHalf;
-		short shortSample = buffer[i];
-		f = ((float) shortSample) / (float) 32768;
-		if( f > 1) 
-			f = 1;
-		if( f < -1 ) 
-			f = -1;
-		// Multiply by volume?
-		f *= volume;
-		pcmQueueF[abm->pcmQueueIndex + i] += f;
-
-		if (debug == -17)
-			std::cout<<"\n"<<pcmQueueF[abm->pcmQueueIndex + i]<<" sample: "<<sample<<" sample1/2: "<<sample1<<"/"<<sample2;
-		++floatsProcessed;
-//		++floatsProcessed;
+		MixerSource * source = sources[i];
+		if (source->audio == forAudio)
+			return source;
 	}
-	/// Increase index?
-	if (debug == -22)
-		PrintQueue("Start of where we filled data (-5,+5), should have values for all 10", abm->pcmQueueIndex - 5, abm->pcmQueueIndex + 5);
-	abm->pcmQueueIndex += samples;
-	if (debug == -22)
-		PrintQueue("End of marker position after filling it", abm->pcmQueueIndex -5, abm->pcmQueueIndex + 10 - 5);
+	return NULL;
+}
+
+/// Removes and deletes the source of given audio, dropping anything not yet mixed.
+void AudioMixer::RemoveSource(Audio * forAudio)
+{
+	MixerSource * source = GetSource(forAudio);
+	if (!source)
+		return;
+	sources.RemoveItemUnsorted(source);
+	delete source;
 }
 
-/// Sends update to driver, moves back data and updates marker locations.
+/// Bus for given AudioType.
+AudioBus * AudioMixer::Bus(int audioType)
+{
+	if (audioType < 0 || audioType >= AudioType::NUM_TYPES)
+		return NULL;
+	return &buses[audioType];
+}
+
+/// Sends update to driver, mixing as much as it can take.
 void AudioMixer::Update()
 {
 	SendToDriver(audioDriver);
 }
 
-/// Depends on current marker in buffer.
-int AudioMixer::SamplesToBuffer(Audio * forAudio)
+/** Mixes the next frames of all sources into output, interleaved at the mixer's channels and sample rate.
+	Each pass adds the sources into their buses, then the buses into the output, ramping any volume changes over the pass.
+*/
+void AudioMixer::Mix(float * output, int frames)
 {
-	ABM * abm = GetMarker(forAudio);
-	if (!abm)
-		// Full size possible
-		return queueSampleTotal;
-	/// Subset based on current index -> how far we have buffered last frame counting
-	return queueSampleTotal - abm->pcmQueueIndex - 1;
+	for (int done = 0; done < frames; done += AUDIO_MIX_FRAMES)
+	{
+		int passFrames = frames - done;
+		if (passFrames > AUDIO_MIX_FRAMES)
+			passFrames = AUDIO_MIX_FRAMES;
+		int samples = passFrames * channels;
+		for (int i = 0; i < AudioType::NUM_TYPES; ++i)
+			buses[i].active = false;
+		for (int i = 0; i < sources.Size(); ++i)
+		{
+			MixerSource * source = sources[i];
+			if (source->Drained())
+				continue;
+			AudioBus & bus = buses[source->bus];
+			if (!bus.active)
+			{
+				memset(bus.pcm, 0, samples * sizeof(float));
+				bus.active = true;
+			}
+			source->Mix(bus.pcm, passFrames, channels, sampleRate, inputScratch, outputScratch);
+		}
+
+		float * out = output + done * channels;
+		memset(out, 0, samples * sizeof(float));
+		for (int i = 0; i < AudioType::NUM_TYPES; ++i)
+		{
+			AudioBus & bus = buses[i];
+			float busVolume = bus.muted ? 0.f : bus.volume;
+			if (bus.active)
+				MixPCMFloat(bus.pcm, out, samples, bus.mixedVolume, busVolume);
+			bus.mixedVolume = busVolume;
+		}
+		/// Apply master volume RIGHT before sending to device! o.o
+		float masterVolume = muted ? 0.f : volume;
+		FinishPCMFloat(out, samples, mixedVolume, masterVolume);
+		mixedVolume = masterVolume;
+	}
 }
 
 /// Sends current buffer to audio driver.
@@ -137,75 +201,35 @@ void AudioMixer::SendToDriver(int driverID)
 	WMMDevice * device = WMMDevice::MainOutput();
 	if (!device)
 		return;
-	//	int bytesToBuffer = device->BytesToBuffer();
-	/// Always send a constant amount of samples, based on the mixer's buffer-size?
-	int defaultSamplesToSend = int (queueSampleTotal * 0.1);
-	/// Check availability in driver.
-	int driverSamplesToBuffer = device->SamplesToBuffer();
-	// Use the lower value.
-	int samplesToSend = min(defaultSamplesToSend, driverSamplesToBuffer);
-	if (samplesToSend <= 0)
+	int deviceChannels = device->Channels();
+	if (deviceChannels <= 0 || deviceChannels > PCM_MAX_CHANNELS)
+		return;
+	if (deviceChannels != channels)
+		pendingFrames = 0;
+	channels = deviceChannels;
+	sampleRate = device->SampleRate();
+	/// Check availability in driver, and send at most a constant amount of frames.
+	int framesToSend = device->SamplesToBuffer() / channels;
+	if (framesToSend > AUDIO_SEND_FRAMES)
+		framesToSend = AUDIO_SEND_FRAMES;
+	if (framesToSend <= 0)
 	{
 		SleepThread(5);
 		return;
 	}
-	// Calc volume.
-	float currentVolume = volume;
-	if (muted)
-		currentVolume = 0.f;
-	/// Apply master volume RIGHT before sending to device! o.o
-	for (int i = 0; i < samplesToSend; ++i)
+	if (framesToSend > pendingFrames)
 	{
-		pcmQueueF[i] *= currentVolume;
-	}
-	int bytesBuffered = device->BufferData((char*)pcmQueueF, samplesToSend * sizeof(float));
-	int bytesPerSample = sizeof(float);
-	int samplesBuffered = bytesBuffered / bytesPerSample;
-
-	/// Move back existing data.
-	int samplesRemainingInQueue = queueSampleTotal - samplesBuffered;
-	if (debug == -22)
-		PrintQueue("End of samples buffered, this part should be moved back to 0", samplesBuffered, samplesBuffered + 10);
-	memmove(pcmQueueF, pcmQueueF + samplesBuffered, samplesRemainingInQueue * bytesPerSample);
-	if (debug == -22)
-		PrintQueue("From 0, post movement, should be the same as the above", 0, 10);
-	// Nullify the newly added end part of the buffer
-	memset(pcmQueueF + samplesRemainingInQueue, 0, samplesBuffered * bytesPerSample);
-	if (debug == -22)
-		PrintQueue("From after samplesBuffered, should be 0s", samplesBuffered, samplesBuffered + 10);
-
-	// Move back all markers too.
-	for (int i = 0; i < markers.Size(); ++i)
-	{
-		ABM * abm = markers[i];
-		abm->pcmQueueIndex -= samplesBuffered;
-		if (abm->pcmQueueIndex < 0)
-		{
-			markers.RemoveIndex(i);
-			--i;
-			delete abm;
-		}
+		Mix(output + pendingFrames * channels, framesToSend - pendingFrames);
+		pendingFrames = framesToSend;
 	}
+	int bytesBuffered = device->BufferData((char*)output, framesToSend * channels * sizeof(float));
+	int framesBuffered = bytesBuffered / (channels * (int) sizeof(float));
+	if (framesBuffered <= 0)
+		return;
+	if (framesBuffered > pendingFrames)
+		framesBuffered = pendingFrames;
+	/// Anything the driver did not take is sent first next time.
+	pendingFrames -= framesBuffered;
+	memmove(output, output + framesBuffered * channels, pendingFrames * channels * sizeof(float));
 #endif
 }
-
-
-AudioBufferMarker * AudioMixer::GetMarker(Audio * forAudio)
-{
-	for (int i = 0; i < markers.Size(); ++i)
-	{
-		AudioBufferMarker * abm = markers[i];
-		if (abm->audio == forAudio)
-			return abm;
-	}
-	return NULL;
-}
-
-void AudioMixer::PrintQueue(String text, int fromIndex, int toIndex)
-{
-	std::cout<<"\n"<<text;
-	for (int i = fromIndex; i < toIndex; ++i)
-	{
-		std::cout<<"\nAQ "<<i<<": "<<pcmQueueF[i];
-	}
-}
@@ -7,56 +7,96 @@
 
 #include "List/List.h"
 #include "String/AEString.h"
+#include "AudioTypes.h"
+#include "MixerSource.h"
 
 class Audio;
 
-// For organizing internally in the mixer, making sure audio is buffered correctly.
-#define ABM AudioBufferMarker
-struct AudioBufferMarker 
+/// Frames mixed per pass, few enough that the bus buffers stay in cache.
+#define AUDIO_MIX_FRAMES		256
+/// Most frames sent to the driver per update.
+#define AUDIO_SEND_FRAMES		1024
+
+/** Sub-mix of all sources of one AudioType, e.g. music or sound effects, with its own volume.
+	Mixed into the master output once all its sources have been added.
+*/
+struct AudioBus
 {
-	Audio * audio;
-	int pcmQueueIndex; // index in the queue it was last buffered to in samples
+	AudioBus();
+	~AudioBus();
+	/// 0 to 1. Set by the AudioManager from its category volumes.
+	float volume;
+	bool muted;
+private:
+	friend class AudioMixer;
+	/// Interleaved sum of the sources of the current pass.
+	float * pcm;
+	/// If any source was mixed into pcm this pass. Silent buses are skipped.
+	bool active;
+	/// Volume the last pass ended at, which the next one ramps from.
+	float mixedVolume;
 };
 
-class AudioMixer 
+/** Mixes the sources of all playing Audio into sub-buses by AudioType, and those into the master output for the driver.
+	Sources are fed blocks of decoded PCM, see MixerSource, and are resampled to the mixer's format if needed.
+	Sources are added and removed on the audio thread, while their blocks may be decoded on any one other thread each.
+*/
+class AudioMixer
 {
 	friend class AudioManager;
 	AudioMixer();
 	~AudioMixer();
 public:
+	/// Checks that sources are mixed exactly, resampled, and averaged when downmixed. Asserts on failure.
+	static void UnitTest();
 	static void AllocateMaster();
 	static void DeallocateMaster();
 
 	/// Buffers floating point [-1,1]-based PCM data.
 	void BufferPCMFloat(Audio * audio, float * buffer, int samples, int channels);
-	/// Buffers short [-32768,32767]-based PCM data.
-	void BufferPCMShort(Audio * audio, short * buffer, int samples, int channels, float volume);
+	/** Buffers short [-32768,32767]-based PCM data, copying it into the blocks of the audio's source.
+		Returns samples buffered, fewer if the source is full. Decoders can use Source to write straight into the blocks instead.
+		Mixed into the bus given when the source was created, or that of AudioType::NONE.
+	*/
+	int BufferPCMShort(Audio * audio, short * buffer, int samples, int channels, int sampleRate, float volume);
 
-	/// Sends update to driver, moves back data and updates marker locations.
-	void Update();
+	/** Returns the source of given audio, creating it with given format, mixed into the bus of given AudioType, if needed.
+		Returns NULL if the format is not supported.
+	*/
+	MixerSource * Source(Audio * audio, int channels, int sampleRate, int audioType);
+	/// Returns the source of given audio, or NULL if it has none.
+	MixerSource * GetSource(Audio * forAudio);
+	/// Removes and deletes the source of given audio, dropping anything not yet mixed.
+	void RemoveSource(Audio * forAudio);
+	/// Bus for given AudioType.
+	AudioBus * Bus(int audioType);
 
-	/// Depends on current marker in buffer.
-	int SamplesToBuffer(Audio * forAudio);
+	/// Sends update to driver, mixing as much as it can take.
+	void Update();
+	/// Mixes the next frames of all sources into output, interleaved at the mixer's channels and sample rate.
+	void Mix(float * output, int frames);
 
+	/// Output format. Taken from the driver when it is known.
+	int channels;
+	int sampleRate;
 private:
 	/// 0 to 1, preferably (might go over though, if amplifying).
 	float volume;
 	/// o.o
 	bool muted;
+	/// Volume the last pass ended at, which the next one ramps from.
+	float mixedVolume;
 	/// Sends current buffer to audio driver.
 	void SendToDriver(int driverID);
-	AudioBufferMarker * GetMarker(Audio * forAudio);
-
-	void PrintQueue(String text, int fromIndex, int toIndex);
-	/// 
-//	char * pcmQueueC;
-	
-	// Default?
-	float * pcmQueueF;
-	int queueSampleTotal;
-
-	List<AudioBufferMarker*> markers;
 
+	List<MixerSource*> sources;
+	AudioBus buses[AudioType::NUM_TYPES];
+	/// Shared by all sources while mixing, see MixerSource::Mix.
+	float * inputScratch;
+	float * outputScratch;
+	/// Mixed output, of which the first pendingFrames were not yet taken by the driver.
+	float * output;
+	int pendingFrames;
 };
 
 /// 1 mixer.
@@ -0,0 +1,112 @@
+/// Emil Hedemalm
+/// 2016-08-30
+/// Checks that the AudioMixer mixes, resamples and downmixes sources correctly.
+
+#include "AudioMixer.h"
+#include "MathLib/Constants.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+/// Format of the test mixer, as a typical shared-mode device.
+#define TEST_RATE		48000
+#define TEST_CHANNELS	2
+
+/// Fills the free blocks of a source from a looping buffer of interleaved samples, as a decoder would.
+static void Decode(MixerSource * source, const short * pcm, int pcmFrames, int & frame)
+{
+	int channels = source->channels;
+	PCMBlock * block;
+	while ((block = source->AcquireBlock()) != NULL)
+	{
+		for (int copied = 0; copied < PCM_BLOCK_FRAMES; )
+		{
+			int frames = PCM_BLOCK_FRAMES - copied;
+			if (frames > pcmFrames - frame)
+				frames = pcmFrames - frame;
+			memcpy(block->samples + copied * channels, pcm + frame * channels, frames * channels * sizeof(short));
+			copied += frames;
+			frame = (frame + frames) % pcmFrames;
+		}
+		source->Submit(PCM_BLOCK_FRAMES);
+	}
+}
+
+void AudioMixer::UnitTest()
+{
+	AudioMixer mixer;
+	mixer.channels = TEST_CHANNELS;
+	mixer.sampleRate = TEST_RATE;
+	char key;
+
+	/// Same format: the output should be exactly the samples at the source's volume.
+	const int pcmSamples = 1 << 16;
+	short * pcm = new short[pcmSamples];
+	for (int i = 0; i < pcmSamples; ++i)
+		pcm[i] = (short) ((i * 7919) % 65536 - 32768);
+	float * output = new float[AUDIO_SEND_FRAMES * TEST_CHANNELS];
+	MixerSource * source = mixer.Source((Audio*) &key, TEST_CHANNELS, TEST_RATE, AudioType::SFX);
+	source->SetVolume(0.5f);
+	int frame = 0;
+	Decode(source, pcm, pcmSamples / TEST_CHANNELS, frame);
+	mixer.Mix(output, AUDIO_SEND_FRAMES);
+	for (int i = 0; i < AUDIO_SEND_FRAMES * TEST_CHANNELS; ++i)
+		assert(fabs(output[i] - pcm[i] / 32768.f * 0.5f) <= 1e-6f);
+	mixer.RemoveSource((Audio*) &key);
+
+	/// 44.1 kHz mono sine, mixed in several updates: should come out as the same sine at 48 kHz on both channels.
+	const int sineRate = 44100, sineFrequency = 440;
+	for (int i = 0; i < sineRate; ++i)
+		pcm[i] = (short) (16384 * sin(2 * PI * sineFrequency * i / sineRate));
+	source = mixer.Source((Audio*) &key, 1, sineRate, AudioType::SPEECH);
+	source->SetVolume(1.f);
+	frame = 0;
+	for (int update = 0; update < 8; ++update)
+	{
+		Decode(source, pcm, sineRate, frame);
+		memset(output, 0, AUDIO_SEND_FRAMES * TEST_CHANNELS * sizeof(float));
+		mixer.Mix(output, AUDIO_SEND_FRAMES);
+		for (int i = 0; i < AUDIO_SEND_FRAMES; ++i)
+		{
+			double t = (update * AUDIO_SEND_FRAMES + i) / (double) TEST_RATE;
+			float expected = (float) (0.5 * sin(2 * PI * sineFrequency * t));
+			for (int c = 0; c < TEST_CHANNELS; ++c)
+				assert(fabs(output[i * TEST_CHANNELS + c] - expected) < 2e-3f);
+		}
+	}
+	mixer.RemoveSource((Audio*) &key);
+
+	/// Stereo on a mono mixer, at the same and at a different rate: both channels should be averaged, not the right one dropped.
+	mixer.channels = 1;
+	const int downmixRates[2] = {TEST_RATE, sineRate};
+	for (int r = 0; r < 2; ++r)
+	{
+		int downmixRate = downmixRates[r];
+		const int downmixFrequency = 50;
+		for (int i = 0; i < pcmSamples / 2; ++i)
+		{
+			short left = (short) (16384 * sin(2 * PI * downmixFrequency * i / downmixRate));
+			pcm[i * 2] = left;
+			pcm[i * 2 + 1] = left / 2;
+		}
+		source = mixer.Source((Audio*) &key, 2, downmixRate, AudioType::SFX);
+		source->SetVolume(1.f);
+		frame = 0;
+		for (int update = 0; update < 4; ++update)
+		{
+			Decode(source, pcm, pcmSamples / 2, frame);
+			memset(output, 0, AUDIO_SEND_FRAMES * sizeof(float));
+			mixer.Mix(output, AUDIO_SEND_FRAMES);
+			for (int i = 0; i < AUDIO_SEND_FRAMES; ++i)
+			{
+				double t = (update * AUDIO_SEND_FRAMES + i) / (double) TEST_RATE;
+				float expected = (float) (0.75 * 0.5 * sin(2 * PI * downmixFrequency * t));
+				assert(fabs(output[i] - expected) < 2e-3f);
+			}
+		}
+		mixer.RemoveSource((Audio*) &key);
+	}
+
+	delete[] output;
+	delete[] pcm;
+}
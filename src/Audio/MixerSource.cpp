@@ -0,0 +1,248 @@
+/// Emil Hedemalm
+/// 2016-08-30
+/// Source of PCM for the AudioMixer, fed decoded blocks through lock-free queues and resampled to the mixer's rate.
+
+#include "MixerSource.h"
+#include "PCMMix.h"
+#include <cstring>
+
+PCMBlockQueue::PCMBlockQueue()
+: head(0), tail(0)
+{
+	memset(slots, 0, sizeof(slots));
+}
+
+/// Producer side. Returns false if full.
+bool PCMBlockQueue::Push(PCMBlock * block)
+{
+	unsigned int t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) >= PCM_QUEUE_SLOTS)
+		return false;
+	slots[t % PCM_QUEUE_SLOTS] = block;
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+/// Consumer side. Returns NULL if empty.
+PCMBlock * PCMBlockQueue::Pop()
+{
+	unsigned int h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire))
+		return NULL;
+	PCMBlock * block = slots[h % PCM_QUEUE_SLOTS];
+	head.store(h + 1, std::memory_order_release);
+	return block;
+}
+
+/// Consumer side. Returns the block at given position from the front without removing it, or NULL if there are not that many.
+PCMBlock * PCMBlockQueue::Peek(int index)
+{
+	unsigned int h = head.load(std::memory_order_relaxed);
+	if (tail.load(std::memory_order_acquire) - h <= (unsigned int) index)
+		return NULL;
+	return slots[(h + index) % PCM_QUEUE_SLOTS];
+}
+
+/// Blocks queued. Only a hint when called from the producer side.
+int PCMBlockQueue::Size() const
+{
+	return (int) (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+}
+
+MixerSource::MixerSource(Audio * audio, int channels, int sampleRate, int bus)
+: audio(audio), channels(channels), sampleRate(sampleRate), bus(bus), queuedFrames(0), volume(1.f)
+{
+	int blockSamples = PCM_BLOCK_FRAMES * channels;
+	sampleMemory = new short[blockSamples * PCM_BLOCKS_PER_SOURCE];
+	for (int i = 0; i < PCM_BLOCKS_PER_SOURCE; ++i)
+	{
+		blocks[i].samples = sampleMemory + i * blockSamples;
+		blocks[i].frames = 0;
+		freeBlocks.Push(&blocks[i]);
+	}
+	acquired = NULL;
+	frameInBlock = 0;
+	mixedVolume = -1.f;
+	memset(previous, 0, sizeof(previous));
+	position = 1.0;
+}
+
+MixerSource::~MixerSource()
+{
+	delete[] sampleMemory;
+}
+
+/// Decoder side. Returns a free block to decode up to PCM_BLOCK_FRAMES frames into, or NULL if all are queued. Returns the same block until it is submitted.
+PCMBlock * MixerSource::AcquireBlock()
+{
+	if (!acquired)
+		acquired = freeBlocks.Pop();
+	return acquired;
+}
+
+/// Decoder side. Queues the acquired block for mixing, with given frames of data in it.
+void MixerSource::Submit(int frames)
+{
+	if (!acquired || frames <= 0)
+		return;
+	if (frames > PCM_BLOCK_FRAMES)
+		frames = PCM_BLOCK_FRAMES;
+	acquired->frames = frames;
+	/// Counted before it is visible to the mixer, so the count never goes below zero.
+	queuedFrames.fetch_add(frames);
+	queuedBlocks.Push(acquired);
+	acquired = NULL;
+}
+
+/// Decoder side. Sets the volume of the source, which the mixer ramps to over its next pass.
+void MixerSource::SetVolume(float newVolume)
+{
+	volume.store(newVolume, std::memory_order_relaxed);
+}
+
+/** Mixer side. Adds up to frames of the source to out, at given channels and sample rate, ramping from the volume of the previous pass.
+	inputScratch must hold (PCM_RESAMPLE_FRAMES + 1) * PCM_MAX_CHANNELS floats, and outputScratch frames * channels floats.
+	Returns frames mixed, fewer if the source ran out of data.
+*/
+int MixerSource::Mix(float * out, int frames, int outChannels, int outSampleRate, float * inputScratch, float * outputScratch)
+{
+	float endVolume = volume.load(std::memory_order_relaxed);
+	float startVolume = mixedVolume < 0 ? endVolume : mixedVolume;
+	mixedVolume = endVolume;
+	int mixed = 0;
+
+	/// Same format as the mixer: convert and add straight from the blocks.
+	if (sampleRate == outSampleRate && channels == outChannels)
+	{
+		while (mixed < frames)
+		{
+			PCMBlock * block = queuedBlocks.Peek(0);
+			if (!block)
+				break;
+			int count = block->frames - frameInBlock;
+			if (count > frames - mixed)
+				count = frames - mixed;
+			MixPCMShort(block->samples + frameInBlock * channels, out + mixed * channels, count * channels,
+				RampedVolume(startVolume, endVolume, mixed, frames), RampedVolume(startVolume, endVolume, mixed + count, frames));
+			Consume(count);
+			mixed += count;
+		}
+		return mixed;
+	}
+
+	/** Linear interpolation between source frames. The frames read are laid out in inputScratch after the previous frame consumed,
+		with position the read position relative to that, so that interpolation carries on seamlessly from one pass to the next.
+	*/
+	double step = sampleRate / (double) outSampleRate;
+	/// More source channels than outputs, e.g. stereo to mono, are averaged rather than dropped.
+	bool downmix = channels > outChannels;
+	while (mixed < frames)
+	{
+		/// Output frames for which the needed source frames fit in the scratch.
+		int count = frames - mixed;
+		int fitting = (int) ((PCM_RESAMPLE_FRAMES - 1 - position) / step) + 1;
+		if (count > fitting)
+			count = fitting > 0 ? fitting : 1;
+		int needed = (int) (position + (count - 1) * step) + 1;
+		if (needed > PCM_RESAMPLE_FRAMES)
+			needed = PCM_RESAMPLE_FRAMES;
+		memcpy(inputScratch, previous, channels * sizeof(float));
+		int available = Convert(inputScratch + channels, needed) + 1;
+
+		int produced = 0;
+		double at = position;
+		float * to = outputScratch;
+		for (; produced < count; ++produced, at += step)
+		{
+			int index = (int) at;
+			if (index + 1 >= available)
+				break;
+			float fraction = (float) (at - index);
+			const float * from = inputScratch + index * channels;
+			for (int c = 0; c < outChannels; ++c)
+			{
+				if (downmix)
+				{
+					/// Output c is the average of source channels c, c + outChannels and so on.
+					float sum = 0;
+					int folded = 0;
+					for (int s = c; s < channels; s += outChannels, ++folded)
+						sum += from[s] + (from[s + channels] - from[s]) * fraction;
+					*to++ = sum / folded;
+					continue;
+				}
+				/// Mono is spread to all outputs, otherwise source channels repeat across extra outputs.
+				int sourceChannel = c % channels;
+				float a = from[sourceChannel], b = from[sourceChannel + channels];
+				*to++ = a + (b - a) * fraction;
+			}
+		}
+		if (produced == 0)
+			break;
+		MixPCMFloat(outputScratch, out + mixed * outChannels, produced * outChannels,
+			RampedVolume(startVolume, endVolume, mixed, frames), RampedVolume(startVolume, endVolume, mixed + produced, frames));
+		mixed += produced;
+
+		/// The frame read from last becomes the new previous frame. Frames before it are done with.
+		int done = (int) at;
+		if (done > available - 1)
+			done = available - 1;
+		memcpy(previous, inputScratch + done * channels, channels * sizeof(float));
+		Consume(done);
+		position = at - done;
+		if (produced < count)
+			break;
+	}
+	return mixed;
+}
+
+/// True if everything submitted has been mixed.
+bool MixerSource::Drained() const
+{
+	return queuedFrames.load(std::memory_order_acquire) <= 0;
+}
+
+/// Frames submitted but not yet mixed. Only a hint when called from the decoder side.
+int MixerSource::QueuedFrames() const
+{
+	return queuedFrames.load(std::memory_order_acquire);
+}
+
+/// Converts up to count frames, from the current read position onwards, to floats in out. Returns frames converted.
+int MixerSource::Convert(float * out, int count)
+{
+	int converted = 0;
+	int offset = frameInBlock;
+	for (int i = 0; converted < count; ++i)
+	{
+		PCMBlock * block = queuedBlocks.Peek(i);
+		if (!block)
+			break;
+		int fromBlock = block->frames - offset;
+		if (fromBlock > count - converted)
+			fromBlock = count - converted;
+		ConvertPCMShort(block->samples + offset * channels, out + converted * channels, fromBlock * channels);
+		converted += fromBlock;
+		offset = 0;
+	}
+	return converted;
+}
+
+/// Moves the read position forward, returning blocks which are done to the decoder.
+void MixerSource::Consume(int count)
+{
+	queuedFrames.fetch_sub(count);
+	frameInBlock += count;
+	for (PCMBlock * block = queuedBlocks.Peek(0); block && frameInBlock >= block->frames; block = queuedBlocks.Peek(0))
+	{
+		frameInBlock -= block->frames;
+		queuedBlocks.Pop();
+		freeBlocks.Push(block);
+	}
+}
+
+/// Volume to use after given share of the current pass.
+float MixerSource::RampedVolume(float startVolume, float endVolume, int done, int total) const
+{
+	return startVolume + (endVolume - startVolume) * done / total;
+}
@@ -0,0 +1,118 @@
+/// Emil Hedemalm
+/// 2016-08-30
+/// Source of PCM for the AudioMixer, fed decoded blocks through lock-free queues and resampled to the mixer's rate.
+
+#ifndef MIXER_SOURCE_H
+#define MIXER_SOURCE_H
+
+#include <atomic>
+
+class Audio;
+
+/// Frames per decoded block. About 21 ms at 48 kHz.
+#define PCM_BLOCK_FRAMES		1024
+/// Blocks per source, which bounds how far ahead of playback a source can be decoded.
+#define PCM_BLOCKS_PER_SOURCE	8
+/// Slots in a PCMBlockQueue. A power of two, and no fewer than the blocks of a source, so that queueing a block never fails.
+#define PCM_QUEUE_SLOTS			8
+/// Most channels of a source or of the mixer output.
+#define PCM_MAX_CHANNELS		8
+/// Source frames converted per resampling pass. Sizes the input scratch given to MixerSource::Mix.
+#define PCM_RESAMPLE_FRAMES		512
+
+/// Decoded interleaved 16-bit PCM, handed from a decoder to the mixer.
+struct PCMBlock
+{
+	/// Room for PCM_BLOCK_FRAMES frames at the source's channels.
+	short * samples;
+	/// Frames of valid data in samples.
+	int frames;
+};
+
+/** Fixed-size queue of blocks between exactly one producing and one consuming thread, needing no locks.
+	Each side only writes its own index, and publishes it with release ordering once the slot is written or read.
+*/
+class PCMBlockQueue
+{
+public:
+	PCMBlockQueue();
+	/// Producer side. Returns false if full.
+	bool Push(PCMBlock * block);
+	/// Consumer side. Returns NULL if empty.
+	PCMBlock * Pop();
+	/// Consumer side. Returns the block at given position from the front without removing it, or NULL if there are not that many.
+	PCMBlock * Peek(int index);
+	/// Blocks queued. Only a hint when called from the producer side.
+	int Size() const;
+private:
+	PCMBlock * slots[PCM_QUEUE_SLOTS];
+	/// Counts of blocks popped and pushed, which wrap around. Slots are indexed by them modulo PCM_QUEUE_SLOTS.
+	std::atomic<unsigned int> head, tail;
+};
+
+/** Owns the blocks of one playing Audio, which circulate between a decoder and the mixer without locks or allocation:
+	the decoder acquires a free block, fills it and submits it, and the mixer returns it once mixed.
+	The decoder side (AcquireBlock, Submit, SetVolume) may run on any one thread, the mixer side (Mix, Drained) on the mixer's.
+	A source whose rate and channels match the mixer's is mixed straight from its blocks. Others are linearly interpolated.
+*/
+class MixerSource
+{
+public:
+	MixerSource(Audio * audio, int channels, int sampleRate, int bus);
+	~MixerSource();
+
+	/// Decoder side. Returns a free block to decode up to PCM_BLOCK_FRAMES frames into, or NULL if all are queued. Returns the same block until it is submitted.
+	PCMBlock * AcquireBlock();
+	/// Decoder side. Queues the acquired block for mixing, with given frames of data in it.
+	void Submit(int frames);
+	/// Decoder side. Sets the volume of the source, which the mixer ramps to over its next pass.
+	void SetVolume(float volume);
+
+	/** Mixer side. Adds up to frames of the source to out, at given channels and sample rate, ramping from the volume of the previous pass.
+		inputScratch must hold (PCM_RESAMPLE_FRAMES + 1) * PCM_MAX_CHANNELS floats, and outputScratch frames * channels floats.
+		Returns frames mixed, fewer if the source ran out of data.
+	*/
+	int Mix(float * out, int frames, int outChannels, int outSampleRate, float * inputScratch, float * outputScratch);
+	/// True if everything submitted has been mixed.
+	bool Drained() const;
+	/// Frames submitted but not yet mixed. Only a hint when called from the decoder side.
+	int QueuedFrames() const;
+
+	/// Audio this is the source of. Only used to find it.
+	Audio * audio;
+	/// Format of the decoded blocks.
+	int channels;
+	int sampleRate;
+	/// Index of the AudioBus mixed into.
+	int bus;
+private:
+	/// Not copyable, as it owns its blocks.
+	MixerSource(const MixerSource & other);
+	void operator = (const MixerSource & other);
+
+	/// Converts up to count frames, from the current read position onwards, to floats in out. Returns frames converted.
+	int Convert(float * out, int count);
+	/// Moves the read position forward, returning blocks which are done to the decoder.
+	void Consume(int count);
+	/// Volume to use after given share of the current pass.
+	float RampedVolume(float startVolume, float endVolume, int done, int total) const;
+
+	PCMBlock blocks[PCM_BLOCKS_PER_SOURCE];
+	short * sampleMemory;
+	/// Blocks waiting to be mixed, and blocks free to decode into.
+	PCMBlockQueue queuedBlocks, freeBlocks;
+	/// Taken from freeBlocks by the decoder, but not yet submitted.
+	PCMBlock * acquired;
+	/// Frames of the front queued block which have been mixed.
+	int frameInBlock;
+	std::atomic<int> queuedFrames;
+	std::atomic<float> volume;
+	/// Volume the last pass ended at, or negative before the first.
+	float mixedVolume;
+
+	/// Resampling state: the last source frame consumed, and the read position relative to it, in source frames.
+	float previous[PCM_MAX_CHANNELS];
+	double position;
+};
+
+#endif
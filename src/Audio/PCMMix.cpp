@@ -0,0 +1,120 @@
+/// Emil Hedemalm
+/// 2016-08-30
+/// Conversion and mixing of interleaved PCM samples, using SSE2 where available.
+
+#include "PCMMix.h"
+#include "SSE.h"
+
+/// SSE2 is needed for the integer conversions. Any x86-64 compiler has it even where USE_SSE is not defined.
+#if defined(USE_SSE) || defined(__SSE2__)
+#define PCM_MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+#define SHORT_TO_FLOAT (1.f / 32768.f)
+
+#ifdef PCM_MIX_SSE2
+/// Sign-extends 8 shorts to two vectors of 4 floats each.
+static inline void ShortsToFloats(const short * in, __m128 & low, __m128 & high)
+{
+	__m128i shorts = _mm_loadu_si128((const __m128i*) in);
+	/// Unpacking a value with itself puts it in the upper half of each int, which the arithmetic shift then sign-extends.
+	low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(shorts, shorts), 16));
+	high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(shorts, shorts), 16));
+}
+#endif
+
+/// Converts 16-bit samples to floats in [-1,1).
+void ConvertPCMShort(const short * in, float * out, int samples)
+{
+	int i = 0;
+#ifdef PCM_MIX_SSE2
+	const __m128 scale = _mm_set1_ps(SHORT_TO_FLOAT);
+	for (; i + 8 <= samples; i += 8)
+	{
+		__m128 low, high;
+		ShortsToFloats(in + i, low, high);
+		_mm_storeu_ps(out + i, _mm_mul_ps(low, scale));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(high, scale));
+	}
+#endif
+	for (; i < samples; ++i)
+		out[i] = in[i] * SHORT_TO_FLOAT;
+}
+
+/** Converts 16-bit samples and adds them to out, scaled by a volume going linearly from startVolume to endVolume over the samples.
+	Ramping the volume like this keeps changes between blocks from clicking.
+*/
+void MixPCMShort(const short * in, float * out, int samples, float startVolume, float endVolume)
+{
+	if (samples <= 0)
+		return;
+	/// The conversion scale is folded into the volume.
+	float volume = startVolume * SHORT_TO_FLOAT;
+	float step = (endVolume - startVolume) * SHORT_TO_FLOAT / samples;
+	int i = 0;
+#ifdef PCM_MIX_SSE2
+	__m128 volumes = _mm_setr_ps(volume, volume + step, volume + step * 2, volume + step * 3);
+	const __m128 step4 = _mm_set1_ps(step * 4);
+	for (; i + 8 <= samples; i += 8)
+	{
+		__m128 low, high;
+		ShortsToFloats(in + i, low, high);
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(low, volumes)));
+		volumes = _mm_add_ps(volumes, step4);
+		_mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(high, volumes)));
+		volumes = _mm_add_ps(volumes, step4);
+	}
+#endif
+	for (; i < samples; ++i)
+		out[i] += in[i] * (volume + step * i);
+}
+
+/// Adds in to out, scaled by a volume going linearly from startVolume to endVolume over the samples.
+void MixPCMFloat(const float * in, float * out, int samples, float startVolume, float endVolume)
+{
+	if (samples <= 0)
+		return;
+	float step = (endVolume - startVolume) / samples;
+	int i = 0;
+#ifdef PCM_MIX_SSE2
+	__m128 volumes = _mm_setr_ps(startVolume, startVolume + step, startVolume + step * 2, startVolume + step * 3);
+	const __m128 step4 = _mm_set1_ps(step * 4);
+	for (; i + 4 <= samples; i += 4)
+	{
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), volumes)));
+		volumes = _mm_add_ps(volumes, step4);
+	}
+#endif
+	for (; i < samples; ++i)
+		out[i] += in[i] * (startVolume + step * i);
+}
+
+/// Scales by a volume going linearly from startVolume to endVolume, then clamps to [-1,1], as the last step before sending to a driver.
+void FinishPCMFloat(float * pcm, int samples, float startVolume, float endVolume)
+{
+	if (samples <= 0)
+		return;
+	float step = (endVolume - startVolume) / samples;
+	int i = 0;
+#ifdef PCM_MIX_SSE2
+	__m128 volumes = _mm_setr_ps(startVolume, startVolume + step, startVolume + step * 2, startVolume + step * 3);
+	const __m128 step4 = _mm_set1_ps(step * 4);
+	const __m128 one = _mm_set1_ps(1.f), minusOne = _mm_set1_ps(-1.f);
+	for (; i + 4 <= samples; i += 4)
+	{
+		__m128 scaled = _mm_mul_ps(_mm_loadu_ps(pcm + i), volumes);
+		_mm_storeu_ps(pcm + i, _mm_max_ps(_mm_min_ps(scaled, one), minusOne));
+		volumes = _mm_add_ps(volumes, step4);
+	}
+#endif
+	for (; i < samples; ++i)
+	{
+		float f = pcm[i] * (startVolume + step * i);
+		if (f > 1)
+			f = 1;
+		if (f < -1)
+			f = -1;
+		pcm[i] = f;
+	}
+}
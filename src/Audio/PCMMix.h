@@ -0,0 +1,19 @@
+/// Emil Hedemalm
+/// 2016-08-30
+/// Conversion and mixing of interleaved PCM samples, using SSE2 where available.
+
+#ifndef PCM_MIX_H
+#define PCM_MIX_H
+
+/// Converts 16-bit samples to floats in [-1,1).
+void ConvertPCMShort(const short * in, float * out, int samples);
+/** Converts 16-bit samples and adds them to out, scaled by a volume going linearly from startVolume to endVolume over the samples.
+	Ramping the volume like this keeps changes between blocks from clicking.
+*/
+void MixPCMShort(const short * in, float * out, int samples, float startVolume, float endVolume);
+/// Adds in to out, scaled by a volume going linearly from startVolume to endVolume over the samples.
+void MixPCMFloat(const float * in, float * out, int samples, float startVolume, float endVolume);
+/// Scales by a volume going linearly from startVolume to endVolume, then clamps to [-1,1], as the last step before sending to a driver.
+void FinishPCMFloat(float * pcm, int samples, float startVolume, float endVolume);
+
+#endif
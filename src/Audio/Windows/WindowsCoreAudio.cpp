@@ -349,6 +349,18 @@ int WMMDevice::BufferData(char * data, int maxBytes)
 	return bytesWritten;
 }
 
+/// Channels of the mix format, interleaved in the data buffered.
+int WMMDevice::Channels()
+{
+	return pwfx ? pwfx->nChannels : 0;
+}
+
+/// Frames per second of the mix format.
+int WMMDevice::SampleRate()
+{
+	return pwfx ? pwfx->nSamplesPerSec : 0;
+}
+
 int WMMDevice::BytesPerFrame()
 {
 	return this->pwfx->nChannels * this->pwfx->wBitsPerSample / 8;
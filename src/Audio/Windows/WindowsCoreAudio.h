@@ -53,6 +53,10 @@ public:
 	int SamplesToBuffer();
 	/// Buffers data. Returns amount of bytes actually buffered, or -1 on error.
 	int BufferData(char * data, int maxData);
+	/// Channels of the mix format, interleaved in the data buffered.
+	int Channels();
+	/// Frames per second of the mix format.
+	int SampleRate();
 
 private:
 
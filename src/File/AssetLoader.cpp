@@ -0,0 +1,280 @@
+/// Emil Hedemalm
+/// 2016-08-22
+/// Loads textures and models on a pool of worker threads, handing them back to the managers once done.
+
+#include "AssetLoader.h"
+
+#include "File/FileUtil.h"
+#include "Texture.h"
+#include "TextureManager.h"
+#include "Model/Model.h"
+#include "Model/ModelManager.h"
+#include "Graphics/GraphicsManager.h"
+#include "Graphics/Messages/GraphicsMessage.h"
+#include <iostream>
+
+AssetRequest::AssetRequest(int type, String source)
+: type(type), source(source), state(PENDING), texture(NULL), model(NULL)
+{
+}
+
+AssetLoader * AssetLoader::assetLoader = NULL;
+
+void AssetLoader::Allocate()
+{
+	assert(assetLoader == NULL);
+	assetLoader = new AssetLoader();
+}
+
+/// Stops the workers, deleting assets which were loaded but never handed over.
+void AssetLoader::Deallocate()
+{
+	assert(assetLoader);
+	delete assetLoader;
+	assetLoader = NULL;
+}
+
+AssetLoader::AssetLoader()
+: stopWorkers(false), pending(0)
+{
+	/// The state processor and graphics thread are busy with their own things, but always use at least one.
+	int numWorkers = (int) std::thread::hardware_concurrency() - 1;
+	if (numWorkers < 1)
+		numWorkers = 1;
+	for (int i = 0; i < numWorkers; ++i)
+		workers.AddItem(new std::thread(&AssetLoader::WorkerLoop, this));
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		stopWorkers = true;
+	}
+	requestQueued.notify_all();
+	for (int i = 0; i < workers.Size(); ++i)
+	{
+		workers[i]->join();
+		delete workers[i];
+	}
+	workers.Clear();
+	/// Anything still pending was never handed over to the managers.
+	for (auto it = requests.begin(); it != requests.end(); ++it)
+	{
+		AssetRequest * request = it->second;
+		if (request->state == AssetRequest::PENDING)
+		{
+			delete request->texture;
+			delete request->model;
+		}
+		delete request;
+	}
+	requests.clear();
+}
+
+/// Queues the texture at given resolved source for loading, or returns the request already pending for it.
+AssetRequest * AssetLoader::LoadTexture(String source, AssetCallback callback, void * callbackData)
+{
+	return Request(AssetRequest::TEXTURE, source, callback, callbackData);
+}
+
+/// Queues the .obj at given resolved source for loading, or returns the request already pending for it.
+AssetRequest * AssetLoader::LoadModel(String source, AssetCallback callback, void * callbackData)
+{
+	return Request(AssetRequest::MODEL, source, callback, callbackData);
+}
+
+/// Returns a finished request for a texture already loaded by the TextureManager.
+AssetRequest * AssetLoader::Loaded(Texture * texture, AssetCallback callback, void * callbackData)
+{
+	return Finished(AssetRequest::TEXTURE, texture->source, texture, NULL, callback, callbackData);
+}
+
+/// Returns a finished request for a model already loaded by the ModelManager.
+AssetRequest * AssetLoader::Loaded(Model * model, AssetCallback callback, void * callbackData)
+{
+	return Finished(AssetRequest::MODEL, model->Source(), NULL, model, callback, callbackData);
+}
+
+/** Hands assets finished since the last call over to their managers, queues their bufferization and calls the requests' callbacks.
+	Call from the thread which loads assets synchronously, i.e. the state processor.
+*/
+void AssetLoader::Process()
+{
+	List<AssetRequest*> done;
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		if (finished.Size() == 0)
+			return;
+		done = finished;
+		finished.Clear();
+	}
+	for (int i = 0; i < done.Size(); ++i)
+	{
+		AssetRequest * request = done[i];
+		/// The manager may have loaded the same asset synchronously meanwhile, in which case that one is kept.
+		if (request->texture)
+		{
+			Texture * texture = TexMan.AddTexture(request->texture);
+			if (texture == request->texture)
+				Graphics.QueueMessage(new GMBufferTexture(texture));
+			request->texture = texture;
+		}
+		else if (request->model)
+		{
+			Model * model = ModelMan.AddModel(request->model);
+			if (model == request->model)
+				Graphics.QueueMessage(new GMBufferMesh(model->GetTriangulatedMesh()));
+			request->model = model;
+		}
+		List<AssetCallback> callbacks;
+		List<void*> callbackData;
+		{
+			std::lock_guard<std::mutex> lock(requestMutex);
+			request->state = (request->texture || request->model) ? AssetRequest::LOADED : AssetRequest::FAILED;
+			--pending;
+			callbacks = request->callbacks;
+			callbackData = request->callbackData;
+			request->callbacks.Clear();
+			request->callbackData.Clear();
+		}
+		for (int j = 0; j < callbacks.Size(); ++j)
+			callbacks[j](request, callbackData[j]);
+	}
+}
+
+/// Amount of requests not yet handed over by Process, e.g. for loading screens.
+int AssetLoader::Pending()
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	return pending;
+}
+
+/** Returns the request for given source, queueing it if new or if a previous load of it has finished.
+	Adds the callback, to be called by Process once done.
+*/
+AssetRequest * AssetLoader::Request(int type, String source, AssetCallback callback, void * callbackData)
+{
+	std::string key = String(String(type) + ":" + source).c_str();
+	AssetRequest * request = NULL;
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		auto it = requests.find(key);
+		if (it != requests.end())
+			request = it->second;
+		else
+		{
+			request = new AssetRequest(type, source);
+			/// Marked finished so that it is queued below.
+			request->state = AssetRequest::FAILED;
+			requests[key] = request;
+		}
+		/// Finished earlier, but the manager no longer has it (or never got it), so load it again.
+		if (request->state != AssetRequest::PENDING)
+		{
+			request->state = AssetRequest::PENDING;
+			request->texture = NULL;
+			request->model = NULL;
+			/// Created here rather than by the workers, since the constructor hands out IDs.
+			if (type == AssetRequest::TEXTURE)
+			{
+				request->texture = new Texture();
+				request->texture->source = source;
+			}
+			++pending;
+			queued.Push(request);
+			requestQueued.notify_one();
+		}
+		if (callback)
+		{
+			request->callbacks.AddItem(callback);
+			request->callbackData.AddItem(callbackData);
+		}
+	}
+	return request;
+}
+
+/// Returns the request for given source, marked as loaded with given asset.
+AssetRequest * AssetLoader::Finished(int type, String source, Texture * texture, Model * model, AssetCallback callback, void * callbackData)
+{
+	std::string key = String(String(type) + ":" + source).c_str();
+	AssetRequest * request = NULL;
+	bool callNow = false;
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		auto it = requests.find(key);
+		if (it != requests.end())
+			request = it->second;
+		else
+		{
+			request = new AssetRequest(type, source);
+			/// Nothing to load, it is marked as loaded below.
+			request->state = AssetRequest::LOADED;
+			requests[key] = request;
+		}
+		/// Already being loaded, e.g. if loaded synchronously after the async request was made. Process will resolve it to the loaded asset.
+		if (request->state == AssetRequest::PENDING)
+		{
+			if (callback)
+			{
+				request->callbacks.AddItem(callback);
+				request->callbackData.AddItem(callbackData);
+			}
+			return request;
+		}
+		request->texture = texture;
+		request->model = model;
+		request->state = AssetRequest::LOADED;
+		callNow = callback != NULL;
+	}
+	if (callNow)
+		callback(request, callbackData);
+	return request;
+}
+
+void AssetLoader::WorkerLoop()
+{
+	while (true)
+	{
+		AssetRequest * request = NULL;
+		{
+			std::unique_lock<std::mutex> lock(requestMutex);
+			while (!stopWorkers && queued.Length() == 0)
+				requestQueued.wait(lock);
+			if (stopWorkers)
+				return;
+			request = queued.Pop();
+		}
+		Load(request);
+		std::lock_guard<std::mutex> lock(requestMutex);
+		finished.AddItem(request);
+	}
+}
+
+/// Reads the request's asset into memory. Called by the workers.
+void AssetLoader::Load(AssetRequest * request)
+{
+	String source = request->source;
+	if (request->type == AssetRequest::TEXTURE)
+	{
+		Texture * texture = request->texture;
+		if (FileExists(source) && texture->LoadFromFile())
+		{
+			texture->SetSource(source);
+			texture->SetName(source);
+		}
+		else
+		{
+			std::cout<<"\nAssetLoader: Unable to load texture "<<source;
+			delete texture;
+			request->texture = NULL;
+		}
+	}
+	else if (request->type == AssetRequest::MODEL)
+	{
+		/// The pool is shared by all workers, whose batches take turns, instead of each reading large files on a pool of its own.
+		request->model = ModelManager::ReadObj(source, ModelMan.jobPool);
+		if (!request->model)
+			std::cout<<"\nAssetLoader: Unable to load model "<<source;
+	}
+}
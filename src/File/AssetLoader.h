@@ -0,0 +1,122 @@
+/// Emil Hedemalm
+/// 2016-08-22
+/// Loads textures and models on a pool of worker threads, handing them back to the managers once done.
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "String/AEString.h"
+#include "List/List.h"
+#include "Queue/Queue.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
+#include <string>
+
+class Texture;
+class Model;
+class AssetRequest;
+
+/// Called once a request has finished, successfully or not, from the thread calling AssetLoader::Process.
+typedef void (*AssetCallback)(AssetRequest * request, void * data);
+
+/** Handle to an asset being loaded by the AssetLoader, returned straight away by e.g. TextureManager::LoadTextureAsync.
+	There is only one request per source, so duplicate requests share it. Requests are owned by the loader and stay valid until it is deallocated.
+*/
+class AssetRequest
+{
+	friend class AssetLoader;
+public:
+	enum {
+		TEXTURE,
+		MODEL,
+	};
+	enum {
+		PENDING,
+		LOADED,
+		FAILED,
+	};
+	int Type() const { return type; };
+	int State() const { return state; };
+	/// If it has either loaded or failed.
+	bool IsDone() const { return state != PENDING; };
+	/// Resolved source the asset is read from.
+	const String & Source() const { return source; };
+	/// The loaded texture, or NULL if not loaded (yet).
+	Texture * GetTexture() const { return state == LOADED ? texture : NULL; };
+	/// The loaded model, or NULL if not loaded (yet).
+	Model * GetModel() const { return state == LOADED ? model : NULL; };
+private:
+	AssetRequest(int type, String source);
+	int type;
+	String source;
+	std::atomic<int> state;
+	Texture * texture;
+	Model * model;
+	/// To call once done, guarded by the loader's mutex.
+	List<AssetCallback> callbacks;
+	List<void*> callbackData;
+};
+
+#define AssetLoad	(*AssetLoader::Instance())
+
+/** Decodes textures and parses models on a set of worker threads, so that maps may be loaded and assets streamed in without stalling the game.
+	Workers only read the asset into memory. Process, called each frame by the state processor, registers finished assets with the
+	TextureManager and ModelManager and queues their bufferization to the graphics thread, which owns the GL context.
+	Use through the managers' Async-functions, which resolve paths and check for already loaded assets first.
+*/
+class AssetLoader
+{
+	AssetLoader();
+	~AssetLoader();
+	static AssetLoader * assetLoader;
+public:
+	static void Allocate();
+	static AssetLoader * Instance() { return assetLoader; };
+	/// Stops the workers, deleting assets which were loaded but never handed over.
+	static void Deallocate();
+
+	/// Queues the texture at given resolved source for loading, or returns the request already pending for it.
+	AssetRequest * LoadTexture(String source, AssetCallback callback = NULL, void * callbackData = NULL);
+	/// Queues the .obj at given resolved source for loading, or returns the request already pending for it.
+	AssetRequest * LoadModel(String source, AssetCallback callback = NULL, void * callbackData = NULL);
+	/// Returns a finished request for a texture already loaded by the TextureManager.
+	AssetRequest * Loaded(Texture * texture, AssetCallback callback = NULL, void * callbackData = NULL);
+	/// Returns a finished request for a model already loaded by the ModelManager.
+	AssetRequest * Loaded(Model * model, AssetCallback callback = NULL, void * callbackData = NULL);
+
+	/** Hands assets finished since the last call over to their managers, queues their bufferization and calls the requests' callbacks.
+		Call from the thread which loads assets synchronously, i.e. the state processor.
+	*/
+	void Process();
+	/// Amount of requests not yet handed over by Process, e.g. for loading screens.
+	int Pending();
+	/// Amount of worker threads.
+	int Workers() const { return workers.Size(); };
+private:
+	/** Returns the request for given source, queueing it if new or if a previous load of it has finished.
+		Adds the callback, to be called by Process once done.
+	*/
+	AssetRequest * Request(int type, String source, AssetCallback callback, void * callbackData);
+	/// Returns the request for given source, marked as loaded with given asset.
+	AssetRequest * Finished(int type, String source, Texture * texture, Model * model, AssetCallback callback, void * callbackData);
+	void WorkerLoop();
+	/// Reads the request's asset into memory. Called by the workers.
+	void Load(AssetRequest * request);
+
+	List<std::thread*> workers;
+	/// Guards everything below as well as the requests' callbacks.
+	std::mutex requestMutex;
+	std::condition_variable requestQueued;
+	bool stopWorkers;
+	/// All requests made, by type and source.
+	std::unordered_map<std::string, AssetRequest*> requests;
+	Queue<AssetRequest*> queued;
+	/// Loaded or failed by the workers, to be handed over by Process.
+	List<AssetRequest*> finished;
+	int pending;
+};
+
+#endif
@@ -12,6 +12,7 @@
 #endif
 
 #include <fstream>
+#include <cstdlib>
 
 /// For converting 4-byted endianness!
 int FourSwap (int i){
@@ -396,3 +397,21 @@ String GetFirstFreePath(String pathPreExtension, String extension){
 	assert(false && "FileUtil.cpp, GetFirstFreePath: No valid path found, inform the user");
 	return path;
 }
+
+/// Returns the system's folder for temporary files, ending with a slash. For files which should not be left in the working directory, such as those of tests.
+String GetTemporaryFolder()
+{
+#ifdef WINDOWS
+	char folder[MAX_PATH + 1];
+	DWORD length = GetTempPathA(MAX_PATH + 1, folder);
+	if (length > 0 && length <= MAX_PATH)
+		return String(folder);
+	return String();
+#else
+	const char * folder = getenv("TMPDIR");
+	String path = folder && folder[0] ? folder : "/tmp";
+	if (!path.EndsWith('/'))
+		path += "/";
+	return path;
+#endif
+}
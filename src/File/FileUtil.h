@@ -44,4 +44,7 @@ bool EnsureFoldersExistForPath(String path);
 /// For example "var/bra/da", ".awe", might return "var/bra/da15.awe" if 14 occurences already exist.
 String GetFirstFreePath(String pathPreExtension, String extension);
 
+/// Returns the system's folder for temporary files, ending with a slash. For files which should not be left in the working directory, such as those of tests.
+String GetTemporaryFolder();
+
 #endif
@@ -8,6 +8,7 @@
 #include "FileUtil.h"
 #include "Time/Time.h"
 #include <fstream>
+#include <mutex>
 
 #include "Output.h"
 
@@ -31,6 +32,10 @@ void LogToFile(String fileName,  String codeFile, String function, String logTex
 	if (causeAssertionError)
 		assert(false && "LogFile-triggered assertion error. See relevant log file for details.");
 
+	/// Logged to from worker threads as well, e.g. by the AssetLoader.
+	static std::mutex logMutex;
+	std::lock_guard<std::mutex> lock(logMutex);
+
 	Time time = Time::Now();
 	String timeString = time.ToString("H:m:S ");
 	String logTextWithFunction = codeFile +"::"+function+" "+logText;
@@ -0,0 +1,129 @@
+/// Emil Hedemalm
+/// 2016-08-21
+/// Read-only memory mapping of whole files.
+
+#include "MappedFile.h"
+
+#if defined LINUX | defined OSX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+: data(NULL), size(0)
+{
+#ifdef WINDOWS
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+#else
+	fileDescriptor = -1;
+#endif
+}
+
+/// Unmaps the file, if still mapped.
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/// Maps the whole file at given path. Returns false if it could not be opened, or is empty.
+bool MappedFile::Open(String path)
+{
+	Close();
+#ifdef WINDOWS
+	fileHandle = CreateFile(path.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		Close();
+		return false;
+	}
+	data = (const char*) MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+	size = fileSize.QuadPart;
+#else
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+	void * mapping = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	data = (const char*) mapping;
+	size = fileStat.st_size;
+#endif
+	return true;
+}
+
+/// Unmaps the file. Pointers into it are no longer valid afterwards.
+void MappedFile::Close()
+{
+#ifdef WINDOWS
+	if (data)
+		UnmapViewOfFile(data);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+	mappingHandle = NULL;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (data)
+		munmap((void*) data, size);
+	if (fileDescriptor >= 0)
+		close(fileDescriptor);
+	fileDescriptor = -1;
+#endif
+	data = NULL;
+	size = 0;
+}
+
+/// 64-bit FNV-1a hash of the contents.
+uint64 MappedFile::ContentHash() const
+{
+	return Hash(data, size);
+}
+
+/// 64-bit FNV-1a hash of given bytes.
+uint64 MappedFile::Hash(const void * bytes, int64 numBytes)
+{
+	const unsigned char * b = (const unsigned char*) bytes;
+	uint64 hash = 14695981039346656037ULL;
+	for (int64 i = 0; i < numBytes; ++i)
+	{
+		hash ^= b[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/// Hash of the contents of the file at given path, or 0 if it could not be read.
+uint64 MappedFile::HashFile(String path)
+{
+	MappedFile file;
+	if (!file.Open(path))
+		return 0;
+	return file.ContentHash();
+}
@@ -0,0 +1,56 @@
+/// Emil Hedemalm
+/// 2016-08-21
+/// Read-only memory mapping of whole files.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "String/AEString.h"
+#include "OS/OS.h"
+#include "System/DataTypes.h"
+
+#if defined WINDOWS
+	#include "OS/WindowsIncludes.h"
+#endif
+
+/** Maps a whole file into memory for reading, so that binary data can be used straight from the OS's page cache,
+	instead of being read through a stream field by field. The mapping is page-aligned.
+*/
+class MappedFile 
+{
+	MappedFile(const MappedFile & otherFile);
+	void operator = (const MappedFile & otherFile);
+public:
+	MappedFile();
+	/// Unmaps the file, if still mapped.
+	~MappedFile();
+	/// Maps the whole file at given path. Returns false if it could not be opened, or is empty.
+	bool Open(String path);
+	/// Unmaps the file. Pointers into it are no longer valid afterwards.
+	void Close();
+	bool IsOpen() const { return data != NULL; };
+
+	/// Start of the mapped contents.
+	const char * Data() const { return data; };
+	/// In bytes.
+	int64 Size() const { return size; };
+
+	/// 64-bit FNV-1a hash of the contents.
+	uint64 ContentHash() const;
+	/// 64-bit FNV-1a hash of given bytes.
+	static uint64 Hash(const void * bytes, int64 numBytes);
+	/// Hash of the contents of the file at given path, or 0 if it could not be read.
+	static uint64 HashFile(String path);
+
+private:
+	const char * data;
+	int64 size;
+#ifdef WINDOWS
+	HANDLE fileHandle;
+	HANDLE mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
+
+#endif
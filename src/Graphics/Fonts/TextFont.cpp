@@ -587,6 +587,7 @@ bool TextFont::PrepareForRender(GraphicsState & graphicsState, float textSizePix
 		texture->releaseOnBufferization = false;
 		TexMan.BufferizeTexture(texture);
 	}
+	TexMan.MarkUsed(texture);
 
 	/// Prepare shader.
 	if (shaderBased)
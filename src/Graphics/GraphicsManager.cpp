@@ -37,6 +37,7 @@
 #include "GraphicsProperty.h"
 
 #include "File/LogFile.h"
+#include "Thread/JobPool.h"
 
 //#include "Texture/Texture.h"
 //#include "Texture/TextureManager.h"
@@ -128,6 +129,7 @@ GraphicsManager::GraphicsManager()
 	deferredRenderingBox->SetDimensions(-size, size, -size, size);
 
 	renderSettings = new RenderSettings();
+	jobPool = new JobPool();
 
 	paused = false;
 	processing = false;
@@ -196,6 +198,7 @@ GraphicsManager::~GraphicsManager()
 	messageQueue.ClearAndDelete();
 
 	/// Delete stuff
+	SAFE_DELETE(jobPool);
 	if (deferredRenderingBox){
 		delete deferredRenderingBox;
 		deferredRenderingBox = NULL;
@@ -34,6 +34,7 @@ class ParticleSystem;
 class RenderRay;
 class AppWindow;
 class RenderPipeline;
+class JobPool;
 
 #define MAX_TEXTURES	250
 
@@ -240,6 +241,8 @@ public:
 
 	/// CBA friending all message-functions...
 	RenderSettings * renderSettings;
+	/// Worker threads for data-parallel work within the graphics thread, such as CPU skinning of large meshes.
+	JobPool * jobPool;
 
 	/// Wooo. Font-handlin'
 	TextFont * GetFont(String byName);
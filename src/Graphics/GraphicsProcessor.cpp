@@ -348,6 +348,9 @@ PROCESSOR_THREAD_START(GraphicsManager)
 					renderTimer.Stop();
 					FrameStats.renderTotal = float (renderTimer.GetMs());
 					Graphics.renderQueried = false;
+
+					/// Release textures unused for a while if over the memory budget.
+					TexMan.UpdateResidency();
 				
 				}
 			
@@ -84,6 +84,7 @@ void GraphicsProperty::OnRegister()
 
 
 #include "GraphicsState.h"
+#include "Physics/PhysicsManager.h"
 
 /// Processes estimators related to this entity.
 void GraphicsProperty::Process(int timeInMs, GraphicsState & graphicsState)
@@ -95,6 +96,19 @@ void GraphicsProperty::Process(int timeInMs, GraphicsState & graphicsState)
 		owner->RecalculateMatrix(transform, &smoothedPosition);
 		// TODO: Add a flag for temporal Anti-Alisasin so that not ALL static entities too have their shit recalculated each frame... ?
 	}
+	/// With fixed physics time steps, render in-between the last two steps, so that motion stays smooth at any frame rate.
+	else if (owner->physics && Physics.InterpolatedPosition(owner, smoothedPosition))
+	{
+		owner->RecalculateMatrix(transform, &smoothedPosition);
+		owner->renderTransform = &transform;
+		owner->renderPosition = &smoothedPosition;
+	}
+	/// Stopped moving, or fixed time steps were disabled.
+	else if (owner->renderTransform == &transform)
+	{
+		owner->renderTransform = &owner->transformationMatrix;
+		owner->renderPosition = &owner->worldPosition;
+	}
 
 	if (allAnimationsPaused)
 		return;
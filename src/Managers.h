@@ -22,6 +22,7 @@
 #include "Pathfinding/WaypointManager.h"
 #include "Audio/AudioManager.h"
 #include "TextureManager.h"
+#include "File/AssetLoader.h"
 #include "Game/GameVariableManager.h"
 #include "Script/ScriptManager.h"
 #include "Graphics/FrameStatistics.h"
@@ -73,22 +73,24 @@ int TileGrid2D::GenerateWaypoints(NavMesh * navMesh, float maxNeighbourDistance)
 		wp->pData = tile;
 //		std::cout<<"\nTile types: "<<TileTypes.Types();
 		assert(TileTypes.Types() && "Load and set tile types first?");
+		bool passable;
 		/// Null-types
 		if (tile->type == NULL){
-			wp->passable = tile->IsVacant();	
+			passable = tile->IsVacant();	
 		}
 		/// Valid types
 		else {
-			wp->passable = tile->type->walkability;
+			passable = tile->type->walkability;
 			/// If any objects exist on this tile, mark it as unwalkable!
 			if (tile->objects.Size())
 			{
-				wp->passable = false;
+				passable = false;
 			}
 		}
 
 
 		navMesh->AddWaypoint(wp);
+		navMesh->SetPassable(wp, passable);
 	FOR_TILE_END
 
 	navMesh->ConnectWaypointsByProximity(maxNeighbourDistance);
@@ -0,0 +1,700 @@
+/// Emil Hedemalm
+/// 2016-08-23
+/// Expression compiled to a compact stack bytecode, for evaluating the same expression many times per frame.
+
+#include "CompiledExpression.h"
+#include "Timer/Timer.h"
+#include <cmath>
+#include <cassert>
+#include <iostream>
+
+/// Arguments given to a NumericFunction are gathered on the stack, so limit them.
+#define MAX_FUNCTION_ARGUMENTS	16
+
+CompiledExpression::CompiledExpression()
+: stackDepth(0), maxStackDepth(0), compiled(false)
+{
+}
+
+/** Compiles the parsed expression. Each variable in it is looked up in slotNames (case-insensitive), and will be read from the same index
+	in the array given to Evaluate. Variables not found there must be constants, such as PI.
+	Returns false if it could not be compiled, e.g. due to unknown variables, strings or syntax errors, with the reason in Error().
+*/
+bool CompiledExpression::Compile(const Expression & expression, const List<String> & names)
+{
+	code.Clear();
+	constants.Clear();
+	functions.Clear();
+	stack.Clear();
+	error = String();
+	stackDepth = maxStackDepth = 0;
+	functionEvaluators = expression.functionEvaluators;
+	slotNames = names;
+	for (int i = 0; i < slotNames.Size(); ++i)
+		slotNames[i].SetComparisonMode(String::NOT_CASE_SENSITIVE);
+	compiled = false;
+	if (expression.symbols.Size() == 0)
+	{
+		error = "Empty expression";
+		return false;
+	}
+	if (!CompileRange(expression.symbols, 0, expression.symbols.Size()))
+		return false;
+	/// Sized once, so that evaluation never allocates.
+	ExpressionValue zero;
+	zero.type = DataType::INTEGER;
+	zero.iValue = 0;
+	zero.fValue = 0;
+	for (int i = 0; i < maxStackDepth; ++i)
+		stack.AddItem(zero);
+	compiled = true;
+	return true;
+}
+
+/** Evaluates using given variables, ordered as the slotNames given to Compile. Variables must be of type FLOAT or INTEGER.
+	Only type, iResult and fResult are set in the result, and text only on errors, in which case type is NO_TYPE.
+	Uses an internal stack, so the same object may not be evaluated from several threads at once.
+*/
+ExpressionResult CompiledExpression::Evaluate(const Variable * slots)
+{
+	ExpressionValue value;
+	if (!Evaluate(slots, value))
+		return ExpressionResult::Error(error);
+	ExpressionResult result(value.type);
+	result.iResult = value.iValue;
+	result.fResult = value.fValue;
+	return result;
+}
+
+/// Evaluates into a value, returning false on errors.
+bool CompiledExpression::Evaluate(const Variable * slots, ExpressionValue & value)
+{
+	if (!compiled)
+	{
+		error = "Expression not compiled";
+		return false;
+	}
+	const Instruction * instructions = code.GetArray();
+	const ExpressionValue * constantValues = constants.GetArray();
+	int numInstructions = code.Size();
+	/// Points to the topmost value, if any.
+	ExpressionValue * top = stack.GetArray() - 1;
+	for (int i = 0; i < numInstructions; ++i)
+	{
+		const Instruction & instruction = instructions[i];
+		switch(instruction.op)
+		{
+			case PUSH_CONSTANT:
+				*++top = constantValues[instruction.index];
+				break;
+			case PUSH_SLOT:
+			{
+				const Variable & var = slots[instruction.index];
+				++top;
+				switch(var.type)
+				{
+					case DataType::FLOAT:	top->type = DataType::FLOAT;	top->fValue = var.fValue;	break;
+					case DataType::BOOLEAN:
+					case DataType::INTEGER:	top->type = DataType::INTEGER;	top->iValue = var.iValue;	break;
+					default:
+						error = "Undefined variable data type of \'"+slotNames[instruction.index]+"\'";
+						return false;
+				}
+				break;
+			}
+			case NEGATE:
+				if (top->type == DataType::INTEGER)
+					top->iValue = -top->iValue;
+				else
+					top->fValue = -top->fValue;
+				break;
+			case CALL:
+			{
+				Function & function = functions[instruction.index];
+				int count = instruction.count;
+				top -= count;
+				ExpressionValue * arguments = top + 1;
+				ExpressionValue result;
+				if (function.numeric)
+				{
+					float floatArguments[MAX_FUNCTION_ARGUMENTS];
+					for (int j = 0; j < count; ++j)
+						floatArguments[j] = arguments[j].Float();
+					result.type = DataType::FLOAT;
+					result.fValue = function.numeric(floatArguments, count);
+				}
+				else if (!CallEvaluator(function, arguments, count, result))
+					return false;
+				*++top = result;
+				break;
+			}
+			default:
+			{
+				/// Binary operators.
+				ExpressionValue & b = *top--;
+				ExpressionValue & a = *top;
+				int op = instruction.op;
+				if (a.type == DataType::INTEGER && b.type == DataType::INTEGER)
+				{
+					int one = a.iValue, two = b.iValue;
+					switch(op)
+					{
+						case ADD:			a.iValue = one + two; break;
+						case SUBTRACT:		a.iValue = one - two; break;
+						case MULTIPLY:		a.iValue = one * two; break;
+						case DIVIDE:
+						case MODULO:
+							if (two == 0)
+							{
+								error = "Division by zero";
+								return false;
+							}
+							a.iValue = op == DIVIDE? one / two : one % two;
+							break;
+						case POWER:			a.iValue = (int) pow((float)one, (float)two); break;
+						case LESS:			a.iValue = one < two; break;
+						case LESS_EQUAL:	a.iValue = one <= two; break;
+						case GREATER:		a.iValue = one > two; break;
+						case GREATER_EQUAL:	a.iValue = one >= two; break;
+						case EQUAL:			a.iValue = one == two; break;
+						case NOT_EQUAL:		a.iValue = one != two; break;
+						case AND:			a.iValue = one && two; break;
+						case OR:			a.iValue = one || two; break;
+					}
+					break;
+				}
+				float one = a.Float(), two = b.Float();
+				a.type = DataType::FLOAT;
+				switch(op)
+				{
+					case ADD:			a.fValue = one + two; break;
+					case SUBTRACT:		a.fValue = one - two; break;
+					case MULTIPLY:		a.fValue = one * two; break;
+					case DIVIDE:		a.fValue = one / two; break;
+					case MODULO:		a.fValue = fmod(one, two); break;
+					case POWER:			a.fValue = pow(one, two); break;
+					default:
+						/// Comparisons and logical operators give integers.
+						a.type = DataType::INTEGER;
+						switch(op)
+						{
+							case LESS:			a.iValue = one < two; break;
+							case LESS_EQUAL:	a.iValue = one <= two; break;
+							case GREATER:		a.iValue = one > two; break;
+							case GREATER_EQUAL:	a.iValue = one >= two; break;
+							case EQUAL:			a.iValue = one == two; break;
+							case NOT_EQUAL:		a.iValue = one != two; break;
+							case AND:			a.iValue = one != 0 && two != 0; break;
+							case OR:			a.iValue = one != 0 || two != 0; break;
+						}
+				}
+				break;
+			}
+		}
+	}
+	value = *top;
+	return true;
+}
+
+
+/** Compares Expression::Evaluate against compiled evaluation of the given expression and variables, printing the time taken by each.
+	Returns false if the results differ or it could not be compiled.
+*/
+bool CompiledExpression::Benchmark(String text, List<Variable> variables, int iterations)
+{
+	Expression expression;
+	expression.functionEvaluators.Add(&defMatFuncEval);
+	if (!expression.ParseExpression(text))
+	{
+		std::cout<<"\nCompiledExpression::Benchmark: Unable to parse "<<text;
+		return false;
+	}
+	List<String> names;
+	for (int i = 0; i < variables.Size(); ++i)
+		names.Add(variables[i].name);
+	CompiledExpression compiledExpression;
+	if (!compiledExpression.Compile(expression, names))
+	{
+		std::cout<<"\nCompiledExpression::Benchmark: Unable to compile "<<text<<": "<<compiledExpression.Error();
+		return false;
+	}
+	ExpressionResult interpreted, compiledResult;
+	Timer timer;
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		interpreted = expression.Evaluate(variables);
+	timer.Stop();
+	int64 interpretedMs = timer.GetMs();
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		compiledResult = compiledExpression.Evaluate(variables);
+	timer.Stop();
+	int64 compiledMs = timer.GetMs();
+	std::cout<<"\nCompiledExpression::Benchmark: "<<text<<" x"<<iterations<<": interpreted "<<interpretedMs<<" ms, compiled "<<compiledMs<<" ms";
+	/// Expression passes values around as text, so allow for some rounding.
+	float one = interpreted.GetFloat(), two = compiledResult.GetFloat();
+	float tolerance = 0.0001f * (1 + AbsoluteValue(one));
+	if (interpreted.type == DataType::NO_TYPE || compiledResult.type == DataType::NO_TYPE || AbsoluteValue(one - two) > tolerance)
+	{
+		std::cout<<"\nCompiledExpression::Benchmark: Results differ, interpreted "<<one<<", compiled "<<two;
+		return false;
+	}
+	return true;
+}
+
+
+/// Compiles the expression for slots x and y.
+static bool CompileTestExpression(const char * text, Expression & expression, CompiledExpression & compiledExpression)
+{
+	expression.functionEvaluators.Add(&defMatFuncEval);
+	if (!expression.ParseExpression(text))
+		return false;
+	List<String> names;
+	names.Add(String("X"), String("y"));
+	return compiledExpression.Compile(expression, names);
+}
+
+/// Evaluates the compiled expression for x = 3 and y = 1.5.
+static ExpressionResult EvaluateTestExpression(const char * text)
+{
+	Expression expression;
+	CompiledExpression compiledExpression;
+	if (!CompileTestExpression(text, expression, compiledExpression))
+		return ExpressionResult::Error(compiledExpression.Error());
+	List<Variable> variables;
+	variables.Add(Variable("x", 3), Variable("y", 1.5f));
+	return compiledExpression.Evaluate(variables);
+}
+
+/// Asserts that the compiled expression gives a result of given type and value for x = 3 and y = 1.5.
+static void AssertCompiledResult(const char * text, int type, float value)
+{
+	ExpressionResult result = EvaluateTestExpression(text);
+	assert(result.type == type);
+	assert(AbsoluteValue(result.GetFloat() - value) < 0.0001f);
+}
+
+/** Compares compiled evaluation against Expression::Evaluate, and checks operators, functions and errors which Expression does not support.
+	Expects Expression::InitializeConstants to have been called.
+*/
+void CompiledExpression::UnitTest()
+{
+	const char * interpretable[] = {"1+2*3", "(1+2)*3", "x*2+y", "x/2", "10%3", "2^3", "x>2", "PI*2", "7/2", "7.0/2", "y*y-x", "x*2+y*(x+y)/3"};
+	const int numInterpretable = sizeof(interpretable) / sizeof(const char *);
+	for (int i = 0; i < numInterpretable; ++i)
+	{
+		Expression expression;
+		CompiledExpression compiledExpression;
+		/// Compiled outside the assert, so that the evaluation below has something to run without it.
+		bool compiled = CompileTestExpression(interpretable[i], expression, compiledExpression);
+		assert(compiled);
+		(void) compiled;
+		List<Variable> variables;
+		variables.Add(Variable("x", 3), Variable("y", 1.5f));
+		ExpressionResult interpreted = expression.Evaluate(variables);
+		ExpressionResult compiledResult = compiledExpression.Evaluate(variables);
+		/// Expression passes values around as text, so allow for some rounding.
+		float one = interpreted.GetFloat(), two = compiledResult.GetFloat();
+		assert(interpreted.type != DataType::NO_TYPE && compiledResult.type == interpreted.type);
+		assert(AbsoluteValue(one - two) <= 0.0001f * (1 + AbsoluteValue(one)));
+	}
+
+	/// Precedence, associativity and unary minus.
+	AssertCompiledResult("x-1-1", DataType::INTEGER, 1);
+	AssertCompiledResult("2-3*x+y/2", DataType::FLOAT, -6.25f);
+	AssertCompiledResult("-x+3", DataType::INTEGER, 0);
+	AssertCompiledResult("3-x*-1", DataType::INTEGER, 6);
+	AssertCompiledResult("-(x+1)*2", DataType::INTEGER, -8);
+	AssertCompiledResult("2*-y", DataType::FLOAT, -3);
+	/// Functions, numeric or not.
+	AssertCompiledResult("abs(x-10)", DataType::FLOAT, 7);
+	AssertCompiledResult("abs(-2.5)*(x+1)", DataType::FLOAT, 10);
+	AssertCompiledResult("abs((x))+Random(x,x)", DataType::FLOAT, 6);
+	/// Comparisons and logical operators on floats give integers.
+	AssertCompiledResult("x<=2 || y==1.5", DataType::INTEGER, 1);
+	AssertCompiledResult("x<=2 && y==1.5", DataType::INTEGER, 0);
+	AssertCompiledResult("y>1 && x<4", DataType::INTEGER, 1);
+
+	/// Errors when compiling or evaluating.
+	ExpressionResult divisionByZero = EvaluateTestExpression("1/0");
+	assert(divisionByZero.type == DataType::NO_TYPE);
+	(void) divisionByZero;
+	const char * uncompilable[] = {"z+1", "(1+2", "\"a\""};
+	const int numUncompilable = sizeof(uncompilable) / sizeof(const char *);
+	for (int i = 0; i < numUncompilable; ++i)
+	{
+		Expression expression;
+		CompiledExpression compiledExpression;
+		bool compiled = CompileTestExpression(uncompilable[i], expression, compiledExpression);
+		assert(!compiled);
+		(void) compiled;
+		assert(!compiledExpression.IsCompiled() && compiledExpression.Error().Length() > 0);
+	}
+}
+
+/// Names of the variables in the parsed expression which are not constants, and thus need slots. Each name is listed once.
+List<String> CompiledExpression::RequiredVariables(const Expression & expression)
+{
+	List<String> names;
+	for (int i = 0; i < expression.symbols.Size(); ++i)
+	{
+		const Symbol & symbol = expression.symbols[i];
+		if (symbol.type != Symbol::VARIABLE)
+			continue;
+		String name = symbol.text;
+		name.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+		bool known = false;
+		for (int j = 0; j < names.Size() && !known; ++j)
+			known = names[j] == name;
+		for (int j = 0; j < Expression::constantVariables.Size() && !known; ++j)
+			known = name == Expression::constantVariables[j].name;
+		if (!known)
+			names.AddItem(name);
+	}
+	return names;
+}
+
+/** Compiles symbols [from, to) into postfix instructions, using shunting-yard.
+	Parenthesis and function arguments recurse. Returns false on errors.
+*/
+bool CompiledExpression::CompileRange(const List<Symbol> & symbols, int from, int to)
+{
+	/// Operators waiting for their right-hand operand, lowest precedence first.
+	List<int> operators;
+	bool expectOperand = true;
+	for (int i = from; i < to; ++i)
+	{
+		const Symbol & symbol = symbols[i];
+		if (symbol.type == Symbol::OPERATOR)
+		{
+			int op = OperatorCode(symbol.text);
+			if (expectOperand)
+			{
+				/// Unary signs.
+				if (op == SUBTRACT)
+				{
+					operators.AddItem(NEGATE);
+					continue;
+				}
+				else if (op == ADD)
+					continue;
+				error = "Expected operand before \'"+symbol.text+"\'";
+				return false;
+			}
+			if (op < 0)
+			{
+				error = "Unknown operator \'"+symbol.text+"\'";
+				return false;
+			}
+			PushOperator(operators, op);
+			expectOperand = true;
+			continue;
+		}
+		/// The parser merges signs into constants following variables or parenthesis, e.g. "x-1" gives x and -1, so split them up again.
+		if (!expectOperand && symbol.type == Symbol::CONSTANT && (symbol.text.At(0) == '-' || symbol.text.At(0) == '+'))
+		{
+			PushOperator(operators, symbol.text.At(0) == '-'? SUBTRACT : ADD);
+			PushConstant(symbol.text.Part(1));
+			continue;
+		}
+		if (!expectOperand)
+		{
+			error = "Expected operator before \'"+symbol.text+"\'";
+			return false;
+		}
+		switch(symbol.type)
+		{
+			case Symbol::CONSTANT:
+				PushConstant(symbol.text);
+				break;
+			case Symbol::VARIABLE:
+			{
+				int slot = -1;
+				for (int j = 0; j < slotNames.Size(); ++j)
+				{
+					if (slotNames[j] == symbol.text)
+					{
+						slot = j;
+						break;
+					}
+				}
+				if (slot >= 0)
+				{
+					Emit(PUSH_SLOT, slot);
+					break;
+				}
+				bool found = false;
+				for (int j = 0; j < Expression::constantVariables.Size(); ++j)
+				{
+					Variable & var = Expression::constantVariables[j];
+					var.name.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+					if (var.name == symbol.text)
+					{
+						PushConstant(var);
+						found = true;
+						break;
+					}
+				}
+				if (!found)
+				{
+					error = "Undefined variable \'"+symbol.text+"\'";
+					return false;
+				}
+				break;
+			}
+			case Symbol::BEGIN_PARENTHESIS:
+			{
+				int closing = ClosingParenthesis(symbols, i);
+				if (closing < 0 || closing >= to)
+				{
+					error = "Unmatched parenthesis";
+					return false;
+				}
+				if (closing == i + 1)
+				{
+					error = "Empty parenthesis";
+					return false;
+				}
+				if (!CompileRange(symbols, i + 1, closing))
+					return false;
+				i = closing;
+				break;
+			}
+			case Symbol::FUNCTION_NAME:
+			{
+				int opening = i + 1;
+				if (opening >= to || symbols[opening].type != Symbol::BEGIN_PARENTHESIS)
+				{
+					error = "Expected parenthesis after function \'"+symbol.text+"\'";
+					return false;
+				}
+				int closing = ClosingParenthesis(symbols, opening);
+				if (closing < 0 || closing >= to)
+				{
+					error = "Unmatched parenthesis in call to \'"+symbol.text+"\'";
+					return false;
+				}
+				/// Compile each argument, separated by commas outside any nested parenthesis.
+				int count = 0;
+				if (closing > opening + 1)
+				{
+					int argumentStart = opening + 1, depth = 0;
+					for (int j = opening + 1; j <= closing; ++j)
+					{
+						int type = symbols[j].type;
+						if (type == Symbol::BEGIN_PARENTHESIS)
+							++depth;
+						else if (type == Symbol::END_PARENTHESIS && j < closing)
+							--depth;
+						else if (j == closing || (type == Symbol::ARGUMENT_ENUMERATOR && depth == 0))
+						{
+							if (j == argumentStart)
+							{
+								error = "Empty argument in call to \'"+symbol.text+"\'";
+								return false;
+							}
+							if (!CompileRange(symbols, argumentStart, j))
+								return false;
+							++count;
+							argumentStart = j + 1;
+						}
+					}
+				}
+				if (count > MAX_FUNCTION_ARGUMENTS)
+				{
+					error = "Too many arguments in call to \'"+symbol.text+"\'";
+					return false;
+				}
+				Function function;
+				function.name = symbol.text;
+				function.evaluator = NULL;
+				function.numeric = NULL;
+				for (int j = 0; j < functionEvaluators.Size(); ++j)
+				{
+					FunctionEvaluator * evaluator = functionEvaluators[j];
+					if (evaluator->IsFunction(symbol.text))
+					{
+						function.evaluator = evaluator;
+						function.numeric = evaluator->GetNumericFunction(symbol.text);
+						break;
+					}
+				}
+				if (!function.evaluator)
+				{
+					error = "Undefined function \'"+symbol.text+"\'";
+					return false;
+				}
+				functions.AddItem(function);
+				Emit(CALL, functions.Size() - 1, count);
+				i = closing;
+				break;
+			}
+			case Symbol::STRING:
+				error = "Strings can not be compiled";
+				return false;
+			default:
+				error = "Unexpected symbol \'"+symbol.text+"\'";
+				return false;
+		}
+		expectOperand = false;
+	}
+	if (expectOperand)
+	{
+		error = "Expected operand at end of expression";
+		return false;
+	}
+	while (operators.Size())
+	{
+		Emit(operators.Last());
+		operators.RemoveLast();
+	}
+	return true;
+}
+
+/// Emits pending operators of same or higher precedence, as all are left-associative, then adds op to them.
+void CompiledExpression::PushOperator(List<int> & operators, int op)
+{
+	while (operators.Size() && Precedence(operators.Last()) >= Precedence(op))
+	{
+		Emit(operators.Last());
+		operators.RemoveLast();
+	}
+	operators.AddItem(op);
+}
+
+/// Returns index of the parenthesis closing the one at index, or -1.
+int CompiledExpression::ClosingParenthesis(const List<Symbol> & symbols, int index)
+{
+	int depth = 0;
+	for (int i = index; i < symbols.Size(); ++i)
+	{
+		if (symbols[i].type == Symbol::BEGIN_PARENTHESIS)
+			++depth;
+		else if (symbols[i].type == Symbol::END_PARENTHESIS)
+		{
+			--depth;
+			if (depth == 0)
+				return i;
+		}
+	}
+	return -1;
+}
+
+int CompiledExpression::OperatorCode(const String & text)
+{
+	if (text == "+")	return ADD;
+	if (text == "-")	return SUBTRACT;
+	if (text == "*")	return MULTIPLY;
+	if (text == "/")	return DIVIDE;
+	if (text == "%")	return MODULO;
+	if (text == "^")	return POWER;
+	if (text == "<")	return LESS;
+	if (text == "<=")	return LESS_EQUAL;
+	if (text == ">")	return GREATER;
+	if (text == ">=")	return GREATER_EQUAL;
+	if (text == "==")	return EQUAL;
+	if (text == "!=")	return NOT_EQUAL;
+	if (text == "&&")	return AND;
+	if (text == "||")	return OR;
+	return -1;
+}
+
+/// Same as in Expression, with unary minus binding the tightest.
+int CompiledExpression::Precedence(int op)
+{
+	switch(op)
+	{
+		case NEGATE:		return 5;
+		case POWER:			return 4;
+		case MULTIPLY:
+		case DIVIDE:
+		case MODULO:		return 3;
+		case ADD:
+		case SUBTRACT:		return 2;
+		case AND:
+		case OR:			return 0;
+		default:			return 1;
+	}
+}
+
+void CompiledExpression::Emit(int op, int index, int count)
+{
+	Instruction instruction;
+	instruction.op = (unsigned char) op;
+	instruction.count = (unsigned char) count;
+	instruction.index = (short) index;
+	code.AddItem(instruction);
+	/// Track how deep the stack gets.
+	switch(op)
+	{
+		case PUSH_CONSTANT:
+		case PUSH_SLOT:		++stackDepth;			break;
+		case NEGATE:								break;
+		case CALL:			stackDepth += 1 - count;	break;
+		default:			--stackDepth;			break;
+	}
+	if (stackDepth > maxStackDepth)
+		maxStackDepth = stackDepth;
+}
+
+void CompiledExpression::PushConstant(const String & constantText)
+{
+	/// Signs are handled as operators, except when merged into the constant by the parser.
+	String text = constantText;
+	if (text.At(0) == '+')
+		text = text.Part(1);
+	ExpressionValue value;
+	if (text.Contains("."))
+	{
+		value.type = DataType::FLOAT;
+		value.fValue = text.ParseFloat();
+		value.iValue = 0;
+	}
+	else
+	{
+		value.type = DataType::INTEGER;
+		value.iValue = text.ParseInt();
+		value.fValue = 0;
+	}
+	constants.AddItem(value);
+	Emit(PUSH_CONSTANT, constants.Size() - 1);
+}
+
+void CompiledExpression::PushConstant(const Variable & variable)
+{
+	ExpressionValue value;
+	value.type = variable.type == DataType::FLOAT? DataType::FLOAT : DataType::INTEGER;
+	value.fValue = variable.fValue;
+	value.iValue = variable.iValue;
+	constants.AddItem(value);
+	Emit(PUSH_CONSTANT, constants.Size() - 1);
+}
+
+/// Calls a function without a NumericFunction through its evaluator, converting arguments to and from strings.
+bool CompiledExpression::CallEvaluator(Function & function, ExpressionValue * arguments, int count, ExpressionValue & result)
+{
+	List<String> argumentStrings;
+	for (int i = 0; i < count; ++i)
+	{
+		if (arguments[i].type == DataType::INTEGER)
+			argumentStrings.AddItem(String(arguments[i].iValue));
+		else
+			argumentStrings.AddItem(String(arguments[i].fValue));
+	}
+	ExpressionResult functionResult;
+	if (!function.evaluator->EvaluateFunction(function.name, argumentStrings, functionResult))
+	{
+		error = "Unable to evaluate function \'"+function.name+"\'";
+		return false;
+	}
+	switch(functionResult.type)
+	{
+		case DataType::FLOAT:	result.type = DataType::FLOAT;	result.fValue = functionResult.fResult;	break;
+		case DataType::BOOLEAN:
+		case DataType::INTEGER:	result.type = DataType::INTEGER;	result.iValue = functionResult.iResult;	break;
+		default:
+			error = "Function \'"+function.name+"\' did not return a number";
+			return false;
+	}
+	return true;
+}
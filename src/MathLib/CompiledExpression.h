@@ -0,0 +1,112 @@
+/// Emil Hedemalm
+/// 2016-08-23
+/// Expression compiled to a compact stack bytecode, for evaluating the same expression many times per frame.
+
+#ifndef COMPILED_EXPRESSION_H
+#define COMPILED_EXPRESSION_H
+
+#include "FunctionEvaluator.h"
+
+/// Numeric value on the evaluation stack. Type is DataType::INTEGER or DataType::FLOAT.
+struct ExpressionValue
+{
+	int type;
+	int iValue;
+	float fValue;
+	float Float() const { return type == DataType::FLOAT ? fValue : (float) iValue; };
+};
+
+/** Compiled form of an Expression.
+	Variables are resolved to indices (slots) in an array given to Evaluate, constants such as PI are folded in,
+	operator precedence is resolved into postfix order, and functions are resolved to their evaluator, or directly to a
+	NumericFunction if the evaluator provides one. Evaluation thus does no parsing, name look-ups or string conversions.
+
+	Results match Expression::Evaluate: operations on two integers give integers, and anything involving a float gives a float.
+	Comparisons and logical operators give integers 0 or 1, also for floats (which Expression does not support).
+	Expressions with strings can not be compiled.
+*/
+class CompiledExpression
+{
+public:
+	CompiledExpression();
+
+	/** Compiles the parsed expression. Each variable in it is looked up in slotNames (case-insensitive), and will be read from the same index
+		in the array given to Evaluate. Variables not found there must be constants, such as PI.
+		Returns false if it could not be compiled, e.g. due to unknown variables, strings or syntax errors, with the reason in Error().
+	*/
+	bool Compile(const Expression & expression, const List<String> & slotNames);
+	/// If compiled successfully.
+	bool IsCompiled() const { return compiled; };
+	/// Reason the last Compile or Evaluate failed.
+	String Error() const { return error; };
+
+	/** Evaluates using given variables, ordered as the slotNames given to Compile. Variables must be of type FLOAT or INTEGER.
+		Only type, iResult and fResult are set in the result, and text only on errors, in which case type is NO_TYPE.
+		Uses an internal stack, so the same object may not be evaluated from several threads at once.
+	*/
+	ExpressionResult Evaluate(const Variable * slots);
+	ExpressionResult Evaluate(List<Variable> & slots) { return Evaluate(slots.GetArray()); };
+	/// Evaluates into a value, returning false on errors.
+	bool Evaluate(const Variable * slots, ExpressionValue & value);
+
+	/// Compares compiled evaluation against Expression::Evaluate, asserting on the results. Expects Expression::InitializeConstants to have been called.
+	static void UnitTest();
+	/** Compares Expression::Evaluate against compiled evaluation of the given expression and variables, printing the time taken by each.
+		Returns false if the results differ or it could not be compiled. Not run by UnitTests, see Benchmarks.
+	*/
+	static bool Benchmark(String expression, List<Variable> variables, int iterations = 100000);
+	/// Names of the variables in the parsed expression which are not constants, and thus need slots. Each name is listed once.
+	static List<String> RequiredVariables(const Expression & expression);
+private:
+	enum opCodes {
+		PUSH_CONSTANT,
+		PUSH_SLOT,
+		NEGATE,
+		ADD, SUBTRACT, MULTIPLY, DIVIDE, MODULO, POWER,
+		LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL,
+		AND, OR,
+		/// Calls functions[index] with the top count values as arguments.
+		CALL,
+	};
+	struct Instruction
+	{
+		unsigned char op;
+		unsigned char count;
+		short index;
+	};
+	struct Function
+	{
+		String name;
+		FunctionEvaluator * evaluator;
+		NumericFunction numeric;
+	};
+
+	/** Compiles symbols [from, to) into postfix instructions, using shunting-yard.
+		Parenthesis and function arguments recurse. Returns false on errors.
+	*/
+	bool CompileRange(const List<Symbol> & symbols, int from, int to);
+	/// Returns index of the parenthesis closing the one at index, or -1.
+	static int ClosingParenthesis(const List<Symbol> & symbols, int index);
+	static int OperatorCode(const String & text);
+	static int Precedence(int op);
+	/// Emits pending operators of same or higher precedence, then adds op to them.
+	void PushOperator(List<int> & operators, int op);
+	void Emit(int op, int index = 0, int count = 0);
+	void PushConstant(const String & text);
+	void PushConstant(const Variable & variable);
+	/// Calls a function without a NumericFunction through its evaluator, converting arguments to and from strings.
+	bool CallEvaluator(Function & function, ExpressionValue * arguments, int count, ExpressionValue & result);
+
+	List<Instruction> code;
+	List<ExpressionValue> constants;
+	List<Function> functions;
+	List<FunctionEvaluator*> functionEvaluators;
+	List<String> slotNames;
+	/// Evaluation stack, sized when compiling.
+	List<ExpressionValue> stack;
+	int stackDepth, maxStackDepth;
+	bool compiled;
+	String error;
+};
+
+#endif
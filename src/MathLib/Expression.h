@@ -36,6 +36,7 @@ public:
 
 class Expression 
 {
+	friend class CompiledExpression;
 public:
 	Expression();
 	/// Creates and parses the expression as based on the provided text, making it ready to call Evaluate straight away.
@@ -32,5 +32,29 @@ bool DefaultMathFunctionEvaluator::IsFunction(String name)
 		return true;
 	return false;
 }
+
+static float NumericRandom(const float * arguments, int count)
+{
+	static Random funcRand;
+	if (count < 2)
+		return 0;
+	return funcRand.Randf(arguments[1] - arguments[0]) + arguments[0];
+}
+
+static float NumericAbs(const float * arguments, int count)
+{
+	if (count < 1)
+		return 0;
+	return AbsoluteValue(arguments[0]);
+}
+
+NumericFunction DefaultMathFunctionEvaluator::GetNumericFunction(String name)
+{
+	if (name == "Random")
+		return NumericRandom;
+	else if (name == "abs")
+		return NumericAbs;
+	return NULL;
+}
 DefaultMathFunctionEvaluator defMatFuncEval;
 
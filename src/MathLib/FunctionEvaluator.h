@@ -7,12 +7,17 @@
 
 #include "Expression.h"
 
+/// Function taking and returning plain numbers, called directly by CompiledExpression.
+typedef float (*NumericFunction)(const float * arguments, int count);
+
 /// Sub-class to handle things.
 class FunctionEvaluator
 {
 public:
 	virtual bool EvaluateFunction(String byName, List<String> arguments, ExpressionResult & result) = 0;
 	virtual bool IsFunction(String name) = 0;
+	/// Returns the named function if it only takes and returns numbers, so that compiled expressions may skip string conversions. NULL by default.
+	virtual NumericFunction GetNumericFunction(String name) { return NULL; };
 };
 
 /**	Enables the following functions in expressions (and in extension Scripts):
@@ -24,6 +29,7 @@ class DefaultMathFunctionEvaluator : public FunctionEvaluator
 public:
 	virtual bool EvaluateFunction(String byName, List<String> arguments, ExpressionResult & result);
 	virtual bool IsFunction(String name);
+	virtual NumericFunction GetNumericFunction(String name);
 };
 extern DefaultMathFunctionEvaluator defMatFuncEval;
 
@@ -18,6 +18,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <cstring>
 #include <Util.h>
 
 #include "Matrix/Matrix.h"
@@ -32,6 +33,12 @@
 #include "TextureManager.h"
 
 #include "File/LogFile.h"
+#include "File/MappedFile.h"
+#include "Thread/JobPool.h"
+
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#endif
 
 Mesh::Mesh()
 {
@@ -178,162 +185,249 @@ void Mesh::DeallocateArrays()
 	faces.Clear();
 }
 
-	struct p1 {
-		float a;
-	};
-	struct p2 {
-		float a,b;
-	};
-	struct p3 {
-		float a,b,c;
-	};
+#define MESH_CURRENT_VERSION 3
 
-#define MESH_CURRENT_VERSION 2
+/** Header of the binary mesh cache, followed by the sections it points to. 
+	Each section starts at an offset from the start of the file aligned to MESH_CACHE_ALIGNMENT, so that the arrays can be read straight from a memory mapping.
+	Vectors are stored as packed floats, regardless of SSE padding.
+*/
+struct MeshCacheHeader 
+{
+	char about[32];
+	int version;
+	/// Of the mesh's source file contents, see MappedFile::HashFile.
+	uint64 sourceHash;
+	int64 fileSize;
+	int numVertices, numUVs, numNormals, numFaces;
+	/// Sum of the amount of vertices in all faces.
+	int numFaceVertices;
+	int triangulated;
+	float centerOfMesh[3];
+	float radiusOrigo;
+	float aabbMin[3], aabbMax[3];
+	int nameLength, sourceLength;
+	/// Section offsets.
+	int64 name, source;
+	/// 3, 2 and 3 floats each.
+	int64 vertices, uvs, normals;
+	/// Amount of vertices in each face.
+	int64 faceSizes;
+	/// For each face, its vertex, uv and normal indices, numVertices each.
+	int64 faceIndices;
+	/// For each face, uvTangent (4 floats) and uvBiTangent (3 floats).
+	int64 faceTangents;
+};
+
+#define MESH_CACHE_ALIGNMENT 16
+#define MESH_CACHE_ABOUT "Erenik Engine Compressed mesh."
+
+/// Reserves a section of given size, returning its offset.
+static int64 AddSection(int64 & fileSize, int64 sectionSize)
+{
+	int64 offset = (fileSize + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+	fileSize = offset + sectionSize;
+	return offset;
+}
 
-/// Load from customized compressed data form. Returns true upon success.
-bool Mesh::SaveCompressedTo(String compressedPath)
+/// Checks that a section lies within the file.
+static bool ValidSection(const MeshCacheHeader & header, int64 offset, int64 sectionSize)
+{
+	return offset >= (int64) sizeof(MeshCacheHeader) && offset % MESH_CACHE_ALIGNMENT == 0 && sectionSize >= 0 && offset + sectionSize <= header.fileSize;
+}
+
+/** Saves to the binary mesh cache format, keyed to a hash of the contents of the source it was loaded from, see MappedFile::HashFile. 
+	The whole file is assembled in memory and written at once. Returns true upon success.
+*/
+bool Mesh::SaveCompressedTo(String compressedPath, uint64 sourceHash)
 {
-	std::fstream file;
-	file.open(compressedPath.c_str(), std::ios_base::out | std::ios_base::binary);
-	if (!file.is_open())
-		return false;
-	String about = "Erenik Engine Compressed mesh.";
-	int version = MESH_CURRENT_VERSION;
-
-	about.WriteTo(file);
-	file.write((char*)&version, sizeof(int));
-	this->name.WriteTo(file);
-	this->source.WriteTo(file);
-
-	// Write extra data so that they do not have to be re-calculated.?
-	centerOfMesh.WriteTo(file);
-	file.write((char*)&radiusOrigo, sizeof(float));
-	file.write((char*)&triangulated, sizeof(bool));
 	// Write AABB data so that it is pre-loaded.
 	assert(aabb && "No aabb when trying to save compressed mesh. Calculate it NOW!");
 	if (!aabb)
 		return false;
 	assert(aabb->scale.MaxPart());
-	aabb->WriteTo(file);
-
-	// Write number of each specific array.
-	file.write((char*)&numVertices, sizeof(int));
-	file.write((char*)&numUVs, sizeof(int));
-	file.write((char*)&numNormals, sizeof(int));
-	file.write((char*)&numFaces, sizeof(int));
-	
-	// Then start writing the data of the arrays.
-	int sizeOfUV = sizeof(Vector2f);
-
-	int sizeOfVector3i = sizeof(Vector3i);
-	int sizeOfVector3f = sizeof(Vector3f);
-	int sizeOfVector3d = sizeof(Vector3d);
-
-	int sizeOfP1 = sizeof(p1);
-	int sizeOfP2 = sizeof(p2);
-	int sizeOfP3 = sizeof(p3);
-
-
-	int sizeOfVertex = sizeOfVector3f;
-
-	Vector3f * vertexArrayPtr = vertices.GetArray();
-
-	int size = numVertices * sizeOfVertex;
 
-	// Write data.
-	
-	for (int i = 0; i < numVertices; ++i)
-		vertices[i].WriteTo(file);
-	for (int i = 0; i < numUVs; ++i)
-		uvs[i].WriteTo(file);
-	for (int i = 0; i < numNormals; ++i)
-		normals[i].WriteTo(file);
-	/*
-	if (numVertices)
-		file.write((char*)vertices.GetArray(), numVertices * sizeOfVertex);
-	if (numUVs)
-		file.write((char*)uvs.GetArray(), numUVs * sizeOfUV);
-	if (numNormals)
-		file.write((char*)normals.GetArray(), numNormals * sizeOfVertex);
-//*/
-
-	// Save all numFaces.
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(MeshCacheHeader));
+	strncpy(header.about, MESH_CACHE_ABOUT, sizeof(header.about) - 1);
+	header.version = MESH_CURRENT_VERSION;
+	header.sourceHash = sourceHash;
+	header.numVertices = numVertices;
+	header.numUVs = numUVs;
+	header.numNormals = numNormals;
+	header.numFaces = numFaces;
 	for (int i = 0; i < numFaces; ++i)
+		header.numFaceVertices += faces[i].numVertices;
+	header.triangulated = triangulated;
+	for (int i = 0; i < 3; ++i)
+	{
+		header.centerOfMesh[i] = centerOfMesh[i];
+		header.aabbMin[i] = aabb->min[i];
+		header.aabbMax[i] = aabb->max[i];
+	}
+	header.radiusOrigo = radiusOrigo;
+	header.nameLength = name.Length();
+	header.sourceLength = source.Length();
+
+	int64 fileSize = sizeof(MeshCacheHeader);
+	header.name = AddSection(fileSize, header.nameLength);
+	header.source = AddSection(fileSize, header.sourceLength);
+	header.vertices = AddSection(fileSize, numVertices * 3 * sizeof(float));
+	header.uvs = AddSection(fileSize, numUVs * 2 * sizeof(float));
+	header.normals = AddSection(fileSize, numNormals * 3 * sizeof(float));
+	header.faceSizes = AddSection(fileSize, numFaces * sizeof(int));
+	header.faceIndices = AddSection(fileSize, header.numFaceVertices * 3 * sizeof(int));
+	header.faceTangents = AddSection(fileSize, numFaces * 7 * sizeof(float));
+	header.fileSize = fileSize;
+
+	char * blob = new char[fileSize];
+	memset(blob, 0, fileSize);
+	memcpy(blob, &header, sizeof(MeshCacheHeader));
+	memcpy(blob + header.name, name.c_str(), header.nameLength);
+	memcpy(blob + header.source, source.c_str(), header.sourceLength);
+	float * f = (float*) (blob + header.vertices);
+	for (int i = 0; i < numVertices; ++i, f += 3)
+	{
+		const Vector3f & vertex = vertices[i];
+		f[0] = vertex.x; f[1] = vertex.y; f[2] = vertex.z;
+	}
+	f = (float*) (blob + header.uvs);
+	for (int i = 0; i < numUVs; ++i, f += 2)
+	{
+		const Vector2f & uv = uvs[i];
+		f[0] = uv.x; f[1] = uv.y;
+	}
+	f = (float*) (blob + header.normals);
+	for (int i = 0; i < numNormals; ++i, f += 3)
+	{
+		const Vector3f & normal = normals[i];
+		f[0] = normal.x; f[1] = normal.y; f[2] = normal.z;
+	}
+	int * faceSizes = (int*) (blob + header.faceSizes);
+	int * faceIndices = (int*) (blob + header.faceIndices);
+	f = (float*) (blob + header.faceTangents);
+	for (int i = 0; i < numFaces; ++i, f += 7)
 	{
 		MeshFace & mf = faces[i];
-		mf.WriteTo(file);
+		int n = faceSizes[i] = mf.numVertices;
+		memcpy(faceIndices, mf.vertices.GetArray(), n * sizeof(int));
+		memcpy(faceIndices + n, mf.uvs.GetArray(), n * sizeof(int));
+		memcpy(faceIndices + 2 * n, mf.normals.GetArray(), n * sizeof(int));
+		faceIndices += 3 * n;
+		f[0] = mf.uvTangent.x; f[1] = mf.uvTangent.y; f[2] = mf.uvTangent.z; f[3] = mf.uvTangent.w;
+		f[4] = mf.uvBiTangent.x; f[5] = mf.uvBiTangent.y; f[6] = mf.uvBiTangent.z;
 	}
-	std::cout<<"\nMesh saved in compressed form to file: "<<compressedPath;
-	return true;
+
+	std::fstream file;
+	file.open(compressedPath.c_str(), std::ios_base::out | std::ios_base::binary);
+	bool ok = file.is_open();
+	if (ok)
+	{
+		file.write(blob, fileSize);
+		ok = file.good();
+		file.close();
+	}
+	delete[] blob;
+	if (ok)
+		std::cout<<"\nMesh saved in compressed form to file: "<<compressedPath;
+	return ok;
 }
 	
-/// Load from customized compressed data form.
-bool Mesh::LoadCompressedFrom(String compressedPath)
+/** Loads from the binary mesh cache format, by mapping the file and reading the arrays straight from it.
+	Returns false if the file is missing, corrupt, of another version, or was saved for another source hash. A sourceHash of 0 accepts any.
+*/
+bool Mesh::LoadCompressedFrom(String compressedPath, uint64 sourceHash)
 {
-	std::fstream file;
-	file.open(compressedPath.c_str(), std::ios_base::in | std::ios_base::binary);
-	if (!file.is_open())
+	MappedFile file;
+	if (!file.Open(compressedPath))
 		return false;
-	String about;
-	int version;
-	about.ReadFrom(file);
-	file.read((char*)&version, sizeof(int));
-	if (version != MESH_CURRENT_VERSION)
+	if (file.Size() < (int64) sizeof(MeshCacheHeader))
 		return false;
-	this->name.ReadFrom(file);
-	this->source.ReadFrom(file);
-	
+	MeshCacheHeader header;
+	memcpy(&header, file.Data(), sizeof(MeshCacheHeader));
+	if (header.version != MESH_CURRENT_VERSION || header.fileSize != file.Size())
+		return false;
+	if (sourceHash && header.sourceHash != sourceHash)
+		return false;
+	if (header.numVertices < 0 || header.numUVs < 0 || header.numNormals < 0 || header.numFaces < 0 || header.numFaceVertices < 0)
+		return false;
+	if (!ValidSection(header, header.name, header.nameLength) ||
+		!ValidSection(header, header.source, header.sourceLength) ||
+		!ValidSection(header, header.vertices, header.numVertices * 3 * (int64) sizeof(float)) ||
+		!ValidSection(header, header.uvs, header.numUVs * 2 * (int64) sizeof(float)) ||
+		!ValidSection(header, header.normals, header.numNormals * 3 * (int64) sizeof(float)) ||
+		!ValidSection(header, header.faceSizes, header.numFaces * (int64) sizeof(int)) ||
+		!ValidSection(header, header.faceIndices, header.numFaceVertices * 3 * (int64) sizeof(int)) ||
+		!ValidSection(header, header.faceTangents, header.numFaces * 7 * (int64) sizeof(float)))
+		return false;
+	const char * data = file.Data();
+	/// Check that the faces add up and only index existing vertices, uvs and normals before allocating anything.
+	const int * faceSizes = (const int*) (data + header.faceSizes);
+	const int * faceIndices = (const int*) (data + header.faceIndices);
+	int64 faceVertices = 0;
+	for (int i = 0; i < header.numFaces; ++i)
+	{
+		int n = faceSizes[i];
+		if (n <= 0 || faceVertices + n > header.numFaceVertices)
+			return false;
+		const int * indices = faceIndices + 3 * faceVertices;
+		for (int j = 0; j < n; ++j)
+		{
+			/// Faces of meshes without uvs or normals index them with 0, see ObjReader.
+			int vertex = indices[j], uv = indices[n + j], normal = indices[2 * n + j];
+			if (vertex < 0 || vertex >= header.numVertices ||
+				(header.numUVs && (uv < 0 || uv >= header.numUVs)) ||
+				(header.numNormals && (normal < 0 || normal >= header.numNormals)))
+				return false;
+		}
+		faceVertices += n;
+	}
+	if (faceVertices != header.numFaceVertices)
+		return false;
+
+	this->name = String(data + header.name, data + header.name + header.nameLength);
+	this->source = String(data + header.source, data + header.source + header.sourceLength);
 	assert(source.Length());
 	assert(name.Length());
 
-	// Write extra data so that they do not have to be re-calculated.?
-	centerOfMesh.ReadFrom(file);
-	file.read((char*)&radiusOrigo, sizeof(float));
-	file.read((char*)&triangulated, sizeof(bool));
-	// Write AABB data so that it is pre-loaded.
+	centerOfMesh = Vector3f(header.centerOfMesh[0], header.centerOfMesh[1], header.centerOfMesh[2]);
+	radiusOrigo = header.radiusOrigo;
+	triangulated = header.triangulated != 0;
+	Vector3f min(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]),
+		max(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
 	if (!aabb) 
-		aabb = new AABB();
-	aabb->ReadFrom(file);
-	
-	// Write number of each specific array.
-	file.read((char*)&numVertices, sizeof(int));
-	file.read((char*)&numUVs, sizeof(int));
-	file.read((char*)&numNormals, sizeof(int));
-	file.read((char*)&numFaces, sizeof(int));
-	
-	// Allocate arrays.
-	AllocateArrays();
-
-	// Then start writing the data of the arrays.
-	int sizeOfVertex = sizeof(Vector3f);
-	int sizeOfUV = sizeof(Vector2f);
-
-	// Load 'em.
-	int sizeOfP1 = sizeof(p1);
-	int sizeOfP2 = sizeof(p2);
-	int sizeOfP3 = sizeof(p3);
-
-	Vector3f * vertexArrayPtr = vertices.GetArray();
-
-	int size = numVertices * sizeOfVertex;
+		aabb = new AABB(min, max);
+	else
+		*aabb = AABB(min, max);
 
-	// Read data.
-	for (int i = 0; i < numVertices; ++i)
-		vertices[i].ReadFrom(file);
-	for (int i = 0; i < numUVs; ++i)
-		uvs[i].ReadFrom(file);
-	for (int i = 0; i < numNormals; ++i)
-		normals[i].ReadFrom(file);
+	numVertices = header.numVertices;
+	numUVs = header.numUVs;
+	numNormals = header.numNormals;
+	numFaces = header.numFaces;
+	AllocateArrays();
 
-	// Load all numFaces.
-	for (int i = 0; i < numFaces; ++i)
+	const float * f = (const float*) (data + header.vertices);
+	for (int i = 0; i < numVertices; ++i, f += 3)
+		vertices[i] = Vector3f(f[0], f[1], f[2]);
+	f = (const float*) (data + header.uvs);
+	for (int i = 0; i < numUVs; ++i, f += 2)
+		uvs[i] = Vector2f(f[0], f[1]);
+	f = (const float*) (data + header.normals);
+	for (int i = 0; i < numNormals; ++i, f += 3)
+		normals[i] = Vector3f(f[0], f[1], f[2]);
+	f = (const float*) (data + header.faceTangents);
+	for (int i = 0; i < numFaces; ++i, f += 7)
 	{
 		MeshFace & mf = faces[i];
-		mf.ReadFrom(file);
-//		mf.Print();	
+		int n = mf.numVertices = faceSizes[i];
+		mf.AllocateArrays();
+		memcpy(mf.vertices.GetArray(), faceIndices, n * sizeof(int));
+		memcpy(mf.uvs.GetArray(), faceIndices + n, n * sizeof(int));
+		memcpy(mf.normals.GetArray(), faceIndices + 2 * n, n * sizeof(int));
+		faceIndices += 3 * n;
+		/// Tangents are stored too, so no need to re-calculate them.
+		mf.uvTangent = Vector4f(f[0], f[1], f[2], f[3]);
+		mf.uvBiTangent = Vector3f(f[4], f[5], f[6]);
 	}
-	
-	this->CalculateUVTangents();
 
 	loadedFromCompactObj = true;
 	return true;
@@ -558,45 +652,187 @@ void Mesh::BindVertexBuffer(GraphicsState * graphicsState)
 		glVertexAttribPointer(shader->attributeBiTangent, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * floatsPerVertex, (void *)offsetB);		// Tangents
 }
 
+/// Vertices per job when skinning large meshes on several threads.
+#define VERTICES_PER_SKINNING_JOB 4096
+
 /// Re-skins the mesh's vertices to match the current skeletal animation. Every single vertex will be re-calculated and then re-buffered.
 void Mesh::SkinToCurrentSkeletalAnimation()
 {
+	if (vertexWeights.Size() != vertices.Size())
+		return;
 	/// Save original vertices if not already done so.
 	if (originalVertexPositions.Size() != vertices.Size())
 		originalVertexPositions = vertices;
-	
-	for (int i = 0; i < vertices.Size(); ++i)
+	if (boneIndices.Size() != vertices.Size())
+		PackVertexWeights();
+	UpdateSkinningPalette();
+
+	int jobs = (vertices.Size() + VERTICES_PER_SKINNING_JOB - 1) / VERTICES_PER_SKINNING_JOB;
+	JobPool * jobPool = GraphicsMan.jobPool;
+	if (jobs > 1 && jobPool && jobPool->Workers() > 0)
+		jobPool->ParallelFor(jobs, SkinVerticesJob, this);
+	else
+		SkinVertices(0, vertices.Size());
+	this->lastUpdate = Time::Now();
+}
+
+/// Fills boneIndices and boneWeights from vertexWeights.
+void Mesh::PackVertexWeights()
+{
+	boneIndices.Clear();
+	boneWeights.Clear();
+	for (int i = 0; i < vertexWeights.Size(); ++i)
 	{
-		Vector3f & vertexPosition = vertices[i];
-		vertexPosition = Vector3f();
-		Vector3f & originalVertexPosition = originalVertexPositions[i];
 		List<VertexWeight> & vertex_weights = vertexWeights[i];
-		for (int i = 0; i < vertex_weights.Size(); ++i)
+		int indices[4] = {0, 0, 0, 0};
+		float weights[4] = {0, 0, 0, 0};
+		int numWeights = 0;
+		bool dropped = false;
+		/// Keep the strongest ones, sorted by weight.
+		for (int j = 0; j < vertex_weights.Size(); ++j)
+		{
+			VertexWeight & weight = vertex_weights[j];
+			if (weight.boneIndex < 0 || weight.boneIndex >= invBindPoseMatrices.Size())
+				continue;
+			int slot;
+			if (numWeights < 4)
+				slot = numWeights++;
+			else if (weight.weight > weights[3])
+			{
+				slot = 3;
+				dropped = true;
+			}
+			else 
+			{
+				dropped = true;
+				continue;
+			}
+			while (slot > 0 && weights[slot - 1] < weight.weight)
+			{
+				indices[slot] = indices[slot - 1];
+				weights[slot] = weights[slot - 1];
+				--slot;
+			}
+			indices[slot] = weight.boneIndex;
+			weights[slot] = weight.weight;
+		}
+		/// Re-normalize if any were dropped, so that the vertex does not shrink towards the origin.
+		if (dropped)
 		{
-			/**	The skinning calculation for each vertex v in a bind shape is as follows.
+			float sum = weights[0] + weights[1] + weights[2] + weights[3];
+			if (sum > 0)
+				for (int j = 0; j < 4; ++j)
+					weights[j] /= sum;
+		}
+		boneIndices.AddItem(Vector4i(indices[0], indices[1], indices[2], indices[3]));
+		boneWeights.AddItem(Vector4f(weights[0], weights[1], weights[2], weights[3]));
+	}
+}
 
-				for (int i = 0; i < numVertices; ++i)
-					skinnedVertexPosition += {[(vertexPosition * BSM) * IBMi * JMi] * JW}
+/// Updates skinningPalette from the skeleton's current pose.
+void Mesh::UpdateSkinningPalette()
+{
+	/**	The skinning calculation for each vertex v in a bind shape is as follows.
 
-				 n: The number of joints that influence vertex v
-				 BSM: Bind-shape matrix
-				 IBMi: Inverse bind-pose matrix of joint i
-				 JMi: Transformation matrix of joint i
-				 JW: Weight of the influence of joint i on vertex v
-			*/
-			int boneIndex = vertex_weights[i].boneIndex;
-			Matrix4f & inverseBindMatrix = invBindPoseMatrices[boneIndex];
-			Bone * bone = skeleton->GetBoneByIndex(boneIndex);
-			assert(bone);
-			float & weight = vertex_weights[i].weight;
-			
-			Matrix4f skinningMatrix = bone->nodeModelMatrix * inverseBindMatrix;
-			Vector3f attempt2 = skinningMatrix.Product(originalVertexPosition) * weight;
-			Vector3f skinning2 = bone->nodeModelMatrix.Product(inverseBindMatrix.Product(bindShapeMatrix.Product(originalVertexPosition))) * weight;
-			vertexPosition += skinning2;
+		for (int i = 0; i < numVertices; ++i)
+			skinnedVertexPosition += {[(vertexPosition * BSM) * IBMi * JMi] * JW}
+
+		 n: The number of joints that influence vertex v
+		 BSM: Bind-shape matrix
+		 IBMi: Inverse bind-pose matrix of joint i
+		 JMi: Transformation matrix of joint i
+		 JW: Weight of the influence of joint i on vertex v
+
+		All but the weight are the same for every vertex, so they are multiplied together once per bone here.
+	*/
+	int numBones = invBindPoseMatrices.Size();
+	if (paletteBones.Size() != numBones)
+	{
+		List<Bone*> allBones;
+		skeleton->FetchBones(allBones);
+		paletteBones.Clear();
+		for (int i = 0; i < numBones; ++i)
+			paletteBones.AddItem(NULL);
+		for (int i = 0; i < allBones.Size(); ++i)
+		{
+			Bone * bone = allBones[i];
+			if (bone->boneIndex >= 0 && bone->boneIndex < numBones)
+				paletteBones[bone->boneIndex] = bone;
 		}
+		skinningPalette.Clear();
+		for (int i = 0; i < numBones; ++i)
+			skinningPalette.AddItem(Matrix4f());
 	}
-	this->lastUpdate = Time::Now();
+	for (int i = 0; i < numBones; ++i)
+	{
+		Bone * bone = paletteBones[i];
+		assert(bone);
+		if (!bone)
+			continue;
+		skinningPalette[i] = bone->nodeModelMatrix * invBindPoseMatrices[i] * bindShapeMatrix;
+	}
+}
+
+/// Skins vertices in the interval [start, end) using the palette.
+void Mesh::SkinVertices(int start, int end)
+{
+	const Matrix4f * palette = skinningPalette.GetArray();
+	const Vector4i * indices = boneIndices.GetArray();
+	const Vector4f * weights = boneWeights.GetArray();
+	const Vector3f * original = originalVertexPositions.GetArray();
+	Vector3f * skinned = vertices.GetArray();
+	for (int i = start; i < end; ++i)
+	{
+		const int boneIndex[4] = {indices[i].x, indices[i].y, indices[i].z, indices[i].w};
+		const float weight[4] = {weights[i].x, weights[i].y, weights[i].z, weights[i].w};
+		const Vector3f & position = original[i];
+#ifdef USE_SSE
+		/// Blend the columns of the bones' matrices, then transform the position once.
+		__m128 col0 = _mm_setzero_ps(), col1 = _mm_setzero_ps(), col2 = _mm_setzero_ps(), col3 = _mm_setzero_ps();
+		for (int j = 0; j < 4; ++j)
+		{
+			if (weight[j] == 0)
+				continue;
+			const float * m = palette[boneIndex[j]].element;
+			__m128 w = _mm_set1_ps(weight[j]);
+			col0 = _mm_add_ps(col0, _mm_mul_ps(_mm_loadu_ps(m), w));
+			col1 = _mm_add_ps(col1, _mm_mul_ps(_mm_loadu_ps(m + 4), w));
+			col2 = _mm_add_ps(col2, _mm_mul_ps(_mm_loadu_ps(m + 8), w));
+			col3 = _mm_add_ps(col3, _mm_mul_ps(_mm_loadu_ps(m + 12), w));
+		}
+		__m128 result = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(position.x)), _mm_mul_ps(col1, _mm_set1_ps(position.y))),
+			_mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(position.z)), col3));
+		float out[4];
+		_mm_storeu_ps(out, result);
+		skinned[i] = Vector3f(out[0], out[1], out[2]);
+#else
+		/// Blend the bones' matrices, then transform the position once.
+		float m[16] = {0};
+		for (int j = 0; j < 4; ++j)
+		{
+			if (weight[j] == 0)
+				continue;
+			const float * element = palette[boneIndex[j]].element;
+			for (int k = 0; k < 16; ++k)
+				m[k] += element[k] * weight[j];
+		}
+		skinned[i] = Vector3f(m[0] * position.x + m[4] * position.y + m[8] * position.z + m[12],
+			m[1] * position.x + m[5] * position.y + m[9] * position.z + m[13],
+			m[2] * position.x + m[6] * position.y + m[10] * position.z + m[14]);
+#endif
+	}
+}
+
+/// Job for skinning one part of the mesh. Data is the mesh.
+void Mesh::SkinVerticesJob(int index, void * data)
+{
+	Mesh * mesh = (Mesh*) data;
+	int start = index * VERTICES_PER_SKINNING_JOB;
+	int end = start + VERTICES_PER_SKINNING_JOB;
+	if (end > mesh->vertices.Size())
+		end = mesh->vertices.Size();
+	mesh->SkinVertices(start, end);
 }
 
 /// Returns the relative path to the resource the mesh was loaded from.
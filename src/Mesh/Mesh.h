@@ -58,10 +58,14 @@ public:
 	void AllocateArrays();
 	void DeallocateArrays();
 	
-	/// Load from customized compressed data form. Returns true upon success.
-	bool SaveCompressedTo(String compressedPath);
-	/// Load from customized compressed data form. Returns true upon success.
-	bool LoadCompressedFrom(String compressedPath);
+	/** Saves to the binary mesh cache format, keyed to a hash of the contents of the source it was loaded from, see MappedFile::HashFile. 
+		The whole file is assembled in memory and written at once. Returns true upon success.
+	*/
+	bool SaveCompressedTo(String compressedPath, uint64 sourceHash);
+	/** Loads from the binary mesh cache format, by mapping the file and reading the arrays straight from it.
+		Returns false if the file is missing, corrupt, of another version, or was saved for another source hash. A sourceHash of 0 accepts any.
+	*/
+	bool LoadCompressedFrom(String compressedPath, uint64 sourceHash);
 
     /// Mostly for debug
 	void PrintContents();
@@ -85,7 +89,9 @@ public:
 	void BindVertexBuffer(GraphicsState * graphicsState);
 	/// Renders the meshi-mesh :3
 	void Render(GraphicsState * graphicsState);
-	/// Re-skins the mesh's vertices to match the current skeletal animation. Every single vertex will be re-calculated and then re-buffered.
+	/** Re-skins the mesh's vertices to match the current skeletal animation. Every single vertex will be re-calculated and then re-buffered.
+		Uses the 4 strongest bone weights per vertex, and splits large meshes across the GraphicsManager's job pool.
+	*/
 	void SkinToCurrentSkeletalAnimation();
 	/// Updates the skinning matrix map to be used for skinning using shaders.
 	void UpdateSkinningMatrixMap();
@@ -132,10 +138,12 @@ public:
 	/// MeshFaces that define the mesh, using the provided vertices and UV-coordinates
 	List<MeshFace> faces;
 
-	/// Vertex-bone weights in compact form. Indices to the bones.
+	/// Vertex-bone weights in compact form, the 4 strongest per vertex. Indices to the bones. Filled from vertexWeights when first skinning on the CPU.
 	List<Vector4i> boneIndices;
-	/// Vertex-bone weights in compact form. Weights of said indices.
+	/// Vertex-bone weights in compact form. Weights of said indices, 0 for unused ones.
 	List<Vector4f> boneWeights;
+	/// Skinning matrix for each bone index: bone model matrix * inverse bind pose matrix * bind-shape matrix. Updated once per skinning.
+	List<Matrix4f> skinningPalette;
 	
 	/// Skinning data! o.o
 	List<int> weightsPerVertex;	
@@ -195,6 +203,17 @@ protected:
 	int * boneIndexData;
 	float * boneWeightData;
 
+	/// Fills boneIndices and boneWeights from vertexWeights.
+	void PackVertexWeights();
+	/// Updates skinningPalette from the skeleton's current pose.
+	void UpdateSkinningPalette();
+	/// Skins vertices in the interval [start, end) using the palette.
+	void SkinVertices(int start, int end);
+	/// Job for skinning one part of the mesh. Data is the mesh.
+	static void SkinVerticesJob(int index, void * data);
+	/// Bones of the skeleton by bone index, fetched once instead of searching the skeleton for each one.
+	List<SkeletalAnimationNode*> paletteBones;
+
 };
 
 class GraphicsState;
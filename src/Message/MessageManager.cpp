@@ -13,6 +13,7 @@
 #include "Message/MathMessage.h"
 #include "FileEvent.h"
 #include "Network/Packet/Packet.h"
+#include "Network/Packet/PacketPool.h"
 #include <Mutex/Mutex.h>
 
 #include "Physics/PhysicsManager.h"
@@ -94,7 +95,8 @@ void MessageManager::ProcessPackets(){
 	{
 		Packet * packet = packetQueue.Pop();
 		ProcessPacket(packet);
-		delete packet;
+		/// Received packets are re-used.
+		PacketPool::Release(packet);
 	}
 	packetQueueMutex.Release();
 #endif
@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cctype>
 //#include <windows.h>
 
 #include "File/FileUtil.h"
@@ -19,11 +20,14 @@
 #include "Model/Model.h"
 #include "XML/XMLParser.h"
 #include "Model/ColladaImporter.h"
+#include "File/AssetLoader.h"
 
 #include "SkeletalAnimationNode.h"
 
 #include "PhysicsLib/Shapes/AABB.h"
 #include "File/File.h"
+#include "File/MappedFile.h"
+#include "Thread/JobPool.h"
 
 // Static model manager singleton
 ModelManager * ModelManager::modelManager = NULL;
@@ -51,11 +55,13 @@ void ModelManager::Deallocate()
 ModelManager::ModelManager(){
 	idEnumerator = 1;
 	defaultTexture = NULL;
+	jobPool = new JobPool();
 }
 
 ModelManager::~ModelManager()
 {
 	modelList.ClearAndDelete();
+	delete jobPool;
 }
 
 /// Loads required models (either hard-coded or from file)
@@ -76,7 +82,7 @@ void ModelManager::Initialize()
 Model * ModelManager::NewDynamic()
 {
 	Model * model = new Model();
-	modelList.Add(model);
+	Register(model);
 	return model;
 }
 
@@ -93,13 +99,9 @@ Model * ModelManager::GetModel(String name)
 {
 	name = FilePath::MakeRelative(name);
 //    std::cout<<"\nGetModel: "<<name;
-	for (int i = 0; i < modelList.Size(); ++i)
-	{
-		String modelName = modelList[i]->Name();
-		modelName.SetComparisonMode(String::NOT_CASE_SENSITIVE);
-		if (modelName.Contains(name))
-			return modelList[i];
-	}
+	Model * model = FindByName(name);
+	if (model)
+		return model;
 	std::cout<<"\nINFO: Unable to load model "<<name<<", trying to load from file.";
 	Model * newModel = NULL;
 	if (name.Contains(".dae"))
@@ -133,6 +135,17 @@ int ModelManager::LoadModels(List<String> modelSourceList){
 	return failed;
 }
 
+/** Queues all models in the provided source list for loading on the AssetLoader's workers, returning their requests straight away.
+	Sources which are already loaded get finished requests.
+*/
+List<AssetRequest*> ModelManager::LoadModelsAsync(List<String> modelSourceList)
+{
+	List<AssetRequest*> requests;
+	for (int i = 0; i < modelSourceList.Size(); ++i)
+		requests.AddItem(LoadObjAsync(modelSourceList[i]));
+	return requests;
+}
+
 /// Loads Model with single Mesh from file. Used primarily for static objects.
 Model * ModelManager::LoadObj(String source)
 {
@@ -141,15 +154,135 @@ Model * ModelManager::LoadObj(String source)
 	source = FilePath::MakeRelative(source);
 //	std::cout<<"\nModelMan::LoadObj("<<source<<")...";
 	// Check if it pre-exists
+	Model * loaded = GetLoadedObj(source);
+	if (loaded)
+	{
+		std::cout<<"\nObject already loaded, returning a pointer to it!";
+		return loaded;
+	}
+	Model * model = ReadObj(ResolveObjSource(source), jobPool);
+	if (model)
+		Register(model);
+	return model;
+}
+
+/** Queues target .obj for loading on the AssetLoader's workers, returning its request straight away.
+	The model is registered and queued for bufferization once AssetLoader::Process has handed it over.
+	If it is already loaded the request is finished at once, and if a request is already pending for it that one is returned.
+*/
+AssetRequest * ModelManager::LoadObjAsync(String source, AssetCallback callback, void * callbackData)
+{
+	assert(AssetLoader::Instance());
+	source = FilePath::MakeRelative(source);
+	Model * loaded = GetLoadedObj(source);
+	if (loaded)
+		return AssetLoad.Loaded(loaded, callback, callbackData);
+	return AssetLoad.LoadModel(ResolveObjSource(source), callback, callbackData);
+}
+
+/** Registers a model loaded elsewhere, e.g. by the AssetLoader.
+	If a model with the same source was loaded meanwhile the given one is deleted and the existing one is returned.
+*/
+Model * ModelManager::AddModel(Model * model)
+{
+	Model * loaded = GetLoadedObj(model->mesh->source);
+	if (loaded && loaded != model)
+	{
+		delete model;
+		return loaded;
+	}
+	if (!loaded)
+		Register(model);
+	return model;
+}
+
+/// Returns a loaded model whose mesh's source matches given (relative) source, or NULL.
+Model * ModelManager::GetLoadedObj(String source)
+{
+	std::string key = Key(source);
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		auto it = modelsBySource.find(key);
+		if (it != modelsBySource.end() && SourceMatches(it->second, source))
+			return it->second;
+	}
+	/// Partial sources, e.g. without the obj/ folder. Remember the result so the next query is direct.
 	for (int i = 0; i < modelList.Size(); ++i)
 	{
 		Model * model = modelList[i];
 	//	std::cout<<"\nModel source: "<<model->source;
-		if (model->mesh->source.Contains(source) || source.Contains(model->mesh->source)){
-			std::cout<<"\nObject already loaded, returning a pointer to it!";
+		if (SourceMatches(model, source))
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			modelsBySource[key] = model;
+			return model;
+		}
+	}
+	return NULL;
+}
+
+/// Returns a model whose name contains given name, ignoring case, or NULL.
+Model * ModelManager::FindByName(String name)
+{
+	std::string key = Key(name);
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		auto it = modelsByName.find(key);
+		if (it != modelsByName.end() && NameMatches(it->second, name))
+			return it->second;
+	}
+	for (int i = 0; i < modelList.Size(); ++i)
+	{
+		if (NameMatches(modelList[i], name))
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			modelsByName[key] = modelList[i];
 			return modelList[i];
 		}
 	}
+	return NULL;
+}
+
+/// Adds the model to the list and indexes it.
+void ModelManager::Register(Model * model)
+{
+	modelList.Add(model);
+	std::lock_guard<std::mutex> lock(indexMutex);
+	if (model->name.Length())
+		modelsByName.insert(std::make_pair(Key(model->name), model));
+	if (model->mesh && model->mesh->source.Length())
+		modelsBySource.insert(std::make_pair(Key(model->mesh->source), model));
+}
+
+/// Key for the indices: lower case, with uniform folder slashes.
+std::string ModelManager::Key(String nameOrSource)
+{
+	nameOrSource.Replace('\\', '/');
+	std::string key = nameOrSource.c_str();
+	for (int i = 0; i < (int) key.size(); ++i)
+		key[i] = tolower(key[i]);
+	return key;
+}
+
+/// Same partial matching as has always been used for sources, so "cube" finds "obj/cube.obj".
+bool ModelManager::SourceMatches(Model * model, String & source)
+{
+	if (!model->mesh)
+		return false;
+	return model->mesh->source.Contains(source) || source.Contains(model->mesh->source);
+}
+
+/// If the model's name contains given name, ignoring case.
+bool ModelManager::NameMatches(Model * model, String & name)
+{
+	String modelName = model->Name();
+	modelName.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+	return modelName.Contains(name);
+}
+
+/// Adds obj/ before and .obj at end of the relative source if needed.
+String ModelManager::ResolveObjSource(String source)
+{
 	/// Add obj/ before and .obj at end if needed
 	if (!(source.Contains("obj/") ||
 		source.Contains("obj\\") ||
@@ -161,7 +294,14 @@ Model * ModelManager::LoadObj(String source)
 	{
 		source += ".obj";
 	}
+	return source;
+}
 
+/** Reads target .obj (or its compressed version) into a new model without registering it, so it may be called from any thread.
+	Source should already have been resolved with ResolveObjSource.
+*/
+Model * ModelManager::ReadObj(String source, JobPool * jobPool)
+{
 // std::cout<<"\nModelMan::LoadObj("<<source<<")...2";
 	// Check if a compressed version exists.
 	String compressedPath = source;
@@ -191,17 +331,8 @@ Model * ModelManager::LoadObj(String source)
 	bool modelLoaded = false;
 //	std::cout<<"\nModelMan::LoadObj("<<source<<")...5";
 		
-	/// Compare file-times, if .obj is newere, reload it.
-	File objFile(source);
-	File compressedFile(compressedPath);
-	Time lastEdit, cLastEdit;
-	bool objFileExists = objFile.LastModified(lastEdit);
-	bool cObjFileExists = compressedFile.LastModified(cLastEdit);
-	if (!cObjFileExists)
-		loadCompressed = false;
-	if (loadCompressed)
-		if (lastEdit > cLastEdit)
-			loadCompressed = false;
+	/// The compressed version is keyed to the contents of the .obj, so it is rebuilt whenever it changes. 0 if there is no .obj, accepting any compressed version.
+	uint64 sourceHash = MappedFile::HashFile(source);
 
 	Mesh * mesh = NULL;
 	if (loadCompressed)
@@ -210,7 +341,7 @@ Model * ModelManager::LoadObj(String source)
 		mesh = new Mesh();
 		bool compressedLoadResult = false;
 //		std::cout<<"\nModelMan::LoadObj("<<source<<")...6";
-		compressedLoadResult = mesh->LoadCompressedFrom(compressedPath);
+		compressedLoadResult = mesh->LoadCompressedFrom(compressedPath, sourceHash);
 //		std::cout<<"\nModelMan::LoadObj("<<source<<")...7";
 		if (compressedLoadResult)
 			std::cout<<"found compressed version.";
@@ -249,7 +380,7 @@ Model * ModelManager::LoadObj(String source)
 	  //  path.Replace('\\', '/'); // Replace bad folder slashes with good-'uns!
 		std::cout<<"\nLoading model from source: "<<source;
 		std::cout<<"\nCalling ObjReader::ReadObj";
-		modelLoaded = ObjReader::ReadObj(source.c_str(), mesh);
+		modelLoaded = ObjReader::ReadObj(source.c_str(), mesh, jobPool);
 		
 		mesh->CalculateBounds();
 		assert(mesh->radiusOrigo > 0);
@@ -287,10 +418,8 @@ Model * ModelManager::LoadObj(String source)
 			triangulatedMesh->CalculateBounds();
 
 			// Save the triangulized mesh in compressed form ! 
-			model->triangulatedMesh->SaveCompressedTo(compressedPath);
+			model->triangulatedMesh->SaveCompressedTo(compressedPath, sourceHash);
 		}
-
-		modelList.Add(model);
 		return model;
 	}
 	else {
@@ -384,7 +513,7 @@ Model * ModelManager::LoadCollada(String source)
 	std::cout<<"\nNormalized";
 	model->triangulatedMesh->CalculateUVTangents();
 	std::cout<<"\nUVd";
-	modelList.Add(model);
+	Register(model);
 	return model;
 }
 
@@ -6,12 +6,15 @@
 #define MODEL_MANAGER_H
 
 #include "Util.h"
+#include <unordered_map>
+#include <string>
+#include <mutex>
 
 class Model;
 class Texture;
-
-/// Maximum amount of simultaneously loaded objects
-const int MAX_MODELS = 1000;
+class AssetRequest;
+class JobPool;
+typedef void (*AssetCallback)(AssetRequest * request, void * data);
 
 #define ModelMan	(*ModelManager::Instance())
 
@@ -45,9 +48,29 @@ public:
 		Returns amount of failed loadings.
 	*/
 	int LoadModels(List<String> modelSourceList);
+	/** Queues all models in the provided source list for loading on the AssetLoader's workers, returning their requests straight away.
+		Sources which are already loaded get finished requests.
+	*/
+	List<AssetRequest*> LoadModelsAsync(List<String> modelSourceList);
 	/** Loads Model with single Mesh from file.
 		Used primarily for static objects. */
 	Model * LoadObj(String source);
+	/** Queues target .obj for loading on the AssetLoader's workers, returning its request straight away.
+		The model is registered and queued for bufferization once AssetLoader::Process has handed it over, after which the callback, if any, is called.
+		If it is already loaded the request is finished at once, and if a request is already pending for it that one is returned.
+	*/
+	AssetRequest * LoadObjAsync(String source, AssetCallback callback = NULL, void * callbackData = NULL);
+	/** Registers a model loaded elsewhere, e.g. by the AssetLoader.
+		If a model with the same source was loaded meanwhile the given one is deleted and the existing one is returned.
+	*/
+	Model * AddModel(Model * model);
+
+	/// Adds obj/ before and .obj at end of the relative source if needed.
+	static String ResolveObjSource(String source);
+	/** Reads target .obj (or its compressed version) into a new model without registering it, so it may be called from any thread.
+		Source should already have been resolved with ResolveObjSource. Large .obj files are parsed on the given job pool, if any, see ObjReader::ReadObj.
+	*/
+	static Model * ReadObj(String source, JobPool * jobPool = NULL);
 	
 	/// Loads a model using target Collada file, using all given geometry nodes within it to generate a single mesh.
 	Model * LoadCollada(String source);
@@ -58,10 +81,30 @@ public:
 
 	/// Default texture for newly constructed objects.
 	Texture * defaultTexture;
+	/// Worker threads for parsing large .obj files. Shared by LoadObj and the AssetLoader's workers, so that no load starts a pool of its own.
+	JobPool * jobPool;
 
 private:
+	/// Returns a loaded model whose mesh's source matches given (relative) source, or NULL.
+	Model * GetLoadedObj(String source);
+	/// Returns a model whose name contains given name, ignoring case, or NULL.
+	Model * FindByName(String name);
+	/// Adds the model to the list and indexes it.
+	void Register(Model * model);
+	/// Key for the indices: lower case, with uniform folder slashes.
+	static std::string Key(String nameOrSource);
+	/// Same partial matching as has always been used for sources, so "cube" finds "obj/cube.obj".
+	static bool SourceMatches(Model * model, String & source);
+	/// If the model's name contains given name, ignoring case.
+	static bool NameMatches(Model * model, String & name);
+
 	/// Array for all objects
 	List<Model*> modelList;
+	/** Lookup indices by name and mesh source, keyed as queried. Entries are verified on lookup,
+		and a full search is used (and its result indexed) when they are missing or out of date.
+	*/
+	std::unordered_map<std::string, Model*> modelsByName, modelsBySource;
+	std::mutex indexMutex;
 	/// Id counter for generating unique id's
 	int idEnumerator;
 };
@@ -6,23 +6,15 @@
 #include "Network/Peer.h"
 #include "Network/Socket/Socket.h"
 #include "Network/Packet/PacketTypes.h"
+#include "PacketFramer.h"
 #include <cassert>
 
-/// List of packet size types.
-int Packet::packet_size[PacketType::PACKET_TYPES]; 
-
-/// Public packet size registration function.
-void Packet::SetPacketSize(int packetType, int packetSize){
-	assert(packetType >= 0 && packetType < PacketType::PACKET_TYPES);
-	assert(packetSize >= 0);
-	packet_size[packetType] = packetSize;
-}
-
 Packet::Packet(int type)
 : type(type)
 {
 	socket = NULL;
 	sender = NULL;
+	pooled = false;
 }
 Packet::~Packet(){};
 
@@ -30,6 +22,7 @@ Packet::Packet(const Packet & copy)
 {
 	data = copy.data;
 	sender = NULL;
+	pooled = false;
 }
 const Packet & Packet::operator= (const Packet & copy){
 	data = copy.data;
@@ -46,7 +39,7 @@ bool Packet::Send(Socket * sock)
 	if (!sock)
 		return false;
 	assert(size > 0);
-	int bytesWritten = sock->Write((const char *) data.GetData(), data.Bytes());
+	int bytesWritten = PacketFramer::Write(sock, *this);
 	return bytesWritten > 0;
 }
 
@@ -27,9 +27,6 @@ struct Packet{					// 24 byte
 class Packet {
 	friend class Session;
 public:
-	/// Public packet size registration function.
-	static void SetPacketSize(int packetType, int packetSize);
-
 	/// Empty constructor that sets data to "EmptyPacket"
 	Packet(int type);
 	/// Virtual destructor so that subclass destructors are run correctly.
@@ -41,7 +38,7 @@ public:
 
 	/// Sends this packet's data to target Peer, using necessary packet-headers.
 	virtual bool Send(Peer * peer);
-	/// Sends this packet's data to target QTcpSocket, using necessary packet-headers.
+	/// Sends this packet's data to target socket, framed by its length and type. See PacketFramer.
 	virtual bool Send(Socket * sock);
 
 	/// Type of packet, 0 = default, 1 = SIP 
@@ -58,10 +55,8 @@ public:
 	int target;
 	/// Socket from which this packet was received.
 	Socket * socket;
-
-private:
-	/// List of packet size types.
-	static int packet_size[PacketType::PACKET_TYPES]; 
+	/// If taken from the PacketPool, to which it should be released once processed.
+	bool pooled;
 };
 
 #endif
@@ -0,0 +1,48 @@
+/// Emil Hedemalm
+/// 2016-08-28
+/// Length-prefixed framing of packets sent over stream sockets.
+
+#include "PacketFramer.h"
+#include "Packet.h"
+#include "Network/Socket/Socket.h"
+#include "DataStream/RingBuffer.h"
+
+/// Writes the header and data of the packet, both or neither. Returns bytes written, 0 if the socket is busy, or -1 if closed.
+int PacketFramer::Write(Socket * socket, Packet & packet)
+{
+	uchar header[FRAME_HEADER_BYTES];
+	int payloadBytes = packet.data.Bytes();
+	WriteHeader(header, packet.type, payloadBytes);
+	return socket->Write((const char*) header, FRAME_HEADER_BYTES, (const char*) packet.data.GetData(), payloadBytes);
+}
+
+void PacketFramer::WriteHeader(uchar * header, int type, int payloadBytes)
+{
+	/// Little-endian, regardless of platform.
+	for (int i = 0; i < 4; ++i)
+		header[i] = (uchar) (payloadBytes >> (i * 8));
+	header[4] = (uchar) type;
+}
+
+/** Looks for a frame at the start of the buffer, without consuming it. Returns COMPLETE and sets frame if a whole frame has been received.
+	Call buffer.Consume(frame.frameBytes) once done with it.
+*/
+int PacketFramer::Next(RingBuffer & buffer, PacketFrame & frame)
+{
+	uchar header[FRAME_HEADER_BYTES];
+	if (!buffer.Peek(header, FRAME_HEADER_BYTES))
+		return INCOMPLETE;
+	uint32 payloadBytes = 0;
+	for (int i = 0; i < 4; ++i)
+		payloadBytes |= (uint32) header[i] << (i * 8);
+	if (payloadBytes > MAX_FRAME_PAYLOAD)
+		return MALFORMED;
+	int frameBytes = FRAME_HEADER_BYTES + (int) payloadBytes;
+	if (buffer.Size() < frameBytes)
+		return INCOMPLETE;
+	frame.type = header[4];
+	frame.payload = buffer.Contiguous(frameBytes) + FRAME_HEADER_BYTES;
+	frame.payloadBytes = payloadBytes;
+	frame.frameBytes = frameBytes;
+	return COMPLETE;
+}
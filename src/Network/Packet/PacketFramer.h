@@ -0,0 +1,52 @@
+/// Emil Hedemalm
+/// 2016-08-28
+/// Length-prefixed framing of packets sent over stream sockets.
+
+#ifndef PACKET_FRAMER_H
+#define PACKET_FRAMER_H
+
+#include "System/DataTypes.h"
+
+class Packet;
+class Socket;
+class RingBuffer;
+
+/// 4 bytes payload length followed by 1 byte packet type, see PacketTypes.h
+#define FRAME_HEADER_BYTES	5
+/// Larger frames are considered malformed. Must be less than REACTOR_RECEIVE_LIMIT, so that a whole frame may be received.
+#define MAX_FRAME_PAYLOAD	(512 * 1024)
+
+/// A complete frame within a receive buffer.
+struct PacketFrame
+{
+	int type;
+	/// Points into the receive buffer, valid until the frame is consumed or more data is received.
+	const uchar * payload;
+	int payloadBytes;
+	/// Header and payload, to be consumed from the buffer once handled.
+	int frameBytes;
+};
+
+/** Each packet is sent as a header with the length of its payload, so that the receiver can tell where packets start and end
+	regardless of how TCP splits or joins them. Frames are parsed in place in the receive buffer of a SocketReactor.
+*/
+class PacketFramer
+{
+public:
+	enum results {
+		/// More data is needed.
+		INCOMPLETE,
+		COMPLETE,
+		/// The data can not be a frame, e.g. due to an unreasonable length. The stream can not be recovered.
+		MALFORMED,
+	};
+	/// Writes the header and data of the packet, both or neither. Returns bytes written, 0 if the socket is busy, or -1 if closed.
+	static int Write(Socket * socket, Packet & packet);
+	static void WriteHeader(uchar * header, int type, int payloadBytes);
+	/** Looks for a frame at the start of the buffer, without consuming it. Returns COMPLETE and sets frame if a whole frame has been received.
+		Call buffer.Consume(frame.frameBytes) once done with it.
+	*/
+	static int Next(RingBuffer & buffer, PacketFrame & frame);
+};
+
+#endif
@@ -0,0 +1,70 @@
+/// Emil Hedemalm
+/// 2016-08-28
+/// Recycling of received packets and their payload buffers.
+
+#include "PacketPool.h"
+#include "Packet.h"
+
+List<Packet*> PacketPool::idle;
+std::mutex PacketPool::idleMutex;
+
+/// Returns an empty packet of given type, re-used if possible.
+Packet * PacketPool::Get(int type)
+{
+	Packet * packet = NULL;
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+		if (idle.Size())
+		{
+			packet = idle.Last();
+			idle.RemoveLast();
+		}
+	}
+	if (!packet)
+	{
+		packet = new Packet(type);
+		packet->pooled = true;
+	}
+	packet->type = type;
+	packet->size = 0;
+	packet->sender = NULL;
+	packet->socket = NULL;
+	return packet;
+}
+
+/// Returns a packet taken from Get to the pool. Any other packet is deleted, so any processed packet may be released this way.
+void PacketPool::Release(Packet * packet)
+{
+	if (!packet->pooled || packet->data.Bytes() + packet->data.FreeBytes() > PACKET_POOL_MAX_PAYLOAD)
+	{
+		delete packet;
+		return;
+	}
+	/// Keeps the allocated buffer.
+	packet->data.PopAll();
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+		if (idle.Size() < PACKET_POOL_SIZE)
+		{
+			idle.AddItem(packet);
+			return;
+		}
+	}
+	delete packet;
+}
+
+/// Deletes all idle packets.
+void PacketPool::Clear()
+{
+	std::lock_guard<std::mutex> lock(idleMutex);
+	for (int i = 0; i < idle.Size(); ++i)
+		delete idle[i];
+	idle.Clear();
+}
+
+/// Idle packets, for statistics.
+int PacketPool::Idle()
+{
+	std::lock_guard<std::mutex> lock(idleMutex);
+	return idle.Size();
+}
@@ -0,0 +1,38 @@
+/// Emil Hedemalm
+/// 2016-08-28
+/// Recycling of received packets and their payload buffers.
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include "List/List.h"
+#include <mutex>
+
+class Packet;
+
+/// Max idle packets kept for re-use. Further released packets are deleted.
+#define PACKET_POOL_SIZE			1024
+/// Packets whose payload buffer grew beyond this are deleted when released, so that a few large packets do not keep their memory.
+#define PACKET_POOL_MAX_PAYLOAD		(64 * 1024)
+
+/** Received packets are taken from here by the network thread and released by whoever processes them, e.g. the MessageManager.
+	Released packets keep their payload buffer, so that reading a packet of similar size again needs no allocation.
+	Only the short hand-over of each packet is guarded, so the threads seldom wait for each other.
+*/
+class PacketPool
+{
+public:
+	/// Returns an empty packet of given type, re-used if possible.
+	static Packet * Get(int type);
+	/// Returns a packet taken from Get to the pool. Any other packet is deleted, so any processed packet may be released this way.
+	static void Release(Packet * packet);
+	/// Deletes all idle packets.
+	static void Clear();
+	/// Idle packets, for statistics.
+	static int Idle();
+private:
+	static List<Packet*> idle;
+	static std::mutex idleMutex;
+};
+
+#endif
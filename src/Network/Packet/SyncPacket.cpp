@@ -4,50 +4,48 @@
 
 #include "SyncPacket.h"
 #include "PacketTypes.h"
-#include "Entity/Entity.h"
-#include <sstream>
+#include "DataStream/BitStream.h"
 
-SyncPacket::SyncPacket()
+/// Snapshot to send.
+SyncPacket::SyncPacket(const BitWriter & snapshot)
 : Packet(PacketType::SYNCHRONIZATION)
 {
-
+	data.PushInt8(SNAPSHOT);
+	data.PushBytes((uchar*) snapshot.Data(), snapshot.Bytes());
+	size = data.Bytes();
 }
 
-void SyncPacket::AddEntity(Entity* entity)
+/// Acknowledgement of given snapshot tick.
+SyncPacket::SyncPacket(int acknowledgedTick)
+: Packet(PacketType::SYNCHRONIZATION)
 {
-	entities.Add(entity);
+	BitWriter tick;
+	tick.Write(acknowledgedTick, 32);
+	data.PushInt8(ACKNOWLEDGEMENT);
+	data.PushBytes((uchar*) tick.Data(), tick.Bytes());
+	size = data.Bytes();
 }
 
-/// Re-writes the data to be sent.
-void SyncPacket::UpdateData()
+/** Parses received packet data. For snapshots, snapshotData and snapshotBytes are set to the part to pass to SnapshotReceiver::Read.
+	For acknowledgements acknowledgedTick is set. Returns the kind, or INVALID if malformed.
+*/
+int SyncPacket::Parse(const uchar * data, int bytes, const uchar *& snapshotData, int & snapshotBytes, int & acknowledgedTick)
 {
-	data.PopAll();
-	std::stringstream ss;
-	ss << propertiesToSync + "\n";
-	for (int i = 0; i < entities.Size(); ++i)
+	if (bytes < 1)
+		return INVALID;
+	switch(data[0])
 	{
-		if (propertiesToSync.Contains("position"))
-			ss << entities[i]->worldPosition;
+		case SNAPSHOT:
+			snapshotData = data + 1;
+			snapshotBytes = bytes - 1;
+			return SNAPSHOT;
+		case ACKNOWLEDGEMENT:
+		{
+			BitReader reader(data + 1, bytes - 1);
+			acknowledgedTick = reader.Read(32);
+			return reader.Overflowed() ? INVALID : ACKNOWLEDGEMENT;
+		}
+		default:
+			return INVALID;
 	}
-	String text = ss.str().c_str();
-	data.Push(text);
 }
-
-#ifndef SYNC_PACK_H
-#define SYNC_PACK_H
-
-class SyncPacket : public Packet {
-public:
-	SyncPacket();
-	/// For adding entity to sync
-	void AddEntity(Entity* entity);
-	/// String with properties to sync.
-	String propertiesToSync;
-private:
-	/// Re-writes the data to be sent.
-	void UpdateData();
-	List< Entity* > entities;
-	
-};
-
-#endif
\ No newline at end of file
@@ -6,20 +6,28 @@
 #define SYNC_PACK_H
 
 #include "Packet.h"
-#include "Entity/Entity.h"
 
+class BitWriter;
+
+/** Carries either a binary entity snapshot from host to client, as written by SnapshotReplicator,
+	or the client's acknowledgement of the latest snapshot it has reconstructed. See Network/Sync/.
+*/
 class SyncPacket : public Packet {
 public:
-	SyncPacket();
-	/// For adding entity to sync
-	void AddEntity(Entity* entity);
-	/// String with properties to sync.
-	String propertiesToSync;
-private:
-	/// Re-writes the data to be sent.
-	void UpdateData();
-	List< Entity* > entities;
-	
+	/// Snapshot to send.
+	SyncPacket(const BitWriter & snapshot);
+	/// Acknowledgement of given snapshot tick.
+	SyncPacket(int acknowledgedTick);
+
+	enum kinds {
+		SNAPSHOT,
+		ACKNOWLEDGEMENT,
+		INVALID,
+	};
+	/** Parses received packet data. For snapshots, snapshotData and snapshotBytes are set to the part to pass to SnapshotReceiver::Read.
+		For acknowledgements acknowledgedTick is set. Returns the kind, or INVALID if malformed.
+	*/
+	static int Parse(const uchar * data, int bytes, const uchar *& snapshotData, int & snapshotBytes, int & acknowledgedTick);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -10,6 +10,7 @@
 #include "Network/Peer.h"
 #include "String/StringUtil.h"
 #include "Network/Socket/TcpSocket.h"
+#include "Network/Socket/SocketReactor.h"
 #include "SIPEvent.h"
 #include "Game/Game.h"
 #include "Message/MessageManager.h"
@@ -54,6 +55,7 @@ bool SIPSession::ConnectTo(String ipAddress, int port)
 	bool success = sock->ConnectTo(ipAddress, port);
 	if (success){
 		sockets.Add(sock);
+		reactor->Add(sock);
 		return true;
 	}
 	lastErrorString = sock->GetLastErrorString();
@@ -121,10 +123,11 @@ void SIPSession::EvaluateConnections()
     // If hosting, check for new connections
 	if (this->tcpServer){
 		assert(this->tcpServer);
-		Socket * newSocket = this->tcpServer->NextPendingConnection();
-		if (newSocket)
+		Socket * newSocket;
+		while((newSocket = this->tcpServer->NextPendingConnection()) != NULL)
 		{
 		    sockets.Add(newSocket);
+		    reactor->Add(newSocket);
             std::cout<<"\nNew socket accepted in SIP session.";
         }
     }
@@ -189,6 +192,8 @@ List<Packet*> SIPSession::ReadPackets()
 {
 	List<SIPPacket*> packets;
 	List<Packet*> p;
+	/// Receive on all sockets at once, so that reading each below does not wait.
+	reactor->Poll(0);
 	// For each socket
 	for (int i = 0; i < sockets.Size(); ++i){
 		// Reach packets
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <iostream>
 #include <cstring>
+#include <cerrno>
 
 TcpServer::TcpServer(){
 	port = 33000;
@@ -86,6 +87,15 @@ bool TcpServer::Start()
 		lastErrorString = "Error listening to socket";
 		return false;
 	}
+	/// Non-blocking, so that pending connections can be accepted until there are no more, without waiting.
+#ifdef WINDOWS
+	unsigned long mode = 1;
+	ioctlsocket(listenSocket, FIONBIO, &mode);
+#else
+	int flags = fcntl(listenSocket, F_GETFL, 0);
+	if (flags >= 0)
+		fcntl(listenSocket, F_SETFL, flags | O_NONBLOCK);
+#endif
 	std::cout<<"\nServer up and running, port: " << port;
 	return true;
 }
@@ -101,24 +111,25 @@ void TcpServer::Stop(){
 
 /// Returns the next pending connection, if any available. If not, returns NULL.
 Socket * TcpServer::NextPendingConnection(){
-	/// Check if there is any pending connection.
-	fd_set readfds;
-
-    if (!ReadyToRead(listenSocket))
-        return NULL;
-
-    std::cout<<"\nPending connection found.";
-	/// Accept pending connection.
+	/// Accept pending connection. The listen socket is non-blocking, so this fails straight away if there are none.
 	sockaddr socketAddress;
 	int size = sizeof(sockaddr);
 	SOCKET newSock = accept(listenSocket, &socketAddress, (socklen_t *) &size);
 	if (newSock == INVALID_SOCKET){
-		std::cout<<"\nGetaddrinfo failed.";
-		int result = GetLastError();
-		lastErrorString = "Getaddrinfo failed, errorCode: " + String::ToString(result);
-		assert(false && "Handle");
-
+#ifdef WINDOWS
+		bool nonePending = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		bool nonePending = errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+		if (!nonePending)
+		{
+			int result = sockerrno;
+			std::cout<<"\nTcpServer::NextPendingConnection: accept failed, errorCode: "<<result;
+			lastErrorString = "Accept failed, errorCode: " + String::ToString(result);
+		}
+		return NULL;
 	}
+    std::cout<<"\nPending connection found.";
 	/// Identify new socket stats as far as possible.
 	Socket * sock = new Socket(SocketType::NULL_TYPE);
 	sock->sockfd = newSock;
@@ -8,23 +8,23 @@
 #include "SessionTypes.h"
 #include "Network/Peer.h"
 #include "Network/Server/TcpServer.h"
+#include "Network/Socket/Socket.h"
+#include "Timer/Timer.h"
 
 /// Name of our specific session, the game's name, max amount of peers/clients, and your name for this session.
 GameSession::GameSession(String sessionName, String gameName, int maxPeers)
-: Session(sessionName, gameName, SessionType::GAME), maxPlayers(maxPlayers)
+: Session(sessionName, gameName, SessionType::GAME), maxPlayers(maxPeers)
 {
 	currentPlayers = 0;
-	udpSocket = NULL;
+	udpTransport = NULL;
+	hostConnection = NULL;
 	isLocal = true;
 }
 
 /// Virtual destructor for proper deallocation.
 GameSession::~GameSession()
 {
-	if (udpSocket){
-		udpSocket->Close();
-		delete udpSocket;
-	}
+	delete udpTransport;
 	// Session or subclass should handle most?
 }
 
@@ -42,7 +42,7 @@ Game * GameSession::GetGame()
 	game->host = me->name;
 	game->port = this->tcpServer->Port();
 	assert(game->port > 0);
-	game->udpPort = this->udpSocket->port;
+	game->udpPort = this->udpTransport->Port();
 	game->currentPlayers = this->currentPlayers;
 	game->maxPlayers = this->maxPlayers;
 	return game;
@@ -50,8 +50,10 @@ Game * GameSession::GetGame()
 	return NULL;
 }
 
-/// Performs regular tcp connection via Session, but also sets up our client UDP socket.
-bool GameSession::ConnectTo(String ipAddress, int port, int clientUdpPort /* = -1 */)
+/** Performs regular tcp connection via Session, but also sets up our client UDP socket.
+	If hostUdpPort is given, a UDP connection to the host is made too, binding any free port if clientUdpPort is not given.
+*/
+bool GameSession::ConnectTo(String ipAddress, int port, int clientUdpPort, int hostUdpPort /* = -1 */)
 {
 	bool result = Session::ConnectTo(ipAddress, port);
 	if (!result){
@@ -59,17 +61,26 @@ bool GameSession::ConnectTo(String ipAddress, int port, int clientUdpPort /* = -
 		return false;
 	}
 	// Only do UDP stuff if it was requested to use a UDP port.
-	if (clientUdpPort > 0)
+	if (clientUdpPort > 0 || hostUdpPort > 0)
 	{
-		if (!udpSocket)
-			udpSocket = new UdpSocket();
-		result = udpSocket->Bind(clientUdpPort);
-		udpSocket->peerAddress = ipAddress;
-		if (!result)
+		if (!udpTransport)
+			udpTransport = new UdpTransport();
+		hostConnection = NULL;
+		if (!udpTransport->Bind(clientUdpPort > 0 ? clientUdpPort : 0))
 		{
-			this->lastErrorString = udpSocket->GetLastErrorString();
+			this->lastErrorString = "Unable to bind UDP port "+String(clientUdpPort);
 			return false;
 		}
+		if (hostUdpPort > 0)
+		{
+			hostConnection = udpTransport->Connect(ipAddress, hostUdpPort);
+			if (!hostConnection)
+			{
+				this->lastErrorString = "Unable to resolve "+ipAddress+" for UDP";
+				return false;
+			}
+			hostConnection->peer = host;
+		}
 	}
 	isLocal = false;
 	return true;
@@ -85,13 +96,10 @@ bool GameSession::Host(int tcpPort, int udpPort)
 		return false;
 	}
 	/// Create 
-	if (udpSocket){
-		udpSocket->Close();
-		delete udpSocket;
-		udpSocket = NULL;
-	}
-	udpSocket = new UdpSocket();
-	result = udpSocket->Bind(udpPort);
+	if (!udpTransport)
+		udpTransport = new UdpTransport();
+	hostConnection = NULL;
+	result = udpTransport->Bind(udpPort, true, maxPlayers);
 	if (!result)
 	{
 		std::cout<<"\nGameSession::Host: Unable to bind UdpSocket.";	
@@ -99,13 +107,113 @@ bool GameSession::Host(int tcpPort, int udpPort)
 	}
 	/// Save away port numbers
 	this->port = tcpPort;
-	this->udpPort = udpPort;
+	this->udpPort = udpTransport->Port();
 	isLocal = false;
 	return true;
 }
 
+/// Stops the session, closing the UDP socket too.
+void GameSession::Stop()
+{
+	Session::Stop();
+	hostConnection = NULL;
+	if (udpTransport)
+		udpTransport->Close();
+}
+
 /// Called when the host disconnects.
 void GameSession::OnHostDisconnected(Peer * host)
 {
 	/// Woo.
 }
+
+/// Reads packets from the TCP sockets via Session, then updates the UDP transport and appends what arrived over it.
+List<Packet*> GameSession::ReadPackets()
+{
+	List<Packet*> packets = Session::ReadPackets();
+	if (!udpTransport)
+		return packets;
+	udpTransport->Update(Timer::GetCurrentTimeMs(true));
+	/// Before reading, so that packets from newly accepted connections have their sender set.
+	if (isHost)
+		IdentifyUdpConnections();
+	packets += udpTransport->ReadPackets();
+	/// Drop connections which have gone silent, e.g. clients which left without telling.
+	for (int i = 0; i < udpTransport->connections.Size(); ++i)
+	{
+		UdpConnection * connection = udpTransport->connections[i];
+		if (!connection->TimedOut())
+			continue;
+		std::cout<<"\nGameSession::ReadPackets: UDP connection to "<<connection->AddressString()<<" timed out.";
+		if (connection == hostConnection)
+			hostConnection = NULL;
+		udpTransport->Disconnect(connection);
+		--i;
+	}
+	return packets;
+}
+
+/** Sends target packet over UDP, to the host if we are a client, or to all connected clients if we are hosting.
+	Use UdpDelivery::UNRELIABLE_SEQUENCED for e.g. entity snapshots, where only the newest matters.
+*/
+void GameSession::SendUdp(Packet & packet, int delivery, int channel /*= 0*/)
+{
+	if (!udpTransport)
+		return;
+	if (hostConnection)
+	{
+		hostConnection->Send(packet, delivery, channel);
+		return;
+	}
+	if (!isHost)
+		return;
+	for (int i = 0; i < udpTransport->connections.Size(); ++i)
+		udpTransport->connections[i]->Send(packet, delivery, channel);
+}
+
+/// Called every time a socket is deleted. UDP connections to the socket's peer forget it, as it may be deleted along with it.
+void GameSession::OnSocketDeleted(Socket * sock)
+{
+	if (udpTransport && sock->peer)
+	{
+		for (int i = 0; i < udpTransport->connections.Size(); ++i)
+		{
+			UdpConnection * connection = udpTransport->connections[i];
+			if (connection->peer == sock->peer)
+				connection->peer = NULL;
+		}
+	}
+	Session::OnSocketDeleted(sock);
+}
+
+/** Sets the peer of UDP connections accepted while hosting, to that of the TCP socket connected from the same address, once it has one.
+	Clients sharing an address, e.g. when testing on one machine, are matched with their sockets in the order they connected.
+*/
+void GameSession::IdentifyUdpConnections()
+{
+	for (int i = 0; i < udpTransport->connections.Size(); ++i)
+	{
+		UdpConnection * connection = udpTransport->connections[i];
+		if (connection->peer)
+			continue;
+		char ip[INET_ADDRSTRLEN] = {0};
+		inet_ntop(AF_INET, (void*) &connection->address.sin_addr, ip, sizeof(ip));
+		for (int j = 0; j < sockets.Size(); ++j)
+		{
+			Socket * sock = sockets[j];
+			if (!sock->peer || sock->peerAddress != ip || UdpConnectionTo(sock->peer))
+				continue;
+			connection->peer = sock->peer;
+			break;
+		}
+	}
+}
+
+/// Returns the UDP connection to the peer, or NULL.
+UdpConnection * GameSession::UdpConnectionTo(Peer * peer)
+{
+	for (int i = 0; i < udpTransport->connections.Size(); ++i)
+		if (udpTransport->connections[i]->peer == peer)
+			return udpTransport->connections[i];
+	return NULL;
+}
@@ -6,7 +6,7 @@
 #define GAME_SESSION_H
 
 #include "Session.h"
-#include "Network/Socket/UdpSocket.h"
+#include "Network/Udp/UdpTransport.h"
 
 class Game;
 
@@ -21,20 +21,32 @@ public:
 	/// Sends a packet to all peers in the session, via the host if possible.
 //	void Send(Packet * packet);
 
-	/// Performs regular tcp connection via Session, but also sets up our client UDP socket.
-	virtual bool ConnectTo(String ipAddress, int port, int clientUdpPort);
-	/// Calls host for Session but also creates and binds a UDP socket.
+	/** Performs regular tcp connection via Session, but also sets up our client UDP socket.
+		If hostUdpPort is given, a UDP connection to the host is made too, binding any free port if clientUdpPort is not given.
+	*/
+	virtual bool ConnectTo(String ipAddress, int port, int clientUdpPort, int hostUdpPort = -1);
+	/// Calls host for Session but also creates and binds a UDP socket, accepting UDP connections from up to maxPlayers clients.
 	virtual bool Host(int tcpPort, int udpPort);
+	/// Stops the session, closing the UDP socket too.
+	virtual void Stop();
 
 	/// Called when the host disconnects.
 	virtual void OnHostDisconnected(Peer * host);
 
+	/// Reads packets from the TCP sockets via Session, then updates the UDP transport and appends what arrived over it.
+	virtual List<Packet*> ReadPackets();
+	/** Sends target packet over UDP, to the host if we are a client, or to all connected clients if we are hosting.
+		Use UdpDelivery::UNRELIABLE_SEQUENCED for e.g. entity snapshots, where only the newest matters.
+	*/
+	void SendUdp(Packet & packet, int delivery, int channel = 0);
+
 	/// Returns a Game-object containing all necessary info about this specific game instance.
 	Game * GetGame();
 
-	/// For fast-paced data.
-	UdpSocket * udpSocket;
-//	UdpSocket * clientUdpSocket;
+	/// For fast-paced data. Holds one UdpConnection per client when hosting, or one to the host when connected.
+	UdpTransport * udpTransport;
+	/// UDP connection to the host, if connected as a client with a host UDP port.
+	UdpConnection * hostConnection;
 
 	/// Maximum amount of peers for this game session.
 	int maxPlayers;
@@ -46,6 +58,15 @@ public:
 	/// Name! o-o
 	String Name(){return name;};
 protected:
+	/// Called every time a socket is deleted. UDP connections to the socket's peer forget it, as it may be deleted along with it.
+	virtual void OnSocketDeleted(Socket * sock);
+private:
+	/** Sets the peer of UDP connections accepted while hosting, to that of the TCP socket connected from the same address, once it has one.
+		Clients sharing an address, e.g. when testing on one machine, are matched with their sockets in the order they connected.
+	*/
+	void IdentifyUdpConnections();
+	/// Returns the UDP connection to the peer, or NULL.
+	UdpConnection * UdpConnectionTo(Peer * peer);
 
 };
 
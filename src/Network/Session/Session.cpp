@@ -9,6 +9,10 @@
 #include "Network/Peer.h"
 #include "Network/Socket/TcpSocket.h"
 #include "Network/Server/TcpServer.h"
+#include "Network/Socket/SocketReactor.h"
+#include "Network/Packet/PacketFramer.h"
+#include "Network/Packet/PacketPool.h"
+#include "DataStream/RingBuffer.h"
 
 #include "Network/NetworkManager.h"
 
@@ -31,6 +35,7 @@ Session::Session(String name, String typeName, int type)
 	host = NULL;
 	tcpServer = NULL;
 	hostSocket = NULL;
+	reactor = new SocketReactor();
 	maxPeers = 32;
 }
 
@@ -39,6 +44,7 @@ Session::~Session()
 	std::cout<<"\nSession destructor.";
 	SAFE_DELETE(tcpServer);
 	SAFE_DELETE(hostSocket);
+	SAFE_DELETE(reactor);
 }
 
 
@@ -70,6 +76,7 @@ bool Session::ConnectTo(String ipAddress, int port)
 	bool success = hostSocket->ConnectTo(ipAddress, port);
 	if (success)
 	{
+		reactor->Add(hostSocket);
 		isConnected = true;
 		return true;
 	}
@@ -166,9 +173,12 @@ void Session::EvaluateConnections(){
 	// If hosting, check for new connections
 	if (this->tcpServer){
 		assert(this->tcpServer);
-		Socket * newSocket = this->tcpServer->NextPendingConnection();
-		if (newSocket)
+		Socket * newSocket;
+		while((newSocket = this->tcpServer->NextPendingConnection()) != NULL)
+		{
 			sockets.Add(newSocket);
+			reactor->Add(newSocket);
+		}
 	}
 
 	/// Deletes those sockets that either have errors or have been flagged for deletion (other errors)
@@ -210,36 +220,41 @@ void Session::SendText(String text)
 	
 
 /** Reads packets, creating them and returning them for processing. 
-	Each batch of received bytes is considered one "packet". Subclass to override.
+	Packets are framed as written by Packet::Send, see PacketFramer. Partially received packets are kept until complete.
+	The returned packets are taken from the PacketPool, and should be released to it once processed. Subclass to override.
 */
 List<Packet*> Session::ReadPackets()
 {
 	List<Packet*> packetsReceived;
-	const int packetBufferSize = 5000;
-	char packetBuffer[packetBufferSize];
-
-	/// Gather relevant sockets to check for received data.
-	List<Socket*> socketsToCheck;
-	if (isHost)
-	{
-		socketsToCheck = sockets;
-	}
-	else {
-		if (hostSocket)
-			socketsToCheck = hostSocket;
-	}	
 
-	/// Check all sockets now.
-	for (int i = 0; i < socketsToCheck.Size(); ++i)
+	/// Receive on all sockets at once, then visit only those which got anything.
+	reactor->Poll(0);
+	const List<Socket*> & readable = reactor->ReadableSockets();
+	for (int i = 0; i < readable.Size(); ++i)
 	{
-		Socket * s = socketsToCheck[i];
-		int bytesRead = s->Read(packetBuffer, packetBufferSize);
-		// Read one packet each frame?
-		if (bytesRead > 0)
+		Socket * s = readable[i];
+		/// Only the host socket is read when not hosting.
+		if (!isHost && s != hostSocket)
+			continue;
+		RingBuffer * received = reactor->ReceiveBuffer(s);
+		PacketFrame frame;
+		int result;
+		while((result = PacketFramer::Next(*received, frame)) == PacketFramer::COMPLETE)
 		{
-			Packet * pack = new Packet(PacketType::NULL_TYPE);
-			pack->data.PushBytes((uchar *)packetBuffer, bytesRead);
+			/// Copied once, straight from the receive buffer into a recycled payload buffer.
+			Packet * pack = PacketPool::Get(frame.type);
+			pack->data.PushBytes((uchar *)frame.payload, frame.payloadBytes);
+			pack->size = frame.payloadBytes;
+			pack->socket = s;
+			pack->sender = s->peer;
 			packetsReceived.Add(pack);
+			received->Consume(frame.frameBytes);
+		}
+		if (result == PacketFramer::MALFORMED)
+		{
+			std::cout<<"\nSession::ReadPackets: Malformed packet from "<<s->peerAddress<<", disconnecting.";
+			received->Clear();
+			s->deleteFlag = 1;
 		}
 	}
 	return packetsReceived;
@@ -261,6 +276,8 @@ String Session::TypeName(int id){
 			return "VoiceOverIP";
 		case SessionType::VIDEO:
 			return "Video transmission";
+		case SessionType::ENTITY_SYNC:
+			return "Entity synchronization";
 		default:
 			return "Undefined";
 	}
@@ -297,6 +314,8 @@ void Session::SendPackets(){
 		packetQueue.Remove(packet);
 		delete packet;
 	}
+	/// Send everything written to the sockets this frame, with one call per socket.
+	reactor->Flush();
 }
 
 /// Called every time a socket is deleted. Any references to the socket should then be removed.
@@ -10,6 +10,7 @@ class Peer;
 class Packet;
 class TcpServer;
 class Socket;
+class SocketReactor;
 
 class Session {
 	friend class NetworkManager;
@@ -46,7 +47,8 @@ public:
 	/// Sends text as a packet.
 	virtual void SendText(String text);
 	/** Reads packets, creating them and returning them for processing. 
-		Each batch of received bytes is considered one "packet". Subclass to override.
+		Packets are framed as written by Packet::Send, see PacketFramer. Partially received packets are kept until complete.
+		The returned packets are taken from the PacketPool, and should be released to it once processed. Subclass to override.
 	*/
 	virtual List<Packet*> ReadPackets();
 
@@ -87,6 +89,8 @@ protected:
 	Socket * hostSocket;
 	/// List of sockets not currently associated with a single peer.
 	List<Socket*> sockets;
+	/// Handles the I/O of all sockets above and the hostSocket, so they can be read and written without waiting.
+	SocketReactor * reactor;
 	/// If true, we are the host to this session. This will be true also when playing single-player.
 	bool isHost;
 	/// If true, we are currently connected to a peer/host.
@@ -12,6 +12,7 @@ enum sessionTypes {
 	GAME, // Session type that handles both a chat and a game, including spectators.
 	VOIP, // Voice over IP.
 	VIDEO, // For transmitting a live-stream, camera, or similar.
+	ENTITY_SYNC, // Replication of entity states from host to clients, see Network/Sync/.
 };};
 
 #endif
@@ -5,6 +5,7 @@
 #include "Socket.h"
 #include "Network/Peer.h"
 #include "Timer/Timer.h"
+#include "SocketReactor.h"
 
 /// Closes target socket.
 void CloseSocket(SOCKET sock){
@@ -87,6 +88,8 @@ Socket::Socket(int type)
 : type(type)
 {
 	peer = NULL;
+	sockfd = INVALID_SOCKET;
+	reactor = NULL;
 	deleteFlag = 0;
 	nonBlocking = false;
 	messagesSent = 0;
@@ -100,6 +103,8 @@ Socket::Socket(int type)
 
 /// Destructor that closes sockets if required.
 Socket::~Socket(){
+	if (reactor)
+		reactor->Remove(this);
 	if (sockfd != INVALID_SOCKET)
 		Close();
 	std::cout<<"\nSocket destructor";
@@ -108,6 +113,11 @@ Socket::~Socket(){
 /// Writes bytes from buffer into socket. Returns bytes written or -1 if the socket is closed.
 int Socket::Write(const char * fromBuffer, int maxBytesToWrite)
 {
+	if (reactor)
+	{
+		++messagesSent;
+		return reactor->Write(this, fromBuffer, maxBytesToWrite);
+	}
 	timeval t = {0, 1000};
 	if (!ReadyToWrite(sockfd))
         return 0;
@@ -117,9 +127,30 @@ int Socket::Write(const char * fromBuffer, int maxBytesToWrite)
 	return bytesWritten;
 }
 
+/** Writes a header followed by a body, e.g. of a framed packet. If handled by a SocketReactor, both are queued or neither,
+	so that a partial write can not corrupt the stream. Returns total bytes written, or -1 if the socket is closed.
+*/
+int Socket::Write(const char * header, int headerBytes, const char * body, int bodyBytes)
+{
+	if (reactor)
+	{
+		++messagesSent;
+		return reactor->Write(this, header, headerBytes, body, bodyBytes);
+	}
+	int headerWritten = Write(header, headerBytes);
+	if (headerWritten <= 0)
+		return headerWritten;
+	int bodyWritten = Write(body, bodyBytes);
+	if (bodyWritten < 0)
+		return bodyWritten;
+	return headerWritten + bodyWritten;
+}
+
 /// Reads bytes from the socket. If the socket has closed -1 will be returned.
 int Socket::Read(char * intoBuffer, int maxBytesToRead)
 {
+	if (reactor)
+		return reactor->Read(this, intoBuffer, maxBytesToRead);
 	timeval t = {0, 1000};
 	if (!ReadyToRead(sockfd))
         return 0;
@@ -155,6 +186,9 @@ bool Socket::ShouldDelete(){
 
 /// Closes the socket. Returns false if any error occured.
 bool Socket::Close(){
+	/// Stop listening for events before the descriptor may be re-used.
+	if (reactor)
+		reactor->Remove(this);
 	if (sockfd == INVALID_SOCKET)
 		return true;
 	int result = closesocket(sockfd);
@@ -242,6 +276,9 @@ bool Socket::ConnectTo(String hostAddress, int port)
 
 /// Performs a select check to see if it currently has any errors.
 bool Socket::HasError(){
+	/// The reactor flags the socket for deletion on errors instead.
+	if (reactor)
+		return false;
 	fd_set efds = {1, sockfd};
 	struct timeval timeout = {0, 1000};
 	int result = select(0, NULL, NULL, &efds, &timeout);
@@ -267,6 +304,7 @@ void Socket::SetNonBlocking(bool nonBlockingEnabled){
     flags = blocking ? (flags&~O_NONBLOCK) : (flags|O_NONBLOCK);
     bool success = fcntl(sockfd, F_SETFL, flags);
 #endif
+    nonBlocking = nonBlockingEnabled;
     return;
 }
 
@@ -9,6 +9,7 @@
 #include <String/AEString.h>
 
 class Peer;
+class SocketReactor;
 
 namespace SocketType {
 enum socketTypes{
@@ -27,14 +28,21 @@ bool ReadyToWrite(SOCKET sock);
 class Socket {
 	friend class Session;
 	friend class TcpServer;
+	friend class SocketReactor;
 public:
 	/// Constructor specifying type of socket and host address.
 	Socket(int type);
 	/// Destructor that closes sockets if required.
 	virtual ~Socket();
-	/// Writes bytes from buffer into socket. Returns bytes written or -1 if the socket is closed.
+	/** Writes bytes from buffer into socket. Returns bytes written or -1 if the socket is closed.
+		If handled by a SocketReactor the bytes are queued, and sent on its next Flush or Poll.
+	*/
 	virtual int Write(const char * fromBuffer, int maxBytesToWrite);
-	/// Reads bytes from the socket. If the socket has closed -1 will be returned.
+	/** Writes a header followed by a body, e.g. of a framed packet. If handled by a SocketReactor, both are queued or neither,
+		so that a partial write can not corrupt the stream. Returns total bytes written, or -1 if the socket is closed.
+	*/
+	int Write(const char * header, int headerBytes, const char * body, int bodyBytes);
+	/// Reads bytes from the socket. If the socket has closed -1 will be returned. If handled by a SocketReactor, reads what it has received.
 	virtual int Read(char * intoBuffer, int maxBytesToRead);
 
 	/// If the delete flag has been set.
@@ -98,6 +106,8 @@ protected:
 	struct addrinfo hints, *servInfo, *server;
 	/// Main socket
 	SOCKET sockfd;
+	/// Reactor handling the I/O of this socket, if any. See SocketReactor::Add.
+	SocketReactor * reactor;
 
 };
 
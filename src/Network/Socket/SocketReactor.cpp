@@ -0,0 +1,406 @@
+/// Emil Hedemalm
+/// 2016-08-27
+/// Event-driven I/O for all sockets of a session, using epoll on Linux.
+
+#include "SocketReactor.h"
+#include "Socket.h"
+#include "DataStream/RingBuffer.h"
+#include <cerrno>
+
+#ifdef LINUX
+#include <sys/epoll.h>
+#endif
+#ifndef WINDOWS
+#include <sys/uio.h>
+#endif
+#ifdef WINDOWS
+#define poll WSAPoll
+#endif
+/// Peers closing their end should give an error, not kill the process with SIGPIPE.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/// Bytes to have free in the receive buffer before each recv.
+#define RECEIVE_CHUNK	4096
+
+struct SocketReactor::Connection
+{
+	Connection(Socket * socket)
+	: socket(socket), received(RECEIVE_CHUNK), toSend(RECEIVE_CHUNK)
+	{
+		writable = true;
+		closed = false;
+		readPending = writePending = throttled = false;
+	}
+	Socket * socket;
+	RingBuffer received, toSend;
+	/// False after a send would have blocked, until the socket signals it is writable again.
+	bool writable;
+	/// If closed by the peer, or failed.
+	bool closed;
+	/// If in pendingReads, pendingWrites and throttledReads respectively.
+	bool readPending, writePending, throttled;
+};
+
+/// If the last socket call failed only because it would have blocked.
+static bool WouldBlock()
+{
+#ifdef WINDOWS
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/// If the last socket call was interrupted by a signal, and should be retried.
+static bool Interrupted()
+{
+#ifdef WINDOWS
+	return false;
+#else
+	return errno == EINTR;
+#endif
+}
+
+SocketReactor::SocketReactor()
+{
+#ifdef LINUX
+	epollFd = epoll_create1(0);
+	if (epollFd < 0)
+		std::cout<<"\nSocketReactor: Unable to create epoll instance, errno: "<<errno;
+#endif
+}
+
+/// Releases all sockets, without closing them.
+SocketReactor::~SocketReactor()
+{
+	for (std::unordered_map<Socket*, Connection*>::iterator it = connections.begin(); it != connections.end(); ++it)
+	{
+		it->first->reactor = NULL;
+		delete it->second;
+	}
+#ifdef LINUX
+	if (epollFd >= 0)
+		close(epollFd);
+#endif
+}
+
+/// Makes the socket non-blocking and starts handling its I/O. Returns false if it is not open or could not be registered.
+bool SocketReactor::Add(Socket * socket)
+{
+	if (Contains(socket))
+		return true;
+	if (socket->sockfd == INVALID_SOCKET)
+		return false;
+	socket->SetNonBlocking();
+	Connection * connection = new Connection(socket);
+#ifdef LINUX
+	epoll_event event;
+	memset(&event, 0, sizeof(epoll_event));
+	/// Edge-triggered: only notified when new data arrives or it becomes writable again, so each socket is read and written until it would block.
+	event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	event.data.ptr = connection;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket->sockfd, &event) != 0)
+	{
+		std::cout<<"\nSocketReactor::Add: Unable to register socket, errno: "<<errno;
+		delete connection;
+		return false;
+	}
+#endif
+	connections[socket] = connection;
+	socket->reactor = this;
+	/// Data may have arrived before it was added.
+	connection->readPending = true;
+	pendingReads.AddItem(connection);
+	return true;
+}
+
+/// Stops handling its I/O. Unsent and unread data is discarded.
+void SocketReactor::Remove(Socket * socket)
+{
+	Connection * connection = Find(socket);
+	if (!connection)
+		return;
+#ifdef LINUX
+	if (!connection->closed)
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, socket->sockfd, NULL);
+#endif
+	if (connection->readPending)
+		pendingReads.Remove(connection);
+	if (connection->writePending)
+		pendingWrites.Remove(connection);
+	if (connection->throttled)
+		throttledReads.Remove(connection);
+	readable.Remove(socket);
+	connections.erase(socket);
+	socket->reactor = NULL;
+	delete connection;
+}
+
+bool SocketReactor::Contains(Socket * socket) const
+{
+	return Find(socket) != NULL;
+}
+
+/** Waits at most timeoutMs for events (0 to not wait, -1 to wait until any), receives all available data,
+	and sends queued data to sockets which became writable. Sockets which close or fail are flagged for deletion.
+	Returns the number of sockets which received data, as listed by ReadableSockets.
+*/
+int SocketReactor::Poll(int timeoutMs /*= 0*/)
+{
+	readable.Clear();
+	/** Throttled sockets may have more data waiting, which edge-triggered epoll will not signal again,
+		so resume reading them once enough of their received data has been read.
+	*/
+	for (int i = 0; i < throttledReads.Size(); ++i)
+	{
+		Connection * connection = throttledReads[i];
+		if (connection->received.Size() >= REACTOR_RECEIVE_LIMIT)
+			continue;
+		throttledReads.RemoveIndex(i--);
+		connection->throttled = false;
+		connection->readPending = true;
+		pendingReads.AddItem(connection);
+	}
+	/// Don't wait if there is data to receive. Sockets still throttled can not be read from, so they do not count.
+	if (pendingReads.Size())
+		timeoutMs = 0;
+#ifdef LINUX
+	epoll_event events[REACTOR_MAX_EVENTS];
+	int numEvents = epoll_wait(epollFd, events, REACTOR_MAX_EVENTS, timeoutMs);
+	for (int i = 0; i < numEvents; ++i)
+	{
+		Connection * connection = (Connection*) events[i].data.ptr;
+		uint32 flags = events[i].events;
+		/// Hang-ups and errors are read too, so that remaining data is received before the socket is flagged.
+		if ((flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && !connection->readPending && !connection->throttled)
+		{
+			connection->readPending = true;
+			pendingReads.AddItem(connection);
+		}
+		if (flags & EPOLLOUT)
+			connection->writable = true;
+	}
+#else
+	/// Level-triggered, so only ask for writability while blocked with data to send, and for data while not throttled.
+	List<pollfd> pollFds;
+	List<Connection*> polled;
+	pollFds.Reserve((int) connections.size());
+	polled.Reserve((int) connections.size());
+	for (std::unordered_map<Socket*, Connection*>::iterator it = connections.begin(); it != connections.end(); ++it)
+	{
+		Connection * connection = it->second;
+		if (connection->closed)
+			continue;
+		pollfd pollFd;
+		memset(&pollFd, 0, sizeof(pollfd));
+		pollFd.fd = it->first->sockfd;
+		if (!connection->throttled)
+			pollFd.events = POLLIN;
+		if (!connection->writable && connection->toSend.Size())
+			pollFd.events |= POLLOUT;
+		/// Hang-ups would be reported even without asking, waking every poll.
+		if (!pollFd.events)
+			continue;
+		pollFds.AddItem(pollFd);
+		polled.AddItem(connection);
+	}
+	int numEvents = pollFds.Size() ? poll(pollFds.GetArray(), pollFds.Size(), timeoutMs) : 0;
+	for (int i = 0; i < pollFds.Size() && numEvents > 0; ++i)
+	{
+		Connection * connection = polled[i];
+		short flags = pollFds[i].revents;
+		if ((flags & (POLLIN | POLLHUP | POLLERR)) && !connection->readPending && !connection->throttled)
+		{
+			connection->readPending = true;
+			pendingReads.AddItem(connection);
+		}
+		if (flags & POLLOUT)
+			connection->writable = true;
+	}
+#endif
+
+	/// Receive, throttling those which reached their limit until their data has been read.
+	List<Connection*> toRead = pendingReads;
+	pendingReads.Clear();
+	for (int i = 0; i < toRead.Size(); ++i)
+	{
+		Connection * connection = toRead[i];
+		connection->readPending = false;
+		int before = connection->received.Size();
+		Receive(connection);
+		if (connection->received.Size() > before)
+			readable.AddItem(connection->socket);
+		if (!connection->closed && connection->received.Size() >= REACTOR_RECEIVE_LIMIT)
+		{
+			connection->throttled = true;
+			throttledReads.AddItem(connection);
+		}
+	}
+	Flush();
+	return readable.Size();
+}
+
+/// Reads received bytes. Returns 0 if there are none, or -1 if there are none and the socket has closed.
+int SocketReactor::Read(Socket * socket, char * intoBuffer, int maxBytesToRead)
+{
+	Connection * connection = Find(socket);
+	if (!connection)
+		return -1;
+	int bytesRead = connection->received.Read((uchar*) intoBuffer, maxBytesToRead);
+	if (bytesRead == 0 && connection->closed)
+		return -1;
+	return bytesRead;
+}
+
+/// Bytes received and not yet read.
+int SocketReactor::BytesAvailable(Socket * socket) const
+{
+	Connection * connection = Find(socket);
+	return connection ? connection->received.Size() : 0;
+}
+
+/// Received data of the socket, for parsing it in place. NULL if not handled.
+RingBuffer * SocketReactor::ReceiveBuffer(Socket * socket)
+{
+	Connection * connection = Find(socket);
+	return connection ? &connection->received : NULL;
+}
+
+/** Queues bytes to be sent on the next Flush or Poll. Returns bytes queued, 0 if too much is already waiting,
+	or -1 if the socket has closed.
+*/
+int SocketReactor::Write(Socket * socket, const char * fromBuffer, int bytesToWrite)
+{
+	return Write(socket, fromBuffer, bytesToWrite, NULL, 0);
+}
+
+/// Queues both parts, e.g. a header and its payload, or neither. Returns total bytes queued, 0 or -1 as above.
+int SocketReactor::Write(Socket * socket, const char * first, int firstBytes, const char * second, int secondBytes)
+{
+	Connection * connection = Find(socket);
+	if (!connection || connection->closed)
+		return -1;
+	int bytesToWrite = firstBytes + secondBytes;
+	if (connection->toSend.Size() + bytesToWrite > REACTOR_SEND_LIMIT)
+		return 0;
+	connection->toSend.Reserve(bytesToWrite);
+	connection->toSend.Write((const uchar*) first, firstBytes);
+	connection->toSend.Write((const uchar*) second, secondBytes);
+	if (!connection->writePending)
+	{
+		connection->writePending = true;
+		pendingWrites.AddItem(connection);
+	}
+	return bytesToWrite;
+}
+
+/// Sends as much queued data as the sockets accept, with one call per socket.
+void SocketReactor::Flush()
+{
+	List<Connection*> toWrite = pendingWrites;
+	pendingWrites.Clear();
+	for (int i = 0; i < toWrite.Size(); ++i)
+	{
+		Connection * connection = toWrite[i];
+		connection->writePending = false;
+		Send(connection);
+		/// Wait for it to become writable again.
+		if (!connection->closed && connection->toSend.Size())
+		{
+			connection->writePending = true;
+			pendingWrites.AddItem(connection);
+		}
+	}
+}
+
+SocketReactor::Connection * SocketReactor::Find(Socket * socket) const
+{
+	std::unordered_map<Socket*, Connection*>::const_iterator it = connections.find(socket);
+	return it != connections.end() ? it->second : NULL;
+}
+
+/// Receives until the socket has no more data or the receive limit is reached.
+void SocketReactor::Receive(Connection * connection)
+{
+	Socket * socket = connection->socket;
+	while (!connection->closed && connection->received.Size() < REACTOR_RECEIVE_LIMIT)
+	{
+		connection->received.Reserve(RECEIVE_CHUNK);
+		int contiguous;
+		uchar * into = connection->received.WritePointer(contiguous);
+		int bytesRead = recv(socket->sockfd, (char*) into, contiguous, 0);
+		if (bytesRead > 0)
+		{
+			connection->received.Commit(bytesRead);
+			socket->bytesReceived += bytesRead;
+		}
+		/// Closed by the peer.
+		else if (bytesRead == 0)
+			Close(connection);
+		else if (WouldBlock())
+			return;
+		else if (!Interrupted())
+		{
+			std::cout<<"\nSocketReactor: Error receiving, errorCode: "<<sockerrno<<" Setting delete flag.";
+			Close(connection);
+		}
+	}
+}
+
+/// Sends queued data until done or the socket would block.
+void SocketReactor::Send(Connection * connection)
+{
+	Socket * socket = connection->socket;
+	RingBuffer & toSend = connection->toSend;
+	while (!connection->closed && connection->writable && toSend.Size())
+	{
+		/// The queued data is in at most two parts.
+		int firstBytes, secondBytes;
+		const uchar * first = toSend.ReadPointer(firstBytes);
+		const uchar * second = toSend.ReadPointer(secondBytes, firstBytes);
+#ifdef WINDOWS
+		int bytesSent = send(socket->sockfd, (const char*) first, firstBytes, 0);
+#else
+		/// As writev, but without raising SIGPIPE.
+		iovec parts[2];
+		parts[0].iov_base = (void*) first;
+		parts[0].iov_len = firstBytes;
+		parts[1].iov_base = (void*) second;
+		parts[1].iov_len = secondBytes;
+		msghdr message;
+		memset(&message, 0, sizeof(msghdr));
+		message.msg_iov = parts;
+		message.msg_iovlen = secondBytes ? 2 : 1;
+		int bytesSent = (int) sendmsg(socket->sockfd, &message, MSG_NOSIGNAL);
+#endif
+		if (bytesSent > 0)
+		{
+			toSend.Consume(bytesSent);
+			socket->bytesSent += bytesSent;
+		}
+		else if (bytesSent < 0 && WouldBlock())
+			connection->writable = false;
+		else if (bytesSent < 0 && Interrupted())
+			continue;
+		else
+		{
+			std::cout<<"\nSocketReactor: Error sending, errorCode: "<<sockerrno<<" Setting delete flag.";
+			Close(connection);
+		}
+	}
+}
+
+/// Flags the socket for deletion, and stops listening for its events.
+void SocketReactor::Close(Connection * connection)
+{
+	if (connection->closed)
+		return;
+	connection->closed = true;
+	connection->toSend.Clear();
+	connection->socket->deleteFlag = 1;
+#ifdef LINUX
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->socket->sockfd, NULL);
+#endif
+}
@@ -0,0 +1,93 @@
+/// Emil Hedemalm
+/// 2016-08-27
+/// Event-driven I/O for all sockets of a session, using epoll on Linux.
+
+#ifndef SOCKET_REACTOR_H
+#define SOCKET_REACTOR_H
+
+#include "Network/NetworkIncludes.h"
+#include "List/List.h"
+#include <unordered_map>
+
+class Socket;
+class RingBuffer;
+
+/// Stop reading from a socket while this many bytes of it are unread, until they are.
+#define REACTOR_RECEIVE_LIMIT	(1024 * 1024)
+/// Refuse writes to a socket while this many bytes are waiting to be sent, e.g. to a peer which stopped reading.
+#define REACTOR_SEND_LIMIT		(4 * 1024 * 1024)
+/// Max events handled per Poll.
+#define REACTOR_MAX_EVENTS		256
+
+/** Owns the I/O of added sockets. Instead of polling each socket with a timeout, Poll waits for events on all
+	of them at once, reads all available data into per-socket receive buffers and sends what has been written to them.
+	Socket::Read and Socket::Write of added sockets use these buffers, so that writes are batched into one send per socket,
+	and reads never wait.
+
+	On Linux sockets are registered edge-triggered with epoll, so that only sockets with new events are visited.
+	Elsewhere poll is used over all sockets.
+*/
+class SocketReactor
+{
+public:
+	SocketReactor();
+	/// Releases all sockets, without closing them.
+	~SocketReactor();
+
+	/// Makes the socket non-blocking and starts handling its I/O. Returns false if it is not open or could not be registered.
+	bool Add(Socket * socket);
+	/// Stops handling its I/O. Unsent and unread data is discarded.
+	void Remove(Socket * socket);
+	bool Contains(Socket * socket) const;
+	/// Number of sockets handled.
+	int Sockets() const { return (int) connections.size(); };
+
+	/** Waits at most timeoutMs for events (0 to not wait, -1 to wait until any), receives all available data,
+		and sends queued data to sockets which became writable. Sockets which close or fail are flagged for deletion.
+		Returns the number of sockets which received data, as listed by ReadableSockets.
+	*/
+	int Poll(int timeoutMs = 0);
+	/// Sockets which received data during the last Poll.
+	const List<Socket*> & ReadableSockets() const { return readable; };
+
+	/// Reads received bytes. Returns 0 if there are none, or -1 if there are none and the socket has closed.
+	int Read(Socket * socket, char * intoBuffer, int maxBytesToRead);
+	/// Bytes received and not yet read.
+	int BytesAvailable(Socket * socket) const;
+	/// Received data of the socket, for parsing it in place. NULL if not handled.
+	RingBuffer * ReceiveBuffer(Socket * socket);
+	/** Queues bytes to be sent on the next Flush or Poll. Returns bytes queued, 0 if too much is already waiting,
+		or -1 if the socket has closed.
+	*/
+	int Write(Socket * socket, const char * fromBuffer, int bytesToWrite);
+	/// Queues both parts, e.g. a header and its payload, or neither. Returns total bytes queued, 0 or -1 as above.
+	int Write(Socket * socket, const char * first, int firstBytes, const char * second, int secondBytes);
+	/// Sends as much queued data as the sockets accept, with one call per socket.
+	void Flush();
+
+private:
+	struct Connection;
+	Connection * Find(Socket * socket) const;
+	/// Receives until the socket has no more data or the receive limit is reached.
+	void Receive(Connection * connection);
+	/// Sends queued data until done or the socket would block.
+	void Send(Connection * connection);
+	/// Flags the socket for deletion, and stops listening for its events.
+	void Close(Connection * connection);
+
+	std::unordered_map<Socket*, Connection*> connections;
+	/// Connections which may have more to receive, e.g. just added or resumed after being throttled.
+	List<Connection*> pendingReads;
+	/** Connections which reached the receive limit, and may have more waiting in the socket. They are not read from or waited on
+		until enough of their received data has been read, and then move to pendingReads.
+	*/
+	List<Connection*> throttledReads;
+	/// Connections with queued data to send.
+	List<Connection*> pendingWrites;
+	List<Socket*> readable;
+#ifdef LINUX
+	int epollFd;
+#endif
+};
+
+#endif
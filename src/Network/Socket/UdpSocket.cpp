@@ -4,6 +4,7 @@
 
 #include "Network/NetworkIncludes.h"
 #include "UdpSocket.h"
+#include <cerrno>
 
 UdpSocket::UdpSocket()
 : Socket(SocketType::UDP)
@@ -82,19 +83,47 @@ int UdpSocket::WriteTo(String ip, String port, const char * fromBuffer, int maxB
 	return bytesWritten;
 }
 
+/** Writes a datagram to an already resolved address, e.g. one filled in by ReadFrom, without looking it up each time.
+	Returns bytes written, 0 if the socket's send buffer is full, or -1 if it failed.
+*/
+int UdpSocket::WriteTo(const sockaddr * address, int addressBytes, const char * fromBuffer, int bytesToWrite)
+{
+	int bytesWritten = sendto(sockfd, fromBuffer, bytesToWrite, 0, address, addressBytes);
+	if (bytesWritten == SOCKET_ERROR)
+	{
+#ifdef WINDOWS
+		bool wouldBlock = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		bool wouldBlock = errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+		return wouldBlock ? 0 : -1;
+	}
+	this->bytesSent += bytesWritten;
+	return bytesWritten;
+}
+
 /// Reads bytes from the socket. If the socket has closed -1 will be returned.
 int UdpSocket::ReadFrom(sockaddr * address, char * intoBuffer, int maxBytesToRead)
 {
-	timeval t = {0, 1000};
-	if (!ReadyToRead(sockfd))
+	/// Once bound the socket is non-blocking, so there is no need to select before each read.
+	if (!nonBlocking && !ReadyToRead(sockfd))
         return 0;
 	int size = sizeof(sockaddr);
 	int flags = 0;
 	int bytesRead = recvfrom(sockfd, intoBuffer, maxBytesToRead, flags, address, (socklen_t*) &size);
 	if (bytesRead == SOCKET_ERROR){
 		int error = WSAGetLastError();
+#ifdef WINDOWS
+		/// Nothing to read, or an earlier datagram was not delivered. Neither is a problem for the socket itself.
+		if (error == WSAEWOULDBLOCK || error == WSAECONNRESET)
+			return 0;
+#else
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED)
+			return 0;
+#endif
 		std::cout<<"\nError reading socket from given address. ErrorCode: "<<error;
 		deleteFlag = 1;
+		return -1;
 	}
 	bytesReceived += bytesRead;
 	return bytesRead;
@@ -103,10 +132,10 @@ int UdpSocket::ReadFrom(sockaddr * address, char * intoBuffer, int maxBytesToRea
 /// Closes the socket.
 void UdpSocket::Close()
 {
-	CloseSocket(sockfd);
+	Socket::Close();
 }
 
-/// Attempts to connect to target host.
+/// Binds the socket to given port, or any free port if 0. The bound port is then stored in port.
 bool UdpSocket::Bind(int port)
 {
     std::cout<<"\nUdpSocket::ConnectTo";
@@ -142,7 +171,9 @@ bool UdpSocket::Bind(int port)
 			break;	// Success!
 		}
 		CloseSocket(sockfd);
+		sockfd = INVALID_SOCKET;
 	}
+	freeaddrinfo(servInfo);
 	/// Error handling
 	if (!boundSuccessfully)
 	{
@@ -157,6 +188,11 @@ bool UdpSocket::Bind(int port)
 //	assert(result == 0);
 	/// Disable blocking
 	SetNonBlocking();
+	/// Find the port actually bound, in case 0 was given to let the system pick one.
+	sockaddr_in boundAddress;
+	socklen_t boundAddressBytes = sizeof(boundAddress);
+	if (getsockname(sockfd, (sockaddr*) &boundAddress, &boundAddressBytes) == 0)
+		this->port = ntohs(boundAddress.sin_port);
 	return true;
 }
 
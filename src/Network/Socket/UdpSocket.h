@@ -24,11 +24,17 @@ public:
 
 	/// Writes bytes from buffer to target address and port. Returns bytes written or -1 if the socket is closed.
 	virtual int WriteTo(String ip, String port, const char * fromBuffer, int maxBytesToWrite);
-	/// Reads bytes from the socket. If the socket has closed -1 will be returned.
+	/** Writes a datagram to an already resolved address, e.g. one filled in by ReadFrom, without looking it up each time.
+		Returns bytes written, 0 if the socket's send buffer is full, or -1 if it failed.
+	*/
+	int WriteTo(const sockaddr * address, int addressBytes, const char * fromBuffer, int bytesToWrite);
+	/** Reads a datagram from the socket, and the address it was sent from. Returns 0 if none is waiting.
+		If the socket has closed -1 will be returned.
+	*/
 	virtual int ReadFrom(sockaddr * address, char * intoBuffer, int maxBytesToRead);
 	/// Closes the socket.
 	virtual void Close();
-	/// Attempts to connect to target host.
+	/// Binds the socket to given port, or any free port if 0. The bound port is then stored in port.
 	virtual bool Bind(int port);
 private:
 
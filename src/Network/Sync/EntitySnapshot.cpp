@@ -0,0 +1,215 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Quantized entity states and snapshots of them, as replicated from host to clients.
+
+#include "EntitySnapshot.h"
+#include "DataStream/BitStream.h"
+#include "Entity/Entity.h"
+#include "Physics/PhysicsProperty.h"
+#include <cmath>
+
+static const float TWO_PI = 6.28318531f;
+
+static int Quantize(float value, float steps)
+{
+	return (int) floor(value * steps + 0.5f);
+}
+
+/// Wraps angles to [0, SNAPSHOT_ROTATION_STEPS[.
+static int QuantizeAngle(float radians)
+{
+	return Quantize(radians / TWO_PI, SNAPSHOT_ROTATION_STEPS) & (SNAPSHOT_ROTATION_STEPS - 1);
+}
+
+EntityState::EntityState()
+{
+	id = 0;
+	for (int i = 0; i < 3; ++i)
+		position[i] = rotation[i] = velocity[i] = 0;
+}
+
+/// Quantizes the world position, rotation and velocity of the entity.
+EntityState::EntityState(Entity * entity)
+{
+	Set(entity->id, entity->worldPosition, entity->rotation, entity->Velocity());
+}
+
+/// Quantizes given values. Rotation is in radians, as Entity::rotation.
+void EntityState::Set(int id, const Vector3f & position, const Vector3f & rotation, const Vector3f & velocity)
+{
+	this->id = id;
+	for (int i = 0; i < 3; ++i)
+	{
+		this->position[i] = Quantize(position[i], SNAPSHOT_POSITION_STEPS);
+		this->rotation[i] = QuantizeAngle(rotation[i]);
+		this->velocity[i] = Quantize(velocity[i], SNAPSHOT_VELOCITY_STEPS);
+	}
+}
+
+Vector3f EntityState::Position() const
+{
+	return Vector3f((float) position[0], (float) position[1], (float) position[2]) / (float) SNAPSHOT_POSITION_STEPS;
+}
+
+Vector3f EntityState::Rotation() const
+{
+	return Vector3f((float) rotation[0], (float) rotation[1], (float) rotation[2]) * (TWO_PI / SNAPSHOT_ROTATION_STEPS);
+}
+
+Vector3f EntityState::Velocity() const
+{
+	return Vector3f((float) velocity[0], (float) velocity[1], (float) velocity[2]) / (float) SNAPSHOT_VELOCITY_STEPS;
+}
+
+/// Sets position, rotation, and velocity if it has physics, of the entity.
+void EntityState::ApplyTo(Entity * entity) const
+{
+	entity->rotation = Rotation();
+	if (entity->physics)
+		entity->physics->velocity = Velocity();
+	/// Recalculates the matrix too.
+	entity->SetPosition(Position());
+}
+
+/// Returns which fields differ from the other state.
+int EntityState::ChangedFields(const EntityState & other) const
+{
+	int fields = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (position[i] != other.position[i])
+			fields |= POSITION;
+		if (rotation[i] != other.rotation[i])
+			fields |= ROTATION;
+		if (velocity[i] != other.velocity[i])
+			fields |= VELOCITY;
+	}
+	return fields;
+}
+
+/** Writes a mask of the fields which differ from the baseline, followed by the difference of each.
+	Unchanged fields take no space, and small changes (e.g. movement since the last acknowledged snapshot) only a few bits.
+*/
+void EntityState::Write(BitWriter & writer, const EntityState & baseline) const
+{
+	int fields = ChangedFields(baseline);
+	writer.Write(fields, 3);
+	for (int i = 0; i < 3 && (fields & POSITION); ++i)
+		/// Differences wrap around as unsigned, so that they can not overflow.
+		WriteDelta(writer, (int) ((uint32) position[i] - (uint32) baseline.position[i]));
+	for (int i = 0; i < 3 && (fields & ROTATION); ++i)
+	{
+		/// Take the shorter way around.
+		int delta = (rotation[i] - baseline.rotation[i]) & (SNAPSHOT_ROTATION_STEPS - 1);
+		if (delta >= SNAPSHOT_ROTATION_STEPS / 2)
+			delta -= SNAPSHOT_ROTATION_STEPS;
+		WriteDelta(writer, delta);
+	}
+	for (int i = 0; i < 3 && (fields & VELOCITY); ++i)
+		WriteDelta(writer, (int) ((uint32) velocity[i] - (uint32) baseline.velocity[i]));
+}
+
+/// Reads fields written by Write, using the same baseline. The id is not read. Returns false if the data ended prematurely.
+bool EntityState::Read(BitReader & reader, const EntityState & baseline)
+{
+	int fields = reader.Read(3);
+	for (int i = 0; i < 3; ++i)
+	{
+		position[i] = baseline.position[i];
+		rotation[i] = baseline.rotation[i];
+		velocity[i] = baseline.velocity[i];
+	}
+	for (int i = 0; i < 3 && (fields & POSITION); ++i)
+		position[i] = (int) ((uint32) position[i] + (uint32) ReadDelta(reader));
+	for (int i = 0; i < 3 && (fields & ROTATION); ++i)
+		rotation[i] = (rotation[i] + ReadDelta(reader)) & (SNAPSHOT_ROTATION_STEPS - 1);
+	for (int i = 0; i < 3 && (fields & VELOCITY); ++i)
+		velocity[i] = (int) ((uint32) velocity[i] + (uint32) ReadDelta(reader));
+	return !reader.Overflowed();
+}
+
+/// Writes a difference using 2 bits for its size, followed by 0, 6, 12 or 32 bits.
+void EntityState::WriteDelta(BitWriter & writer, int delta)
+{
+	/// Zig-zag encode, so that small negative values are small too.
+	uint32 value = ((uint32) delta << 1) ^ (uint32) (delta >> 31);
+	if (value == 0)
+		writer.Write(0, 2);
+	else if (value < (1 << 6))
+	{
+		writer.Write(1, 2);
+		writer.Write(value, 6);
+	}
+	else if (value < (1 << 12))
+	{
+		writer.Write(2, 2);
+		writer.Write(value, 12);
+	}
+	else
+	{
+		writer.Write(3, 2);
+		writer.Write(value, 32);
+	}
+}
+
+int EntityState::ReadDelta(BitReader & reader)
+{
+	static const int sizes[4] = {0, 6, 12, 32};
+	uint32 value = reader.Read(sizes[reader.Read(2)]);
+	return (int) (value >> 1) ^ -(int) (value & 1);
+}
+
+EntitySnapshot::EntitySnapshot(int tick)
+: tick(tick)
+{
+}
+
+/// Returns the state of entity with given id, or NULL if not included.
+const EntityState * EntitySnapshot::Get(int id) const
+{
+	int index = LowerBound(id);
+	if (index < states.Size() && states[index].id == id)
+		return &states[index];
+	return NULL;
+}
+
+/// Adds the state, or replaces the previous state of the same entity.
+void EntitySnapshot::Set(const EntityState & state)
+{
+	int index = LowerBound(state.id);
+	if (index < states.Size() && states[index].id == state.id)
+		states[index] = state;
+	else
+		states.Insert(state, index);
+}
+
+/// Returns false if not included.
+bool EntitySnapshot::Remove(int id)
+{
+	int index = LowerBound(id);
+	if (index >= states.Size() || states[index].id != id)
+		return false;
+	states.RemoveIndex(index, ListOption::RETAIN_ORDER);
+	return true;
+}
+
+void EntitySnapshot::Clear()
+{
+	tick = 0;
+	states.Clear();
+}
+
+/// Index of the state with given id, or of the first with a larger id if not included.
+int EntitySnapshot::LowerBound(int id) const
+{
+	int low = 0, high = states.Size();
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (states[middle].id < id)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
@@ -0,0 +1,86 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Quantized entity states and snapshots of them, as replicated from host to clients.
+
+#ifndef ENTITY_SNAPSHOT_H
+#define ENTITY_SNAPSHOT_H
+
+#include "MathLib/Vector3f.h"
+#include "List/List.h"
+
+class Entity;
+class BitWriter;
+class BitReader;
+
+/// Steps per unit when quantizing positions and velocities, i.e. positions are replicated with a precision of 1/64 units.
+#define SNAPSHOT_POSITION_STEPS	64
+#define SNAPSHOT_VELOCITY_STEPS	64
+/// Steps per full turn when quantizing rotations.
+#define SNAPSHOT_ROTATION_STEPS	65536
+
+/** Position, rotation and velocity of an entity, quantized to integers so that they can be compared exactly
+	and written as small deltas against an earlier state.
+*/
+class EntityState
+{
+public:
+	EntityState();
+	/// Quantizes the world position, rotation and velocity of the entity.
+	EntityState(Entity * entity);
+	/// Quantizes given values. Rotation is in radians, as Entity::rotation.
+	void Set(int id, const Vector3f & position, const Vector3f & rotation, const Vector3f & velocity);
+
+	Vector3f Position() const;
+	Vector3f Rotation() const;
+	Vector3f Velocity() const;
+	/// Sets position, rotation, and velocity if it has physics, of the entity.
+	void ApplyTo(Entity * entity) const;
+
+	enum fields {
+		POSITION = 1,
+		ROTATION = 2,
+		VELOCITY = 4,
+		ALL_FIELDS = POSITION | ROTATION | VELOCITY,
+	};
+	/// Returns which fields differ from the other state.
+	int ChangedFields(const EntityState & other) const;
+	/** Writes a mask of the fields which differ from the baseline, followed by the difference of each.
+		Unchanged fields take no space, and small changes (e.g. movement since the last acknowledged snapshot) only a few bits.
+	*/
+	void Write(BitWriter & writer, const EntityState & baseline) const;
+	/// Reads fields written by Write, using the same baseline. The id is not read. Returns false if the data ended prematurely.
+	bool Read(BitReader & reader, const EntityState & baseline);
+
+	int id;
+	int position[3];
+	/// In the range [0, SNAPSHOT_ROTATION_STEPS[.
+	int rotation[3];
+	int velocity[3];
+private:
+	/// Writes a difference using 2 bits for its size, followed by 0, 6, 12 or 32 bits.
+	static void WriteDelta(BitWriter & writer, int delta);
+	static int ReadDelta(BitReader & reader);
+};
+
+/// States of all entities known at a given tick, sorted by id.
+class EntitySnapshot
+{
+public:
+	EntitySnapshot(int tick = 0);
+	/// Returns the state of entity with given id, or NULL if not included.
+	const EntityState * Get(int id) const;
+	/// Adds the state, or replaces the previous state of the same entity.
+	void Set(const EntityState & state);
+	/// Returns false if not included.
+	bool Remove(int id);
+	void Clear();
+
+	/// Number of the tick it was captured, starting at 1. 0 for the empty snapshot, which everything is sent relative to initially.
+	int tick;
+	List<EntityState> states;
+private:
+	/// Index of the state with given id, or of the first with a larger id if not included.
+	int LowerBound(int id) const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Loopback test of entity replication, measuring bandwidth per entity and tick.
+
+#include "SnapshotBenchmark.h"
+#include "SnapshotReplicator.h"
+#include "SnapshotReceiver.h"
+#include "SyncSessionData.h"
+#include "DataStream/BitStream.h"
+#include "Network/Packet/SyncPacket.h"
+#include "Random/Random.h"
+#include <sstream>
+#include <cmath>
+#include <iostream>
+
+/// Entity as simulated on the host, without requiring the full Entity.
+struct BenchmarkEntity
+{
+	int id;
+	Vector3f position, rotation, velocity, angularVelocity;
+};
+
+/// Returns true if all states of the snapshots are identical.
+static bool SameStates(const EntitySnapshot & one, const EntitySnapshot & two)
+{
+	if (one.states.Size() != two.states.Size())
+		return false;
+	for (int i = 0; i < one.states.Size(); ++i)
+	{
+		const EntityState & a = one.states[i], & b = two.states[i];
+		if (a.id != b.id || a.ChangedFields(b) != 0)
+			return false;
+	}
+	return true;
+}
+
+/// Passes packet data through the loopback, unless lost. Returns the parsed kind, or INVALID if lost.
+static int Transmit(SyncPacket & packet, Random & random, float packetLoss, const uchar *& snapshotData, int & snapshotBytes, int & acknowledgedTick)
+{
+	if (random.Randf() < packetLoss)
+		return SyncPacket::INVALID;
+	return SyncPacket::Parse(packet.data.GetData(), packet.data.Bytes(), snapshotData, snapshotBytes, acknowledgedTick);
+}
+
+/** Simulates numEntities, a third of them moving, replicated over a lossy loopback for given ticks.
+	Prints bytes per entity per tick, compared to writing full text state as SyncPacket used to. Returns false if any snapshot exceeded bytesPerSnapshot, 
+	or if the client state ever deviates from the host's by more than the quantization, once all entities have arrived. Not run by UnitTests, see Benchmarks.
+*/
+bool BenchmarkSnapshots(int numEntities /*= 300*/, int ticks /*= 600*/, int bytesPerSnapshot /*= 1200*/, float packetLoss /*= 0.1f*/)
+{
+	Random random;
+	random.Init(2016);
+	List<BenchmarkEntity> entities;
+	for (int i = 0; i < numEntities; ++i)
+	{
+		BenchmarkEntity entity;
+		entity.id = i + 1;
+		entity.position = Vector3f(random.Randf(200.f) - 100.f, random.Randf(10.f), random.Randf(200.f) - 100.f);
+		entity.rotation = Vector3f(0, random.Randf(6.f), 0);
+		if (i % 3 == 0)
+		{
+			entity.velocity = Vector3f(random.Randf(10.f) - 5.f, 0, random.Randf(10.f) - 5.f);
+			entity.angularVelocity = Vector3f(0, random.Randf(2.f) - 1.f, 0);
+		}
+		entities.AddItem(entity);
+	}
+
+	SnapshotReplicator replicator;
+	SyncSessionData peerData;
+	peerData.bytesPerSnapshot = bytesPerSnapshot;
+	SnapshotReceiver receiver;
+	const float timeStep = 1 / 60.f;
+	int64 snapshotBytes = 0, textBytes = 0;
+	int mismatches = 0, overBudget = 0, largestSnapshot = 0;
+
+	/// Simulate, then let all entities come to rest and check that the client converges to the same state.
+	int restTicks = 120;
+	for (int tick = 0; tick < ticks + restTicks; ++tick)
+	{
+		bool resting = tick >= ticks;
+		replicator.BeginTick();
+		for (int i = 0; i < entities.Size(); ++i)
+		{
+			BenchmarkEntity & entity = entities[i];
+			if (resting)
+				entity.velocity = entity.angularVelocity = Vector3f();
+			entity.position += entity.velocity * timeStep;
+			entity.rotation += entity.angularVelocity * timeStep;
+			EntityState state;
+			state.Set(entity.id, entity.position, entity.rotation, entity.velocity);
+			replicator.SetState(state);
+		}
+
+		BitWriter writer;
+		replicator.Write(&peerData, writer);
+		if (writer.Bytes() > bytesPerSnapshot)
+			++overBudget;
+		if (writer.Bytes() > largestSnapshot)
+			largestSnapshot = writer.Bytes();
+		SyncPacket snapshot(writer);
+		if (!resting)
+		{
+			snapshotBytes += snapshot.size;
+			/// As the old SyncPacket would have written it, with positions only.
+			std::stringstream ss;
+			ss << "position\n";
+			for (int i = 0; i < entities.Size(); ++i)
+				ss << entities[i].position;
+			textBytes += ss.str().length();
+		}
+
+		const uchar * data = NULL;
+		int bytes = 0, acknowledgedTick = 0;
+		float loss = resting ? 0 : packetLoss;
+		if (Transmit(snapshot, random, loss, data, bytes, acknowledgedTick) != SyncPacket::SNAPSHOT)
+			continue;
+		if (!receiver.Read(data, bytes))
+			continue;
+		/// The client must know exactly what the host thinks it will know.
+		if (!SameStates(receiver.Latest(), peerData.sent[peerData.sent.Size() - 1]))
+			++mismatches;
+
+		SyncPacket acknowledgement(receiver.LastTick());
+		if (Transmit(acknowledgement, random, loss, data, bytes, acknowledgedTick) == SyncPacket::ACKNOWLEDGEMENT)
+			replicator.Acknowledge(&peerData, acknowledgedTick);
+	}
+
+	/// Rounding to the nearest step, but allow for float error in the simulation.
+	const float tolerance = 0.5f / SNAPSHOT_POSITION_STEPS + 0.001f;
+	const EntitySnapshot & latest = receiver.Latest();
+	for (int i = 0; i < entities.Size(); ++i)
+	{
+		const EntityState * state = latest.Get(entities[i].id);
+		Vector3f error = state ? state->Position() - entities[i].position : Vector3f(1, 1, 1);
+		if (fabs(error.x) > tolerance || fabs(error.y) > tolerance || fabs(error.z) > tolerance)
+			++mismatches;
+	}
+
+	float entityTicks = (float) numEntities * ticks;
+	std::cout<<"\nBenchmarkSnapshots: "<<numEntities<<" entities x"<<ticks<<" ticks, "<<packetLoss * 100<<"% loss: "
+		<<snapshotBytes / entityTicks<<" bytes per entity and tick, text "<<textBytes / entityTicks
+		<<"\n Largest snapshot "<<largestSnapshot<<" of "<<bytesPerSnapshot<<" bytes allowed";
+	if (mismatches)
+		std::cout<<"\nBenchmarkSnapshots: "<<mismatches<<" mismatches.";
+	if (overBudget)
+		std::cout<<"\nBenchmarkSnapshots: "<<overBudget<<" snapshots over budget.";
+	return mismatches == 0 && overBudget == 0;
+}
@@ -0,0 +1,14 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Loopback test of entity replication, measuring bandwidth per entity and tick.
+
+#ifndef SNAPSHOT_BENCHMARK_H
+#define SNAPSHOT_BENCHMARK_H
+
+/** Simulates numEntities, a third of them moving, replicated over a lossy loopback for given ticks.
+	Prints bytes per entity per tick, compared to writing full text state as SyncPacket used to. Returns false if any snapshot exceeded bytesPerSnapshot, 
+	or if the client state ever deviates from the host's by more than the quantization, once all entities have arrived. Not run by UnitTests, see Benchmarks.
+*/
+bool BenchmarkSnapshots(int numEntities = 300, int ticks = 600, int bytesPerSnapshot = 1200, float packetLoss = 0.1f);
+
+#endif
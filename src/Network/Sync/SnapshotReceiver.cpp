@@ -0,0 +1,93 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Client side of entity replication: reconstructs snapshots from deltas written by a SnapshotReplicator.
+
+#include "SnapshotReceiver.h"
+#include "DataStream/BitStream.h"
+#include "Entity/Entity.h"
+
+SnapshotReceiver::SnapshotReceiver()
+{
+}
+
+/** Reconstructs a snapshot. Returns false if it could not be used: older than the latest one,
+	relative to a snapshot no longer known, or malformed.
+*/
+bool SnapshotReceiver::Read(const uchar * data, int bytes)
+{
+	BitReader reader(data, bytes);
+	int tick = reader.Read(32);
+	int ticksSinceBaseline = reader.ReadVariable();
+	if (reader.Overflowed() || tick <= LastTick())
+		return false;
+
+	int baselineIndex = -1;
+	if (ticksSinceBaseline > 0)
+	{
+		for (int i = 0; i < received.Size(); ++i)
+			if (received[i].tick == tick - ticksSinceBaseline)
+				baselineIndex = i;
+		if (baselineIndex < 0)
+			return false;
+	}
+	const EntitySnapshot & baseline = baselineIndex >= 0 ? received[baselineIndex] : empty;
+
+	EntitySnapshot view = baseline;
+	view.tick = tick;
+	while (reader.ReadBool())
+		view.Remove(reader.ReadVariable());
+	EntityState state;
+	EntityState none;
+	while (reader.ReadBool())
+	{
+		int id = reader.ReadVariable();
+		const EntityState * base = baseline.Get(id);
+		state.Read(reader, base ? *base : none);
+		state.id = id;
+		view.Set(state);
+	}
+	if (reader.Overflowed())
+		return false;
+
+	/// The host will not use anything older than the baseline again, having had it acknowledged.
+	List<EntitySnapshot> kept;
+	for (int i = baselineIndex < 0 ? 0 : baselineIndex; i < received.Size(); ++i)
+		kept.Add(std::move(received[i]));
+	kept.Add(std::move(view));
+	if (kept.Size() > MAX_RECEIVED_SNAPSHOTS)
+		kept.RemoveIndex(0, ListOption::RETAIN_ORDER);
+	received = std::move(kept);
+	return true;
+}
+
+/// The latest reconstructed snapshot. Empty until one has been read.
+const EntitySnapshot & SnapshotReceiver::Latest() const
+{
+	if (received.Size())
+		return received[received.Size() - 1];
+	return empty;
+}
+
+/// Tick of the latest reconstructed snapshot, 0 if none.
+int SnapshotReceiver::LastTick() const
+{
+	return Latest().tick;
+}
+
+/// Sets the latest state of each given entity, by id. Entities not in the snapshot are left as they are.
+void SnapshotReceiver::ApplyTo(List<Entity*> & entities) const
+{
+	const EntitySnapshot & latest = Latest();
+	for (int i = 0; i < entities.Size(); ++i)
+	{
+		const EntityState * state = latest.Get(entities[i]->id);
+		if (state)
+			state->ApplyTo(entities[i]);
+	}
+}
+
+/// Forgets all snapshots, e.g. when disconnecting.
+void SnapshotReceiver::Clear()
+{
+	received.Clear();
+}
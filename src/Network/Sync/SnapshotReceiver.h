@@ -0,0 +1,40 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Client side of entity replication: reconstructs snapshots from deltas written by a SnapshotReplicator.
+
+#ifndef SNAPSHOT_RECEIVER_H
+#define SNAPSHOT_RECEIVER_H
+
+#include "EntitySnapshot.h"
+
+/// Reconstructed snapshots to keep as possible baselines. Should match MAX_UNACKNOWLEDGED_SNAPSHOTS on the host.
+#define MAX_RECEIVED_SNAPSHOTS	32
+
+/** Read each received snapshot, then acknowledge LastTick() to the host (e.g. with a SyncPacket) so that it may
+	send later snapshots relative to it.
+*/
+class SnapshotReceiver
+{
+public:
+	SnapshotReceiver();
+	/** Reconstructs a snapshot. Returns false if it could not be used: older than the latest one,
+		relative to a snapshot no longer known, or malformed.
+	*/
+	bool Read(const uchar * data, int bytes);
+	/// The latest reconstructed snapshot. Empty until one has been read.
+	const EntitySnapshot & Latest() const;
+	/// Tick of the latest reconstructed snapshot, 0 if none.
+	int LastTick() const;
+	/// Sets the latest state of each given entity, by id. Entities not in the snapshot are left as they are.
+	void ApplyTo(List<Entity*> & entities) const;
+	/// Forgets all snapshots, e.g. when disconnecting.
+	void Clear();
+	/// Round trips states through deltas and replicates entities over a lossy loopback, asserting on the results. See SnapshotTests.cpp
+	static void UnitTest();
+private:
+	/// Ordered by tick.
+	List<EntitySnapshot> received;
+	EntitySnapshot empty;
+};
+
+#endif
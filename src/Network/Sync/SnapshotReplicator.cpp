@@ -0,0 +1,201 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Host side of entity replication: captures a snapshot each tick and writes it to each peer as a delta against what it has acknowledged.
+
+#include "SnapshotReplicator.h"
+#include "SyncSessionData.h"
+#include "DataStream/BitStream.h"
+#include "Network/Packet/SyncPacket.h"
+#include "Network/Peer.h"
+#include "Network/Udp/UdpConnection.h"
+#include "Entity/Entity.h"
+#include <algorithm>
+
+/// Entity which differs from what a peer has acknowledged.
+struct SyncCandidate
+{
+	const EntityState * state;
+	float priority;
+};
+
+/// Highest priority first. Ties by id, so the order is the same each tick.
+static bool HigherPriority(const SyncCandidate & one, const SyncCandidate & two)
+{
+	if (one.priority != two.priority)
+		return one.priority > two.priority;
+	return one.state->id < two.state->id;
+}
+
+SnapshotReplicator::SnapshotReplicator()
+{
+}
+
+/// Starts a new tick, with no entities in the current snapshot.
+void SnapshotReplicator::BeginTick()
+{
+	++current.tick;
+	current.states.Clear();
+}
+
+/// Adds or replaces an entity's state in the current snapshot.
+void SnapshotReplicator::SetState(const EntityState & state)
+{
+	current.Set(state);
+}
+
+/// Begins a new tick with the current states of given entities.
+void SnapshotReplicator::Capture(List<Entity*> & entities)
+{
+	BeginTick();
+	current.states.Reserve(entities.Size());
+	for (int i = 0; i < entities.Size(); ++i)
+		current.Set(EntityState(entities[i]));
+}
+
+/** Writes the current snapshot for the peer, relative to the last snapshot it acknowledged.
+	Format: tick (32 bits), ticks since the baseline (variable, 0 for none), then ids of removed entities and
+	ids with state deltas of updated entities, each list preceded by a 1-bit for each item and ended by a 0-bit.
+*/
+void SnapshotReplicator::Write(SyncSessionData * peerData, BitWriter & writer)
+{
+	const EntitySnapshot & baseline = peerData->acknowledged;
+	writer.Write(current.tick, 32);
+	writer.WriteVariable(baseline.tick > 0 ? current.tick - baseline.tick : 0);
+	/// What the peer will know if it receives this snapshot.
+	EntitySnapshot view = baseline;
+	view.tick = current.tick;
+
+	/// Entities which no longer exist, or are no longer relevant to the peer.
+	for (int i = 0; i < baseline.states.Size(); ++i)
+	{
+		int id = baseline.states[i].id;
+		const EntityState * state = current.Get(id);
+		if (state && Relevance(peerData, *state) > 0)
+			continue;
+		writer.WriteBool(true);
+		writer.WriteVariable(id);
+		view.Remove(id);
+	}
+	writer.WriteBool(false);
+
+	/// Entities which changed, prioritized by how long they have waited and how relevant they are.
+	List<SyncCandidate> candidates;
+	candidates.Reserve(current.states.Size());
+	for (int i = 0; i < current.states.Size(); ++i)
+	{
+		const EntityState & state = current.states[i];
+		const EntityState * base = baseline.Get(state.id);
+		float relevance = Relevance(peerData, state);
+		if (relevance <= 0 || (base && state.ChangedFields(*base) == 0))
+		{
+			peerData->priorities.erase(state.id);
+			continue;
+		}
+		SyncCandidate candidate;
+		candidate.state = &state;
+		candidate.priority = peerData->priorities[state.id] += relevance;
+		candidates.AddItem(candidate);
+	}
+	std::sort(candidates.GetArray(), candidates.GetArray() + candidates.Size(), HigherPriority);
+
+	int bitBudget = peerData->bytesPerSnapshot * 8;
+	bool anySent = false;
+	EntityState empty;
+	BitWriter entityData;
+	for (int i = 0; i < candidates.Size(); ++i)
+	{
+		const EntityState & state = *candidates[i].state;
+		const EntityState * base = baseline.Get(state.id);
+		entityData.Clear();
+		entityData.WriteBool(true);
+		entityData.WriteVariable(state.id);
+		state.Write(entityData, base ? *base : empty);
+		/// Leave space for the ending bit. Smaller deltas further down may still fit.
+		if (anySent && writer.Bits() + entityData.Bits() + 1 > bitBudget)
+			continue;
+		writer.Write(entityData);
+		view.Set(state);
+		peerData->priorities.erase(state.id);
+		anySent = true;
+	}
+	writer.WriteBool(false);
+
+	/// Forget priorities of entities no longer present.
+	for (std::unordered_map<int, float>::iterator it = peerData->priorities.begin(); it != peerData->priorities.end(); )
+	{
+		if (current.Get(it->first))
+			++it;
+		else
+			it = peerData->priorities.erase(it);
+	}
+
+	peerData->sent.Add(std::move(view));
+	if (peerData->sent.Size() > MAX_UNACKNOWLEDGED_SNAPSHOTS)
+		peerData->sent.RemoveIndex(0, ListOption::RETAIN_ORDER);
+}
+
+/// Writes and sends the current snapshot to the peer in a SyncPacket. Returns false if it failed to send.
+bool SnapshotReplicator::Send(Peer * peer)
+{
+	BitWriter writer;
+	Write(PeerData(peer), writer);
+	SyncPacket packet(writer);
+	return packet.Send(peer);
+}
+
+/** Writes and sends the current snapshot to the connection's peer as an unreliable sequenced packet, so that a lost one delays nothing.
+	Returns false if the connection has no peer, or the snapshot does not fit a datagram, see the peer's bytesPerSnapshot.
+*/
+bool SnapshotReplicator::Send(UdpConnection * connection)
+{
+	if (!connection->peer)
+		return false;
+	BitWriter writer;
+	Write(PeerData(connection->peer), writer);
+	SyncPacket packet(writer);
+	return connection->Send(packet, UdpDelivery::UNRELIABLE_SEQUENCED);
+}
+
+/// To be called when the peer acknowledges a snapshot. Returns false if it was unknown or older than the last acknowledged one.
+bool SnapshotReplicator::Acknowledge(SyncSessionData * peerData, int tick)
+{
+	if (tick <= peerData->acknowledged.tick)
+		return false;
+	List<EntitySnapshot> & sent = peerData->sent;
+	for (int i = 0; i < sent.Size(); ++i)
+	{
+		if (sent[i].tick != tick)
+			continue;
+		peerData->acknowledged = std::move(sent[i]);
+		/// Earlier ones can no longer be used as baselines, since the peer may have dropped them.
+		List<EntitySnapshot> later;
+		for (int j = i + 1; j < sent.Size(); ++j)
+			later.Add(std::move(sent[j]));
+		sent = std::move(later);
+		return true;
+	}
+	return false;
+}
+
+/// Returns the replication data of the peer, creating and attaching it if needed.
+SyncSessionData * SnapshotReplicator::PeerData(Peer * peer)
+{
+	SyncSessionData * data = peer->GetSessionData<SyncSessionData>();
+	if (!data)
+	{
+		data = new SyncSessionData();
+		peer->sessionData.Add(data);
+	}
+	return data;
+}
+
+/// 1 for entities within relevanceDistance of the peer's view, decreasing beyond, and 0 if beyond its cullDistance.
+float SnapshotReplicator::Relevance(SyncSessionData * peerData, const EntityState & state)
+{
+	float distance = (state.Position() - peerData->viewPosition).Length();
+	if (peerData->cullDistance > 0 && distance > peerData->cullDistance)
+		return 0;
+	if (distance <= peerData->relevanceDistance)
+		return 1.f;
+	return peerData->relevanceDistance / distance;
+}
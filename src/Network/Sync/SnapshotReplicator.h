@@ -0,0 +1,52 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Host side of entity replication: captures a snapshot each tick and writes it to each peer as a delta against what it has acknowledged.
+
+#ifndef SNAPSHOT_REPLICATOR_H
+#define SNAPSHOT_REPLICATOR_H
+
+#include "EntitySnapshot.h"
+
+class Peer;
+class SyncSessionData;
+class UdpConnection;
+
+/** Each tick, capture the synchronized entities, then call Send (or Write) for each peer.
+	A peer is sent the entities which differ from what it has acknowledged, most relevant first, until its bytesPerSnapshot are used up.
+	Entities left out gain priority, so that they are sent in later ticks. Since deltas are always against acknowledged state,
+	lost packets need no re-sending: later snapshots contain anything still unacknowledged.
+*/
+class SnapshotReplicator
+{
+public:
+	SnapshotReplicator();
+
+	/// Starts a new tick, with no entities in the current snapshot.
+	void BeginTick();
+	/// Adds or replaces an entity's state in the current snapshot.
+	void SetState(const EntityState & state);
+	/// Begins a new tick with the current states of given entities.
+	void Capture(List<Entity*> & entities);
+
+	/// Writes the current snapshot for the peer, relative to the last snapshot it acknowledged.
+	void Write(SyncSessionData * peerData, BitWriter & writer);
+	/// Writes and sends the current snapshot to the peer in a SyncPacket. Returns false if it failed to send.
+	bool Send(Peer * peer);
+	/** Writes and sends the current snapshot to the connection's peer as an unreliable sequenced packet, so that a lost one delays nothing.
+		Returns false if the connection has no peer, or the snapshot does not fit a datagram, see the peer's bytesPerSnapshot.
+	*/
+	bool Send(UdpConnection * connection);
+	/// To be called when the peer acknowledges a snapshot. Returns false if it was unknown or older than the last acknowledged one.
+	bool Acknowledge(SyncSessionData * peerData, int tick);
+
+	/// Returns the replication data of the peer, creating and attaching it if needed.
+	static SyncSessionData * PeerData(Peer * peer);
+
+	/// States captured this tick.
+	EntitySnapshot current;
+private:
+	/// 1 for entities within relevanceDistance of the peer's view, decreasing beyond, and 0 if beyond its cullDistance.
+	float Relevance(SyncSessionData * peerData, const EntityState & state);
+};
+
+#endif
@@ -0,0 +1,163 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Tests of entity states written as deltas, and of replication over a lossy loopback.
+
+#include "SnapshotReceiver.h"
+#include "SnapshotReplicator.h"
+#include "SyncSessionData.h"
+#include "DataStream/BitStream.h"
+#include "Network/Packet/SyncPacket.h"
+#include "Random/Random.h"
+#include <cmath>
+
+/// Entity as simulated on the host, without requiring the full Entity.
+struct SimulatedEntity
+{
+	int id;
+	Vector3f position, rotation, velocity;
+};
+
+/// Returns true if all states of the snapshots are identical.
+static bool SameStates(const EntitySnapshot & one, const EntitySnapshot & two)
+{
+	if (one.states.Size() != two.states.Size())
+		return false;
+	for (int i = 0; i < one.states.Size(); ++i)
+	{
+		const EntityState & a = one.states[i], & b = two.states[i];
+		if (a.id != b.id || a.ChangedFields(b) != 0)
+			return false;
+	}
+	return true;
+}
+
+/// Writes the state as a delta against the baseline, reads it back and asserts that it is identical. Returns bits written.
+static int AssertRoundTrip(const EntityState & state, const EntityState & baseline)
+{
+	BitWriter writer;
+	state.Write(writer, baseline);
+	BitReader reader(writer.Data(), writer.Bytes());
+	EntityState decoded;
+	decoded.id = state.id;
+	bool read = decoded.Read(reader, baseline);
+	assert(read && decoded.ChangedFields(state) == 0);
+	(void) read;
+	return writer.Bits();
+}
+
+/// Passes packet data through the loopback, unless lost. Returns the parsed kind, or INVALID if lost.
+static int Transmit(SyncPacket & packet, Random & random, float packetLoss, const uchar *& snapshotData, int & snapshotBytes, int & acknowledgedTick)
+{
+	if (random.Randf() < packetLoss)
+		return SyncPacket::INVALID;
+	return SyncPacket::Parse(packet.data.GetData(), packet.data.Bytes(), snapshotData, snapshotBytes, acknowledgedTick);
+}
+
+/** Round trips of single states against baselines, then entities replicated from a SnapshotReplicator over a lossy loopback,
+	asserting that the client always reconstructs what the host sent and converges to the host's state once entities come to rest.
+*/
+void SnapshotReceiver::UnitTest()
+{
+	EntityState baseline, state;
+	baseline.Set(7, Vector3f(1, 2, 3), Vector3f(0, -0.01f, 0), Vector3f());
+	state = baseline;
+	/// Unchanged states take only the field mask.
+	assert(AssertRoundTrip(state, baseline) == 3);
+	/// Small and large moves, in both directions.
+	state.Set(7, Vector3f(1.5f, 2, 2.75f), baseline.Rotation(), Vector3f());
+	AssertRoundTrip(state, baseline);
+	state.Set(7, Vector3f(-1000, 5000, 3), baseline.Rotation(), Vector3f(-3, 0, 12.5f));
+	AssertRoundTrip(state, baseline);
+	AssertRoundTrip(baseline, state);
+	/// Rotation wrapping around past a full turn is sent the short way around, as one 12-bit delta.
+	state.Set(7, baseline.Position(), Vector3f(0, 0.02f, 0), Vector3f());
+	int wrappedBits = AssertRoundTrip(state, baseline);
+	assert(wrappedBits == 3 + 3 * 2 + 12);
+	/// Against the empty state, as for entities not yet acknowledged.
+	AssertRoundTrip(state, EntityState());
+	/// Truncated data is rejected.
+	state.Set(7, Vector3f(-1000, 5000, 3), Vector3f(1, 2, 3), Vector3f(10, 0, 0));
+	BitWriter writer;
+	state.Write(writer, baseline);
+	BitReader truncated(writer.Data(), writer.Bytes() - 2);
+	EntityState decoded;
+	bool readTruncated = decoded.Read(truncated, baseline);
+	assert(!readTruncated);
+	(void) readTruncated;
+
+	/// Replication of moving entities, with a budget too small to send all of them each tick.
+	Random random;
+	random.Init(2016);
+	List<SimulatedEntity> entities;
+	for (int i = 0; i < 60; ++i)
+	{
+		SimulatedEntity entity;
+		entity.id = i + 1;
+		entity.position = Vector3f(random.Randf(200.f) - 100.f, random.Randf(10.f), random.Randf(200.f) - 100.f);
+		entity.rotation = Vector3f(0, random.Randf(6.f), 0);
+		if (i % 3 == 0)
+			entity.velocity = Vector3f(random.Randf(10.f) - 5.f, 0, random.Randf(10.f) - 5.f);
+		entities.AddItem(entity);
+	}
+	SnapshotReplicator replicator;
+	SyncSessionData peerData;
+	peerData.bytesPerSnapshot = 200;
+	SnapshotReceiver receiver;
+	const float timeStep = 1 / 60.f, packetLoss = 0.2f;
+	/// Move for a while, then let all entities come to rest, without losses, and check that the client converges.
+	const int movingTicks = 120, restTicks = 60;
+	int received = 0;
+	for (int tick = 0; tick < movingTicks + restTicks; ++tick)
+	{
+		bool resting = tick >= movingTicks;
+		replicator.BeginTick();
+		for (int i = 0; i < entities.Size(); ++i)
+		{
+			SimulatedEntity & entity = entities[i];
+			if (resting)
+				entity.velocity = Vector3f();
+			entity.position += entity.velocity * timeStep;
+			EntityState entityState;
+			entityState.Set(entity.id, entity.position, entity.rotation, entity.velocity);
+			replicator.SetState(entityState);
+		}
+		BitWriter snapshotWriter;
+		replicator.Write(&peerData, snapshotWriter);
+		/// No entity alone is near the budget, so every snapshot must stay within it.
+		assert(snapshotWriter.Bytes() <= peerData.bytesPerSnapshot);
+		SyncPacket snapshot(snapshotWriter);
+
+		const uchar * data = NULL;
+		int bytes = 0, acknowledgedTick = 0;
+		float loss = resting ? 0 : packetLoss;
+		if (Transmit(snapshot, random, loss, data, bytes, acknowledgedTick) != SyncPacket::SNAPSHOT)
+			continue;
+		bool read = receiver.Read(data, bytes);
+		assert(read);
+		if (!read)
+			continue;
+		++received;
+		/// The client must know exactly what the host thinks it will know.
+		assert(SameStates(receiver.Latest(), peerData.sent[peerData.sent.Size() - 1]));
+
+		SyncPacket acknowledgement(receiver.LastTick());
+		if (Transmit(acknowledgement, random, loss, data, bytes, acknowledgedTick) == SyncPacket::ACKNOWLEDGEMENT)
+			replicator.Acknowledge(&peerData, acknowledgedTick);
+	}
+	assert(received > restTicks);
+
+	/// Rounding to the nearest step, but allow for float error in the simulation.
+	const float tolerance = 0.5f / SNAPSHOT_POSITION_STEPS + 0.001f;
+	const EntitySnapshot & latest = receiver.Latest();
+	assert(latest.states.Size() == entities.Size());
+	for (int i = 0; i < entities.Size(); ++i)
+	{
+		const EntityState * entityState = latest.Get(entities[i].id);
+		assert(entityState);
+		if (!entityState)
+			continue;
+		Vector3f error = entityState->Position() - entities[i].position;
+		assert(fabs(error.x) <= tolerance && fabs(error.y) <= tolerance && fabs(error.z) <= tolerance);
+		assert(entityState->Velocity().Length() == 0);
+	}
+}
@@ -0,0 +1,29 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Per-peer state of entity replication: what the peer has acknowledged, and what has been sent to it since.
+
+#include "SyncSessionData.h"
+#include "Network/Session/SessionTypes.h"
+
+SyncSessionData::SyncSessionData()
+: SessionData(Type())
+{
+	bytesPerSnapshot = 1200;
+	relevanceDistance = 50.f;
+	cullDistance = 0;
+	Reset();
+}
+
+// ID used for template function identification.
+int SyncSessionData::Type()
+{
+	return SessionType::ENTITY_SYNC;
+}
+
+/// Resets to sending full state, e.g. when the peer (re-)joins.
+void SyncSessionData::Reset()
+{
+	acknowledged.Clear();
+	sent.Clear();
+	priorities.clear();
+}
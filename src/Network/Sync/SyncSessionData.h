@@ -0,0 +1,41 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Per-peer state of entity replication: what the peer has acknowledged, and what has been sent to it since.
+
+#ifndef SYNC_SESSION_DATA_H
+#define SYNC_SESSION_DATA_H
+
+#include "Network/Session/SessionData.h"
+#include "EntitySnapshot.h"
+#include <unordered_map>
+
+/// Max snapshots awaiting acknowledgement per peer. Older ones are dropped, and their contents re-sent.
+#define MAX_UNACKNOWLEDGED_SNAPSHOTS	32
+
+class SyncSessionData : public SessionData {
+public:
+	SyncSessionData();
+	// ID used for template function identification.
+	static int Type();
+
+	/// Resets to sending full state, e.g. when the peer (re-)joins.
+	void Reset();
+
+	/// Max bytes of entity data per snapshot sent to this peer. At least one entity is always sent.
+	int bytesPerSnapshot;
+	/// Where the peer is looking from, e.g. its camera or player entity. Entities nearer it are prioritized.
+	Vector3f viewPosition;
+	/// Entities within this distance of the view have full priority, further ones decreasing with the distance.
+	float relevanceDistance;
+	/// Entities beyond this distance are not sent, and removed from the peer. 0 to never cull.
+	float cullDistance;
+
+	/// What the peer has confirmed to know. Deltas are written against this.
+	EntitySnapshot acknowledged;
+	/// What the peer would know after receiving each snapshot sent since, ordered by tick.
+	List<EntitySnapshot> sent;
+	/// Accumulated priority of entities which changed but were not sent yet, by entity id.
+	std::unordered_map<int, float> priorities;
+};
+
+#endif
@@ -0,0 +1,567 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// One remote end of a UdpTransport: acknowledges datagrams, estimates round-trip time, limits the send rate and delivers packets per channel.
+
+#include "UdpConnection.h"
+#include "Network/Packet/Packet.h"
+#include "Network/Packet/PacketPool.h"
+#include <cstring>
+
+/// Datagram header flags.
+#define UDP_FLAG_ACKNOWLEDGES	0x1
+
+/// Little-endian, regardless of platform.
+static void Write16(uchar *& at, ushort value)
+{
+	at[0] = (uchar) value;
+	at[1] = (uchar) (value >> 8);
+	at += 2;
+}
+
+static void Write32(uchar *& at, uint32 value)
+{
+	for (int i = 0; i < 4; ++i)
+		at[i] = (uchar) (value >> (i * 8));
+	at += 4;
+}
+
+static ushort Read16(const uchar *& at)
+{
+	ushort value = (ushort) (at[0] | (at[1] << 8));
+	at += 2;
+	return value;
+}
+
+static uint32 Read32(const uchar *& at)
+{
+	uint32 value = 0;
+	for (int i = 0; i < 4; ++i)
+		value |= (uint32) at[i] << (i * 8);
+	at += 4;
+	return value;
+}
+
+/// Returns a pooled copy of the packet data.
+static Packet * PooledCopy(int type, const uchar * data, int bytes)
+{
+	Packet * packet = PacketPool::Get(type);
+	packet->data.PushBytes((uchar*) data, bytes);
+	packet->size = bytes;
+	return packet;
+}
+
+UdpConnection::UdpConnection(const sockaddr_in & address)
+: address(address)
+{
+	peer = NULL;
+	datagramsSent = datagramsReceived = datagramsLost = 0;
+	resends = unreliableDropped = 0;
+
+	memset(sent, 0, sizeof(sent));
+	nextSequence = lossCheckSequence = 0;
+	for (int i = 0; i < UDP_SEQUENCE_HISTORY; ++i)
+		received[i] = -1;
+	latestReceived = 0;
+	anyReceived = false;
+	acknowledgementPending = false;
+
+	for (int c = 0; c < UDP_CHANNELS; ++c)
+	{
+		ReliableChannel & channel = reliable[c];
+		for (int i = 0; i < UDP_RELIABLE_WINDOW; ++i)
+		{
+			channel.window[i].packet = NULL;
+			channel.received[i] = NULL;
+		}
+		channel.oldestUnacknowledged = channel.nextId = channel.nextExpected = 0;
+		nextSequencedId[c] = lastSequencedReceived[c] = 0;
+		anySequencedReceived[c] = false;
+	}
+
+	roundTripMs = 100.f;
+	roundTripVarianceMs = 50.f;
+	anyRoundTripSample = false;
+	lowestRoundTripMs = 0;
+
+	sendRate = UDP_INITIAL_SEND_RATE;
+	sendBudget = UDP_MAX_DATAGRAM;
+	intervalStartMs = 0;
+	intervalSent = intervalLost = intervalRoundTrips = 0;
+	intervalLowestRoundTripMs = 0;
+	intervalAcknowledgedBytes = 0;
+	intervalLimited = false;
+	recoveryUntilMs = 0;
+	packetLoss = 0;
+
+	started = false;
+	timedOut = false;
+	lastUpdateMs = lastSentMs = lastReceivedMs = 0;
+}
+
+UdpConnection::~UdpConnection()
+{
+	for (int c = 0; c < UDP_CHANNELS; ++c)
+	{
+		ReliableChannel & channel = reliable[c];
+		for (int i = 0; i < UDP_RELIABLE_WINDOW; ++i)
+		{
+			if (channel.window[i].packet)
+				PacketPool::Release(channel.window[i].packet);
+			if (channel.received[i])
+				PacketPool::Release(channel.received[i]);
+		}
+		while (channel.waiting.Length())
+			PacketPool::Release(channel.waiting.Pop());
+	}
+	for (int i = 0; i < unreliable.Size(); ++i)
+		PacketPool::Release(unreliable[i].packet);
+	for (int i = 0; i < delivered.Size(); ++i)
+		PacketPool::Release(delivered[i]);
+}
+
+/** Queues a copy of the packet's type and data, to be sent on the next UdpTransport::Update. Returns false if the packet is too large.
+	Unreliable packets which do not fit within the send rate during that update are dropped, while reliable ones wait.
+*/
+bool UdpConnection::Send(Packet & packet, int delivery, int channel /*= 0*/)
+{
+	int bytes = packet.data.Bytes();
+	if (bytes > UDP_MAX_PACKET_BYTES || channel < 0 || channel >= UDP_CHANNELS || delivery < 0 || delivery >= UdpDelivery::DELIVERIES)
+		return false;
+	Packet * copy = PooledCopy(packet.type, packet.data.GetData(), bytes);
+	if (delivery == UdpDelivery::RELIABLE_ORDERED)
+	{
+		reliable[channel].waiting.Push(copy);
+		FillReliableWindow(channel);
+		return true;
+	}
+	UnreliablePacket queued;
+	queued.packet = copy;
+	queued.delivery = (uchar) delivery;
+	queued.channel = (uchar) channel;
+	queued.id = delivery == UdpDelivery::UNRELIABLE_SEQUENCED ? nextSequencedId[channel]++ : 0;
+	unreliable.AddItem(queued);
+	return true;
+}
+
+/// Returns packets received since the last call, in the order delivered. They are taken from the PacketPool, and should be released to it.
+List<Packet*> UdpConnection::ReadPackets()
+{
+	List<Packet*> packets = std::move(delivered);
+	delivered.Clear();
+	return packets;
+}
+
+/// Reliable packets not yet acknowledged, including those waiting to be sent.
+int UdpConnection::ReliablePending() const
+{
+	int pending = 0;
+	for (int c = 0; c < UDP_CHANNELS; ++c)
+	{
+		const ReliableChannel & channel = reliable[c];
+		for (ushort id = channel.oldestUnacknowledged; id != channel.nextId; ++id)
+			if (channel.window[id % UDP_RELIABLE_WINDOW].packet)
+				++pending;
+		pending += const_cast<Queue<Packet*>&>(channel.waiting).Length();
+	}
+	return pending;
+}
+
+/// E.g. "127.0.0.1:33001"
+String UdpConnection::AddressString() const
+{
+	char ip[INET_ADDRSTRLEN] = {0};
+	inet_ntop(AF_INET, (void*) &address.sin_addr, ip, sizeof(ip));
+	return String(ip) + ":" + String::ToString((int) ntohs(address.sin_port));
+}
+
+/// If sequence a is more recent than b, allowing for wrap-around.
+bool UdpConnection::SequenceNewer(ushort a, ushort b)
+{
+	return a != b && (ushort) (a - b) < 32768;
+}
+
+/// If the datagram starts with a header of this protocol.
+bool UdpConnection::IsProtocolDatagram(const uchar * data, int bytes)
+{
+	return bytes >= UDP_HEADER_BYTES && Read16(data) == UDP_PROTOCOL_ID;
+}
+
+/// Handles a received datagram. Returns false if it was malformed or a duplicate.
+bool UdpConnection::Receive(const uchar * data, int bytes, int64 nowMs)
+{
+	if (!IsProtocolDatagram(data, bytes))
+		return false;
+	const uchar * at = data + 2;
+	ushort sequence = Read16(at);
+	ushort ack = Read16(at);
+	uint32 ackBits = Read32(at);
+	uchar flags = *at++;
+
+	/// Check that the messages are all intact before handling any of them.
+	const uchar * end = data + bytes;
+	for (const uchar * message = at; message < end; )
+	{
+		if (end - message < 4)
+			return false;
+		int delivery = message[0] >> 4, channel = message[0] & 0xF;
+		int headerBytes = delivery == UdpDelivery::UNRELIABLE ? 4 : 6;
+		int packetBytes = message[2] | (message[3] << 8);
+		if (delivery >= UdpDelivery::DELIVERIES || channel >= UDP_CHANNELS || end - message < headerBytes + packetBytes)
+			return false;
+		message += headerBytes + packetBytes;
+	}
+
+	/// Too old to tell if it is a duplicate, or a duplicate.
+	if (anyReceived && !SequenceNewer(sequence, latestReceived) && (ushort) (latestReceived - sequence) >= UDP_SEQUENCE_HISTORY)
+		return false;
+	int & slot = received[sequence % UDP_SEQUENCE_HISTORY];
+	if (slot == sequence)
+		return false;
+
+	slot = sequence;
+	if (!anyReceived || SequenceNewer(sequence, latestReceived))
+		latestReceived = sequence;
+	anyReceived = true;
+	acknowledgementPending = true;
+	lastReceivedMs = nowMs;
+	timedOut = false;
+	++datagramsReceived;
+
+	/// Acknowledgements, ignoring any of sequences not yet sent.
+	if ((flags & UDP_FLAG_ACKNOWLEDGES) && (ushort) (nextSequence - 1 - ack) < 32768)
+	{
+		OnAcknowledged(ack, nowMs);
+		for (int i = 0; i < 32; ++i)
+			if (ackBits & (1u << i))
+				OnAcknowledged((ushort) (ack - 1 - i), nowMs);
+		/// Datagrams older than those which can be acknowledged are lost if not yet acknowledged.
+		ushort lossLimit = (ushort) (ack - 32);
+		while (SequenceNewer(lossLimit, lossCheckSequence))
+		{
+			OnLost(lossCheckSequence);
+			++lossCheckSequence;
+		}
+	}
+
+	while (at < end)
+	{
+		int delivery = at[0] >> 4, channel = at[0] & 0xF;
+		int type = at[1];
+		at += 2;
+		int packetBytes = Read16(at);
+		ushort id = delivery == UdpDelivery::UNRELIABLE ? 0 : Read16(at);
+		const uchar * packetData = at;
+		at += packetBytes;
+		switch(delivery)
+		{
+			case UdpDelivery::UNRELIABLE:
+				delivered.AddItem(PooledCopy(type, packetData, packetBytes));
+				break;
+			case UdpDelivery::UNRELIABLE_SEQUENCED:
+				if (anySequencedReceived[channel] && !SequenceNewer(id, lastSequencedReceived[channel]))
+					break;
+				anySequencedReceived[channel] = true;
+				lastSequencedReceived[channel] = id;
+				delivered.AddItem(PooledCopy(type, packetData, packetBytes));
+				break;
+			case UdpDelivery::RELIABLE_ORDERED:
+			{
+				ReliableChannel & reliableChannel = reliable[channel];
+				/// Already delivered, the acknowledgement was lost.
+				if ((ushort) (id - reliableChannel.nextExpected) >= UDP_RELIABLE_WINDOW)
+					break;
+				Packet *& buffered = reliableChannel.received[id % UDP_RELIABLE_WINDOW];
+				if (!buffered)
+					buffered = PooledCopy(type, packetData, packetBytes);
+				/// Deliver in order, as far as received.
+				while (reliableChannel.received[reliableChannel.nextExpected % UDP_RELIABLE_WINDOW])
+				{
+					Packet *& next = reliableChannel.received[reliableChannel.nextExpected % UDP_RELIABLE_WINDOW];
+					delivered.AddItem(next);
+					next = NULL;
+					++reliableChannel.nextExpected;
+				}
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+/// Refills the send budget and re-evaluates the send rate. Called before writing datagrams each update.
+void UdpConnection::BeginUpdate(int64 nowMs)
+{
+	if (!started)
+	{
+		started = true;
+		lastUpdateMs = lastReceivedMs = intervalStartMs = nowMs;
+	}
+	if (nowMs - lastReceivedMs > UDP_TIMEOUT_MS)
+		timedOut = true;
+
+	float burst = sendRate * UDP_BURST_MS / 1000.f;
+	if (burst < UDP_MAX_DATAGRAM + UDP_IP_OVERHEAD)
+		burst = UDP_MAX_DATAGRAM + UDP_IP_OVERHEAD;
+	sendBudget += sendRate * (nowMs - lastUpdateMs) / 1000.f;
+	if (sendBudget > burst)
+		sendBudget = burst;
+	lastUpdateMs = nowMs;
+
+	/// Evaluate the send rate once per round-trip, as that is how long it takes to see the effect of any change.
+	int64 intervalMs = nowMs - intervalStartMs;
+	if (intervalMs < roundTripMs || intervalMs < UDP_BURST_MS)
+		return;
+	if (intervalSent < UDP_LOSS_SAMPLE && intervalMs < 1000)
+		return;
+	float loss = intervalSent ? intervalLost / (float) intervalSent : 0;
+	if (loss > 1)
+		loss = 1;
+	/// A steady loss is just a lossy link, which sending less would not help.
+	bool lossRising = intervalLost > 1 && loss > packetLoss + UDP_CONGESTION_LOSS;
+	packetLoss += (loss - packetLoss) * 0.25f;
+	bool queueing = intervalRoundTrips && intervalLowestRoundTripMs > lowestRoundTripMs + UDP_QUEUE_DELAY_MS;
+	bool congested = lossRising || queueing;
+	/// What the link delivered, allowing for its steady loss.
+	float deliveryRate = intervalAcknowledgedBytes * 1000.f / intervalMs / (1 - packetLoss * 0.9f);
+	if (congested && nowMs >= recoveryUntilMs)
+	{
+		/// Back off below what the link delivered, so that any queue drains, and let it do so before judging again.
+		sendRate *= UDP_RATE_DECREASE;
+		if (queueing && sendRate > deliveryRate * 0.9f)
+			sendRate = deliveryRate * 0.9f;
+		recoveryUntilMs = nowMs + (int64) (roundTripMs * 2);
+	}
+	/// Grow by about one datagram per round-trip, but only if the rate is what holds us back, and the link keeps up with it.
+	else if (!congested && intervalLimited && nowMs >= recoveryUntilMs)
+	{
+		float increase = (UDP_MAX_DATAGRAM + UDP_IP_OVERHEAD) * 1000.f / intervalMs;
+		if (increase > sendRate * UDP_RATE_INCREASE)
+			increase = sendRate * UDP_RATE_INCREASE;
+		if (sendRate + increase > deliveryRate * (1 + UDP_RATE_INCREASE * 2))
+			increase = 0;
+		sendRate += increase;
+	}
+	if (sendRate < UDP_MIN_SEND_RATE)
+		sendRate = UDP_MIN_SEND_RATE;
+	if (sendRate > UDP_MAX_SEND_RATE)
+		sendRate = UDP_MAX_SEND_RATE;
+
+	intervalStartMs = nowMs;
+	intervalSent = intervalLost = intervalRoundTrips = 0;
+	intervalLowestRoundTripMs = 0;
+	intervalAcknowledgedBytes = 0;
+	intervalLimited = false;
+}
+
+/// Writes the next datagram to send into buffer of UDP_MAX_DATAGRAM bytes. Returns its size, or 0 if nothing should be sent now.
+int UdpConnection::WriteDatagram(uchar * buffer, int64 nowMs)
+{
+	int resendDelayMs = ResendDelayMs();
+	bool reliableDue = false;
+	for (int c = 0; c < UDP_CHANNELS && !reliableDue; ++c)
+	{
+		ReliableChannel & channel = reliable[c];
+		for (ushort id = channel.oldestUnacknowledged; id != channel.nextId; ++id)
+		{
+			ReliablePacket & packet = channel.window[id % UDP_RELIABLE_WINDOW];
+			if (packet.packet && Due(packet, nowMs, resendDelayMs))
+			{
+				reliableDue = true;
+				break;
+			}
+		}
+	}
+	bool hasData = reliableDue || unreliable.Size();
+	bool sendAnyway = acknowledgementPending || nowMs - lastSentMs >= UDP_KEEPALIVE_MS;
+	if (hasData && sendBudget <= 0)
+	{
+		intervalLimited = true;
+		hasData = false;
+	}
+	if (!hasData && !sendAnyway)
+		return 0;
+
+	ushort sequence = nextSequence++;
+	SentDatagram & datagram = sent[sequence % UDP_SEQUENCE_HISTORY];
+	/// Sent so long ago that it was never checked for loss.
+	if (datagram.inUse && !datagram.acknowledged)
+		OnLost(datagram.sequence);
+	datagram.sequence = sequence;
+	datagram.inUse = true;
+	datagram.acknowledged = false;
+	datagram.sentMs = nowMs;
+	datagram.bytes = UDP_IP_OVERHEAD;
+	datagram.reliablePackets = 0;
+
+	uint32 ackBits = 0;
+	for (int i = 0; i < 32 && anyReceived; ++i)
+	{
+		ushort previous = (ushort) (latestReceived - 1 - i);
+		if (received[previous % UDP_SEQUENCE_HISTORY] == previous)
+			ackBits |= 1u << i;
+	}
+	uchar * at = buffer;
+	Write16(at, UDP_PROTOCOL_ID);
+	Write16(at, sequence);
+	Write16(at, latestReceived);
+	Write32(at, ackBits);
+	*at++ = anyReceived ? UDP_FLAG_ACKNOWLEDGES : 0;
+	uchar * end = buffer + UDP_MAX_DATAGRAM;
+
+	/// Reliable packets first, oldest first, then unreliable ones as they fit.
+	for (int c = 0; c < UDP_CHANNELS && hasData; ++c)
+	{
+		ReliableChannel & channel = reliable[c];
+		for (ushort id = channel.oldestUnacknowledged; id != channel.nextId && datagram.reliablePackets < UDP_RELIABLE_PER_DATAGRAM; ++id)
+		{
+			ReliablePacket & reliablePacket = channel.window[id % UDP_RELIABLE_WINDOW];
+			if (!reliablePacket.packet || !Due(reliablePacket, nowMs, resendDelayMs))
+				continue;
+			Packet * packet = reliablePacket.packet;
+			int bytes = packet->data.Bytes();
+			if (end - at < 6 + bytes)
+				continue;
+			*at++ = (uchar) (UdpDelivery::RELIABLE_ORDERED << 4 | c);
+			*at++ = (uchar) packet->type;
+			Write16(at, (ushort) bytes);
+			Write16(at, id);
+			memcpy(at, packet->data.GetData(), bytes);
+			at += bytes;
+			if (reliablePacket.sends++)
+				++resends;
+			reliablePacket.lastSentMs = nowMs;
+			datagram.reliableChannels[datagram.reliablePackets] = (uchar) c;
+			datagram.reliableIds[datagram.reliablePackets] = id;
+			++datagram.reliablePackets;
+		}
+	}
+	for (int i = 0; i < unreliable.Size() && hasData; )
+	{
+		UnreliablePacket & queued = unreliable[i];
+		int bytes = queued.packet->data.Bytes();
+		int headerBytes = queued.delivery == UdpDelivery::UNRELIABLE ? 4 : 6;
+		if (end - at < headerBytes + bytes)
+		{
+			++i;
+			continue;
+		}
+		*at++ = (uchar) (queued.delivery << 4 | queued.channel);
+		*at++ = (uchar) queued.packet->type;
+		Write16(at, (ushort) bytes);
+		if (queued.delivery != UdpDelivery::UNRELIABLE)
+			Write16(at, queued.id);
+		memcpy(at, queued.packet->data.GetData(), bytes);
+		at += bytes;
+		PacketPool::Release(queued.packet);
+		unreliable.RemoveIndex(i, ListOption::RETAIN_ORDER);
+	}
+
+	int bytes = (int) (at - buffer);
+	datagram.bytes += bytes;
+	sendBudget -= datagram.bytes;
+	acknowledgementPending = false;
+	lastSentMs = nowMs;
+	++datagramsSent;
+	++intervalSent;
+	return bytes;
+}
+
+/// Drops unreliable packets which could not be sent this update.
+void UdpConnection::EndUpdate()
+{
+	for (int i = 0; i < unreliable.Size(); ++i)
+		PacketPool::Release(unreliable[i].packet);
+	unreliableDropped += unreliable.Size();
+	unreliable.Clear();
+}
+
+/// Marks a sent datagram as acknowledged, sampling the round-trip and acknowledging its reliable packets.
+void UdpConnection::OnAcknowledged(ushort sequence, int64 nowMs)
+{
+	SentDatagram & datagram = sent[sequence % UDP_SEQUENCE_HISTORY];
+	if (!datagram.inUse || datagram.sequence != sequence || datagram.acknowledged)
+		return;
+	datagram.acknowledged = true;
+
+	float sampleMs = (float) (nowMs - datagram.sentMs);
+	if (!anyRoundTripSample)
+	{
+		roundTripMs = sampleMs;
+		roundTripVarianceMs = sampleMs / 2;
+		lowestRoundTripMs = sampleMs;
+		anyRoundTripSample = true;
+	}
+	else
+	{
+		float difference = sampleMs > roundTripMs ? sampleMs - roundTripMs : roundTripMs - sampleMs;
+		roundTripVarianceMs += (difference - roundTripVarianceMs) * 0.25f;
+		roundTripMs += (sampleMs - roundTripMs) * 0.125f;
+		if (sampleMs < lowestRoundTripMs)
+			lowestRoundTripMs = sampleMs;
+	}
+	if (!intervalRoundTrips || sampleMs < intervalLowestRoundTripMs)
+		intervalLowestRoundTripMs = sampleMs;
+	++intervalRoundTrips;
+	intervalAcknowledgedBytes += datagram.bytes;
+
+	for (int i = 0; i < datagram.reliablePackets; ++i)
+	{
+		int c = datagram.reliableChannels[i];
+		ushort id = datagram.reliableIds[i];
+		ReliableChannel & channel = reliable[c];
+		ReliablePacket & packet = channel.window[id % UDP_RELIABLE_WINDOW];
+		if (!packet.packet || packet.id != id)
+			continue;
+		PacketPool::Release(packet.packet);
+		packet.packet = NULL;
+		while (channel.oldestUnacknowledged != channel.nextId && !channel.window[channel.oldestUnacknowledged % UDP_RELIABLE_WINDOW].packet)
+			++channel.oldestUnacknowledged;
+		FillReliableWindow(c);
+	}
+}
+
+/// Counts a sent datagram as lost, and makes its reliable packets be sent again as soon as possible.
+void UdpConnection::OnLost(ushort sequence)
+{
+	SentDatagram & datagram = sent[sequence % UDP_SEQUENCE_HISTORY];
+	if (!datagram.inUse || datagram.sequence != sequence)
+		return;
+	datagram.inUse = false;
+	if (datagram.acknowledged)
+		return;
+	++datagramsLost;
+	++intervalLost;
+	for (int i = 0; i < datagram.reliablePackets; ++i)
+	{
+		ReliablePacket & packet = reliable[datagram.reliableChannels[i]].window[datagram.reliableIds[i] % UDP_RELIABLE_WINDOW];
+		/// Unless it has been sent again since.
+		if (packet.packet && packet.id == datagram.reliableIds[i] && packet.lastSentMs == datagram.sentMs)
+			packet.lastSentMs = -1;
+	}
+}
+
+/// Moves waiting reliable packets into the window of the channel, as earlier ones are acknowledged.
+void UdpConnection::FillReliableWindow(int c)
+{
+	ReliableChannel & channel = reliable[c];
+	while (channel.waiting.Length() && (ushort) (channel.nextId - channel.oldestUnacknowledged) < UDP_RELIABLE_WINDOW)
+	{
+		ReliablePacket & packet = channel.window[channel.nextId % UDP_RELIABLE_WINDOW];
+		packet.packet = channel.waiting.Pop();
+		packet.id = channel.nextId++;
+		packet.lastSentMs = -1;
+		packet.sends = 0;
+	}
+}
+
+/// Time after which an unacknowledged reliable packet is sent again.
+int UdpConnection::ResendDelayMs() const
+{
+	return (int) (roundTripMs + 4 * roundTripVarianceMs) + UDP_MIN_RESEND_MS;
+}
+
+/// If the reliable packet should be sent now.
+bool UdpConnection::Due(const ReliablePacket & packet, int64 nowMs, int resendDelayMs)
+{
+	return packet.lastSentMs < 0 || nowMs - packet.lastSentMs >= resendDelayMs;
+}
@@ -0,0 +1,234 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// One remote end of a UdpTransport: acknowledges datagrams, estimates round-trip time, limits the send rate and delivers packets per channel.
+
+#ifndef UDP_CONNECTION_H
+#define UDP_CONNECTION_H
+
+#include "Network/NetworkIncludes.h"
+#include "List/List.h"
+#include "Queue/Queue.h"
+#include "String/AEString.h"
+
+class Packet;
+class Peer;
+
+/// Identifies datagrams of this protocol, so that stray datagrams are ignored.
+#define UDP_PROTOCOL_ID				0x4145
+/// Largest datagram sent, small enough to not be fragmented on common links.
+#define UDP_MAX_DATAGRAM			1400
+/// Protocol id, sequence, ack, ack bits and flags.
+#define UDP_HEADER_BYTES			11
+/// Delivery and channel, packet type, length and, unless UNRELIABLE, message id.
+#define UDP_MESSAGE_HEADER_BYTES	6
+/// Largest packet data which may be sent. Packets are never split across datagrams.
+#define UDP_MAX_PACKET_BYTES		(UDP_MAX_DATAGRAM - UDP_HEADER_BYTES - UDP_MESSAGE_HEADER_BYTES)
+/// Channels of each delivery, numbered from 0. Channels are independent, so that a lost packet only delays later packets on its own channel.
+#define UDP_CHANNELS				4
+/// Reliable packets which may be unacknowledged at once on a channel. Further packets wait until earlier ones are acknowledged.
+#define UDP_RELIABLE_WINDOW			256
+/// Sent and received datagrams remembered, for acknowledgement and to discard duplicates.
+#define UDP_SEQUENCE_HISTORY		256
+/// Reliable packets tracked per datagram. Further reliable packets wait for the next datagram.
+#define UDP_RELIABLE_PER_DATAGRAM	32
+/// Send rate limits, in bytes per second, including UDP and IP headers.
+#define UDP_INITIAL_SEND_RATE		(128 * 1024)
+#define UDP_MIN_SEND_RATE			(16 * 1024)
+#define UDP_MAX_SEND_RATE			(8 * 1024 * 1024)
+/// Bytes added by UDP and IPv4 to each datagram.
+#define UDP_IP_OVERHEAD				28
+/// Sending is bursty up to this many ms worth of the send rate.
+#define UDP_BURST_MS				50
+/// Rise in the fraction of datagrams lost in one round-trip, above the recent average, which is taken as congestion rather than a lossy link.
+#define UDP_CONGESTION_LOSS			0.2f
+/** Round-trip times staying this far above the lowest seen are taken as a queue building up along the link, i.e. congestion.
+	This usually shows well before any datagrams are dropped.
+*/
+#define UDP_QUEUE_DELAY_MS			40
+/// Datagrams sent before loss in a round-trip is judged, unless a second passes first, as random loss among a few says little.
+#define UDP_LOSS_SAMPLE				16
+/// Factor applied to the send rate on congestion.
+#define UDP_RATE_DECREASE			0.7f
+/// Largest fraction by which the send rate grows per round-trip, so that it approaches the capacity of slow links gently.
+#define UDP_RATE_INCREASE			0.1f
+/// Shortest wait before a reliable packet is sent again, in addition to the round-trip estimate.
+#define UDP_MIN_RESEND_MS			20
+/// A datagram is sent at least this often, to keep acknowledgements and round-trip estimate up to date.
+#define UDP_KEEPALIVE_MS			100
+/// Connections which receive nothing for this long are considered lost.
+#define UDP_TIMEOUT_MS				5000
+
+namespace UdpDelivery {
+enum udpDeliveries {
+	/// Delivered if and when it arrives, possibly out of order. For data which is soon replaced.
+	UNRELIABLE,
+	/// As UNRELIABLE, but a packet older than one already delivered on its channel is dropped. E.g. for entity snapshots.
+	UNRELIABLE_SEQUENCED,
+	/// Sent again until acknowledged, and delivered exactly once in the order sent on its channel.
+	RELIABLE_ORDERED,
+	DELIVERIES,
+};};
+
+/** Packets are queued with Send, and aggregated into as few datagrams as possible by UdpTransport::Update.
+	Each datagram carries a sequence number, and acknowledges the latest 33 datagrams received from the other end, so
+	lost datagrams are detected without any separate acknowledgement packets. Reliable packets in a lost datagram are sent again.
+	The send rate is lowered when losses or rising round-trip times suggest congestion, and raised again while sending is limited by it.
+	Not thread-safe: use from the thread updating the transport.
+*/
+class UdpConnection
+{
+	friend class UdpTransport;
+public:
+	UdpConnection(const sockaddr_in & address);
+	~UdpConnection();
+
+	/** Queues a copy of the packet's type and data, to be sent on the next UdpTransport::Update. Returns false if the packet is too large.
+		Unreliable packets which do not fit within the send rate during that update are dropped, while reliable ones wait.
+	*/
+	bool Send(Packet & packet, int delivery, int channel = 0);
+	/// Returns packets received since the last call, in the order delivered. They are taken from the PacketPool, and should be released to it.
+	List<Packet*> ReadPackets();
+
+	/// Smoothed round-trip time in milliseconds.
+	float RoundTripMs() const { return roundTripMs; };
+	/// Fraction of sent datagrams recently lost, 0 to 1.
+	float PacketLoss() const { return packetLoss; };
+	/// Current send rate limit, in bytes per second.
+	int SendRate() const { return (int) sendRate; };
+	/// Reliable packets not yet acknowledged, including those waiting to be sent.
+	int ReliablePending() const;
+	/// If nothing has been received for UDP_TIMEOUT_MS.
+	bool TimedOut() const { return timedOut; };
+	/// E.g. "127.0.0.1:33001"
+	String AddressString() const;
+
+	/// Remote address.
+	sockaddr_in address;
+	/// Peer at the other end, if known. Set as sender of received packets.
+	Peer * peer;
+
+	/// Statistics.
+	int datagramsSent, datagramsReceived, datagramsLost;
+	/// Reliable packets sent again.
+	int resends;
+	/// Unreliable packets dropped as the send rate did not allow them.
+	int unreliableDropped;
+
+	/// If sequence a is more recent than b, allowing for wrap-around.
+	static bool SequenceNewer(ushort a, ushort b);
+	/// If the datagram starts with a header of this protocol.
+	static bool IsProtocolDatagram(const uchar * data, int bytes);
+private:
+	/// Not copyable, as it owns its queued packets.
+	UdpConnection(const UdpConnection & other);
+	void operator = (const UdpConnection & other);
+
+	/// Handles a received datagram. Returns false if it was malformed or a duplicate.
+	bool Receive(const uchar * data, int bytes, int64 nowMs);
+	/// Refills the send budget and re-evaluates the send rate. Called before writing datagrams each update.
+	void BeginUpdate(int64 nowMs);
+	/// Writes the next datagram to send into buffer of UDP_MAX_DATAGRAM bytes. Returns its size, or 0 if nothing should be sent now.
+	int WriteDatagram(uchar * buffer, int64 nowMs);
+	/// Drops unreliable packets which could not be sent this update.
+	void EndUpdate();
+
+	/// Marks a sent datagram as acknowledged, sampling the round-trip and acknowledging its reliable packets.
+	void OnAcknowledged(ushort sequence, int64 nowMs);
+	/// Counts a sent datagram as lost, and makes its reliable packets be sent again as soon as possible.
+	void OnLost(ushort sequence);
+	/// Moves waiting reliable packets into the window of the channel, as earlier ones are acknowledged.
+	void FillReliableWindow(int channel);
+	/// Time after which an unacknowledged reliable packet is sent again.
+	int ResendDelayMs() const;
+
+	struct SentDatagram
+	{
+		ushort sequence;
+		bool inUse;
+		bool acknowledged;
+		int64 sentMs;
+		/// Including UDP and IP headers.
+		int bytes;
+		int reliablePackets;
+		uchar reliableChannels[UDP_RELIABLE_PER_DATAGRAM];
+		ushort reliableIds[UDP_RELIABLE_PER_DATAGRAM];
+	};
+	/// Indexed by sequence modulo UDP_SEQUENCE_HISTORY.
+	SentDatagram sent[UDP_SEQUENCE_HISTORY];
+	ushort nextSequence;
+	/// Oldest sent sequence not yet checked for loss.
+	ushort lossCheckSequence;
+
+	/// Received sequences, indexed by sequence modulo UDP_SEQUENCE_HISTORY. -1 where none.
+	int received[UDP_SEQUENCE_HISTORY];
+	ushort latestReceived;
+	bool anyReceived;
+	/// If a datagram has been received since we last sent one, which should thus be acknowledged.
+	bool acknowledgementPending;
+
+	/// Packets sent reliably, kept until acknowledged.
+	struct ReliablePacket
+	{
+		Packet * packet;
+		ushort id;
+		/// -1 if not yet sent, or to be sent again as soon as possible.
+		int64 lastSentMs;
+		int sends;
+	};
+	/// If the reliable packet should be sent now.
+	static bool Due(const ReliablePacket & packet, int64 nowMs, int resendDelayMs);
+	struct ReliableChannel
+	{
+		/// Indexed by id modulo UDP_RELIABLE_WINDOW, NULL packet where acknowledged.
+		ReliablePacket window[UDP_RELIABLE_WINDOW];
+		ushort oldestUnacknowledged, nextId;
+		/// Beyond the window, waiting for earlier packets to be acknowledged.
+		Queue<Packet*> waiting;
+		/// Received out of order, indexed by id modulo UDP_RELIABLE_WINDOW.
+		Packet * received[UDP_RELIABLE_WINDOW];
+		ushort nextExpected;
+	};
+	ReliableChannel reliable[UDP_CHANNELS];
+
+	/// Unreliable packets queued since the last update.
+	struct UnreliablePacket
+	{
+		Packet * packet;
+		uchar delivery, channel;
+		ushort id;
+	};
+	List<UnreliablePacket> unreliable;
+	/// Ids of UNRELIABLE_SEQUENCED packets.
+	ushort nextSequencedId[UDP_CHANNELS], lastSequencedReceived[UDP_CHANNELS];
+	bool anySequencedReceived[UDP_CHANNELS];
+
+	/// Received and ready to be read.
+	List<Packet*> delivered;
+
+	/// Round-trip estimation, as for TCP (RFC 6298).
+	float roundTripMs, roundTripVarianceMs;
+	bool anyRoundTripSample;
+	float lowestRoundTripMs;
+
+	/// Bytes per second, and bytes which may currently be sent.
+	float sendRate, sendBudget;
+	/// Send rate evaluation, once per round-trip.
+	int64 intervalStartMs;
+	int intervalSent, intervalLost;
+	/// Lowest round-trip sampled during the interval. Any excess over the lowest ever is time spent queued along the link, as jitter does not raise the lowest.
+	float intervalLowestRoundTripMs;
+	int intervalRoundTrips;
+	/// Bytes of datagrams acknowledged during the interval, i.e. what the link delivered.
+	int intervalAcknowledgedBytes;
+	/// If sending was limited by the send rate during the interval.
+	bool intervalLimited;
+	/// The send rate is not lowered again until then, so that one congestion event only lowers it once.
+	int64 recoveryUntilMs;
+	float packetLoss;
+
+	bool started;
+	bool timedOut;
+	int64 lastUpdateMs, lastSentMs, lastReceivedMs;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// Simulates loss, latency, jitter, duplication and limited bandwidth for datagrams sent by a UdpTransport, e.g. over loopback.
+
+#include "UdpLinkSimulator.h"
+#include "Network/Socket/UdpSocket.h"
+#include <cstring>
+
+UdpLinkSimulator::UdpLinkSimulator()
+{
+	packetLoss = 0;
+	latencyMs = jitterMs = 0;
+	duplicates = 0;
+	bytesPerSecond = 0;
+	queueMs = 250;
+	datagramsDropped = datagramsDuplicated = 0;
+	linkBusyUntilMs = 0;
+	random.Init(2016);
+}
+
+UdpLinkSimulator::~UdpLinkSimulator()
+{
+	Clear();
+}
+
+void UdpLinkSimulator::Seed(int64 seed)
+{
+	random.Init(seed);
+}
+
+/// Takes a datagram to be sent, dropping, duplicating or delaying it.
+void UdpLinkSimulator::Send(const sockaddr_in & address, const uchar * data, int bytes, int64 nowMs)
+{
+	if (bytes > UDP_MAX_DATAGRAM)
+		return;
+	int64 departMs = nowMs;
+	if (bytesPerSecond > 0)
+	{
+		if (linkBusyUntilMs < nowMs)
+			linkBusyUntilMs = nowMs;
+		/// Tail drop, as a router with a full queue.
+		if (linkBusyUntilMs - nowMs > queueMs)
+		{
+			++datagramsDropped;
+			return;
+		}
+		linkBusyUntilMs += (bytes + UDP_IP_OVERHEAD) * 1000 / bytesPerSecond;
+		departMs = linkBusyUntilMs;
+	}
+	if (random.Randf() < packetLoss)
+	{
+		++datagramsDropped;
+		return;
+	}
+	int copies = 1;
+	if (random.Randf() < duplicates)
+	{
+		copies = 2;
+		++datagramsDuplicated;
+	}
+	for (int i = 0; i < copies; ++i)
+	{
+		int jitter = jitterMs > 0 ? (int) random.Randi(jitterMs * 2) - jitterMs : 0;
+		Delay(address, data, bytes, departMs + latencyMs + jitter);
+	}
+}
+
+/// Sends datagrams which are due. Returns how many were sent.
+int UdpLinkSimulator::Flush(UdpSocket * socket, int64 nowMs)
+{
+	int flushed = 0;
+	for (int i = 0; i < queue.Size(); )
+	{
+		DelayedDatagram * datagram = queue[i];
+		if (datagram->dueMs > nowMs)
+		{
+			++i;
+			continue;
+		}
+		socket->WriteTo((sockaddr*) &datagram->address, sizeof(datagram->address), (const char*) datagram->data, datagram->bytes);
+		delete datagram;
+		queue.RemoveIndex(i, ListOption::RETAIN_ORDER);
+		++flushed;
+	}
+	return flushed;
+}
+
+/// Deletes any queued datagrams.
+void UdpLinkSimulator::Clear()
+{
+	for (int i = 0; i < queue.Size(); ++i)
+		delete queue[i];
+	queue.Clear();
+	linkBusyUntilMs = 0;
+}
+
+/// Queues a copy of the datagram, to be sent once due.
+void UdpLinkSimulator::Delay(const sockaddr_in & address, const uchar * data, int bytes, int64 dueMs)
+{
+	DelayedDatagram * datagram = new DelayedDatagram();
+	datagram->dueMs = dueMs;
+	datagram->address = address;
+	datagram->bytes = bytes;
+	memcpy(datagram->data, data, bytes);
+	queue.AddItem(datagram);
+}
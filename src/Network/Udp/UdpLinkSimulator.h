@@ -0,0 +1,64 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// Simulates loss, latency, jitter, duplication and limited bandwidth for datagrams sent by a UdpTransport, e.g. over loopback.
+
+#ifndef UDP_LINK_SIMULATOR_H
+#define UDP_LINK_SIMULATOR_H
+
+#include "UdpConnection.h"
+#include "Random/Random.h"
+
+class UdpSocket;
+
+/** Set as UdpTransport::simulator to pass its outgoing datagrams through here. Each is dropped, duplicated or
+	delayed as configured, then sent by Flush once due. Jitter may reorder datagrams, as on real links.
+	With bytesPerSecond set, datagrams queue up as behind a bottleneck, and are dropped once the queue is full.
+*/
+class UdpLinkSimulator
+{
+public:
+	UdpLinkSimulator();
+	~UdpLinkSimulator();
+
+	/// Fraction of datagrams lost, 0 to 1.
+	float packetLoss;
+	/// One-way delay, plus or minus up to jitterMs.
+	int latencyMs;
+	int jitterMs;
+	/// Fraction of datagrams delivered twice.
+	float duplicates;
+	/// Bandwidth of the simulated link, 0 for unlimited.
+	int bytesPerSecond;
+	/// Longest queue of the bottleneck, in ms. Further datagrams are dropped.
+	int queueMs;
+
+	void Seed(int64 seed);
+	/// Takes a datagram to be sent, dropping, duplicating or delaying it.
+	void Send(const sockaddr_in & address, const uchar * data, int bytes, int64 nowMs);
+	/// Sends datagrams which are due. Returns how many were sent.
+	int Flush(UdpSocket * socket, int64 nowMs);
+	/// Datagrams waiting to be sent.
+	int Queued() const { return queue.Size(); };
+	/// Deletes any queued datagrams.
+	void Clear();
+
+	/// Statistics.
+	int datagramsDropped, datagramsDuplicated;
+private:
+	/// Queues a copy of the datagram, to be sent once due.
+	void Delay(const sockaddr_in & address, const uchar * data, int bytes, int64 dueMs);
+
+	struct DelayedDatagram
+	{
+		int64 dueMs;
+		sockaddr_in address;
+		int bytes;
+		uchar data[UDP_MAX_DATAGRAM];
+	};
+	List<DelayedDatagram*> queue;
+	Random random;
+	/// When the simulated bottleneck has sent all queued data.
+	int64 linkBusyUntilMs;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// Loopback test of UdpTransport channels over a simulated lossy link.
+
+#include "UdpTransport.h"
+#include "UdpLinkSimulator.h"
+#include "Network/Packet/Packet.h"
+#include "Network/Packet/PacketPool.h"
+#include "Network/Peer.h"
+#include <cstring>
+
+/// Simulated frame time.
+#define TEST_TICK_MS	16
+
+/// Sends a packet with index first, padded to given size, which tells the kinds of packets apart.
+static void SendIndexed(UdpConnection * connection, int delivery, int channel, int index, int bytes)
+{
+	Packet packet(PacketType::GAME_SPECIFIC);
+	packet.data.PushBytes((uchar*) &index, sizeof(index));
+	static uchar padding[256] = {0};
+	int paddingBytes = bytes - (int) sizeof(index);
+	if (paddingBytes > 0)
+		packet.data.PushBytes(padding, paddingBytes);
+	connection->Send(packet, delivery, channel);
+}
+
+/** Sends reliable packets on two channels, sequenced and unreliable ones each tick, from a client to a host over loopback,
+	through UdpLinkSimulators which lose, duplicate and reorder datagrams. Asserts that every reliable packet is delivered
+	exactly once and in order on its channel, that sequenced packets are never delivered after a newer one,
+	and that packets from the connection the host accepted have its peer as sender.
+*/
+void UdpTransport::UnitTest()
+{
+	UdpTransport host, client;
+	bool bound = host.Bind(0, true, 1) && client.Bind(0);
+	assert(bound);
+	if (!bound)
+		return;
+	UdpLinkSimulator hostLink, clientLink;
+	hostLink.Seed(1);
+	clientLink.Seed(2);
+	UdpLinkSimulator * links[2] = {&hostLink, &clientLink};
+	for (int i = 0; i < 2; ++i)
+	{
+		links[i]->packetLoss = 0.2f;
+		links[i]->latencyMs = 50;
+		links[i]->jitterMs = 20;
+		links[i]->duplicates = 0.1f;
+	}
+	host.simulator = &hostLink;
+	client.simulator = &clientLink;
+	UdpConnection * toHost = client.Connect("127.0.0.1", host.Port());
+	assert(toHost);
+	if (!toHost)
+		return;
+
+	Peer peer;
+	UdpConnection * accepted = NULL;
+	enum {
+		RELIABLE_CHANNELS = 2,
+		/// Sizes telling the kinds apart.
+		SEQUENCED_BYTES = 100, UNRELIABLE_BYTES = 16, RELIABLE_BYTES = 32,
+	};
+	int reliableSent[RELIABLE_CHANNELS] = {0}, reliableReceived[RELIABLE_CHANNELS] = {0};
+	int sequencedSent = 0, lastSequenced = -1, sequencedReceived = 0;
+	int64 nowMs = 1000;
+	/// Send for 3 seconds, then keep going for reliable packets to arrive.
+	const int ticks = 3000 / TEST_TICK_MS, drainTicks = 10000 / TEST_TICK_MS;
+	for (int tick = 0; tick < ticks + drainTicks; ++tick, nowMs += TEST_TICK_MS)
+	{
+		if (tick < ticks)
+		{
+			SendIndexed(toHost, UdpDelivery::UNRELIABLE_SEQUENCED, 0, sequencedSent++, SEQUENCED_BYTES);
+			SendIndexed(toHost, UdpDelivery::UNRELIABLE, 0, tick, UNRELIABLE_BYTES);
+			SendIndexed(toHost, UdpDelivery::RELIABLE_ORDERED, 0, reliableSent[0]++, RELIABLE_BYTES);
+			if (tick % 3 == 0)
+				SendIndexed(toHost, UdpDelivery::RELIABLE_ORDERED, 1, reliableSent[1]++, RELIABLE_BYTES + 1);
+		}
+		else if (toHost->ReliablePending() == 0 && reliableReceived[0] == reliableSent[0] && reliableReceived[1] == reliableSent[1])
+			break;
+		client.Update(nowMs);
+		host.Update(nowMs);
+
+		List<UdpConnection*> newConnections = host.NewConnections();
+		assert(newConnections.Size() == 0 || (newConnections.Size() == 1 && !accepted));
+		if (newConnections.Size())
+		{
+			accepted = newConnections[0];
+			accepted->peer = &peer;
+		}
+		List<Packet*> packets = host.ReadPackets();
+		for (int i = 0; i < packets.Size(); ++i)
+		{
+			Packet * packet = packets[i];
+			int index = 0;
+			memcpy(&index, packet->data.GetData(), sizeof(index));
+			int bytes = packet->size;
+			assert(packet->sender == &peer);
+			PacketPool::Release(packet);
+			if (bytes == SEQUENCED_BYTES)
+			{
+				assert(index > lastSequenced);
+				lastSequenced = index;
+				++sequencedReceived;
+			}
+			else if (bytes == RELIABLE_BYTES || bytes == RELIABLE_BYTES + 1)
+			{
+				int channel = bytes == RELIABLE_BYTES ? 0 : 1;
+				/// Exactly once, in order.
+				assert(index == reliableReceived[channel]);
+				++reliableReceived[channel];
+			}
+		}
+	}
+	assert(accepted && host.connections.Size() == 1);
+	for (int c = 0; c < RELIABLE_CHANNELS; ++c)
+		assert(reliableReceived[c] == reliableSent[c]);
+	/// Some are lost or overtaken, but most arrive.
+	assert(sequencedReceived > sequencedSent / 2 && sequencedReceived < sequencedSent);
+	assert(toHost->resends > 0 && toHost->datagramsLost > 0);
+}
@@ -0,0 +1,177 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// Real-time transport over a UdpSocket, with unreliable, sequenced and reliable-ordered channels per connection.
+
+#include "UdpTransport.h"
+#include "UdpLinkSimulator.h"
+#include "Network/Socket/UdpSocket.h"
+#include "Network/Packet/Packet.h"
+#include <cstring>
+
+UdpTransport::UdpTransport()
+{
+	simulator = NULL;
+	socket = NULL;
+	acceptConnections = false;
+	maxConnections = 0;
+	datagramsIgnored = 0;
+}
+
+UdpTransport::~UdpTransport()
+{
+	Close();
+}
+
+/** Binds the socket to given port, or any free port if 0. If acceptConnections, datagrams from
+	unknown addresses create new connections, up to maxConnections. Returns false if it could not bind.
+*/
+bool UdpTransport::Bind(int port, bool acceptConnections /*= false*/, int maxConnections /*= 32*/)
+{
+	Close();
+	socket = new UdpSocket();
+	if (!socket->Bind(port))
+	{
+		std::cout<<"\nUdpTransport::Bind: Unable to bind port "<<port<<": "<<socket->GetLastErrorString();
+		delete socket;
+		socket = NULL;
+		return false;
+	}
+	this->acceptConnections = acceptConnections;
+	this->maxConnections = maxConnections;
+	return true;
+}
+
+/// Port bound, or 0 if not bound.
+int UdpTransport::Port() const
+{
+	return socket ? socket->port : 0;
+}
+
+/// Returns the connection to given host, creating it if needed. Returns NULL if the address could not be resolved.
+UdpConnection * UdpTransport::Connect(String host, int port)
+{
+	addrinfo hints, * result = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+	String portString = String::ToString(port);
+	if (getaddrinfo(host.c_str(), portString.c_str(), &hints, &result) != 0 || !result)
+	{
+		std::cout<<"\nUdpTransport::Connect: Unable to resolve "<<host;
+		return NULL;
+	}
+	sockaddr_in address;
+	memcpy(&address, result->ai_addr, sizeof(address));
+	freeaddrinfo(result);
+	UdpConnection * connection = GetConnection(address);
+	if (!connection)
+	{
+		connection = new UdpConnection(address);
+		connections.AddItem(connection);
+	}
+	return connection;
+}
+
+/// Removes and deletes the connection, dropping anything queued to or received from it.
+void UdpTransport::Disconnect(UdpConnection * connection)
+{
+	connections.RemoveItem(connection);
+	newConnections.RemoveItem(connection);
+	delete connection;
+}
+
+/// Disconnects all and closes the socket.
+void UdpTransport::Close()
+{
+	while (connections.Size())
+		Disconnect(connections[0]);
+	if (socket)
+	{
+		socket->Close();
+		delete socket;
+		socket = NULL;
+	}
+}
+
+/// Receives all waiting datagrams, then sends what is queued on each connection, as its send rate allows.
+void UdpTransport::Update(int64 nowMs)
+{
+	if (!socket)
+		return;
+	/// Larger than any valid datagram, so that oversized ones are seen as such rather than truncated.
+	uchar buffer[UDP_MAX_DATAGRAM + 1];
+	sockaddr_in from;
+	int bytes;
+	while ((bytes = socket->ReadFrom((sockaddr*) &from, (char*) buffer, sizeof(buffer))) > 0)
+	{
+		UdpConnection * connection = GetConnection(from);
+		if (!connection && acceptConnections && connections.Size() < maxConnections && UdpConnection::IsProtocolDatagram(buffer, bytes))
+		{
+			connection = new UdpConnection(from);
+			connections.AddItem(connection);
+			newConnections.AddItem(connection);
+		}
+		if (!connection || bytes > UDP_MAX_DATAGRAM || !connection->Receive(buffer, bytes, nowMs))
+			++datagramsIgnored;
+	}
+
+	for (int i = 0; i < connections.Size(); ++i)
+	{
+		UdpConnection * connection = connections[i];
+		connection->BeginUpdate(nowMs);
+		while ((bytes = connection->WriteDatagram(buffer, nowMs)) > 0)
+			SendDatagram(connection, buffer, bytes, nowMs);
+		connection->EndUpdate();
+	}
+	if (simulator)
+		simulator->Flush(socket, nowMs);
+}
+
+/// Returns the packets received by all connections since the last call, with sender set to their connection's peer.
+List<Packet*> UdpTransport::ReadPackets()
+{
+	List<Packet*> packets;
+	for (int i = 0; i < connections.Size(); ++i)
+	{
+		UdpConnection * connection = connections[i];
+		List<Packet*> received = connection->ReadPackets();
+		for (int j = 0; j < received.Size(); ++j)
+		{
+			received[j]->sender = connection->peer;
+			received[j]->socket = socket;
+		}
+		packets += received;
+	}
+	return packets;
+}
+
+/// Returns connections created by incoming datagrams since the last call.
+List<UdpConnection*> UdpTransport::NewConnections()
+{
+	List<UdpConnection*> created = newConnections;
+	newConnections.Clear();
+	return created;
+}
+
+UdpConnection * UdpTransport::GetConnection(const sockaddr_in & address)
+{
+	for (int i = 0; i < connections.Size(); ++i)
+	{
+		UdpConnection * connection = connections[i];
+		if (connection->address.sin_port == address.sin_port && connection->address.sin_addr.s_addr == address.sin_addr.s_addr)
+			return connection;
+	}
+	return NULL;
+}
+
+void UdpTransport::SendDatagram(UdpConnection * connection, const uchar * data, int bytes, int64 nowMs)
+{
+	if (simulator)
+	{
+		simulator->Send(connection->address, data, bytes, nowMs);
+		return;
+	}
+	/// A full send buffer drops the datagram, which is then handled as any lost one.
+	socket->WriteTo((sockaddr*) &connection->address, sizeof(connection->address), (const char*) data, bytes);
+}
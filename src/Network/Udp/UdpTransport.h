@@ -0,0 +1,65 @@
+/// Emil Hedemalm
+/// 2016-08-29
+/// Real-time transport over a UdpSocket, with unreliable, sequenced and reliable-ordered channels per connection.
+
+#ifndef UDP_TRANSPORT_H
+#define UDP_TRANSPORT_H
+
+#include "UdpConnection.h"
+
+class UdpSocket;
+class UdpLinkSimulator;
+
+/** Owns a bound UdpSocket and a UdpConnection for each remote address it talks to.
+	Unlike a TCP stream, a lost datagram only delays reliable packets sent on the same channel, while
+	unreliable packets sent after it, e.g. entity updates, are delivered as soon as they arrive.
+	Call Update regularly, e.g. once per network frame, to receive and send.
+*/
+class UdpTransport
+{
+public:
+	UdpTransport();
+	~UdpTransport();
+
+	/** Binds the socket to given port, or any free port if 0. If acceptConnections, datagrams from
+		unknown addresses create new connections, up to maxConnections. Returns false if it could not bind.
+	*/
+	bool Bind(int port, bool acceptConnections = false, int maxConnections = 32);
+	/// Port bound, or 0 if not bound.
+	int Port() const;
+	/// Returns the connection to given host, creating it if needed. Returns NULL if the address could not be resolved.
+	UdpConnection * Connect(String host, int port);
+	/// Removes and deletes the connection, dropping anything queued to or received from it.
+	void Disconnect(UdpConnection * connection);
+	/// Disconnects all and closes the socket.
+	void Close();
+
+	/// Receives all waiting datagrams, then sends what is queued on each connection, as its send rate allows.
+	void Update(int64 nowMs);
+	/// Returns the packets received by all connections since the last call, with sender set to their connection's peer.
+	List<Packet*> ReadPackets();
+	/// Returns connections created by incoming datagrams since the last call.
+	List<UdpConnection*> NewConnections();
+	/// Sends packets of each delivery over a simulated lossy link on loopback, asserting on what arrives. See UdpTests.cpp
+	static void UnitTest();
+
+	List<UdpConnection*> connections;
+	/// If set, outgoing datagrams pass through it, e.g. to simulate a lossy link over loopback. Not owned.
+	UdpLinkSimulator * simulator;
+	/// Datagrams which were not from a connection of ours, or malformed.
+	int datagramsIgnored;
+private:
+	/// Not copyable, as it owns its socket and connections.
+	UdpTransport(const UdpTransport & other);
+	void operator = (const UdpTransport & other);
+
+	UdpConnection * GetConnection(const sockaddr_in & address);
+	void SendDatagram(UdpConnection * connection, const uchar * data, int bytes, int64 nowMs);
+
+	UdpSocket * socket;
+	bool acceptConnections;
+	int maxConnections;
+	List<UdpConnection*> newConnections;
+};
+
+#endif
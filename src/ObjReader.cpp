@@ -1,287 +1,444 @@
 // Emil Hedemalm
 // 2013-07-03
 // Swapped out std:: class usage for own one in order to handle new .obj files that were failing to parse.
+// 2016-08-22: Replaced with a single-pass parser working straight on the mapped file, optionally split across threads.
 
 #include "ObjReader.h"
 #include <iostream>
 #include <cstring>
+#include <cmath>
 #include "Timer/Timer.h"
+#include "File/MappedFile.h"
+#include "Thread/JobPool.h"
 
 // #include <GL/glew.h>
 #include "Mesh/Mesh.h"
 
+/// Default ObjReader::parallelThreshold.
+#define OBJ_PARALLEL_THRESHOLD (8 * 1024 * 1024)
+/// Chunks per thread, so that threads finishing early can take another one.
+#define OBJ_CHUNKS_PER_THREAD 4
+
+/// Types of lines we care about.
+enum objLineTypes {
+	OBJ_OTHER,
+	OBJ_VERTEX,
+	OBJ_UV,
+	OBJ_NORMAL,
+	OBJ_FACE,
+};
+
+/// Part of the file, parsed by one job. Starts at the start of a line.
+struct ObjChunk 
+{
+	const char * begin, * end;
+	/// Amount of each found in this chunk, by the count pass.
+	int vertices, uvs, normals, faces;
+	/// Index in the mesh's arrays of the first of each in this chunk.
+	int firstVertex, firstUV, firstNormal, firstFace;
+};
+
+/// Shared by the jobs.
+struct ObjParse 
+{
+	Mesh * mesh;
+	List<ObjChunk> chunks;
+};
 
-bool ObjReader::ReadObj(const char * filename, Mesh * mesh)
+inline bool IsObjSpace(char c)
 {
-	std::cout<<"\n\nReadObj called for file: "<<filename;
-	Timer t;
-	t.Start();
-	/// Make sure the mesh doesn't already contain data?
-	char * data;
-	// Size of read data
-	int size;
+	return c == ' ' || c == '\t' || c == '\r';
+}
 
-	int numVertices = 0;
-	int uvCoords = 0;
-	int numNormals = 0;
-	int numFaces = 0;
+inline bool IsObjDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
 
-	try {
+inline const char * SkipSpaces(const char * p, const char * end)
+{
+	while (p < end && IsObjSpace(*p))
+		++p;
+	return p;
+}
 
-		std::fstream fileStream;
-		fileStream.open(filename, std::ios_base::in);
-		if (!fileStream.is_open()){
-		    std::cout<<"\nUnable to open stream to file "<<filename<<" in ObjReader";
-			return false;
-        }
+/// Returns start of the next line.
+inline const char * NextLine(const char * p, const char * end)
+{
+	const char * newLine = (const char*) memchr(p, '\n', end - p);
+	return newLine ? newLine + 1 : end;
+}
 
-		int start  = (int) fileStream.tellg();
+/// Identifies the line starting at p, moving p past the keyword.
+inline int LineType(const char *& p, const char * end)
+{
+	p = SkipSpaces(p, end);
+	if (end - p < 2)
+		return OBJ_OTHER;
+	if (p[0] == 'v')
+	{
+		if (IsObjSpace(p[1]))
+		{
+			p += 2;
+			return OBJ_VERTEX;
+		}
+		if (end - p < 3 || !IsObjSpace(p[2]))
+			return OBJ_OTHER;
+		int type = p[1] == 't' ? OBJ_UV : p[1] == 'n' ? OBJ_NORMAL : OBJ_OTHER;
+		if (type != OBJ_OTHER)
+			p += 3;
+		return type;
+	}
+	if (p[0] == 'f' && IsObjSpace(p[1]))
+	{
+		p += 2;
+		return OBJ_FACE;
+	}
+	return OBJ_OTHER;
+}
 
-		// Get size by seeking to end of file
-		fileStream.seekg( 0, std::ios::end );
-		size = (int) fileStream.tellg();
+/// Powers of 10 exactly representable as doubles.
+static const double powersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-		// Allocate data array for length
-		data = new char [size+5];
-		memset(data, 0, size+5);
+/** Parses a decimal float, with optional sign, fraction and exponent, starting at p. 
+	Returns the position after it, or p if there was none, in which case value is set to 0.
+*/
+const char * ParseObjFloat(const char * p, const char * end, float & value)
+{
+	const char * start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		++p;
+	}
+	unsigned long long mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool anyDigits = false;
+	for (; p < end && IsObjDigit(*p); ++p)
+	{
+		anyDigits = true;
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa)
+				++digits;
+		}
+		else
+			++exponent;
+	}
+	if (p < end && *p == '.')
+	{
+		for (++p; p < end && IsObjDigit(*p); ++p)
+		{
+			anyDigits = true;
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa)
+					++digits;
+				--exponent;
+			}
+		}
+	}
+	if (!anyDigits)
+	{
+		value = 0;
+		return start;
+	}
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char * e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+'))
+		{
+			negativeExponent = *e == '-';
+			++e;
+		}
+		if (e < end && IsObjDigit(*e))
+		{
+			int exp = 0;
+			for (; e < end && IsObjDigit(*e); ++e)
+				if (exp < 10000)
+					exp = exp * 10 + (*e - '0');
+			exponent += negativeExponent ? -exp : exp;
+			p = e;
+		}
+	}
+	double result = (double) mantissa;
+	if (exponent < 0)
+		result /= -exponent <= 22 ? powersOf10[-exponent] : pow(10.0, -exponent);
+	else if (exponent > 0)
+		result *= exponent <= 22 ? powersOf10[exponent] : pow(10.0, exponent);
+	value = (float) (negative ? -result : result);
+	return p;
+}
 
-		// Go to beginning of file and read the data
-		fileStream.seekg( 0, std::ios::beg);
-		fileStream.read((char*) data, size);
+/// Parses an integer with optional sign starting at p. Returns the position after it, or p if there was none.
+inline const char * ParseObjInt(const char * p, const char * end, int & value)
+{
+	const char * start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		++p;
+	}
+	if (p >= end || !IsObjDigit(*p))
+		return start;
+	int result = 0;
+	for (; p < end && IsObjDigit(*p); ++p)
+		result = result * 10 + (*p - '0');
+	value = negative ? -result : result;
+	return p;
+}
 
-		// Then close the stream
-		fileStream.close();
-	} catch (...){
-		return false;
+/// Parses up to given amount of floats, leaving the rest 0. Stops at the end of the line.
+inline const char * ParseObjFloats(const char * p, const char * end, float * values, int count)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		p = SkipSpaces(p, end);
+		const char * next = ParseObjFloat(p, end, values[i]);
+		if (next == p)
+		{
+			for (; i < count; ++i)
+				values[i] = 0;
+			break;
+		}
+		p = next;
 	}
-	int64 allocationTime = t.GetMs();
-	std::cout<<"\nFile load raw data buffer allocationTime: "<<allocationTime;
+	return p;
+}
 
+/// Converts an index from the file, which starts at 1, or is relative to the end if negative.
+inline int ObjIndex(int index, int countSoFar)
+{
+	return index < 0 ? countSoFar + index : index - 1;
+}
 
-	t.Start();
-	/// Try with our own string-class too.
-	String stringData = data;
-	List<String> lines = stringData.GetLines();
-	int64 time = t.GetMs();
-	std::cout<<"\nAllocating stringData and List<String> lines out of the raw data: "<<time;
-	t.Start();
-	/// Now delete the data, too.
-	delete[] data;
-	data = NULL;
-	int64 deallocationTime = t.GetMs();
-	std::cout<<"\nDeallocation time for raw char[] data: "<<deallocationTime;
+/// Counts the lines of each type in the chunk.
+void CountObjChunk(int index, void * data)
+{
+	ObjChunk & chunk = ((ObjParse*) data)->chunks[index];
+	chunk.vertices = chunk.uvs = chunk.normals = chunk.faces = 0;
+	for (const char * line = chunk.begin; line < chunk.end; line = NextLine(line, chunk.end))
+	{
+		const char * p = line;
+		switch(LineType(p, chunk.end))
+		{
+			case OBJ_VERTEX: ++chunk.vertices; break;
+			case OBJ_UV: ++chunk.uvs; break;
+			case OBJ_NORMAL: ++chunk.normals; break;
+			case OBJ_FACE: ++chunk.faces; break;
+		}
+	}
+}
 
-	t.Start();
-	/// Perform initial count-parse.
-	bool newSearch = true;
-	bool oldSearch = false;
-	if (newSearch){
-		for (int i = 0; i < lines.Size(); ++i)
+/// Parses the chunk's lines straight into the mesh's arrays, starting at the indices found by the count pass.
+void ParseObjChunk(int index, void * data)
+{
+	ObjParse & parse = *(ObjParse*) data;
+	ObjChunk & chunk = parse.chunks[index];
+	Mesh * mesh = parse.mesh;
+	int vertex = chunk.firstVertex, uv = chunk.firstUV, normal = chunk.firstNormal, face = chunk.firstFace;
+	float values[3];
+	for (const char * line = chunk.begin; line < chunk.end; )
+	{
+		const char * lineEnd = NextLine(line, chunk.end);
+		const char * p = line;
+		switch(LineType(p, lineEnd))
 		{
-			String line = lines[i];
-			if (line.StartsWith("v "))
-				++numVertices;
-			else if (line.StartsWith("vt "))
-				++uvCoords;
-			else if (line.StartsWith("vn "))
-				++numNormals;
-			else if (line.StartsWith("f "))
-				++numFaces;
+			case OBJ_VERTEX:
+				ParseObjFloats(p, lineEnd, values, 3);
+				mesh->vertices[vertex++] = Vector3f(values[0], values[1], values[2]);
+				break;
+			case OBJ_UV:
+				ParseObjFloats(p, lineEnd, values, 2);
+				mesh->uvs[uv++] = Vector2f(values[0], values[1]);
+				break;
+			case OBJ_NORMAL:
+				ParseObjFloats(p, lineEnd, values, 3);
+				mesh->normals[normal++] = Vector3f(values[0], values[1], values[2]);
+				break;
+			case OBJ_FACE:
+			{
+				/// Count the vertices first, to allocate the face's arrays once.
+				int faceVertices = 0;
+				for (const char * q = SkipSpaces(p, lineEnd); q < lineEnd && *q != '\n'; q = SkipSpaces(q, lineEnd))
+				{
+					++faceVertices;
+					while (q < lineEnd && !IsObjSpace(*q) && *q != '\n')
+						++q;
+				}
+				MeshFace & mf = mesh->faces[face++];
+				mf.numVertices = faceVertices;
+				mf.AllocateArrays();
+				for (int i = 0; i < faceVertices; ++i)
+				{
+					/// v, v/vt, v/vt/vn or v//vn
+					int value = 0;
+					p = SkipSpaces(p, lineEnd);
+					p = ParseObjInt(p, lineEnd, value);
+					mf.vertices[i] = ObjIndex(value, vertex);
+					mf.uvs[i] = mf.normals[i] = 0;
+					if (p < lineEnd && *p == '/')
+					{
+						++p;
+						value = 0;
+						const char * next = ParseObjInt(p, lineEnd, value);
+						if (next != p)
+							mf.uvs[i] = ObjIndex(value, uv);
+						p = next;
+						if (p < lineEnd && *p == '/')
+						{
+							++p;
+							value = 0;
+							next = ParseObjInt(p, lineEnd, value);
+							if (next != p)
+								mf.normals[i] = ObjIndex(value, normal);
+							p = next;
+						}
+					}
+					/// Skip anything else in the token.
+					while (p < lineEnd && !IsObjSpace(*p) && *p != '\n')
+						++p;
+				}
+				break;
+			}
 		}
+		line = lineEnd;
 	}
-	int64 parseTime = t.GetMs();
-	std::cout<<"\nInitial count-parse time: "<<parseTime;
+}
+
+int ObjReader::parallelThreshold = OBJ_PARALLEL_THRESHOLD;
 
+/** Attempts to read an OBJ-file from the specified filename. If successful the mesh is loaded into the provided mesh.
+	The file is mapped and parsed in place in two passes: one counting the vertices, uvs, normals and faces, and one parsing them straight into the mesh's arrays.
+	Files larger than parallelThreshold are split into chunks at line boundaries and parsed on the given job pool, if any. Others are parsed on the calling thread.
+*/
+bool ObjReader::ReadObj(const char * filename, Mesh * mesh, JobPool * jobPool)
+{
+	Timer t;
+	t.Start();
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		std::cout<<"\nUnable to open file "<<filename<<" in ObjReader";
+		return false;
+	}
+	const char * data = file.Data();
+	const char * end = data + file.Size();
+
+	/// Split into chunks at line boundaries.
+	int numChunks = 1;
+	if (jobPool && file.Size() > parallelThreshold)
+		numChunks = (jobPool->Workers() + 1) * OBJ_CHUNKS_PER_THREAD;
+	ObjParse parse;
+	parse.mesh = mesh;
+	const char * chunkBegin = data;
+	for (int i = 0; i < numChunks && chunkBegin < end; ++i)
+	{
+		const char * chunkEnd = end;
+		if (i < numChunks - 1)
+		{
+			chunkEnd = data + file.Size() * (i + 1) / numChunks;
+			if (chunkEnd < chunkBegin)
+				chunkEnd = chunkBegin;
+			chunkEnd = NextLine(chunkEnd, end);
+		}
+		ObjChunk chunk;
+		memset(&chunk, 0, sizeof(ObjChunk));
+		chunk.begin = chunkBegin;
+		chunk.end = chunkEnd;
+		parse.chunks.AddItem(chunk);
+		chunkBegin = chunkEnd;
+	}
+	numChunks = parse.chunks.Size();
+
+	/// Count pass.
+	if (numChunks > 1)
+		jobPool->ParallelFor(numChunks, CountObjChunk, &parse);
+	else if (numChunks == 1)
+		CountObjChunk(0, &parse);
+	int numVertices = 0, numUVs = 0, numNormals = 0, numFaces = 0;
+	for (int i = 0; i < numChunks; ++i)
+	{
+		ObjChunk & chunk = parse.chunks[i];
+		chunk.firstVertex = numVertices;
+		chunk.firstUV = numUVs;
+		chunk.firstNormal = numNormals;
+		chunk.firstFace = numFaces;
+		numVertices += chunk.vertices;
+		numUVs += chunk.uvs;
+		numNormals += chunk.normals;
+		numFaces += chunk.faces;
+	}
 	/// If bad, return.
 	if (numFaces <= 0)
 		return false;
 
-	t.Start();
-
-	// Find out how many numVertices are in the file.
 	mesh->numVertices = numVertices;
-	mesh->numUVs = uvCoords;
-	// Find out how many numFaces are in the file.
+	mesh->numUVs = numUVs;
 	mesh->numFaces = numFaces;
-	mesh->numNormals = numNormals;
-
-	bool hadNormals = false;
-	// Allocate the necessary numNormals
-	if (numNormals > 0 ){
-		hadNormals = true;
-	}
-	else {
-		// Or as many as there are numFaces if we ahve to generate them!
-		mesh->numNormals = numFaces;
-	}
-
-
-	/// allocate them arrays
+	bool hadNormals = numNormals > 0;
+	// Or as many as there are numFaces if we have to generate them!
+	mesh->numNormals = hadNormals ? numNormals : numFaces;
 	mesh->AllocateArrays();
 
+	/// Parse pass.
+	if (numChunks > 1)
+		jobPool->ParallelFor(numChunks, ParseObjChunk, &parse);
+	else
+		ParseObjChunk(0, &parse);
 
-	allocationTime = t.GetMs();
-	std::cout<<"\nSecond allocationTime: "<<allocationTime;
-
- //   std::cout<<"\nMesh after allocation.";
-//	mesh->PrintContents();
-
-
-	/// Print some debug info
-	std::cout<<"\n"<<filename<<" successfully read! \nParsing data:";
-	std::cout<<"\n- "<<mesh->numVertices<<" numVertices";
-	std::cout<<"\n- "<<mesh->numFaces<<" numFaces";
-	std::cout<<"\n- "<<mesh->numUVs<<" numUVs";
-	std::cout<<"\n- "<<mesh->numNormals<<" numNormals";
-
-	
-	t.Start();
-
-	char row[128];
-	memset(row, 0, 128);
-	char * rPtr = &row[0];
-	// Now do the actual loading from the raw data.
-	char * ptr = data;
-
-	int verticesRead = 0;
-	int uvsRead = 0;
-	int normalsRead = 0;
-	int facesRead = 0;
-
-	std::cout<<"\nParsing rows";
-
-    /// Parse every row.. bettar!
-    for (int i = 0; i < lines.Size(); ++i)
+	/// Validate indices, as the rest of the engine trusts them.
+	for (int i = 0; i < numFaces; ++i)
 	{
-		if (i % 10000 == 0)
-			std::cout<<"\n"<<i<<" of "<<lines.Size()<<" lines parsed.";
-		String line = lines[i];
-	//	std::cout<<"\nParsing row: "<<line;
-        // Split row into tokens
-       	List<String> tokens = line.Tokenize(" ");
-	//	std::cout<<"\nTokenized";
-		if (tokens.Size() < 1)
-			continue;
-		String type = tokens[0];
-	//	std::cout<<"\nType fetch o/o"<<line;
-        // Read in vertices values and save them
-		if (type.Contains("#"))
-			continue;
-        else if (type == "v"){
-			if (tokens.Size() < 4)
-				continue;
-			mesh->vertices[verticesRead] = Vector3f(tokens[1].ParseFloat(),tokens[2].ParseFloat(),tokens[3].ParseFloat());
-   //         std::cout<<"\nVertex parsed: "<<mesh->vertices[verticesRead]<< " (verticesRead: "<<verticesRead<<")";
-            ++verticesRead;
-        }
-        // Read in vertices texture mapping coordinates and save them
-        else if (type == "vt")
+		MeshFace & mf = mesh->faces[i];
+		for (int j = 0; j < mf.numVertices; ++j)
 		{
-			if (tokens.Size() < 3)
-				continue;
-            mesh->uvs[uvsRead][0] = tokens[1].ParseFloat();
-            mesh->uvs[uvsRead][1] = tokens[2].ParseFloat();
-            ++uvsRead;
-        }
-        // Read in vertices normals mapping coordinates and save them
-        else if (type == "vn")
-		{
-			if (tokens.Size() < 4)
-				continue;
-            mesh->normals[normalsRead] = Vector3f(tokens[1].ParseFloat(),tokens[2].ParseFloat(),tokens[3].ParseFloat());
-            ++normalsRead;
-        }
-        // Read in faces values and save them
-        else if (type == "f")
-		{
-			int faceVertices = tokens.Size() - 1;
-			MeshFace * faces = &mesh->faces[facesRead];
-            // Allocate the faces number of vertexes depending on the vertexTokens found.
-            faces->numVertices = faceVertices;
-			faces->AllocateArrays();
-            // Nullify
-			memset(faces->vertices.GetArray(), 0, sizeof(unsigned int) * faceVertices);
-			memset(faces->uvs.GetArray(), 0, sizeof(unsigned int) * faceVertices);
-			memset(faces->normals.GetArray(), 0, sizeof(unsigned int) * faceVertices);
-	
-			// If more numFaces to add, take note of it now, since we want to triangulize everything? Eh? o.O
-			if (faceVertices > 3){
-                int facesToAdd = faceVertices - 3;
-            }
-
-			List<String> faceVertexTokens = tokens;
-			bool success = faceVertexTokens.RemoveIndex(0, ListOption::RETAIN_ORDER);
-			assert(success);
-            
-			// Go through all vertices tokens that were found and tokenize again...
-			for	(int i = 0; i < faceVertexTokens.Size(); ++i)
+			if (mf.vertices[j] < 0 || mf.vertices[j] >= numVertices ||
+				(numUVs && (mf.uvs[j] < 0 || mf.uvs[j] >= numUVs)) ||
+				(hadNormals && (mf.normals[j] < 0 || mf.normals[j] >= numNormals)))
 			{
-                // Extra care for files with just numVertices and numNormals..
-                // Count slashes before the tokenizer enters any null-signs
-                int slashes = 0;
-				String faceVertexData = faceVertexTokens[i];
-				slashes = faceVertexData.Count('/');
-				List<String> faceVertexDataTokens = faceVertexData.Tokenize("/");
-				/// Amount of "indices" found for this faces's vertices. That is, the indexes of this vertices' position, uvs and/or normals.
-				int numFaceVertexDataTokens = faceVertexDataTokens.Size();
-                // Regular numFaces without any spacing.
-				if (slashes == numFaceVertexDataTokens - 1)
-				{
-					switch(numFaceVertexDataTokens){
-                    case 3:
-                        // Normal vertices
-                        mesh->faces[facesRead].normals[i] = faceVertexDataTokens[2].ParseInt() - 1;	// -1 since they begin counting at 1!
-                    case 2:
-                        // UV Vertex
-                        mesh->faces[facesRead].uvs[i] = faceVertexDataTokens[1].ParseInt() - 1;		// -1 since they begin counting at 1!
-                    case 1:
-                        // Carteesian vertices
-                        mesh->faces[facesRead].vertices[i] = faceVertexDataTokens[0].ParseInt() - 1;	// -1 since they begin counting at 1!
-                        break;
-                    }
-                }
-                // Assume 2 slashes and just 2 tokens: vertices + normals
-                else if (slashes == 2 && numFaceVertexDataTokens == 2){
-                    // Normal vertices
-                    mesh->faces[facesRead].normals[i] = faceVertexDataTokens[1].ParseInt() - 1;	// -1 since they begin counting at 1!
-                    // Carteesian vertices
-                    mesh->faces[facesRead].vertices[i] = faceVertexDataTokens[0].ParseInt() - 1;	// -1 since they begin counting at 1!
-                }
-    //            std::cout<<"\nmesh->faces[facesRead:"<<facesRead<<"].vertices[i]: "<<mesh->faces[facesRead].vertices[i];
-                assert(mesh->faces[facesRead].vertices[i] < 3000000);
+				std::cout<<"\nInvalid index in face "<<i<<" of "<<filename;
+				return false;
+			}
+		}
+	}
 
-            } // End of parsing this faces.
-            // If we didn't have any numNormals, generate them now!
-            if (!hadNormals)
+	// If we didn't have any numNormals, generate them now, one per face.
+	if (!hadNormals)
+	{
+		for (int i = 0; i < numFaces; ++i)
+		{
+			MeshFace * f = &mesh->faces[i];
+			if (f->numVertices >= 3)
 			{
-                MeshFace * f = &mesh->faces[facesRead];
-                Vector3f side1, side2;
-                side1 = mesh->vertices[f->vertices[1]] - mesh->vertices[f->vertices[0]];
-                side2 = mesh->vertices[f->vertices[2]] - mesh->vertices[f->vertices[0]];
-                mesh->normals[facesRead] = side1.CrossProduct(side2).NormalizedCopy();
-                // Link "all the numNormals" in the faces to this created one.
-                for (int j = 0; j < faceVertices; ++j)
-                    f->normals[j] = facesRead;
-            }
-
-            ++facesRead;
-        }	// End of reading in faces
-	}	// End of while-loop reading through all data
+				Vector3f side1 = mesh->vertices[f->vertices[1]] - mesh->vertices[f->vertices[0]];
+				Vector3f side2 = mesh->vertices[f->vertices[2]] - mesh->vertices[f->vertices[0]];
+				mesh->normals[i] = side1.CrossProduct(side2).NormalizedCopy();
+			}
+			// Link "all the numNormals" in the faces to this created one.
+			for (int j = 0; j < f->numVertices; ++j)
+				f->normals[j] = i;
+		}
+	}
 
 	/// Set source name at least
 	mesh->name = filename;
 	mesh->source = filename;
 
-	parseTime = t.GetMs();
-	std::cout<<"\nSecond major Parse time: "<<parseTime;
-
+	t.Stop();
 	/// Print some debug info
-	std::cout<<"\n"<<mesh->source<<" successfully read! \nParsing data:";
+	std::cout<<"\n"<<filename<<" successfully read in "<<t.GetMs()<<" ms using "<<numChunks<<" chunks:";
 	std::cout<<"\n- "<<mesh->numVertices<<" numVertices";
 	std::cout<<"\n- "<<mesh->numFaces<<" numFaces";
 	std::cout<<"\n- "<<mesh->numUVs<<" numUVs";
 	std::cout<<"\n- "<<mesh->numNormals<<" numNormals";
-
 	return true;
 }
-
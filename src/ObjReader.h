@@ -9,15 +9,27 @@ Abused file: http://3dexport.com/3dmodel-wooden-box-open-39443.htm
 #include <sstream>
 
 class Mesh;
+class JobPool;
 
 /// Custom OBJ-reader class.
 class ObjReader {
 public:
 	/** Attempts to read an OBJ-file from the specified filename. If successful the mesh is loaded into the provided mesh.
-		Vertex Buffer Objects (VBOs) are generated automatically upon loading, and their respective IDs are stored in the mesh as well.
+		The file is mapped and parsed in place in two passes: one counting the vertices, uvs, normals and faces, and one parsing them straight into the mesh's arrays.
+		Files larger than parallelThreshold are split into chunks at line boundaries and parsed on the given job pool, if any. Others are parsed on the calling thread.
 	*/
-	static bool ReadObj(const char * filename, Mesh * mesh);
+	static bool ReadObj(const char * filename, Mesh * mesh, JobPool * jobPool = NULL);
+	/// Size in bytes above which files are parsed on the job pool given to ReadObj. Default 8 MB.
+	static int parallelThreshold;
 
+	/** Writes a grid of given amount of quads with uvs and normals to given path, then times reading it with ReadObj, 
+		single- and multi-threaded, against the previous reader which split the file into Strings line by line. Prints the results.
+		Returns false if the readers' results differ. Not run by UnitTests, see Benchmarks.
+	*/
+	static bool Benchmark(const char * path, int quads = 2000000);
+
+	/// Reads small fixture files with and without job pools, asserting on the results.
+	static void UnitTest();
 };
 
 #endif
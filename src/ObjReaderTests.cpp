@@ -0,0 +1,108 @@
+/// Emil Hedemalm
+/// 2016-08-22
+/// Tests of the ObjReader on small fixture files, read both in one piece and split into chunks.
+
+#include "ObjReader.h"
+#include <cstdio>
+#include <cmath>
+#include "Thread/JobPool.h"
+#include "Mesh/Mesh.h"
+#include "File/FileUtil.h"
+
+#define OBJ_TEST_FILE	"ObjReaderUnitTest.obj"
+
+/// Quads and triangles with uvs and normals, relative indices, faces with fewer components, comments, blank lines, a CRLF line and no final newline.
+static const char * objWithNormals = 
+	"# Fixture\n"
+	"v 0 0 0\n"
+	"v 1 0 0\n"
+	"v 1 1 0\n"
+	"v 0 1 0\n"
+	"vt 0 0\n"
+	"vt 1 0\n"
+	"vt 1 1\n"
+	"vt 0 1\n"
+	"vn 0 0 1\n"
+	"\n"
+	"f 1/1/1 2/2/1 3/3/1 4/4/1\r\n"
+	"v 2 0 -0.5\n"
+	"f -3//1 -4//1 -1//1\n"
+	"f 2 5 3";
+
+/// A single triangle without normals, for which one is generated.
+static const char * objWithoutNormals = 
+	"v 0 0 0\n"
+	"v 1 0 0\n"
+	"v 0 1 0\n"
+	"f 1 2 3\n";
+
+static bool WriteObjTestFile(const char * path, const char * contents)
+{
+	FILE * file = fopen(path, "wb");
+	if (!file)
+		return false;
+	fwrite(contents, 1, strlen(contents), file);
+	fclose(file);
+	return true;
+}
+
+static void AssertFace(const MeshFace & face, int a, int b, int c, int d = -1)
+{
+	int expected[4] = {a, b, c, d};
+	assert(face.numVertices == (d >= 0 ? 4 : 3));
+	for (int i = 0; i < face.numVertices; ++i)
+		assert(face.vertices[i] == expected[i]);
+}
+
+/// Reads the fixtures, written to the temporary folder, with and without job pools. The latter split even these small files into several chunks.
+void ObjReader::UnitTest()
+{
+	String path = GetTemporaryFolder() + OBJ_TEST_FILE;
+	int defaultThreshold = parallelThreshold;
+	parallelThreshold = 0;
+	JobPool callerOnly(0), twoWorkers(2);
+	JobPool * pools[3] = {NULL, &callerOnly, &twoWorkers};
+	/// Done outside the asserts, so that the files are still written and read without them.
+	bool written, read;
+	for (int p = 0; p < 3; ++p)
+	{
+		written = WriteObjTestFile(path.c_str(), objWithNormals);
+		assert(written);
+		Mesh mesh;
+		read = ReadObj(path.c_str(), &mesh, pools[p]);
+		assert(read);
+		assert(mesh.numVertices == 5 && mesh.numUVs == 4 && mesh.numNormals == 1 && mesh.numFaces == 3);
+		assert((mesh.vertices[2] - Vector3f(1, 1, 0)).Length() < 0.0001f);
+		assert((mesh.vertices[4] - Vector3f(2, 0, -0.5f)).Length() < 0.0001f);
+		assert(fabs(mesh.uvs[2].x - 1) + fabs(mesh.uvs[2].y - 1) < 0.0001f);
+		assert((mesh.normals[0] - Vector3f(0, 0, 1)).Length() < 0.0001f);
+
+		AssertFace(mesh.faces[0], 0, 1, 2, 3);
+		for (int i = 0; i < 4; ++i)
+			assert(mesh.faces[0].uvs[i] == i && mesh.faces[0].normals[i] == 0);
+		/// Relative to the 5 vertices read before it.
+		AssertFace(mesh.faces[1], 2, 1, 4);
+		AssertFace(mesh.faces[2], 1, 4, 2);
+
+		written = WriteObjTestFile(path.c_str(), objWithoutNormals);
+		assert(written);
+		Mesh generated;
+		read = ReadObj(path.c_str(), &generated, pools[p]);
+		assert(read);
+		assert(generated.numVertices == 3 && generated.numNormals == 1 && generated.numFaces == 1);
+		AssertFace(generated.faces[0], 0, 1, 2);
+		assert((generated.normals[0] - Vector3f(0, 0, 1)).Length() < 0.0001f);
+		for (int i = 0; i < 3; ++i)
+			assert(generated.faces[0].normals[i] == 0);
+	}
+	parallelThreshold = defaultThreshold;
+	/// No faces, nothing to read.
+	written = WriteObjTestFile(path.c_str(), "v 0 0 0\n");
+	assert(written);
+	Mesh empty;
+	read = ReadObj(path.c_str(), &empty);
+	assert(!read);
+	remove(path.c_str());
+	(void) written;
+	(void) read;
+}
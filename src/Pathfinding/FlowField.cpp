@@ -0,0 +1,146 @@
+/// Emil Hedemalm
+/// 2016-08-16
+/// Flow field (Dijkstra map) towards a single goal waypoint, shared by all entities heading there.
+
+#include "FlowField.h"
+#include "NavMesh.h"
+#include "WaypointHeap.h"
+#include <cfloat>
+
+/// Per-thread open set, re-used between builds.
+static thread_local WaypointHeap flowFieldHeap;
+
+FlowField::FlowField(Waypoint * goal)
+: lastUsed(0), goal(goal), navMesh(NULL), version(0)
+{
+}
+
+/// Integrates costs from the goal over given navmesh.
+void FlowField::Build(NavMesh * nm)
+{
+	navMesh = nm;
+	version = nm->Version();
+	List<Waypoint*> & waypoints = nm->waypoints;
+	int numWaypoints = waypoints.Size();
+	next.Allocate(numWaypoints, true);
+	cost.Allocate(numWaypoints, true);
+	for (int i = 0; i < numWaypoints; ++i)
+	{
+		next[i] = -1;
+		cost[i] = FLT_MAX;
+	}
+	int goalIndex = nm->GetIndex(goal);
+	if (goalIndex < 0)
+		return;
+
+	WaypointHeap & openSet = flowFieldHeap;
+	openSet.Reset(numWaypoints);
+	cost[goalIndex] = 0;
+	openSet.Push(goalIndex, 0);
+	while (!openSet.IsEmpty())
+	{
+		int currentIndex = openSet.Pop();
+		Waypoint * current = waypoints[currentIndex];
+		/// Entities may stand on impassable waypoints and still leave them, as in AStar, but no path leads through them.
+		if (!current->passable && current != goal)
+			continue;
+		float currentCost = cost[currentIndex];
+		for (int i = 0; i < current->neighbours; ++i)
+		{
+			Waypoint * neighbour = current->neighbour[i];
+			int index = neighbour->index;
+			if (index < 0)
+				continue;
+			float tentativeCost = currentCost + (neighbour->position - current->position).Length();
+			if (tentativeCost >= cost[index])
+				continue;
+			bool queued = cost[index] != FLT_MAX;
+			cost[index] = tentativeCost;
+			next[index] = currentIndex;
+			if (queued)
+				openSet.DecreaseKey(index, tentativeCost);
+			else
+				openSet.Push(index, tentativeCost);
+		}
+	}
+}
+
+/// If built from the current version of given navmesh.
+bool FlowField::IsValid(NavMesh * nm) const
+{
+	return navMesh == nm && version == nm->Version();
+}
+
+/// Returns the dense index of the waypoint in the field, or -1 if it is not part of it.
+int FlowField::IndexOf(Waypoint * wp) const
+{
+	if (!navMesh)
+		return -1;
+	int index = navMesh->GetIndex(wp);
+	if (index >= next.Size())
+		return -1;
+	return index;
+}
+
+/// Returns the neighbour to move to from given waypoint, the goal itself if already there, or NULL if the goal cannot be reached.
+Waypoint * FlowField::Next(Waypoint * from) const
+{
+	if (from == goal)
+		return goal;
+	int index = IndexOf(from);
+	if (index < 0 || next[index] < 0 || next[index] >= navMesh->waypoints.Size())
+		return NULL;
+	return navMesh->waypoints[next[index]];
+}
+
+/** As Next, for a field which is no longer valid for given navmesh: only returns the step if it is still a passable neighbour of from.
+	Returns NULL if the field was built from another navmesh.
+*/
+Waypoint * FlowField::StaleNext(Waypoint * from, NavMesh * nm) const
+{
+	if (nm != navMesh)
+		return NULL;
+	Waypoint * step = Next(from);
+	if (!step || step == from)
+		return step;
+	/// Indices shift as waypoints are removed, so the step may not even be a neighbour any more.
+	if (!step->passable && step != goal)
+		return NULL;
+	for (int i = 0; i < from->neighbours; ++i)
+		if (from->neighbour[i] == step)
+			return step;
+	return NULL;
+}
+
+/// Returns the cost of the shortest path from given waypoint to the goal, or FLT_MAX if it cannot be reached.
+float FlowField::CostToGoal(Waypoint * from) const
+{
+	int index = IndexOf(from);
+	if (index < 0)
+		return FLT_MAX;
+	return cost[index];
+}
+
+/// Walks the field from given waypoint to the goal, storing the path in order from -> goal. Returns false if the goal cannot be reached.
+bool FlowField::GetPath(Waypoint * from, Path & path) const
+{
+	path.Clear();
+	if (CostToGoal(from) == FLT_MAX)
+		return false;
+	Waypoint * current = from;
+	path.AddItem(current);
+	/// The field is acyclic, but guard against it being used on a since modified navmesh.
+	for (int steps = 0; current != goal && steps < next.Size(); ++steps)
+	{
+		current = Next(current);
+		if (!current)
+			break;
+		path.AddItem(current);
+	}
+	if (current != goal)
+	{
+		path.Clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,54 @@
+/// Emil Hedemalm
+/// 2016-08-16
+/// Flow field (Dijkstra map) towards a single goal waypoint, shared by all entities heading there.
+
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "Path.h"
+
+class NavMesh;
+
+/** Integration field over a NavMesh towards one goal waypoint.
+	Build runs a single Dijkstra search outwards from the goal, storing for every waypoint its cost to the goal and the
+	neighbour to move to next. Any number of entities may then look up their next waypoint in O(1), or walk out a full path,
+	instead of running one search each. Neighbour connections are assumed to be symmetric.
+
+	The field is tied to the NavMesh version it was built from, see NavMesh::Version, and must be re-built once it is no longer valid.
+*/
+class FlowField 
+{
+public:
+	FlowField(Waypoint * goal);
+	/// Integrates costs from the goal over given navmesh.
+	void Build(NavMesh * navMesh);
+	/// If built from the current version of given navmesh.
+	bool IsValid(NavMesh * navMesh) const;
+
+	/// Returns the neighbour to move to from given waypoint, the goal itself if already there, or NULL if the goal cannot be reached.
+	Waypoint * Next(Waypoint * from) const;
+	/** As Next, for a field which is no longer valid for given navmesh: only returns the step if it is still a passable neighbour of from.
+		Returns NULL if the field was built from another navmesh.
+	*/
+	Waypoint * StaleNext(Waypoint * from, NavMesh * navMesh) const;
+	/// Returns the cost of the shortest path from given waypoint to the goal, or FLT_MAX if it cannot be reached.
+	float CostToGoal(Waypoint * from) const;
+	/// Walks the field from given waypoint to the goal, storing the path in order from -> goal. Returns false if the goal cannot be reached.
+	bool GetPath(Waypoint * from, Path & path) const;
+
+	Waypoint * Goal() const { return goal; };
+	/// Stamp of last use, for eviction by the PathManager.
+	unsigned int lastUsed;
+private:
+	/// Returns the dense index of the waypoint in the field, or -1 if it is not part of it.
+	int IndexOf(Waypoint * wp) const;
+	Waypoint * goal;
+	NavMesh * navMesh;
+	unsigned int version;
+	/// Index of the next waypoint towards the goal, per waypoint index. -1 for the goal and unreachable waypoints.
+	List<int> next;
+	/// Cost to the goal per waypoint index.
+	List<float> cost;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <ctime>
 
 #include "PhysicsLib/Shapes/Ray.h"
+#include "PathHierarchy.h"
 
 /// An organization of waypoints that are interconnected somehow, like a map.
 NavMesh::NavMesh(){
@@ -18,8 +19,11 @@ NavMesh::NavMesh(){
 	waypointArraySize = 0;
 	optimized = false;
 	idCounter = 0;
+	version = 0;
+	hierarchy = NULL;
 }
 NavMesh::~NavMesh(){
+	DeleteHierarchy();
 	CLEAR_AND_DELETE(waypoints);
 
 	/// Deallocate map data array
@@ -36,6 +40,10 @@ NavMesh::~NavMesh(){
 /// Deletes all waypoints.
 void NavMesh::Clear(){
 	CLEAR_AND_DELETE(waypoints);
+	++version;
+	grid.Clear();
+	if (hierarchy)
+		hierarchy->Build();
 }
 
 /// Loads from target navmesh file (specific to this system)
@@ -146,16 +154,48 @@ int NavMesh::AddWaypoint(Waypoint * wp)
 		}
 		wp->id = idCounter++;
 	}
+	wp->index = waypoints.Size();
 	waypoints.Add(wp);
+	++version;
+	if (grid.IsBuilt())
+		grid.Add(wp);
+	if (hierarchy)
+		hierarchy->OnWaypointAdded(wp);
 	return 0;
 }
 
 /// Removes a waypoint from the NavMesh, but does not clean up any remaining bindings.
 int NavMesh::RemoveWaypoint(Waypoint * wp){
-	waypoints.Remove(wp);
+	int index = GetIndex(wp);
+	if (index < 0)
+		return 1;
+	if (hierarchy)
+		hierarchy->OnWaypointRemoved(wp);
+	waypoints.RemoveIndex(index, ListOption::RETAIN_ORDER);
+	wp->index = -1;
+	++version;
+	if (grid.IsBuilt())
+		grid.Remove(wp);
+	/// Re-index all waypoints that moved down.
+	UpdateIndices(index);
 	return 1;
 }
 
+/// Re-assigns Waypoint::index for all waypoints from the given list index and onward.
+void NavMesh::UpdateIndices(int fromIndex)
+{
+	for (int i = fromIndex; i < waypoints.Size(); ++i)
+		waypoints[i]->index = i;
+}
+
+/// Builds the spatial grid if it has not been built, or if the waypoint count has grown a lot since it was built.
+void NavMesh::EnsureGrid()
+{
+	if (grid.IsBuilt() && waypoints.Size() <= grid.BuiltForWaypoints() * 4 + 64)
+		return;
+	grid.Build(waypoints);
+}
+
 /// Cleans up and removes all neighbour references to this waypoint.
 int NavMesh::CleanupNeighbours(Waypoint * wp){
 	assert(wp != NULL);
@@ -165,9 +205,40 @@ int NavMesh::CleanupNeighbours(Waypoint * wp){
 		wp->RemoveNeighbour(wp->neighbour[0]);
 		++neighboursRemoved;
 	}
+	if (neighboursRemoved)
+		++version;
 	return neighboursRemoved;
 }
 
+/// Sets passability of a waypoint, bumping Version so that cached flow fields are rebuilt and notifying the path hierarchy if any. Use this instead of setting Waypoint::passable directly.
+void NavMesh::SetPassable(Waypoint * wp, bool passable)
+{
+	if (wp->passable == passable)
+		return;
+	wp->passable = passable;
+	++version;
+	if (hierarchy)
+		hierarchy->OnWaypointChanged(wp);
+}
+
+/** Builds (or re-builds) a clustered path abstraction of this navmesh, used by the PathManager for long-distance searches. 
+	Cluster size is in world units, and should be several times the distance between neighbouring waypoints.
+*/
+void NavMesh::BuildHierarchy(float clusterSize)
+{
+	DeleteHierarchy();
+	hierarchy = new PathHierarchy(this, clusterSize);
+	hierarchy->Build();
+}
+
+/// Deletes the path abstraction, if any.
+void NavMesh::DeleteHierarchy()
+{
+	if (hierarchy)
+		delete hierarchy;
+	hierarchy = NULL;
+}
+
 /// Returns a pointer to specified Waypoint, or NULL if it does not exist.
 Waypoint * NavMesh::GetWaypointById(int id) const {
 	for (int i = 0; i < waypoints.Size(); ++i){
@@ -183,20 +254,12 @@ Waypoint * NavMesh::GetWaypointById(int id) const {
 
 /// Checks if this waypoint exists in this navMesh.
 bool NavMesh::WaypointPartOf(Waypoint * wp) const {
-	Waypoint * w;
-	for (int i = 0; i < waypoints.Size(); ++i){
-		w = waypoints[i];
-		if (waypoints[i] == wp)
-			return true;
-	}
-	return false;
+	return GetIndex(wp) >= 0;
 }
-/// Gets current index of the waypoint in the array.
-int NavMesh::GetIndex(Waypoint * wp){
-	for (int i = 0; i < waypoints.Size(); ++i){
-		if (waypoints[i] == wp)
-			return i;
-	}
+/// Gets current index of the waypoint in the array. The index is maintained by AddWaypoint/RemoveWaypoint.
+int NavMesh::GetIndex(Waypoint * wp) const {
+	if (wp && wp->index >= 0 && wp->index < waypoints.Size() && waypoints[wp->index] == wp)
+		return wp->index;
 	return -1;
 }
 
@@ -548,6 +611,11 @@ void NavMesh::Scale(float scale)
 		waypoints[i]->position *= scale;
 		waypoints[i]->elevation *= scale;
 	}
+	/// All positions moved, re-build on next query.
+	++version;
+	grid.Clear();
+	if (hierarchy)
+		hierarchy->Build();
 }
 
 /// Attempts to merge all walkable waypoints depending on their distance to each other.
@@ -556,61 +624,51 @@ int NavMesh::MergeWaypointsByProximity(float maxDistance)
 	int waypointsBeforeMerge = waypoints.Size();
 	int walkablesBeforeMerge = walkables;
 	std::cout<<"\nMerging Waypoints by Proximity, maxDistance: "<<maxDistance;
-	/// Sets to merge
-	int MAX_MERGE_SETS = waypoints.Size();
-	Waypoint *** toMerge = new Waypoint ** [MAX_MERGE_SETS];
-	for (int i = 0; i < waypoints.Size(); ++i){
-		toMerge[i] = new Waypoint * [MAX_MERGE_SETS];
-	}
-	int * setSize = new int[MAX_MERGE_SETS];
-	memset(setSize, 0, sizeof(int) * waypoints.Size());
-	int setsDone = 0;
+	/// Sets to merge, stored back to back in setMembers.
+	List<Waypoint*> setMembers;
+	List<int> setStart, setSize;
+	List<Waypoint*> nearby;
+	EnsureGrid();
 	std::cout<<"\nGathering data for merges...";
 	/// Go through every waypoint
 	for (int i = 0; i < waypoints.Size(); ++i){
-		if (i%100 == 0)
+		if (i%1000 == 0)
 			std::cout<<"\n"<<i<<" out of "<<waypoints.Size()<<" processed.";
 		/// Skip unpassables
 		if (!waypoints[i]->passable)
 			continue;
 		/// Begin by adding the initial node.
-		int addedToSetSoFar = 0;
-		toMerge[setsDone][addedToSetSoFar] = waypoints[i];
-		++addedToSetSoFar;
-		/// Don't have to go through all preceding waypoints...
-		for (int j = i + 1; j < waypoints.Size(); ++j){
-			/// check that they are passable, skip the unpassables, yes?
-			if (!waypoints[j]->passable)
+		int start = setMembers.Size();
+		setMembers.AddItem(waypoints[i]);
+		nearby.Clear();
+		grid.GetWithinRadius(waypoints[i]->position, maxDistance, nearby);
+		for (int j = 0; j < nearby.Size(); ++j){
+			Waypoint * wp = nearby[j];
+			/// Don't have to go through all preceding waypoints, and skip the unpassables.
+			if (wp->index <= i || !wp->passable)
 				continue;
-			/// check distance
-			if ((waypoints[i]->position - waypoints[j]->position).Length() < maxDistance){
-				toMerge[setsDone][addedToSetSoFar] = waypoints[j];
-				++addedToSetSoFar;
-			}
+			setMembers.AddItem(wp);
 		}
 		/// Check that we added any nodes the last loop
+		int addedToSetSoFar = setMembers.Size() - start;
 		if (addedToSetSoFar > 1){
-			setSize[setsDone] = addedToSetSoFar;
-			++setsDone;
+			setStart.AddItem(start);
+			setSize.AddItem(addedToSetSoFar);
 		}
+		else 
+			setMembers.RemoveLast();
 	}
 	std::cout<<"\nRegistering merges...";
 	/// Register all merges
 	int merges = 0;
+	int setsDone = setStart.Size();
 	for (int i = 0; i < setsDone; ++i){
 		if (i % 100 == 0)
 			std::cout<<"\n"<<i<<" out of "<<setsDone<<" merges processed.";
-		if (MergeWaypoints(toMerge[i], setSize[i]))
+		if (MergeWaypoints(setMembers.GetArray() + setStart[i], setSize[i]))
 			merges++;
 	}
 
-	/// Deallocate the allocated arrays
-	for (int i = 0; i < MAX_MERGE_SETS; ++i){
-		delete[] toMerge[i];
-	}
-	delete[] toMerge;
-	delete[] setSize;
-
 	if (merges > 0)
 		optimized = true;
 
@@ -686,6 +744,7 @@ bool NavMesh::MergeWaypoints(Waypoint ** waypointList, int waypointsToMerge)
 
 	/// Flag it as merged.
 	wp->merged = true;
+	++version;
 	walkables -= waypointsToMerge - 1;
 
 	/// Check stuff
@@ -703,77 +762,55 @@ bool NavMesh::MergeWaypoints(Waypoint ** waypointList, int waypointsToMerge)
 /// Entities..
 Waypoint * NavMesh::GetClosestToRay(Ray & ray)
 {
-	float closestDot = 0.0f;
-	Waypoint * closest = NULL;
-	float dotProd = 0.0f;
-	Vector3f dir = ray.direction.NormalizedCopy();
-	for (int i = 0; i < waypoints.Size(); ++i){
-		Waypoint * wp = waypoints[i];
-		Vector3f rayStartToWp = wp->position - ray.start;
-		rayStartToWp.Normalize();
-		dotProd = rayStartToWp.DotProduct(dir);
-		if (dotProd > closestDot){
-			closest = wp;
-			closestDot = dotProd;
-		}
-	}
-	return closest;
+	EnsureGrid();
+	return grid.GetClosestToRay(ray);
 }
 
 /// If maxDistance is positive, it will limit the search within that vicinity-range. A negative number will set no limit.
 Waypoint * NavMesh::GetClosestTo(const Vector3f & position, float maxDistance /* = -1.f */){
-	float closestDist = 100000000000000.0f;
-	Waypoint * closest = NULL;
-	float sqMaxLen = maxDistance * maxDistance;
-	for (int i = 0; i < waypoints.Size(); ++i){
-		Waypoint * wp = waypoints[i];
-		float dist = (wp->position - position).LengthSquared();
-		if ((maxDistance < 0 && dist > sqMaxLen) ||
-			(maxDistance > 0 && dist > sqMaxLen))
-			continue;
-		if (dist < closestDist){
-			closest = wp;
-			closestDist = dist;
-		}
-	}
-	return closest;
+	return GetClosestTo(position, maxDistance, NULL);
+}
+/// As above, only considering waypoints for which the filter returns true.
+Waypoint * NavMesh::GetClosestTo(const Vector3f & position, float maxDistance, WaypointGrid::WaypointFilter filter)
+{
+	EnsureGrid();
+	return grid.GetClosest(position, maxDistance, filter);
+}
+
+static bool IsVacant(Waypoint * wp)
+{
+	return wp->IsVacant();
 }
+
 /// Returns vacant waypoint closest to target position
 Waypoint * NavMesh::GetClosestVacantWaypoint(const Vector3f & position)
 {
-	float closestDist = 100000000000000.0f;
-	Waypoint * closest = NULL;
-	for (int i = 0; i < waypoints.Size(); ++i){
-		Waypoint * wp = waypoints[i];
-		if (!wp->IsVacant())
-			continue;
-	//	std::cout<<"\n cppp";
-		float dist = (wp->position - position).LengthSquared();
-		if (dist < closestDist){
-			closest = wp;
-			closestDist = dist;
-		}
-	}
-	return closest;	
+	return GetClosestTo(position, -1.f, IsVacant);
 }
 
 
 /// Creates neighbour-connections automatically, using only a maximum distance. Returns number of connections made.
 int NavMesh::ConnectWaypointsByProximity(float maxDistance){
-	float squareDist = maxDistance * maxDistance;
 	int connectionsMade = 0;
+	EnsureGrid();
+	List<Waypoint*> nearby;
 	Waypoint * wp1, * wp2;
 	for (int i = 0; i < waypoints.Size(); ++i){
 		wp1 = waypoints[i];
-		for (int j = i+1; j < waypoints.Size(); ++j){
-			wp2 = waypoints[j];
-			if ((wp1->position - wp2->position).LengthSquared() < squareDist){
-				wp1->AddNeighbour(wp2);
-				wp2->AddNeighbour(wp1);
-				connectionsMade++;
-			}
+		nearby.Clear();
+		grid.GetWithinRadius(wp1->position, maxDistance, nearby);
+		for (int j = 0; j < nearby.Size(); ++j){
+			wp2 = nearby[j];
+			/// Each pair only once.
+			if (wp2->index <= i)
+				continue;
+			wp1->AddNeighbour(wp2);
+			wp2->AddNeighbour(wp1);
+			connectionsMade++;
 		}
 	}
+	if (connectionsMade)
+		++version;
 	return connectionsMade;
 }
 /// Ensures that each waypoint has atLeast neighbours.
@@ -806,6 +843,7 @@ void NavMesh::EnsureNeighbours(int atLeast){
 			}
 			wp1->AddNeighbour(closest);
 			closest->AddNeighbour(wp1);
+			++version;
 		}
 	}
 }
@@ -5,10 +5,12 @@
 #define NAV_MESH_H
 
 #include "Waypoint.h"
+#include "WaypointGrid.h"
 #include "../Globals.h"
 #include "String/AEString.h"
 
 class Ray;
+class PathHierarchy;
 
 /// An organization of waypoints that are interconnected somehow, like a map.
 class NavMesh {
@@ -53,13 +55,30 @@ public:
 	int RemoveWaypoint(Waypoint * wp);
 	/// Cleans up and removes all neighbour references to this waypoint.
 	int CleanupNeighbours(Waypoint * wp);
+	/// Sets passability of a waypoint, bumping Version so that cached flow fields are rebuilt and notifying the path hierarchy if any. Use this instead of setting Waypoint::passable directly.
+	void SetPassable(Waypoint * wp, bool passable);
+
+	/** Builds (or re-builds) a clustered path abstraction of this navmesh, used by the PathManager for long-distance searches. 
+		Cluster size is in world units, and should be several times the distance between neighbouring waypoints.
+	*/
+	void BuildHierarchy(float clusterSize);
+	/// Deletes the path abstraction, if any.
+	void DeleteHierarchy();
+	/// Returns the path abstraction, or NULL if none has been built.
+	PathHierarchy * Hierarchy() { return hierarchy; };
+
+	/** Change counter, bumped whenever waypoints, neighbours or passability change through the NavMesh' functions.
+		Used to invalidate cached data such as flow fields. Call MarkChanged if editing waypoints directly.
+	*/
+	unsigned int Version() const { return version; };
+	void MarkChanged() { ++version; };
 
 	/// Returns a pointer to specified Waypoint, or NULL if it does not exist.
 	Waypoint * GetWaypointById(int id) const;
 	/// Checks if this waypoint exists in this navMesh.
 	bool WaypointPartOf(Waypoint * wp) const;
-	/// Gets current index of the waypoint in the array.
-	int GetIndex(Waypoint * wp);
+	/// Gets current index of the waypoint in the array. O(1) using Waypoint::index.
+	int GetIndex(Waypoint * wp) const;
 
 	/** Re-load all waypoints from the original 2D reference map. */
 	int ReloadFromOriginal();
@@ -81,6 +100,8 @@ public:
 	Waypoint * GetClosestToRay(Ray & ray);
 	/// If maxDistance is positive, it will limit the search within that vicinity-range. A negative number will set no limit.
 	Waypoint * GetClosestTo(const Vector3f & position, float maxDistance = -1.f);
+	/// As above, only considering waypoints for which the filter returns true.
+	Waypoint * GetClosestTo(const Vector3f & position, float maxDistance, WaypointGrid::WaypointFilter filter);
 	/// Returns vacant waypoint closest to target position
 	Waypoint * GetClosestVacantWaypoint(const Vector3f & position);
 	
@@ -95,9 +116,19 @@ public:
 	String source;
 	String name;
 private:
+	/// Builds the spatial grid if it has not been built, or if the waypoint count has grown a lot since it was built.
+	void EnsureGrid();
+	/// Optional path abstraction, see BuildHierarchy.
+	PathHierarchy * hierarchy;
+	/// Spatial index used by the proximity queries. Kept in sync by AddWaypoint/RemoveWaypoint, cleared by Scale and Clear.
+	WaypointGrid grid;
+	/// Re-assigns Waypoint::index for all waypoints from the given list index and onward.
+	void UpdateIndices(int fromIndex);
 
 	/// An ID-counter, where IDs are set automatically when waypoints are added to the navMesh
 	int idCounter;
+	/// See Version.
+	unsigned int version;
 };
 
 #endif
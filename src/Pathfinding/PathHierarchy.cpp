@@ -0,0 +1,468 @@
+/// Emil Hedemalm
+/// 2016-08-15
+/// Hierarchical path abstraction (HPA*) over a NavMesh, for answering long-distance path queries quickly.
+
+#include "PathHierarchy.h"
+#include "NavMesh.h"
+#include "WaypointHeap.h"
+#include <cfloat>
+#include <cmath>
+#include <cassert>
+
+/// Per-thread buffers for the searches, re-used between queries.
+struct HierarchyScratch
+{
+	HierarchyScratch() : searchID(0) {};
+	/// Grows the low-level buffers to fit numWaypoints and starts a new low-level search.
+	void PrepareLowLevel(int numWaypoints)
+	{
+		heap.Reset(numWaypoints);
+		if (gScore.Size() < numWaypoints)
+		{
+			int oldSize = gScore.Size();
+			gScore.Allocate(numWaypoints, true);
+			cameFrom.Allocate(numWaypoints, true);
+			touched.Allocate(numWaypoints, true);
+			for (int i = oldSize; i < numWaypoints; ++i)
+				touched[i] = 0;
+		}
+		++searchID;
+		if (searchID == 0)
+		{
+			for (int i = 0; i < touched.Size(); ++i)
+				touched[i] = 0;
+			searchID = 1;
+		}
+	}
+	/// Cost to given waypoint in the last low-level search, FLT_MAX if not reached.
+	float CostTo(Waypoint * wp) const
+	{
+		if (wp->index < 0 || wp->index >= touched.Size() || touched[wp->index] != searchID)
+			return FLT_MAX;
+		return gScore[wp->index];
+	}
+	/// Low-level search, indexed by Waypoint::index.
+	WaypointHeap heap;
+	List<float> gScore;
+	List<int> cameFrom;
+	List<unsigned int> touched;
+	unsigned int searchID;
+	/// Abstract search, indexed by abstract node index.
+	WaypointHeap abstractHeap;
+	List<float> abstractG;
+	List<int> abstractCameFrom;
+	List<bool> abstractClosed;
+	/// Costs from the goal to the entrances of its cluster.
+	List<float> goalCosts;
+};
+static thread_local HierarchyScratch hierarchyScratch;
+
+PathHierarchy::PathHierarchy(NavMesh * navMesh, float clusterSize)
+	: navMesh(navMesh), clusterSize(clusterSize)
+{
+	assert(clusterSize > 0);
+}
+
+PathHierarchy::~PathHierarchy()
+{
+	for (std::unordered_map<long long, Cluster*>::iterator it = clusters.begin(); it != clusters.end(); ++it)
+		delete it->second;
+}
+
+long long PathHierarchy::KeyOf(const Waypoint * wp) const
+{
+	/// 21 bits per axis.
+	const long long mask = (1 << 21) - 1;
+	long long x = (long long) floor(wp->position[0] / clusterSize),
+		y = (long long) floor(wp->position[1] / clusterSize),
+		z = (long long) floor(wp->position[2] / clusterSize);
+	return ((x & mask) << 42) | ((y & mask) << 21) | (z & mask);
+}
+
+PathHierarchy::Cluster * PathHierarchy::GetCluster(long long key) const
+{
+	std::unordered_map<long long, Cluster*>::const_iterator it = clusters.find(key);
+	if (it == clusters.end())
+		return NULL;
+	return it->second;
+}
+
+/// Re-builds all clusters from the NavMesh.
+void PathHierarchy::Build()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(dataMutex);
+	for (std::unordered_map<long long, Cluster*>::iterator it = clusters.begin(); it != clusters.end(); ++it)
+		delete it->second;
+	clusters.clear();
+	dirtyClusters.clear();
+	List<Waypoint*> & waypoints = navMesh->waypoints;
+	for (int i = 0; i < waypoints.Size(); ++i)
+	{
+		Waypoint * wp = waypoints[i];
+		long long key = KeyOf(wp);
+		Cluster * cluster = GetCluster(key);
+		if (!cluster)
+		{
+			cluster = new Cluster();
+			cluster->key = key;
+			clusters[key] = cluster;
+		}
+		cluster->waypoints.AddItem(wp);
+	}
+	HierarchyScratch & scratch = hierarchyScratch;
+	for (std::unordered_map<long long, Cluster*>::iterator it = clusters.begin(); it != clusters.end(); ++it)
+		UpdateCluster(it->second, scratch);
+	UpdateAbstractNodes();
+}
+
+/// Re-computes entrances and costs of all clusters marked dirty since last Build/Repair.
+void PathHierarchy::Repair()
+{
+	std::unique_lock<std::shared_timed_mutex> lock(dataMutex);
+	if (dirtyClusters.size() == 0)
+		return;
+	HierarchyScratch & scratch = hierarchyScratch;
+	for (std::unordered_set<long long>::iterator it = dirtyClusters.begin(); it != dirtyClusters.end(); ++it)
+	{
+		Cluster * cluster = GetCluster(*it);
+		if (!cluster)
+			continue;
+		/// Drop clusters which no longer have any waypoints.
+		if (cluster->waypoints.Size() == 0)
+		{
+			clusters.erase(*it);
+			delete cluster;
+			continue;
+		}
+		UpdateCluster(cluster, scratch);
+	}
+	dirtyClusters.clear();
+	UpdateAbstractNodes();
+}
+
+/// If any cluster needs repairing.
+bool PathHierarchy::IsDirty()
+{
+	std::shared_lock<std::shared_timed_mutex> lock(dataMutex);
+	return dirtyClusters.size() > 0;
+}
+
+/// Call after adding a waypoint to the NavMesh.
+void PathHierarchy::OnWaypointAdded(Waypoint * wp)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(dataMutex);
+	long long key = KeyOf(wp);
+	Cluster * cluster = GetCluster(key);
+	if (!cluster)
+	{
+		cluster = new Cluster();
+		cluster->key = key;
+		clusters[key] = cluster;
+	}
+	cluster->waypoints.AddItem(wp);
+	MarkDirty(wp);
+}
+
+/// Call before removing a waypoint from the NavMesh.
+void PathHierarchy::OnWaypointRemoved(Waypoint * wp)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(dataMutex);
+	Cluster * cluster = GetCluster(KeyOf(wp));
+	if (cluster)
+		cluster->waypoints.RemoveItemUnsorted(wp);
+	MarkDirty(wp);
+}
+
+/// Call when passability or neighbours of a waypoint have changed.
+void PathHierarchy::OnWaypointChanged(Waypoint * wp)
+{
+	std::unique_lock<std::shared_timed_mutex> lock(dataMutex);
+	MarkDirty(wp);
+}
+
+/// Marks the waypoint's cluster and those of its neighbours dirty. Assumes dataMutex is held exclusively.
+void PathHierarchy::MarkDirty(Waypoint * wp)
+{
+	dirtyClusters.insert(KeyOf(wp));
+	/// Entrance status of neighbours across the cluster border depends on this waypoint too.
+	for (int i = 0; i < wp->neighbours; ++i)
+		dirtyClusters.insert(KeyOf(wp->neighbour[i]));
+}
+
+/// Re-computes entrances and costs of one cluster.
+void PathHierarchy::UpdateCluster(Cluster * cluster, HierarchyScratch & scratch)
+{
+	cluster->entrances.Clear();
+	for (int i = 0; i < cluster->waypoints.Size(); ++i)
+	{
+		Waypoint * wp = cluster->waypoints[i];
+		if (!wp->passable)
+			continue;
+		for (int j = 0; j < wp->neighbours; ++j)
+		{
+			Waypoint * neighbour = wp->neighbour[j];
+			if (neighbour->index >= 0 && neighbour->passable && KeyOf(neighbour) != cluster->key)
+			{
+				cluster->entrances.AddItem(wp);
+				break;
+			}
+		}
+	}
+	int entrances = cluster->entrances.Size();
+	cluster->costs.Allocate(entrances * entrances, true);
+	for (int i = 0; i < entrances; ++i)
+	{
+		SearchCluster(cluster->entrances[i], cluster->key, NULL, scratch);
+		for (int j = 0; j < entrances; ++j)
+			cluster->costs[i * entrances + j] = scratch.CostTo(cluster->entrances[j]);
+	}
+}
+
+/// Re-assigns abstract node indices to all entrances.
+void PathHierarchy::UpdateAbstractNodes()
+{
+	abstractNodes.Clear();
+	abstractNodeCluster.Clear();
+	abstractNodeLocalIndex.Clear();
+	abstractIndex.clear();
+	for (std::unordered_map<long long, Cluster*>::iterator it = clusters.begin(); it != clusters.end(); ++it)
+	{
+		Cluster * cluster = it->second;
+		for (int i = 0; i < cluster->entrances.Size(); ++i)
+		{
+			abstractIndex[cluster->entrances[i]] = abstractNodes.Size();
+			abstractNodes.AddItem(cluster->entrances[i]);
+			abstractNodeCluster.AddItem(cluster);
+			abstractNodeLocalIndex.AddItem(i);
+		}
+	}
+}
+
+/** Runs Dijkstra from source over passable waypoints within the cluster with given key, storing results in the scratch.
+	Stops once stopAt has been reached, if given.
+*/
+void PathHierarchy::SearchCluster(Waypoint * source, long long key, Waypoint * stopAt, HierarchyScratch & scratch) const
+{
+	List<Waypoint*> & waypoints = navMesh->waypoints;
+	scratch.PrepareLowLevel(waypoints.Size());
+	const unsigned int searchID = scratch.searchID;
+	WaypointHeap & openSet = scratch.heap;
+	int sourceIndex = navMesh->GetIndex(source);
+	/// Not in the NavMesh, nothing is reachable.
+	if (sourceIndex < 0)
+		return;
+	scratch.touched[sourceIndex] = searchID;
+	scratch.gScore[sourceIndex] = 0;
+	scratch.cameFrom[sourceIndex] = -1;
+	openSet.Push(sourceIndex, 0);
+	while (!openSet.IsEmpty())
+	{
+		int currentIndex = openSet.Pop();
+		Waypoint * current = waypoints[currentIndex];
+		if (current == stopAt)
+			return;
+		float currentG = scratch.gScore[currentIndex];
+		for (int i = 0; i < current->neighbours; ++i)
+		{
+			Waypoint * neighbour = current->neighbour[i];
+			int index = neighbour->index;
+			/// Skip dangling neighbours of waypoints removed from the NavMesh.
+			if (index < 0 || !neighbour->passable || KeyOf(neighbour) != key)
+				continue;
+			float g = currentG + (neighbour->position - current->position).Length();
+			if (scratch.touched[index] != searchID)
+			{
+				scratch.touched[index] = searchID;
+				scratch.gScore[index] = g;
+				scratch.cameFrom[index] = currentIndex;
+				openSet.Push(index, g);
+			}
+			else if (g < scratch.gScore[index] && openSet.Contains(index))
+			{
+				scratch.gScore[index] = g;
+				scratch.cameFrom[index] = currentIndex;
+				openSet.DecreaseKey(index, g);
+			}
+		}
+	}
+}
+
+/// Appends the path found by the last SearchCluster to given waypoint (excluding the source) onto the path.
+bool PathHierarchy::AppendClusterPath(Waypoint * to, HierarchyScratch & scratch, List<Waypoint*> & path) const
+{
+	if (scratch.CostTo(to) == FLT_MAX)
+		return false;
+	List<Waypoint*> & waypoints = navMesh->waypoints;
+	int start = path.Size();
+	for (int index = to->index; scratch.cameFrom[index] != -1; index = scratch.cameFrom[index])
+		path.AddItem(waypoints[index]);
+	/// Segment was added goal first, flip it.
+	for (int i = start, j = path.Size() - 1; i < j; ++i, --j)
+		path.Swap(i, j);
+	return true;
+}
+
+/** Calculates a path using the abstraction, stored in reverse order (goal first), same as AStar.
+	Returns false if no path could be found through the abstraction, or while it is out of date (see IsDirty), in which case a full search should be used.
+*/
+bool PathHierarchy::GetPath(Waypoint * from, Waypoint * to, Path & path)
+{
+	std::shared_lock<std::shared_timed_mutex> lock(dataMutex);
+	path.Clear();
+	/// Dirty clusters may hold removed waypoints and stale entrances until Repair.
+	if (dirtyClusters.size() > 0)
+		return false;
+	if (!navMesh->WaypointPartOf(from) || !navMesh->WaypointPartOf(to))
+		return false;
+	HierarchyScratch & scratch = hierarchyScratch;
+	List<Waypoint*> forward;
+	forward.AddItem(from);
+	long long fromKey = KeyOf(from), toKey = KeyOf(to);
+	/// Same cluster, try a direct search first.
+	if (fromKey == toKey)
+	{
+		SearchCluster(from, fromKey, to, scratch);
+		if (AppendClusterPath(to, scratch, forward))
+		{
+			for (int i = forward.Size() - 1; i >= 0; --i)
+				path.AddItem(forward[i]);
+			return true;
+		}
+	}
+	Cluster * fromCluster = GetCluster(fromKey), * toCluster = GetCluster(toKey);
+	if (!fromCluster || !toCluster)
+		return false;
+
+	/// Abstract graph is the entrances, plus the start and goal nodes.
+	int numNodes = abstractNodes.Size();
+	const int startNode = numNodes, goalNode = numNodes + 1;
+	scratch.abstractHeap.Reset(numNodes + 2);
+	scratch.abstractG.Allocate(numNodes + 2, true);
+	scratch.abstractCameFrom.Allocate(numNodes + 2, true);
+	scratch.abstractClosed.Allocate(numNodes + 2, true);
+	for (int i = 0; i < numNodes + 2; ++i)
+	{
+		scratch.abstractG[i] = FLT_MAX;
+		scratch.abstractClosed[i] = false;
+	}
+
+	/// Costs from the goal to its cluster's entrances.
+	SearchCluster(to, toKey, NULL, scratch);
+	scratch.goalCosts.Allocate(toCluster->entrances.Size(), true);
+	for (int i = 0; i < toCluster->entrances.Size(); ++i)
+		scratch.goalCosts[i] = scratch.CostTo(toCluster->entrances[i]);
+
+	/// Connect the start to its cluster's entrances.
+	SearchCluster(from, fromKey, NULL, scratch);
+	scratch.abstractG[startNode] = 0;
+	scratch.abstractClosed[startNode] = true;
+	for (int i = 0; i < fromCluster->entrances.Size(); ++i)
+	{
+		Waypoint * entrance = fromCluster->entrances[i];
+		float cost = scratch.CostTo(entrance);
+		if (cost == FLT_MAX)
+			continue;
+		int node = abstractIndex[entrance];
+		scratch.abstractG[node] = cost;
+		scratch.abstractCameFrom[node] = startNode;
+		scratch.abstractHeap.Push(node, cost + (entrance->position - to->position).Length());
+	}
+
+	/// Abstract A*.
+	bool found = false;
+	while (!scratch.abstractHeap.IsEmpty())
+	{
+		int node = scratch.abstractHeap.Pop();
+		if (node == goalNode)
+		{
+			found = true;
+			break;
+		}
+		scratch.abstractClosed[node] = true;
+		Waypoint * wp = abstractNodes[node];
+		Cluster * cluster = abstractNodeCluster[node];
+		int local = abstractNodeLocalIndex[node];
+		float g = scratch.abstractG[node];
+		/// Edge to the goal.
+		if (cluster == toCluster && scratch.goalCosts[local] != FLT_MAX)
+		{
+			float newG = g + scratch.goalCosts[local];
+			if (newG < scratch.abstractG[goalNode])
+			{
+				bool queued = scratch.abstractHeap.Contains(goalNode);
+				scratch.abstractG[goalNode] = newG;
+				scratch.abstractCameFrom[goalNode] = node;
+				if (queued)
+					scratch.abstractHeap.DecreaseKey(goalNode, newG);
+				else
+					scratch.abstractHeap.Push(goalNode, newG);
+			}
+		}
+		/// Edges within the cluster, then edges to neighbouring clusters.
+		int entrances = cluster->entrances.Size();
+		for (int i = 0; i < entrances + wp->neighbours; ++i)
+		{
+			int otherNode;
+			float cost;
+			if (i < entrances)
+			{
+				cost = cluster->costs[local * entrances + i];
+				if (i == local || cost == FLT_MAX)
+					continue;
+				otherNode = node - local + i;
+			}
+			else
+			{
+				Waypoint * neighbour = wp->neighbour[i - entrances];
+				if (!neighbour->passable)
+					continue;
+				std::unordered_map<Waypoint*, int>::const_iterator it = abstractIndex.find(neighbour);
+				if (it == abstractIndex.end() || abstractNodeCluster[it->second] == cluster)
+					continue;
+				otherNode = it->second;
+				cost = (neighbour->position - wp->position).Length();
+			}
+			if (scratch.abstractClosed[otherNode])
+				continue;
+			float newG = g + cost;
+			if (newG >= scratch.abstractG[otherNode])
+				continue;
+			float h = (abstractNodes[otherNode]->position - to->position).Length();
+			bool queued = scratch.abstractHeap.Contains(otherNode);
+			scratch.abstractG[otherNode] = newG;
+			scratch.abstractCameFrom[otherNode] = node;
+			if (queued)
+				scratch.abstractHeap.DecreaseKey(otherNode, newG + h);
+			else
+				scratch.abstractHeap.Push(otherNode, newG + h);
+		}
+	}
+	if (!found)
+		return false;
+
+	/// Gather the abstract path, goal first.
+	List<Waypoint*> abstractPath;
+	abstractPath.AddItem(to);
+	for (int node = scratch.abstractCameFrom[goalNode]; node != startNode; node = scratch.abstractCameFrom[node])
+		abstractPath.AddItem(abstractNodes[node]);
+	abstractPath.AddItem(from);
+
+	/// Refine each abstract step into waypoints.
+	for (int i = abstractPath.Size() - 1; i > 0; --i)
+	{
+		Waypoint * a = abstractPath[i], * b = abstractPath[i-1];
+		long long key = KeyOf(a);
+		/// Neighbouring entrances in different clusters.
+		if (key != KeyOf(b))
+		{
+			forward.AddItem(b);
+			continue;
+		}
+		SearchCluster(a, key, b, scratch);
+		if (!AppendClusterPath(b, scratch, forward))
+			return false;
+	}
+	for (int i = forward.Size() - 1; i >= 0; --i)
+		path.AddItem(forward[i]);
+	return true;
+}
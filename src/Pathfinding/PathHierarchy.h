@@ -0,0 +1,92 @@
+/// Emil Hedemalm
+/// 2016-08-15
+/// Hierarchical path abstraction (HPA*) over a NavMesh, for answering long-distance path queries quickly.
+
+#ifndef PATH_HIERARCHY_H
+#define PATH_HIERARCHY_H
+
+#include "Path.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <shared_mutex>
+
+class NavMesh;
+struct HierarchyScratch;
+
+/** Clustered abstraction of a NavMesh.
+	Waypoints are grouped into cubic clusters of clusterSize by position. Passable waypoints with a passable neighbour in another cluster
+	are entrances, and the cost between each pair of entrances within a cluster is precomputed.
+	Queries first search the small graph of entrances, then refine each step with a search restricted to a single cluster.
+	Neighbour connections are assumed to be symmetric, as created by NavMesh::ConnectWaypointsByProximity.
+
+	Changes to the NavMesh (added/removed waypoints, changed passability) only mark the affected clusters as dirty,
+	and Repair re-computes just those. Queries may run concurrently from several threads, but not during Repair.
+*/
+class PathHierarchy
+{
+public:
+	PathHierarchy(NavMesh * navMesh, float clusterSize);
+	~PathHierarchy();
+
+	/// Re-builds all clusters from the NavMesh.
+	void Build();
+	/// Re-computes entrances and costs of all clusters marked dirty since last Build/Repair.
+	void Repair();
+	/// If any cluster needs repairing.
+	bool IsDirty();
+
+	/// Call after adding a waypoint to the NavMesh.
+	void OnWaypointAdded(Waypoint * wp);
+	/// Call before removing a waypoint from the NavMesh.
+	void OnWaypointRemoved(Waypoint * wp);
+	/// Call when passability or neighbours of a waypoint have changed.
+	void OnWaypointChanged(Waypoint * wp);
+
+	/** Calculates a path using the abstraction, stored in reverse order (goal first), same as AStar.
+		Returns false if no path could be found through the abstraction, or while it is out of date (see IsDirty), in which case a full search should be used.
+	*/
+	bool GetPath(Waypoint * from, Waypoint * to, Path & path);
+
+	float ClusterSize() const { return clusterSize; };
+	int Clusters() const { return (int) clusters.size(); };
+	int Entrances() const { return abstractNodes.Size(); };
+private:
+	struct Cluster
+	{
+		long long key;
+		List<Waypoint*> waypoints;
+		List<Waypoint*> entrances;
+		/// Cost between entrances, entrances x entrances, FLT_MAX if not connected within the cluster.
+		List<float> costs;
+	};
+	long long KeyOf(const Waypoint * wp) const;
+	Cluster * GetCluster(long long key) const;
+	/// Marks the waypoint's cluster and those of its neighbours dirty. Assumes dataMutex is held exclusively.
+	void MarkDirty(Waypoint * wp);
+	/// Re-computes entrances and costs of one cluster.
+	void UpdateCluster(Cluster * cluster, HierarchyScratch & scratch);
+	/// Re-assigns abstract node indices to all entrances.
+	void UpdateAbstractNodes();
+	/** Runs Dijkstra from source over passable waypoints within the cluster with given key, storing results in the scratch.
+		Stops once stopAt has been reached, if given.
+	*/
+	void SearchCluster(Waypoint * source, long long key, Waypoint * stopAt, HierarchyScratch & scratch) const;
+	/// Appends the path found by the last SearchCluster to given waypoint (excluding the source) onto the path.
+	bool AppendClusterPath(Waypoint * to, HierarchyScratch & scratch, List<Waypoint*> & path) const;
+
+	NavMesh * navMesh;
+	float clusterSize;
+	std::unordered_map<long long, Cluster*> clusters;
+	std::unordered_set<long long> dirtyClusters;
+	/// All entrances, indexed by abstract node index.
+	List<Waypoint*> abstractNodes;
+	List<Cluster*> abstractNodeCluster;
+	/// Index of the abstract node within its cluster's entrances.
+	List<int> abstractNodeLocalIndex;
+	std::unordered_map<Waypoint*, int> abstractIndex;
+	/// Shared by queries, exclusive for Build, Repair and the change callbacks.
+	std::shared_timed_mutex dataMutex;
+};
+
+#endif
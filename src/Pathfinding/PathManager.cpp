@@ -9,7 +9,9 @@
 #include <ctime>
 #include "PathMessage.h"
 #include "Message/MessageManager.h"
-#include "Thread/Thread.h"
+#include "WaypointHeap.h"
+#include "PathHierarchy.h"
+#include "FlowField.h"
 
 /// A manager for handling and calculating paths between various nodes provided by the waypoint-manager.
 // class PathManager{
@@ -19,7 +21,10 @@ void (*searchFunction)(Waypoint * from, Waypoint * to, Path& path) = NULL;
 
 /// Private constructor for singleton pattern
 PathManager::PathManager(){
-	searchFunction = &AStar;
+	searchFunction = &HierarchicalAStar;
+	stopWorkers = false;
+	flowFieldThreshold = 4;
+	flowFieldUseCounter = 0;
 
 	// Create lastPath Mutex
 //	Mutex mutex;
@@ -31,10 +36,13 @@ PathManager * PathManager::pathManager = NULL;
 // public:
 //========================================================================================//
 PathManager::~PathManager(){
+	StopWorkers();
+	ClearFlowFields();
 }
 /// Allocates the waypoint manager singleton
 void PathManager::Allocate(){
 	pathManager = new PathManager();
+	pathManager->StartWorkers();
 }
 void PathManager::Deallocate(){
 	assert(pathManager);
@@ -42,71 +50,382 @@ void PathManager::Deallocate(){
 	pathManager = NULL;
 }
 
-AE_THREAD_START(PathFinderThread)
-	/// Check arguments.
-	Waypoint * from = (Waypoint*) args[1], * to = (Waypoint*) args[2];
-	Entity * entity = (Entity*) args[3];
-	PathMessage * reply = new PathMessage(entity);
-	AStar(from, to, reply->path);
-	reply->path.Mirror();
-	/// Queue reply via Message manager once we are done, since we are currently in another thread.
-	MesMan.QueueMessage(reply);
-AE_THREAD_END
-
-/// In reality only accepts PathMessages, the rest are mostly ignored.
-void PathManager::QueueMessage(PathMessage * pm)
+/** In reality only accepts PathMessages, the rest are mostly ignored. The message is deleted.
+	Queues the search for the worker threads. A new request from an entity supersedes any earlier one it has pending,
+	and requests for the same from/to pair are merged into a single search.
+	Returns false if the queue is full and the request was dropped.
+*/
+bool PathManager::QueueMessage(PathMessage * pm)
 {
-//	messages.AddItem(pm);
 	assert(pm->from);
 	assert(pm->to);
 	assert(pm->entity);
+	int priority = pm->priority == PathMessage::HIGH_PRIORITY? PathMessage::HIGH_PRIORITY : PathMessage::NORMAL_PRIORITY;
+	/// Checked before taking requestMutex, so that the two locks are never held at once.
+	bool hasFlowField = flowFieldThreshold > 0 && HasFlowField(pm->to);
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		/// Any earlier request by this entity is now obsolete.
+		RemoveEntity(pm->entity);
+		PathRequest * request = FindRequest(pm->from, pm->to);
+		if (request)
+		{
+			request->entities.AddItem(pm->entity);
+			/// Bump it up if it is still queued.
+			if (priority > request->priority && queuedRequests[request->priority].RemoveItem(request))
+			{
+				request->priority = priority;
+				queuedRequests[priority].AddItem(request);
+			}
+			delete pm;
+			return true;
+		}
+		if (queuedRequests[0].Size() + queuedRequests[1].Size() >= MAX_QUEUED_REQUESTS)
+		{
+			std::cout<<"\nPathManager::QueueMessage: Request queue full, dropping request.";
+			delete pm;
+			return false;
+		}
+		request = new PathRequest();
+		request->from = pm->from;
+		request->to = pm->to;
+		request->priority = priority;
+		request->entities.AddItem(pm->entity);
+		/// Crowds heading to the same goal share one flow field instead of searching one path each.
+		if (flowFieldThreshold > 0)
+			request->useFlowField = RequestsTowards(pm->to) + 1 >= flowFieldThreshold || hasFlowField;
+		else 
+			request->useFlowField = false;
+		queuedRequests[priority].AddItem(request);
+	}
+	requestCondition.notify_one();
+	delete pm;
+	return true;
+}
 
-	if (pathfindingThreads.Size() > 20)
+/// Cancels any queued or in-progress path requests for given entity, e.g. when it is being deleted. No reply will be sent.
+void PathManager::CancelRequests(Entity * entity)
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	RemoveEntity(entity);
+	for (int i = 0; i < finishedRequests.Size(); ++i)
+		finishedRequests[i]->entities.RemoveItem(entity);
+}
+
+/// Brings the path abstraction up to date and sends replies for all searches finished by the worker threads since last call. Call from the main/state thread.
+void PathManager::Process()
+{
+	/// Bring the path abstraction up to date with any changes to the navmesh.
+	NavMesh * nm = WaypointMan.ActiveNavMesh();
+	if (nm && nm->Hierarchy() && nm->Hierarchy()->IsDirty())
+		nm->Hierarchy()->Repair();
+
+	List<PathRequest*> finished;
 	{
-		messageQueue.AddItem(pm);
-		return;
+		std::lock_guard<std::mutex> lock(requestMutex);
+		if (finishedRequests.Size() == 0)
+			return;
+		finished = finishedRequests;
+		finishedRequests.Clear();
+	}
+	for (int i = 0; i < finished.Size(); ++i)
+	{
+		PathRequest * request = finished[i];
+		for (int j = 0; j < request->entities.Size(); ++j)
+		{
+			Entity * entity = request->entities[j];
+			if (entity->flaggedForDeletion)
+				continue;
+			PathMessage * reply = new PathMessage(entity);
+			reply->path = request->path;
+			MesMan.QueueMessage(reply);
+		}
 	}
+	finished.ClearAndDelete();
+}
 
-	/// Make a new thread.
-	StartThreadFromMessage(pm);
-	delete pm;
+/// Starts one worker per hardware thread, minus one for the main thread.
+void PathManager::StartWorkers()
+{
+	int numWorkers = (int) std::thread::hardware_concurrency() - 1;
+	if (numWorkers < 1)
+		numWorkers = 1;
+	stopWorkers = false;
+	for (int i = 0; i < numWorkers; ++i)
+		workers.AddItem(new std::thread(&PathManager::WorkerLoop, this));
 }
 
-void PathManager::StartThreadFromMessage(PathMessage * pm)
+/// Signals all workers to stop and waits for them to exit.
+void PathManager::StopWorkers()
 {
-	Thread * thread = new Thread(PathFinderThread);
-	thread->AddArgument((Argument*)pm->from);
-	thread->AddArgument((Argument*)pm->to);
-	thread->AddArgument((Argument*)pm->entity);
-	thread->Run();
-	pathfindingThreads.AddItem(thread);
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		stopWorkers = true;
+	}
+	requestCondition.notify_all();
+	for (int i = 0; i < workers.Size(); ++i)
+	{
+		workers[i]->join();
+		delete workers[i];
+	}
+	workers.Clear();
+	flowFieldBuilds.Clear();
+	queuedRequests[0].ClearAndDelete();
+	queuedRequests[1].ClearAndDelete();
+	finishedRequests.ClearAndDelete();
+}
+
+/// Worker thread main loop.
+void PathManager::WorkerLoop()
+{
+	while (true)
+	{
+		PathRequest * request = NULL;
+		Waypoint * flowFieldGoal = NULL;
+		{
+			std::unique_lock<std::mutex> lock(requestMutex);
+			while (!stopWorkers && queuedRequests[0].Size() == 0 && queuedRequests[1].Size() == 0 && flowFieldBuilds.Size() == 0)
+				requestCondition.wait(lock);
+			if (stopWorkers)
+				return;
+			/// Fields first, as entities steering by GetNextWaypoint are waiting on them.
+			if (flowFieldBuilds.Size())
+			{
+				flowFieldGoal = flowFieldBuilds[0];
+				flowFieldBuilds.RemoveIndex(0, ListOption::RETAIN_ORDER);
+			}
+			else 
+			{
+				/// High priority first, otherwise in order of arrival.
+				List<PathRequest*> & queue = queuedRequests[PathMessage::HIGH_PRIORITY].Size()? queuedRequests[PathMessage::HIGH_PRIORITY] : queuedRequests[PathMessage::NORMAL_PRIORITY];
+				request = queue[0];
+				queue.RemoveIndex(0, ListOption::RETAIN_ORDER);
+				activeRequests.AddItem(request);
+			}
+		}
+		if (flowFieldGoal)
+		{
+			BuildFlowField(flowFieldGoal);
+			continue;
+		}
+		if (!request->useFlowField || !GetFlowFieldPath(request->from, request->to, request->path))
+		{
+			searchFunction(request->from, request->to, request->path);
+			request->path.Mirror();
+		}
+		{
+			std::lock_guard<std::mutex> lock(requestMutex);
+			activeRequests.RemoveItemUnsorted(request);
+			/// Everyone waiting may have been cancelled meanwhile.
+			if (request->entities.Size())
+				finishedRequests.AddItem(request);
+			else 
+				delete request;
+		}
+	}
 }
 
-/// For processing the path searches. If 1 thread, iterates a bit, if multi-threaded approach, will mostly keep track of which threads have finished or not.
-void PathManager::Process(int timeInMs)
+/// Removes the entity from all queued and in-progress requests. Queued requests left without entities are dropped. Assumes requestMutex is held.
+void PathManager::RemoveEntity(Entity * entity)
 {
-	static int accum = 0;
-	accum += timeInMs;
-	if (accum > 1000)
-		accum = accum % 1000;
-	for (int i = 0; i < pathfindingThreads.Size(); ++i)
+	for (int p = 0; p < 2; ++p)
 	{
-		Thread * t = pathfindingThreads[i];
-		if (t->HasEnded())
+		List<PathRequest*> & queue = queuedRequests[p];
+		for (int i = 0; i < queue.Size(); ++i)
 		{
-			pathfindingThreads.RemoveItem(t);
-			--i;
-			if (messageQueue.Size())
+			PathRequest * request = queue[i];
+			if (!request->entities.RemoveItemUnsorted(entity))
+				continue;
+			if (request->entities.Size() == 0)
 			{
-				PathMessage * pm = messageQueue[0];
-				StartThreadFromMessage(pm);
-				messageQueue.RemoveItem(pm);
-				delete pm;
+				queue.RemoveIndex(i, ListOption::RETAIN_ORDER);
+				delete request;
+				--i;
 			}
 		}
 	}
+	for (int i = 0; i < activeRequests.Size(); ++i)
+		activeRequests[i]->entities.RemoveItemUnsorted(entity);
+}
+
+/// Returns a queued or in-progress request for given pair, or NULL. Assumes requestMutex is held.
+PathRequest * PathManager::FindRequest(Waypoint * from, Waypoint * to)
+{
+	for (int i = 0; i < activeRequests.Size(); ++i)
+	{
+		PathRequest * request = activeRequests[i];
+		if (request->from == from && request->to == to)
+			return request;
+	}
+	for (int p = 0; p < 2; ++p)
+	{
+		List<PathRequest*> & queue = queuedRequests[p];
+		for (int i = 0; i < queue.Size(); ++i)
+		{
+			PathRequest * request = queue[i];
+			if (request->from == from && request->to == to)
+				return request;
+		}
+	}
+	return NULL;
+}
+
+/// Returns amount of queued or in-progress requests towards given goal. Assumes requestMutex is held.
+int PathManager::RequestsTowards(Waypoint * goal)
+{
+	int count = 0;
+	for (int i = 0; i < activeRequests.Size(); ++i)
+		if (activeRequests[i]->to == goal)
+			++count;
+	for (int p = 0; p < 2; ++p)
+	{
+		List<PathRequest*> & queue = queuedRequests[p];
+		for (int i = 0; i < queue.Size(); ++i)
+			if (queue[i]->to == goal)
+				++count;
+	}
+	return count;
+}
+
+/** Returns the next waypoint from -> goal using a cached flow field towards the goal. O(1), regardless of how many entities share the goal.
+	Never builds on the calling thread: a missing or outdated field is queued for the workers, and meanwhile the step of the outdated field
+	is returned if it still leads to a passable neighbour. Returns goal if already there, or NULL if it cannot be reached or no field is ready yet.
+*/
+Waypoint * PathManager::GetNextWaypoint(Waypoint * from, Waypoint * goal)
+{
+	NavMesh * nm = WaypointMan.ActiveNavMesh();
+	if (!nm || !nm->WaypointPartOf(goal))
+		return NULL;
+	Waypoint * next = NULL;
+	{
+		std::lock_guard<std::mutex> lock(flowFieldMutex);
+		FlowField * field = FindFlowField(goal);
+		if (field && field->IsValid(nm))
+			return field->Next(from);
+		if (field)
+			next = field->StaleNext(from, nm);
+	}
+	QueueFlowFieldBuild(goal);
+	return next;
+}
+
+/** Walks the cached flow field towards goal, storing the path in order from -> goal, building the field on the calling thread first if needed.
+	Returns false if the goal cannot be reached, or if another thread is building the field right now.
+*/
+bool PathManager::GetFlowFieldPath(Waypoint * from, Waypoint * goal, Path & path)
+{
+	path.Clear();
+	NavMesh * nm = WaypointMan.ActiveNavMesh();
+	if (!nm || !nm->WaypointPartOf(goal))
+		return false;
+	{
+		std::lock_guard<std::mutex> lock(flowFieldMutex);
+		FlowField * field = FindFlowField(goal);
+		if (field && field->IsValid(nm))
+			return field->GetPath(from, path);
+	}
+	/// Rather than waiting for another worker's build, the caller can search on its own meanwhile.
+	if (!BuildFlowField(goal))
+		return false;
+	std::lock_guard<std::mutex> lock(flowFieldMutex);
+	FlowField * field = FindFlowField(goal);
+	if (!field || !field->IsValid(nm))
+		return false;
+	return field->GetPath(from, path);
+}
+
+/// Deletes all cached flow fields.
+void PathManager::ClearFlowFields()
+{
+	std::lock_guard<std::mutex> lock(flowFieldMutex);
+	flowFields.ClearAndDelete();
+}
+
+/** Builds a new flow field towards goal on the active navmesh without holding flowFieldMutex, then swaps it into the cache.
+	Returns false if another thread is already building one towards the same goal.
+*/
+bool PathManager::BuildFlowField(Waypoint * goal)
+{
+	NavMesh * nm = WaypointMan.ActiveNavMesh();
+	if (!nm)
+		return false;
+	{
+		std::lock_guard<std::mutex> lock(flowFieldMutex);
+		if (flowFieldsBuilding.Exists(goal))
+			return false;
+		flowFieldsBuilding.AddItem(goal);
+	}
+	FlowField * field = new FlowField(goal);
+	field->Build(nm);
+	std::lock_guard<std::mutex> lock(flowFieldMutex);
+	flowFieldsBuilding.RemoveItemUnsorted(goal);
+	CacheFlowField(field);
+	return true;
+}
+
+/// Queues a build of the flow field towards goal for the workers, unless one is queued already.
+void PathManager::QueueFlowFieldBuild(Waypoint * goal)
+{
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		if (flowFieldBuilds.Exists(goal))
+			return;
+		flowFieldBuilds.AddItem(goal);
+	}
+	requestCondition.notify_one();
+}
+
+/// Returns the cached flow field towards goal, valid or not, or NULL. Marks it as used. Assumes flowFieldMutex is held.
+FlowField * PathManager::FindFlowField(Waypoint * goal)
+{
+	for (int i = 0; i < flowFields.Size(); ++i)
+	{
+		FlowField * field = flowFields[i];
+		if (field->Goal() == goal)
+		{
+			field->lastUsed = ++flowFieldUseCounter;
+			return field;
+		}
+	}
+	return NULL;
+}
+
+/// Adds a newly built field to the cache, replacing any older one towards the same goal or evicting the least recently used one. Assumes flowFieldMutex is held.
+void PathManager::CacheFlowField(FlowField * field)
+{
+	field->lastUsed = ++flowFieldUseCounter;
+	for (int i = 0; i < flowFields.Size(); ++i)
+	{
+		if (flowFields[i]->Goal() == field->Goal())
+		{
+			/// Nobody reads fields without holding flowFieldMutex, so the old one can go right away.
+			delete flowFields[i];
+			flowFields[i] = field;
+			return;
+		}
+	}
+	/// Evict the least recently used one if full.
+	if (flowFields.Size() >= MAX_FLOW_FIELDS)
+	{
+		int oldest = 0;
+		for (int i = 1; i < flowFields.Size(); ++i)
+			if (flowFields[i]->lastUsed < flowFields[oldest]->lastUsed)
+				oldest = i;
+		delete flowFields[oldest];
+		flowFields.RemoveIndex(oldest, ListOption::RETAIN_ORDER);
+	}
+	flowFields.AddItem(field);
 }
 
+/// If a flow field towards goal is cached, valid or not.
+bool PathManager::HasFlowField(Waypoint * goal)
+{
+	std::lock_guard<std::mutex> lock(flowFieldMutex);
+	for (int i = 0; i < flowFields.Size(); ++i)
+		if (flowFields[i]->Goal() == goal)
+			return true;
+	return false;
+}
 
 /** Attempts to get control of the LastPath Mutex
 	Make sure you call ReleaseLastPathMutex afterward!
@@ -169,6 +488,9 @@ void PathManager::SetSearchAlgorithm(const char * name)
 	if (strcmp(name, "AStar") == 0){
 		searchFunction = &AStar;
 	}
+	else if (strcmp(name, "HierarchicalAStar") == 0){
+		searchFunction = &HierarchicalAStar;
+	}
 	else if (strcmp(name, "BreadthFirst") == 0){
 		searchFunction = &BreadthFirst;
 	}
@@ -180,18 +502,11 @@ void PathManager::SetSearchAlgorithm(const char * name)
 	}
 }
 
-/// Ew.
+/// Returns amount of path searches currently being processed by the worker threads.
 int PathManager::ThreadsActive()
 {
-	for (int i = 0; i < pathfindingThreads.Size(); ++i)
-	{
-		Thread * t = pathfindingThreads[i];
-		if (t->HasEnded()){
-			pathfindingThreads.RemoveItem(t);
-			--i;
-		}
-	}
-	return pathfindingThreads.Size();
+	std::lock_guard<std::mutex> lock(requestMutex);
+	return activeRequests.Size();
 }
 
 
@@ -205,95 +520,90 @@ float ManhattanDistance(Waypoint * from, Waypoint * to){
 		AbsoluteValue(from->position[2] - to->position[2]);
 };
 
+/// Per-thread scratch buffers for AStar, re-used between searches so that no allocations occur once warmed up.
+struct AStarScratch 
+{
+	AStarScratch() : searchID(0) {};
+	/// Grows the buffers to fit numWaypoints and starts a new search.
+	void Prepare(int numWaypoints)
+	{
+		openSet.Reset(numWaypoints);
+		if (gScore.Size() < numWaypoints)
+		{
+			int oldSize = gScore.Size();
+			gScore.Allocate(numWaypoints, true);
+			cameFrom.Allocate(numWaypoints, true);
+			touched.Allocate(numWaypoints, true);
+			closed.Allocate(numWaypoints, true);
+			for (int i = oldSize; i < numWaypoints; ++i)
+				touched[i] = closed[i] = 0;
+		}
+		++searchID;
+		/// Wrapped around, clear the stamps so old searches are not mistaken for this one.
+		if (searchID == 0)
+		{
+			for (int i = 0; i < touched.Size(); ++i)
+				touched[i] = closed[i] = 0;
+			searchID = 1;
+		}
+	}
+	/// Open set, keyed on f_score.
+	WaypointHeap openSet;
+	/// Cost from start along best known path, valid where touched == searchID.
+	List<float> gScore;
+	/// Index of the waypoint we came from, valid where touched == searchID.
+	List<int> cameFrom;
+	/// Search stamps per waypoint index, so the arrays do not need clearing between searches.
+	List<unsigned int> touched, closed;
+	unsigned int searchID;
+};
+static thread_local AStarScratch aStarScratch;
+
 /** Calculates the given path using the A* algorithm, derived with guidance from Wikipedia
 	http://en.wikipedia.org/wiki/A*_search_algorithm
+	The open set is a binary heap with decrease-key over the dense Waypoint::index, so each search is O(n log n).
 */
 void AStar(Waypoint * from, Waypoint * to, Path& path)
 {
 	/// TODO: Add custom functions for seeking game-specific tiles. Or manipulate the navmesh in run-time somehow.
-//	std::cout<<"\nBeginning A* path search...";
-	Timer timer;
-	timer.Start();
 	path.Clear();
 
 	/// Get active navmesh, as it should be what we're working with.
 	NavMesh * nm = WaypointMan.ActiveNavMesh();
-	assert(nm->WaypointPartOf(from));
-	if (!nm->WaypointPartOf(to)){
+	/// The scratch buffers are indexed by Waypoint::index, which is -1 for waypoints not in the navmesh.
+	if (!nm || !nm->WaypointPartOf(from) || !nm->WaypointPartOf(to)){
 		std::cout<<"\nWaypoint not part of NavMesh. No path can be generated!";
 		return;
 	}
 
-	// The set of nodes already evaluated.
-	const int SET_SIZE = 65536;
-	Waypoint * closedSet[SET_SIZE];
-	memset(closedSet, 0, SET_SIZE * sizeof(Waypoint*));
-	/** The set of tentative nodes to be evaluated, initially containing the start node
-		The open set is assumed to always be sorted by f_score.
-	*/
-	Waypoint * openSet[SET_SIZE];
-	memset(openSet, 0, SET_SIZE * sizeof(Waypoint*));
-	int itemsInOpenSet = 1;
-	int itemsInClosedSet = 0;
-	// Add start node to the open set
-	openSet[0] = from;
-
-	/// Map of nodes we came from, cost from start along best known path and estimated cost to goal
-	assert(nm->waypoints.Size() < SET_SIZE);
 	List<Waypoint*> & waypointList = nm->waypoints;
-	Waypoint ** cameFrom = new Waypoint * [nm->waypoints.Size()];
-	memset(cameFrom, 0, sizeof(Waypoint *) * nm->waypoints.Size());
-	float * g_score = new float[nm->waypoints.Size()];
-	float * f_score = new float[nm->waypoints.Size()];
+	AStarScratch & scratch = aStarScratch;
+	scratch.Prepare(waypointList.Size());
+	const unsigned int searchID = scratch.searchID;
+	WaypointHeap & openSet = scratch.openSet;
 
 	/// Set start node scores
-	int startNodeIndex = nm->GetIndex(from);
-	assert(startNodeIndex >= 0);
-	g_score[startNodeIndex] = 0;
-	f_score[startNodeIndex] = g_score[startNodeIndex] + ManhattanDistance(from, to);
+	int startIndex = from->index, goalIndex = to->index;
+	scratch.gScore[startIndex] = 0;
+	scratch.cameFrom[startIndex] = -1;
+	scratch.touched[startIndex] = searchID;
+	openSet.Push(startIndex, ManhattanDistance(from, to));
 
 	/// While we still have items in the open set to investigate...
-	while (itemsInOpenSet > 0){
+	while (!openSet.IsEmpty()){
 		/// Get the node in the open set with the lowest estimated total distance score.
-		Waypoint * current = openSet[0];
-		assert(current);
-		float lowestFScore = f_score[nm->GetIndex(openSet[0])];
-		/// Just grab the node with lowest f_score by force ..
-		for (int i = 1; i < itemsInOpenSet; ++i){
-			float fScore = f_score[nm->GetIndex(openSet[i])];
-			if (fScore < lowestFScore){
-				lowestFScore = fScore;
-				current = openSet[i];
-			}
-		}
-		int currentIndex = nm->GetIndex(current);
+		int currentIndex = openSet.Pop();
 		/// If the current node is our goal, reconstruct our path.
-		if (current == to) 
+		if (currentIndex == goalIndex) 
 		{
-		//	std::cout<<"\nGoal has been reached! Yays";
-			path.AddItem(current);
-			while (current != from){
-				current = cameFrom[nm->GetIndex(current)];
-				path.AddItem(current);
-			}
-			timer.Stop();
-//			std::cout<<"\nA* Time taken: "<<timer.GetMicros()<<" microseconds, or "<<timer.GetMs()<<" ms.";
+			for (int index = currentIndex; index != -1; index = scratch.cameFrom[index])
+				path.AddItem(waypointList[index]);
 			return;
 		}
-		/// Remove the current from the open set
-		for (int i = 0; i < itemsInOpenSet; ++i){
-			/// First find the current one..
-			if (openSet[i] != current)
-				continue;
-			/// Then move up the rest!
-			for (int j = i; j < itemsInOpenSet; ++j)
-				openSet[j] = openSet[j+1];
-			break;
-		}
-		--itemsInOpenSet;
-		/// Add the current node to the closedSet
-		closedSet[itemsInClosedSet] = current;
-		++itemsInClosedSet;
+		/// Add the current node to the closed set
+		scratch.closed[currentIndex] = searchID;
+		Waypoint * current = waypointList[currentIndex];
+		float currentGScore = scratch.gScore[currentIndex];
 
 		/// Add all neighbours of the current node to the openSet
 		for (int i = 0; i < current->neighbours; ++i){
@@ -301,60 +611,55 @@ void AStar(Waypoint * from, Waypoint * to, Path& path)
 			/// Check that it's passable, lol..
 			if (!neighbour->passable)
 				continue;
-			bool skip = false;
+			int index = nm->GetIndex(neighbour);
+			/// Dangling neighbour, removed from the navmesh without CleanupNeighbours.
+			if (index < 0)
+				continue;
 			///...unless they've already been examined (are in the closed set)
-			for (int j = 0; j < itemsInClosedSet; ++j){
-				if (neighbour == closedSet[j]){
-					skip = true;
-					break;
-				}
-			}
-			if (skip)
+			if (scratch.closed[index] == searchID)
 				continue;
-
-			/// Get the neighbour's index in our map
-			int index = nm->GetIndex(neighbour);
-			float tentative_g_score = g_score[currentIndex] +
-				(waypointList[index]->position - waypointList[currentIndex]->position).Length();
-
-			/// Check if it already exists in the open set.
-			bool existsInOpenSet = false;
-			for (int j = 0; j < itemsInOpenSet; ++j){
-				if (neighbour == openSet[j]){
-					existsInOpenSet = true;
-					break;
-				}
+			float tentative_g_score = currentGScore + (neighbour->position - current->position).Length();
+			// If it hasn't been reached yet this search, just add it.
+			if (scratch.touched[index] != searchID){
+				scratch.touched[index] = searchID;
+				scratch.cameFrom[index] = currentIndex;
+				scratch.gScore[index] = tentative_g_score;
+				openSet.Push(index, tentative_g_score + ManhattanDistance(neighbour, to));
 			}
-			// If it doesn't exist i nthe open set, just add it.
-			if (!existsInOpenSet){
-				/// Set where we came from, g_score and f_score
-				cameFrom[index] = current;
-				g_score[index] = g_score[currentIndex] +
-					(waypointList[index]->position - waypointList[currentIndex]->position).Length();
-				f_score[index] = g_score[index] + ManhattanDistance(neighbour, to);
-				/// Add the waypoint to the openSet
-				openSet[itemsInOpenSet] = neighbour;
-				++itemsInOpenSet;
-			}
-			/// If it does exist, compare the new g_scores using the given paths.
-			else if (tentative_g_score < g_score[index]){
-				/// Set where we came from, g_score and f_score
-				cameFrom[index] = current;
-				g_score[index] = g_score[currentIndex] +
-					(waypointList[index]->position - waypointList[currentIndex]->position).Length();
-				f_score[index] = g_score[index] + ManhattanDistance(neighbour, to);
+			/// If it does exist, keep the better of the two routes.
+			else if (tentative_g_score < scratch.gScore[index]){
+				scratch.cameFrom[index] = currentIndex;
+				scratch.gScore[index] = tentative_g_score;
+				openSet.DecreaseKey(index, tentative_g_score + ManhattanDistance(neighbour, to));
 			}
 		}
 	}
 	std::cout<<"\nA* Unable to find a suitable path :<";
-	delete[] cameFrom;
-	delete[] g_score;
-	delete[] f_score;
-
 	/// Return an empty path if we failed...
     return;
 }
 
+/** Calculates the given path using the active NavMesh' path abstraction (see NavMesh::BuildHierarchy) if it has one and the waypoints are 
+	further apart than a cluster, falling back to AStar otherwise or if the abstraction fails to find a path.
+*/
+void HierarchicalAStar(Waypoint * from, Waypoint * to, Path& path)
+{
+	NavMesh * nm = WaypointMan.ActiveNavMesh();
+	/// The default search function, so requests made while no navmesh is active end up here.
+	if (!nm){
+		path.Clear();
+		std::cout<<"\nNo active NavMesh. No path can be generated!";
+		return;
+	}
+	PathHierarchy * hierarchy = nm->Hierarchy();
+	if (hierarchy && (from->position - to->position).LengthSquared() > hierarchy->ClusterSize() * hierarchy->ClusterSize())
+	{
+		if (hierarchy->GetPath(from, to, path))
+			return;
+	}
+	AStar(from, to, path);
+}
+
 /// Calculates the given path using the brute force breadth-first algorithm
 void BreadthFirst(Waypoint * from, Waypoint * to, Path& path){
 	std::cout<<"\nBeginning Breadth First path search...";
@@ -5,9 +5,27 @@
 #define PATH_MANAGER_H
 
 #include "Path.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 class PathMessage;
-class Thread;
+class Entity;
+class FlowField;
+
+/// A single queued path search. Requests for the same from/to pair share one search, replying to every waiting entity.
+struct PathRequest 
+{
+	Waypoint * from, * to;
+	/// Entities waiting for this path. Entities are removed as they are cancelled or re-request another path.
+	List<Entity*> entities;
+	/// See PathMessage priorities.
+	int priority;
+	/// If the path should be read from the flow field towards the goal instead of searched for, see PathManager::flowFieldThreshold.
+	bool useFlowField;
+	/// Result, already mirrored to go from -> to.
+	Path path;
+};
 
 #define PathMan		(*PathManager::Instance())
 
@@ -25,12 +43,17 @@ public:
 	/// Get singleton instance
 	static inline PathManager * Instance() { return pathManager; };
 
-	/// In reality only accepts PathMessages, the rest are mostly ignored.
-	void QueueMessage(PathMessage * pm);
-	void StartThreadFromMessage(PathMessage * pm);
+	/** In reality only accepts PathMessages, the rest are mostly ignored. The message is deleted.
+		Queues the search for the worker threads. A new request from an entity supersedes any earlier one it has pending,
+		and requests for the same from/to pair are merged into a single search.
+		Returns false if the queue is full and the request was dropped.
+	*/
+	bool QueueMessage(PathMessage * pm);
+	/// Cancels any queued or in-progress path requests for given entity, e.g. when it is being deleted. No reply will be sent.
+	void CancelRequests(Entity * entity);
 
-	/// For processing the path searches. If 1 thread, iterates a bit, if multi-threaded approach, will mostly keep track of which threads have finished or not.
-	void Process(int timeInMs);
+	/// Brings the path abstraction up to date and sends replies for all searches finished by the worker threads since last call. Call from the main/state thread.
+	void Process();
 
 	/** Attempts to get control of the LastPath Mutex
 		Make sure you call ReleaseLastPathMutex afterward!
@@ -49,21 +72,91 @@ public:
 
 	/// Sets search algorithm by name (must match exact function name for now)
 	void SetSearchAlgorithm(const char * name);
+	/// Checks that path searches fail cleanly when there is no active navmesh. Asserts on failure.
+	static void UnitTest();
+
+	/** Returns the next waypoint from -> goal using a cached flow field towards the goal. O(1), regardless of how many entities share the goal.
+		Never builds on the calling thread: a missing or outdated field is queued for the workers, and meanwhile the step of the outdated field
+		is returned if it still leads to a passable neighbour. Returns goal if already there, or NULL if it cannot be reached or no field is ready yet.
+	*/
+	Waypoint * GetNextWaypoint(Waypoint * from, Waypoint * goal);
+	/// Deletes all cached flow fields.
+	void ClearFlowFields();
 
-	/// Ew.
+	/// Returns amount of path searches currently being processed by the worker threads.
 	int ThreadsActive();
+	/// Returns amount of worker threads in the pool.
+	int Workers() const { return workers.Size(); };
 	/// IF false, no.
 	bool acceptRequests;
+	/// Max amount of distinct searches waiting for a worker.
+	static const int MAX_QUEUED_REQUESTS = 1024;
+	/** When at least this many pending requests share the same goal, they are answered from a flow field towards it instead of searched for one by one.
+		Goals which already have a cached field always use it. 0 disables flow fields for queued requests. Default 4.
+	*/
+	int flowFieldThreshold;
+	/// Max amount of cached flow fields, least recently used ones are evicted first.
+	static const int MAX_FLOW_FIELDS = 16;
 private:
+	/// Starts one worker per hardware thread, minus one for the main thread.
+	void StartWorkers();
+	/// Signals all workers to stop and waits for them to exit.
+	void StopWorkers();
+	/// Worker thread main loop.
+	void WorkerLoop();
+	/// Removes the entity from all queued and in-progress requests. Queued requests left without entities are dropped. Assumes requestMutex is held.
+	void RemoveEntity(Entity * entity);
+	/// Returns a queued or in-progress request for given pair, or NULL. Assumes requestMutex is held.
+	PathRequest * FindRequest(Waypoint * from, Waypoint * to);
+	/// Returns amount of queued or in-progress requests towards given goal. Assumes requestMutex is held.
+	int RequestsTowards(Waypoint * goal);
+	/** Walks the cached flow field towards goal, storing the path in order from -> goal, building the field on the calling thread first if needed.
+		Returns false if the goal cannot be reached, or if another thread is building the field right now.
+	*/
+	bool GetFlowFieldPath(Waypoint * from, Waypoint * goal, Path & path);
+	/** Builds a new flow field towards goal on the active navmesh without holding flowFieldMutex, then swaps it into the cache.
+		Returns false if another thread is already building one towards the same goal.
+	*/
+	bool BuildFlowField(Waypoint * goal);
+	/// Queues a build of the flow field towards goal for the workers, unless one is queued already.
+	void QueueFlowFieldBuild(Waypoint * goal);
+	/// Returns the cached flow field towards goal, valid or not, or NULL. Marks it as used. Assumes flowFieldMutex is held.
+	FlowField * FindFlowField(Waypoint * goal);
+	/// Adds a newly built field to the cache, replacing any older one towards the same goal or evicting the least recently used one. Assumes flowFieldMutex is held.
+	void CacheFlowField(FlowField * field);
+	/// If a flow field towards goal is cached, valid or not.
+	bool HasFlowField(Waypoint * goal);
+
 	/// Last calculated path.
 	Path lastPath;
-	List<Thread*> pathfindingThreads;
-	List<PathMessage*> messageQueue;
+	/// Worker pool.
+	List<std::thread*> workers;
+	bool stopWorkers;
+	/// Guards all request lists below.
+	std::mutex requestMutex;
+	std::condition_variable requestCondition;
+	/// Queued requests, one list per priority.
+	List<PathRequest*> queuedRequests[2];
+	/// Requests currently being searched by a worker.
+	List<PathRequest*> activeRequests;
+	/// Requests finished by a worker, waiting for replies to be sent in Process.
+	List<PathRequest*> finishedRequests;
+	/// Goals whose flow fields are missing or outdated, to be built by the workers. See GetNextWaypoint.
+	List<Waypoint*> flowFieldBuilds;
+	/// Guards the flow field cache. Only held while looking up or swapping fields, never while building one.
+	std::mutex flowFieldMutex;
+	List<FlowField*> flowFields;
+	/// Goals which a thread is building a field towards right now, so that others do not build the same one.
+	List<Waypoint*> flowFieldsBuilding;
+	/// Incremented on each flow field use, see FlowField::lastUsed.
+	unsigned int flowFieldUseCounter;
 };
 
 
 /// Calculates the given path using the A* algorithm
 void AStar(Waypoint * from, Waypoint * to, Path& path);
+/// Calculates the given path using the active NavMesh' path abstraction for long distances, A* otherwise. Default.
+void HierarchicalAStar(Waypoint * from, Waypoint * to, Path& path);
 /// Calculates the given path using the brute force breadth-first algorithm
 void BreadthFirst(Waypoint * from, Waypoint * to, Path& path);
 /// Calculates the given path using the brute force depth-first algorithm
@@ -0,0 +1,29 @@
+/// Emil Hedemalm
+/// 2016-08-15
+/// Tests of the path search functions without an active navmesh.
+
+#include "PathManager.h"
+#include "WaypointManager.h"
+#include "Waypoint.h"
+#include <cassert>
+
+void PathManager::UnitTest()
+{
+	/// Run before the managers are allocated, so use a waypoint manager of our own with no navmesh created.
+	bool allocated = WaypointManager::Instance() == NULL;
+	if (allocated)
+		WaypointManager::Allocate();
+	if (WaypointMan.ActiveNavMesh() == NULL)
+	{
+		Waypoint from, to;
+		to.position = Vector3f(1000.f, 0, 1000.f);
+		Path path;
+		/// The default search function, and the one it falls back to.
+		HierarchicalAStar(&from, &to, path);
+		assert(path.Size() == 0);
+		AStar(&from, &to, path);
+		assert(path.Size() == 0);
+	}
+	if (allocated)
+		WaypointManager::Deallocate();
+}
@@ -9,12 +9,15 @@ PathMessage::PathMessage(Entity * entity, Waypoint * from, Waypoint * to)
 	: Message(MessageType::PATHFINDING_MESSAGE), from(from), to(to), entity(entity)
 {
 	requestResponse = REQUEST;
+	priority = NORMAL_PRIORITY;
 }
 /// Response type. Assumes path has already been written to.
 PathMessage::PathMessage(Entity* entity)
 	: Message(MessageType::PATHFINDING_MESSAGE), entity(entity)
 {
 	requestResponse = RESPONSE;
+	priority = NORMAL_PRIORITY;
+	from = to = NULL;
 }
 
 
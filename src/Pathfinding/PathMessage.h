@@ -32,6 +32,13 @@ public:
 		RESPONSE,
 	};
 	int requestResponse;
+	/// Request priority. Player-controlled entities should use HIGH_PRIORITY so their searches are served first.
+	enum 
+	{
+		NORMAL_PRIORITY,
+		HIGH_PRIORITY,
+	};
+	int priority;
 	Waypoint * to; // Destination wp.
 	Waypoint * from; // Starting point.
 	Path path; // Stored path as reply.
@@ -9,6 +9,7 @@
 #include "StateManager.h"
 #include "Physics/Messages/PhysicsMessage.h"
 #include "WaypointManager.h"
+#include "Player/Player.h"
 
 float PathableProperty::defaultProximityThreshold = 1.0f;
 
@@ -20,8 +21,14 @@ PathableProperty::PathableProperty(Entity* owner)
 	msSinceLastUpdate = 0;
 	updateIntervalMs = 200;
 	proximityThreshold = defaultProximityThreshold;
+	playerControlled = false;
+}
+PathableProperty::~PathableProperty()
+{
+	/// Don't leave any pending searches replying to a deleted entity.
+	if (PathManager::Instance())
+		PathMan.CancelRequests(owner);
 }
-PathableProperty::~PathableProperty(){}
 
 /// Mainly handles.
 void PathableProperty::ProcessMessage(Message * message)
@@ -76,8 +83,9 @@ void PathableProperty::RequestPath(Waypoint * to)
 {
 	Waypoint * from = WaypointMan.GetClosestWaypoint(owner->worldPosition);
 	PathMessage * pm = new PathMessage(owner, from, to);
-	PathMan.QueueMessage(pm); /// TODO: Add message queue and handling in path manager. 
-	/// TODO: Make pathmanager use threads for querying each new path in the navmesh, since it may take some time for each.
+	if (playerControlled || (owner->player && !owner->player->isAI))
+		pm->priority = PathMessage::HIGH_PRIORITY;
+	PathMan.QueueMessage(pm);
 }
 
 /// Requests a path to the target position. This will then be returned via the PathManaging system as a message.
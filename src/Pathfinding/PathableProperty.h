@@ -46,6 +46,8 @@ public:
 	static float defaultProximityThreshold; // default 1.0f
 	/// How long time should go between updates? (minimum) Default 1000ms (1 second)
 	int updateIntervalMs;
+	/// If true, path requests are served before those of other entities. Default false. Entities owned by a non-AI Player are always served first.
+	bool playerControlled;
 	
 private:
 	/// If walking along path.
@@ -34,7 +34,7 @@ void Waypoint::Nullify()
 	data = 0;
 	pData = NULL;
 	id = -1;
-	
+	index = -1;
 }
 
 Waypoint::~Waypoint(){
@@ -37,7 +37,7 @@ public:
 	float elevation;
 	/// Entity that's currently at this waypoint (mostly for debugging)
 	List< Entity* > entities;
-	/// Passability
+	/// Passability. Change it with NavMesh::SetPassable once part of a NavMesh, so flow fields and the path hierarchy are updated.
 	bool passable;
 	/// Other data
 	int data;
@@ -95,6 +95,8 @@ public:
 	int * neighbourIDs;
 	/// Unique ID for this waypoint (in this navMesh).
 	int id;
+	/// Dense index of this waypoint in its NavMesh' waypoint list, maintained by the NavMesh. -1 if not part of any.
+	int index;
 	/// Current amount of neighbours.
 	int neighbours;
 	/// Size of the neighbour arrays at the moment.
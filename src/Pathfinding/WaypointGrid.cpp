@@ -0,0 +1,272 @@
+/// Emil Hedemalm
+/// 2016-08-14
+/// Uniform spatial hash grid of waypoints, used by NavMesh for nearest-waypoint and proximity queries.
+
+#include "WaypointGrid.h"
+#include "PhysicsLib/Shapes/Ray.h"
+#include "MathLib/AEMath.h"
+#include <cmath>
+#include <cassert>
+
+WaypointGrid::WaypointGrid()
+{
+	built = false;
+	cellSize = 1.f;
+	waypoints = 0;
+	builtForWaypoints = 0;
+}
+
+/// Removes all waypoints and marks the grid as not built.
+void WaypointGrid::Clear()
+{
+	cells.clear();
+	built = false;
+	waypoints = 0;
+	builtForWaypoints = 0;
+}
+
+/// Re-builds the grid from given waypoints, picking a cell size so that each occupied cell holds a few waypoints on average.
+void WaypointGrid::Build(const List<Waypoint*> & waypointList)
+{
+	Clear();
+	built = true;
+	builtForWaypoints = waypointList.Size();
+	if (waypointList.Size() == 0)
+		return;
+	Vector3f min = waypointList[0]->position, max = min;
+	for (int i = 1; i < waypointList.Size(); ++i)
+	{
+		const Vector3f & pos = waypointList[i]->position;
+		for (int d = 0; d < 3; ++d)
+		{
+			if (pos[d] < min[d])
+				min[d] = pos[d];
+			if (pos[d] > max[d])
+				max[d] = pos[d];
+		}
+	}
+	/// Only count axes with any extent, so that flat maps get a 2D cell size.
+	float volume = 1.f;
+	int dimensions = 0;
+	for (int d = 0; d < 3; ++d)
+	{
+		float extent = max[d] - min[d];
+		if (extent <= 0.0001f)
+			continue;
+		volume *= extent;
+		++dimensions;
+	}
+	cellSize = 1.f;
+	if (dimensions > 0)
+	{
+		/// Aim for about 2 waypoints per cell.
+		const float waypointsPerCell = 2.f;
+		cellSize = pow(volume * waypointsPerCell / waypointList.Size(), 1.f / dimensions);
+		if (cellSize <= 0.0001f)
+			cellSize = 1.f;
+	}
+	for (int i = 0; i < waypointList.Size(); ++i)
+		Add(waypointList[i]);
+}
+
+Vector3i WaypointGrid::CellOf(const Vector3f & position) const
+{
+	return Vector3i((int) floor(position[0] / cellSize), (int) floor(position[1] / cellSize), (int) floor(position[2] / cellSize));
+}
+
+long long WaypointGrid::Key(int x, int y, int z)
+{
+	/// 21 bits per axis.
+	const long long mask = (1 << 21) - 1;
+	return ((x & mask) << 42) | ((y & mask) << 21) | (z & mask);
+}
+
+const List<Waypoint*> * WaypointGrid::GetCell(int x, int y, int z) const
+{
+	std::unordered_map<long long, List<Waypoint*> >::const_iterator it = cells.find(Key(x, y, z));
+	if (it == cells.end())
+		return NULL;
+	return &it->second;
+}
+
+/// Adds a waypoint into the cell at its current position.
+void WaypointGrid::Add(Waypoint * wp)
+{
+	assert(built);
+	Vector3i cell = CellOf(wp->position);
+	cells[Key(cell.x, cell.y, cell.z)].AddItem(wp);
+	if (waypoints == 0)
+		minCell = maxCell = cell;
+	else 
+	{
+		if (cell.x < minCell.x) minCell.x = cell.x;
+		if (cell.y < minCell.y) minCell.y = cell.y;
+		if (cell.z < minCell.z) minCell.z = cell.z;
+		if (cell.x > maxCell.x) maxCell.x = cell.x;
+		if (cell.y > maxCell.y) maxCell.y = cell.y;
+		if (cell.z > maxCell.z) maxCell.z = cell.z;
+	}
+	++waypoints;
+}
+
+/// Removes a waypoint. Returns false if it was not found in the cell of its current position.
+bool WaypointGrid::Remove(Waypoint * wp)
+{
+	Vector3i cell = CellOf(wp->position);
+	std::unordered_map<long long, List<Waypoint*> >::iterator it = cells.find(Key(cell.x, cell.y, cell.z));
+	if (it == cells.end())
+		return false;
+	if (!it->second.RemoveItemUnsorted(wp))
+		return false;
+	if (it->second.Size() == 0)
+		cells.erase(it);
+	--waypoints;
+	return true;
+}
+
+/** Returns the closest waypoint to position which passes the filter (if any). 
+	If maxDistance is positive, only waypoints within that distance are considered.
+*/
+Waypoint * WaypointGrid::GetClosest(const Vector3f & position, float maxDistance, WaypointFilter filter) const
+{
+	if (waypoints == 0)
+		return NULL;
+	Vector3i center = CellOf(position);
+	/// Search rings (shells of cells) outward, starting at the first ring touching the occupied bounds.
+	int startRing = 0, endRing = 0;
+	int toMin[3] = {minCell.x - center.x, minCell.y - center.y, minCell.z - center.z};
+	int toMax[3] = {maxCell.x - center.x, maxCell.y - center.y, maxCell.z - center.z};
+	for (int d = 0; d < 3; ++d)
+	{
+		if (toMin[d] > startRing)
+			startRing = toMin[d];
+		if (-toMax[d] > startRing)
+			startRing = -toMax[d];
+		if (abs(toMin[d]) > endRing)
+			endRing = abs(toMin[d]);
+		if (abs(toMax[d]) > endRing)
+			endRing = abs(toMax[d]);
+	}
+	if (maxDistance > 0)
+	{
+		int maxRing = (int) ceil(maxDistance / cellSize) + 1;
+		if (maxRing < endRing)
+			endRing = maxRing;
+	}
+	float maxDistSq = maxDistance > 0? maxDistance * maxDistance : -1.f;
+	Waypoint * closest = NULL;
+	float closestDistSq = 0;
+	for (int r = startRing; r <= endRing; ++r)
+	{
+		/// Anything in this ring or beyond is at least (r - 1) cells away.
+		if (closest && r > 0)
+		{
+			float ringMinDist = (r - 1) * cellSize;
+			if (ringMinDist * ringMinDist > closestDistSq)
+				break;
+		}
+		int x0 = center.x - r > minCell.x? center.x - r : minCell.x, x1 = center.x + r < maxCell.x? center.x + r : maxCell.x;
+		int y0 = center.y - r > minCell.y? center.y - r : minCell.y, y1 = center.y + r < maxCell.y? center.y + r : maxCell.y;
+		int z0 = center.z - r > minCell.z? center.z - r : minCell.z, z1 = center.z + r < maxCell.z? center.z + r : maxCell.z;
+		for (int x = x0; x <= x1; ++x)
+		{
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int z = z0; z <= z1; ++z)
+				{
+					/// Only the shell, inner cells were handled by earlier rings.
+					if (abs(x - center.x) != r && abs(y - center.y) != r && abs(z - center.z) != r)
+						continue;
+					const List<Waypoint*> * cell = GetCell(x, y, z);
+					if (!cell)
+						continue;
+					for (int i = 0; i < cell->Size(); ++i)
+					{
+						Waypoint * wp = (*cell)[i];
+						float distSq = (wp->position - position).LengthSquared();
+						if (maxDistSq >= 0 && distSq > maxDistSq)
+							continue;
+						if (closest && distSq >= closestDistSq)
+							continue;
+						if (filter && !filter(wp))
+							continue;
+						closest = wp;
+						closestDistSq = distSq;
+					}
+				}
+			}
+		}
+	}
+	return closest;
+}
+
+/// Adds all waypoints strictly closer than radius to position into result.
+void WaypointGrid::GetWithinRadius(const Vector3f & position, float radius, List<Waypoint*> & result) const
+{
+	if (waypoints == 0)
+		return;
+	Vector3f offset(radius, radius, radius);
+	Vector3i from = CellOf(position - offset), to = CellOf(position + offset);
+	float radiusSq = radius * radius;
+	for (int x = from.x; x <= to.x; ++x)
+	{
+		for (int y = from.y; y <= to.y; ++y)
+		{
+			for (int z = from.z; z <= to.z; ++z)
+			{
+				const List<Waypoint*> * cell = GetCell(x, y, z);
+				if (!cell)
+					continue;
+				for (int i = 0; i < cell->Size(); ++i)
+				{
+					Waypoint * wp = (*cell)[i];
+					if ((wp->position - position).LengthSquared() < radiusSq)
+						result.AddItem(wp);
+				}
+			}
+		}
+	}
+}
+
+/// Returns the waypoint whose direction from the ray's start is closest to the ray's direction, as NavMesh::GetClosestToRay.
+Waypoint * WaypointGrid::GetClosestToRay(Ray & ray) const
+{
+	Vector3f dir = ray.direction.NormalizedCopy();
+	/// Radius of the sphere enclosing a cell.
+	float cellRadius = cellSize * 0.8660254f;
+	float closestDot = 0.0f;
+	Waypoint * closest = NULL;
+	for (std::unordered_map<long long, List<Waypoint*> >::const_iterator it = cells.begin(); it != cells.end(); ++it)
+	{
+		const List<Waypoint*> & cell = it->second;
+		if (cell.Size() == 0)
+			continue;
+		/// Skip whole cells whose bounding sphere cannot contain a better match.
+		Vector3i cellIndex = CellOf(cell[0]->position);
+		Vector3f cellCenter = (Vector3f((float)cellIndex.x, (float)cellIndex.y, (float)cellIndex.z) + Vector3f(0.5f, 0.5f, 0.5f)) * cellSize;
+		Vector3f toCenter = cellCenter - ray.start;
+		float distance = toCenter.Length();
+		if (distance > cellRadius)
+		{
+			float cosToCenter = toCenter.DotProduct(dir) / distance;
+			ClampFloat(cosToCenter, -1.f, 1.f);
+			float angleToCenter = acos(cosToCenter);
+			float angularRadius = asin(cellRadius / distance);
+			float bestAngle = angleToCenter - angularRadius;
+			if (bestAngle > 0 && cos(bestAngle) <= closestDot)
+				continue;
+		}
+		for (int i = 0; i < cell.Size(); ++i)
+		{
+			Waypoint * wp = cell[i];
+			Vector3f rayStartToWp = wp->position - ray.start;
+			rayStartToWp.Normalize();
+			float dotProd = rayStartToWp.DotProduct(dir);
+			if (dotProd > closestDot){
+				closest = wp;
+				closestDot = dotProd;
+			}
+		}
+	}
+	return closest;
+}
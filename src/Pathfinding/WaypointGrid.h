@@ -0,0 +1,65 @@
+/// Emil Hedemalm
+/// 2016-08-14
+/// Uniform spatial hash grid of waypoints, used by NavMesh for nearest-waypoint and proximity queries.
+
+#ifndef WAYPOINT_GRID_H
+#define WAYPOINT_GRID_H
+
+#include "Waypoint.h"
+#include "MathLib/Vector3i.h"
+#include <unordered_map>
+
+class Ray;
+
+/** Buckets waypoints into cubic cells of cellSize, stored sparsely in a hash map so that both flat 2D maps and 3D worlds work.
+	Queries only visit the cells around the query position, instead of every waypoint in the NavMesh.
+	Positions are read when a waypoint is added, so moving a waypoint requires a Remove + Add (or a full Build).
+*/
+class WaypointGrid 
+{
+public:
+	WaypointGrid();
+	/// Filter for the query functions. Return true if the waypoint should be considered.
+	typedef bool (*WaypointFilter)(Waypoint * wp);
+
+	/// Removes all waypoints and marks the grid as not built.
+	void Clear();
+	/// Re-builds the grid from given waypoints, picking a cell size so that each occupied cell holds a few waypoints on average.
+	void Build(const List<Waypoint*> & waypoints);
+	/// If Build has been called since last Clear.
+	bool IsBuilt() const { return built; };
+	/// Amount of waypoints currently in the grid.
+	int Waypoints() const { return waypoints; };
+	/// Amount of waypoints the grid was last built for.
+	int BuiltForWaypoints() const { return builtForWaypoints; };
+
+	/// Adds a waypoint into the cell at its current position.
+	void Add(Waypoint * wp);
+	/// Removes a waypoint. Returns false if it was not found in the cell of its current position.
+	bool Remove(Waypoint * wp);
+
+	/** Returns the closest waypoint to position which passes the filter (if any). 
+		If maxDistance is positive, only waypoints within that distance are considered.
+	*/
+	Waypoint * GetClosest(const Vector3f & position, float maxDistance = -1.f, WaypointFilter filter = NULL) const;
+	/// Adds all waypoints strictly closer than radius to position into result.
+	void GetWithinRadius(const Vector3f & position, float radius, List<Waypoint*> & result) const;
+	/// Returns the waypoint whose direction from the ray's start is closest to the ray's direction, as NavMesh::GetClosestToRay.
+	Waypoint * GetClosestToRay(Ray & ray) const;
+
+	float CellSize() const { return cellSize; };
+private:
+	Vector3i CellOf(const Vector3f & position) const;
+	static long long Key(int x, int y, int z);
+	const List<Waypoint*> * GetCell(int x, int y, int z) const;
+
+	bool built;
+	float cellSize;
+	int waypoints;
+	int builtForWaypoints;
+	/// Bounds of all cells that have held waypoints since last Build. Not shrunk on removal.
+	Vector3i minCell, maxCell;
+	std::unordered_map<long long, List<Waypoint*> > cells;
+};
+
+#endif
@@ -0,0 +1,115 @@
+/// Emil Hedemalm
+/// 2016-08-14
+/// Indexed binary min-heap over dense waypoint indices, used as the open set in path searches.
+
+#include "WaypointHeap.h"
+#include <cassert>
+
+WaypointHeap::WaypointHeap()
+{
+}
+
+/// Clears the heap and makes sure it can hold indices in the range [0, numIndices).
+void WaypointHeap::Reset(int numIndices)
+{
+	/// Only the entries still queued need resetting, the rest are already -1.
+	for (int i = 0; i < heap.Size(); ++i)
+		heapPosition[heap[i]] = -1;
+	heap.Clear();
+	if (heapPosition.Size() < numIndices)
+	{
+		int oldSize = heapPosition.Size();
+		heapPosition.Allocate(numIndices, true);
+		keys.Allocate(numIndices, true);
+		for (int i = oldSize; i < numIndices; ++i)
+			heapPosition[i] = -1;
+		heap.Allocate(numIndices);
+	}
+}
+
+/// Pushes given index with given key. Assumes the index is not already queued.
+void WaypointHeap::Push(int index, float key)
+{
+	assert(index >= 0 && index < heapPosition.Size());
+	assert(heapPosition[index] == -1);
+	keys[index] = key;
+	heap.AddItem(index);
+	heapPosition[index] = heap.Size() - 1;
+	SiftUp(heap.Size() - 1);
+}
+
+/// Lowers the key of an already queued index. Ignored if the new key is not lower.
+void WaypointHeap::DecreaseKey(int index, float key)
+{
+	assert(Contains(index));
+	if (key >= keys[index])
+		return;
+	keys[index] = key;
+	SiftUp(heapPosition[index]);
+}
+
+/// Pops the index with the lowest key.
+int WaypointHeap::Pop()
+{
+	assert(heap.Size() > 0);
+	int top = heap[0];
+	heapPosition[top] = -1;
+	int last = heap.Last();
+	heap.RemoveLast();
+	if (heap.Size() > 0)
+	{
+		Place(0, last);
+		SiftDown(0);
+	}
+	return top;
+}
+
+/// Checks if the index is currently queued.
+bool WaypointHeap::Contains(int index) const
+{
+	return index >= 0 && index < heapPosition.Size() && heapPosition[index] >= 0;
+}
+
+void WaypointHeap::SiftUp(int heapPos)
+{
+	int index = heap[heapPos];
+	float key = keys[index];
+	while (heapPos > 0)
+	{
+		int parentPos = (heapPos - 1) / 2;
+		int parent = heap[parentPos];
+		if (keys[parent] <= key)
+			break;
+		Place(heapPos, parent);
+		heapPos = parentPos;
+	}
+	Place(heapPos, index);
+}
+
+void WaypointHeap::SiftDown(int heapPos)
+{
+	int size = heap.Size();
+	int index = heap[heapPos];
+	float key = keys[index];
+	while (true)
+	{
+		int childPos = heapPos * 2 + 1;
+		if (childPos >= size)
+			break;
+		/// Pick the smaller of the two children.
+		if (childPos + 1 < size && keys[heap[childPos + 1]] < keys[heap[childPos]])
+			++childPos;
+		int child = heap[childPos];
+		if (keys[child] >= key)
+			break;
+		Place(heapPos, child);
+		heapPos = childPos;
+	}
+	Place(heapPos, index);
+}
+
+void WaypointHeap::Place(int heapPos, int index)
+{
+	heap[heapPos] = index;
+	heapPosition[index] = heapPos;
+}
@@ -0,0 +1,43 @@
+/// Emil Hedemalm
+/// 2016-08-14
+/// Indexed binary min-heap over dense waypoint indices, used as the open set in path searches.
+
+#ifndef WAYPOINT_HEAP_H
+#define WAYPOINT_HEAP_H
+
+#include "List/List.h"
+
+/** Priority queue of waypoint indices (see Waypoint::index), ordered by a float key.
+	Keeps track of each index' position within the heap so that keys may be lowered in place (decrease-key),
+	which is what A* and Dijkstra need when a shorter route to an already queued node is found.
+	The buffers are kept between searches, so re-using one heap per thread avoids any allocations after warm-up.
+*/
+class WaypointHeap 
+{
+public:
+	WaypointHeap();
+	/// Clears the heap and makes sure it can hold indices in the range [0, numIndices).
+	void Reset(int numIndices);
+	/// Pushes given index with given key. Assumes the index is not already queued.
+	void Push(int index, float key);
+	/// Lowers the key of an already queued index. Ignored if the new key is not lower.
+	void DecreaseKey(int index, float key);
+	/// Pops the index with the lowest key.
+	int Pop();
+	/// Checks if the index is currently queued.
+	bool Contains(int index) const;
+	bool IsEmpty() const { return heap.Size() == 0; };
+	int Size() const { return heap.Size(); };
+private:
+	void SiftUp(int heapPos);
+	void SiftDown(int heapPos);
+	void Place(int heapPos, int index);
+	/// Indices in heap order.
+	List<int> heap;
+	/// Key per index.
+	List<float> keys;
+	/// Position within the heap per index, -1 if not queued.
+	List<int> heapPosition;
+};
+
+#endif
@@ -256,14 +256,14 @@ void WaypointManager::GenerateNavMeshFromWorld(Entity* worldEntity)
 		/// Just compare one normals for now..
 		float normalDotPosition = mesh->normals[f->normals[0]].DotProduct(wp->position.NormalizedCopy());
 		if (normalDotPosition < 0.5f){
-			wp->passable = false;
+			activeNavMesh->SetPassable(wp, false);
 			--activeNavMesh->walkables;
 		}
 		/// Calculate their elevation too o-o;
 		wp->elevation = wp->position.Length();
 		if (wp->elevation > 4250.0f){
 		//	std::cout<<"\nElevation: "<<wp->elevation;
-			wp->passable = false;
+			activeNavMesh->SetPassable(wp, false);
 			--activeNavMesh->walkables;
 		}
 	}
@@ -383,7 +383,7 @@ bool WaypointManager::ToggleWaypointWalkability(const Vector3f & position){
 	}
 	std::cout<<"\nClosest waypoint: "<<closestWaypoint->position;
 	/// Do stuff
-	closestWaypoint->passable = !closestWaypoint->passable;
+	activeNavMesh->SetPassable(closestWaypoint, !closestWaypoint->passable);
 	/// Check the new mesh too!
 	closestWaypoint = this->activeNavMesh->waypoints[0];
 	distance = (closestWaypoint->position - position).Length();
@@ -397,7 +397,7 @@ bool WaypointManager::ToggleWaypointWalkability(const Vector3f & position){
 	}
 	/// Do stuff
 	std::cout<<"\nClosest waypoint: "<<closestWaypoint->position;
-	closestWaypoint->passable = !closestWaypoint->passable;
+	activeNavMesh->SetPassable(closestWaypoint, !closestWaypoint->passable);
 
 	if (activeNavMesh->optimized){
 		activeNavMesh->Optimize();
@@ -411,23 +411,9 @@ bool WaypointManager::ToggleWaypointWalkability(const Vector3f & position){
 /// Simple get. Checks distance.
 Waypoint * WaypointManager::GetClosestWaypoint(ConstVec3fr toPosition)
 {
-	List<Waypoint*> & waypoints = activeNavMesh->waypoints;
-	if (!waypoints.Size())
+	if (!activeNavMesh->waypoints.Size())
 		return NULL;
-	/// Get a first waypoint
-	Waypoint * closest = NULL;
-	float closestDist = 100000.f;
-	for (int i = 0; i < waypoints.Size(); ++i)
-	{
-		Waypoint * wp = waypoints[i];
-		float thisDist = (wp->position - toPosition).Length();
-		if (thisDist < closestDist)
-		{
-			closest = wp;
-			closestDist = thisDist;
-		}
-	}
-	return closest;
+	return activeNavMesh->GetClosestTo(toPosition);
 }
 
 /// Returns a waypoint that has no active data bound to it's pData member.
@@ -440,62 +426,29 @@ Waypoint * WaypointManager::GetFreeWaypoint(){
 	}
 	return NULL;
 }
+static bool IsValid(Waypoint * wp)
+{
+	return wp->passable;
+}
+static bool IsValidAndFree(Waypoint * wp)
+{
+	return wp->passable && wp->pData == NULL;
+}
+
 /// Returns the closest waypoint to target position that is passable/walkable/valid.
 Waypoint * WaypointManager::GetClosestValidWaypoint(const Vector3f & position)
 {
-	int waypoints = activeNavMesh->waypoints.Size();
-	if (!waypoints)
+	if (!activeNavMesh->waypoints.Size())
 		return NULL;
-	assert(waypoints > 0);
-	/// Get a first waypoint
-	Waypoint * closest = NULL;
-	for (int i = 0; i < waypoints; ++i){
-		if (activeNavMesh->waypoints[i]->passable){
-			closest = activeNavMesh->waypoints[i];
-			break;
-		}
-	}
-	float closestDist = (closest->position - position).Length();
-	for (int i = 0; i < waypoints; ++i){
-		if (!activeNavMesh->waypoints[i]->passable)
-			continue;
-		float thisDist = (activeNavMesh->waypoints[i]->position - position).Length();
-		if (thisDist < closestDist){
-			closest = activeNavMesh->waypoints[i];
-			closestDist = thisDist;
-		}
-	}
-	return closest;
+	return activeNavMesh->GetClosestTo(position, -1.f, IsValid);
 }
 
 /// Gets the closest valid free waypoint (equivalent to GetFreeWaypoint combined with GetClosestValidWaypoint)
 Waypoint * WaypointManager::GetClosestValidFreeWaypoint(const Vector3f & position)
 {
 	assert(activeNavMesh->waypoints.Size() > 0);
-	/// Get an initial one..
-	Waypoint * closest = NULL;
-	for (int i = 0; i < activeNavMesh->waypoints.Size(); ++i){
-		if (!activeNavMesh->waypoints[i]->passable)
-			continue;
-		if (activeNavMesh->waypoints[i]->pData)
-			continue;
-		closest = activeNavMesh->waypoints[i];
-		break;
-	}
-	float closestDist = (closest->position - position).Length();
-	for (int i = 0; i < activeNavMesh->waypoints.Size(); ++i)
-	{
-		if (!activeNavMesh->waypoints[i]->passable)
-			continue;
-		if (activeNavMesh->waypoints[i]->pData)
-			continue;
-		float thisDist = (activeNavMesh->waypoints[i]->position - position).Length();
-		if (thisDist < closestDist){
-			closest = activeNavMesh->waypoints[i];
-			closestDist = thisDist;
-		}
-	}
-	assert(closest->passable && closest->pData == NULL);
+	Waypoint * closest = activeNavMesh->GetClosestTo(position, -1.f, IsValidAndFree);
+	assert(closest && closest->passable && closest->pData == NULL);
 	return closest;
 }
 
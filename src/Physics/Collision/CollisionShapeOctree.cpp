@@ -465,6 +465,7 @@ int CollisionShapeOctree::FindCollisions(Entity* targetEntity, List<Collision> &
 				//	col.one = targetEntity;
 				//	col.two =
 					collissionList.Add(col);
+					std::lock_guard<std::mutex> lock(Physics.activeTrianglesMutex);
 					Physics.activeTriangles.Add(tri);
 				}
 				break;
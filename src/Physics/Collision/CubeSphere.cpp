@@ -6,6 +6,10 @@
 #include "Physics/PhysicsProperty.h"
 #include "PhysicsLib/Shapes/Cube.h"
 #include "PhysicsLib/Shapes/Frustum.h"
+#include <mutex>
+
+/// The cube's shape may be shared by several pairs tested in parallel.
+static std::mutex cubeShapeMutex;
 
 bool CubeSphereCollision(Entity* cubeEntity, Entity* sphereEntity, Collision &data)
 {
@@ -37,6 +41,7 @@ bool CubeSphereCollision(Entity* cubeEntity, Entity* sphereEntity, Collision &da
 
 	
 	/// Save this data for later rendering if it isn't created already, hjaow.
+	cubeShapeMutex.lock();
 	if (cubeEntity->physics->shape == NULL){
 		Cube * cube = new Cube();
 		cubeEntity->physics->shape = (void*)cube;
@@ -50,6 +55,7 @@ bool CubeSphereCollision(Entity* cubeEntity, Entity* sphereEntity, Collision &da
 	c->fartherTopRight = fartherTopRight;
 	c->fartherBottomLeft = fartherBottomLeft;
 	c->fartherBottomRight = fartherBottomRight;
+	cubeShapeMutex.unlock();
 
 
 	// Create the six planes by giving them three points each, in counter-clockwise order
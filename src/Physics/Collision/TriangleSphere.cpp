@@ -134,7 +134,7 @@ bool TriangleSphereCollision(Triangle * triangle, Sphere * sphere, Collision &da
 
 bool TriangleSphereCollision(Triangle * triangle, Entity* sphereEntity, Collision &data, bool planesOnly)
 {
-	static Sphere sphere; // = (Sphere*)sphereEntity->physics->shape;
+	Sphere sphere; // = (Sphere*)sphereEntity->physics->shape;
 	sphere.position = sphereEntity->worldPosition;
 	sphere.radius = sphereEntity->physics->physicalRadius;
 	return TriangleSphereCollision(triangle, &sphere, data, planesOnly);
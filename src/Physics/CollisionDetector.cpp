@@ -9,6 +9,57 @@
 #include "Physics/PhysicsManager.h"
 
 #include "PhysicsLib/PhysicsMesh.h"
+#include "Thread/JobPool.h"
+
+CollisionDetector::CollisionDetector()
+{
+	jobPool = NULL;
+	chunkPairs = NULL;
+}
+
+CollisionDetector::~CollisionDetector()
+{
+	chunkCollisions.ClearAndDelete();
+}
+
+/** Tests all pairs with DetectCollisions(one, two, collisions), split into chunks of PAIRS_PER_JOB across the job pool.
+	Each chunk collects into its own list, and the lists are appended in chunk order, so the result is the same as when testing
+	the pairs in order on a single thread, regardless of amount of workers. 
+*/
+int CollisionDetector::DetectCollisionsInParallel(List<EntityPair> & pairs, List<Collision> & collisions)
+{
+	int collisionsBefore = collisions.Size();
+	int chunks = (pairs.Size() + PAIRS_PER_JOB - 1) / PAIRS_PER_JOB;
+	/// Not worth waking the workers for a single chunk.
+	if (jobPool == NULL || chunks <= 1)
+	{
+		for (int i = 0; i < pairs.Size(); ++i)
+			DetectCollisions(pairs[i].one, pairs[i].two, collisions);
+		return collisions.Size() - collisionsBefore;
+	}
+	while (chunkCollisions.Size() < chunks)
+		chunkCollisions.AddItem(new List<Collision>());
+	chunkPairs = &pairs;
+	jobPool->ParallelFor(chunks, DetectCollisionsJob, this);
+	chunkPairs = NULL;
+	/// Merge in chunk order, so that the order is deterministic.
+	for (int i = 0; i < chunks; ++i)
+		collisions.Add(*chunkCollisions[i]);
+	return collisions.Size() - collisionsBefore;
+}
+
+void CollisionDetector::DetectCollisionsJob(int index, void * data)
+{
+	CollisionDetector * detector = (CollisionDetector*) data;
+	List<EntityPair> & pairs = *detector->chunkPairs;
+	List<Collision> & collisions = *detector->chunkCollisions[index];
+	collisions.Clear();
+	int end = (index + 1) * PAIRS_PER_JOB;
+	if (end > pairs.Size())
+		end = pairs.Size();
+	for (int i = index * PAIRS_PER_JOB; i < end; ++i)
+		detector->DetectCollisions(pairs[i].one, pairs[i].two, collisions);
+}
 
 /// Detects collisions between two entities. Method used is based on physics-shape. Sub-class to override it.
 int CollisionDetector::DetectCollisions(Entity* one, Entity* two, List<Collision> & collisions)
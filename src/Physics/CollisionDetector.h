@@ -10,9 +10,14 @@
 #include "Entity/Entity.h"
 #include "PhysicsLib/AABBSweeper.h"
 
+class JobPool;
+
 class CollisionDetector 
 {
 public:
+	CollisionDetector();
+	virtual ~CollisionDetector();
+
 	/// Does not rely on other structures that require further updates. All entities are present in the list.
 	virtual int DetectCollisions(List<EntityPair> & pairs, List<Collision> & collisions) = 0;
 	/// Does not rely on other structures that require further updates. All entities are present in the list.
@@ -20,7 +25,23 @@ public:
 
 	/// Detects collisions between two entities. Method used is based on physics-shape. Sub-class to override it.
 	virtual int DetectCollisions(Entity* one, Entity* two, List<Collision> & collisions);
+
+	/// Worker threads for the narrow phase, assigned by the PhysicsManager. If NULL, all pairs are tested on the calling thread.
+	JobPool * jobPool;
+protected:
+	/** Tests all pairs with DetectCollisions(one, two, collisions), split into chunks of PAIRS_PER_JOB across the job pool.
+		Each chunk collects into its own list, and the lists are appended in chunk order, so the result is the same as when testing
+		the pairs in order on a single thread, regardless of amount of workers. The per-pair test must thus only write to its output list.
+		Returns amount of collisions found.
+	*/
+	int DetectCollisionsInParallel(List<EntityPair> & pairs, List<Collision> & collisions);
+	static const int PAIRS_PER_JOB = 64;
 private:
+	static void DetectCollisionsJob(int index, void * data);
+	/// Output of each chunk, kept between frames to avoid re-allocation.
+	List< List<Collision>* > chunkCollisions;
+	/// Pairs being tested by DetectCollisionsInParallel.
+	List<EntityPair> * chunkPairs;
 };
 
 #endif
@@ -7,36 +7,10 @@
 #include "Physics/Collision/Collision.h"
 #include "Physics/Collision/Collisions.h"
 
-/// Brute-force method. Does not rely on other structures that require further updates. All entities are present in the list.
+/// Tests the pairs in parallel across the job pool, if any. Output order is the same as when testing them one by one.
 int FirstPersonCD::DetectCollisions(List<EntityPair> & pairs, List<Collision> & collisions)
 {
-	for (int i = 0; i < pairs.Size(); ++i)
-	{
-		// stuff.
-		EntityPair & pair = pairs[i];
-		// do detailed collision detection?
-		Collision data;
-		List<Collision> collisionsFound;
-		// o.o
-		Entity* dynamic = NULL;
-		Entity* dynamic2 = NULL;
-		if (pair.one->physics->type == PhysicsType::DYNAMIC)
-			dynamic = pair.one;
-		if (pair.two->physics->type == PhysicsType::DYNAMIC)
-			dynamic2 = pair.two;
-		if (dynamic == 0 && dynamic2 == 0)
-			continue;
-
-		bool colliding = TestCollision(pair.one, pair.two, collisionsFound);
-		if (!colliding)
-			continue;
-	
-//		std::cout<<"\nCollision, woooo: "<<pair.one->name<<" & "<<pair.two->name;
-
-		collisions.Add(collisionsFound);
-	}
-
-	return 0;
+	return DetectCollisionsInParallel(pairs, collisions);
 }
 
 
@@ -46,11 +20,16 @@ int FirstPersonCD::DetectCollisions(List< Entity* > & entities, List<Collision>
 	// Implement..
 	return 0;
 }
-/// Detects collisions between two entities. Method used is based on physics-shape. Sub-class to override it.
+/// Detects collisions between two entities, if at least one of them is dynamic. May be called from several threads at once.
 int FirstPersonCD::DetectCollisions(Entity* one, Entity* two, List<Collision> & collisions)
 {
-	// Implement..
-	return 0;
+	if (one->physics->type != PhysicsType::DYNAMIC && two->physics->type != PhysicsType::DYNAMIC)
+		return 0;
+	// do detailed collision detection?
+	bool colliding = TestCollision(one, two, collisions);
+//	if (colliding)
+//		std::cout<<"\nCollision, woooo: "<<one->name<<" & "<<two->name;
+	return colliding;
 }
 
 
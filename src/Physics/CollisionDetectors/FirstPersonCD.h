@@ -11,12 +11,12 @@
 class FirstPersonCD : public CollisionDetector 
 {
 public:
-	/// Does not rely on other structures that require further updates. All entities are present in the list.
+	/// Tests the pairs in parallel across the job pool, if any. Output order is the same as when testing them one by one.
 	virtual int DetectCollisions(List<EntityPair> & pairs, List<Collision> & collisions);
 	/// Does not rely on other structures that require further updates. All entities are present in the list.
 	virtual int DetectCollisions(List< Entity* > & entities, List<Collision> & collisions);
 
-	/// Detects collisions between two entities. Method used is based on physics-shape. Sub-class to override it.
+	/// Detects collisions between two entities, if at least one of them is dynamic. May be called from several threads at once.
 	virtual int DetectCollisions(Entity* one, Entity* two, List<Collision> & collisions);
 
 	/// Brute-force method. Does not rely on other structures that require further updates. All entities are present in the list.
@@ -0,0 +1,123 @@
+/// Emil Hedemalm
+/// 2016-08-19
+/// Groups touching bodies into islands, which are put to sleep and woken as a whole.
+
+#include "ContactGraph.h"
+#include "Entity/Entity.h"
+#include "Physics/PhysicsProperty.h"
+#include "Physics/PhysicsStore.h"
+#include "Physics/Collision/Collision.h"
+
+ContactGraph::ContactGraph()
+{
+	sleepLinearVelocity = 0.05f;
+	sleepAngularVelocity = 0.05f;
+	timeToSleep = 0.5f;
+}
+
+/** Call once per physics step after collisions have been resolved. Updates the low-velocity timers of all awake bodies, 
+	which are those in given list as well as the non-sleeping ones of the store, and connects those touching in the collisions.
+	Islands ready to sleep are added to the list, and their entities to the island's. Ownership of the islands goes to the caller.
+*/
+void ContactGraph::FindSleepingIslands(List<Entity*> & dynamicBodies, PhysicsStore & store, List<Collision> & collisions, float timeInSeconds, List<PhysicsIsland*> & islands)
+{
+	bodies.Clear();
+	parent.Clear();
+	canSleep.Clear();
+	for (int i = 0; i < dynamicBodies.Size(); ++i)
+	{
+		Entity * entity = dynamicBodies[i];
+		PhysicsProperty * pp = entity->physics;
+		AddBody(entity, &pp->velocity.x, pp->angularVelocity.LengthSquared(), timeInSeconds);
+	}
+	/// Lightweight bodies have their velocities in the store during the physics steps, and no rotation.
+	for (int i = 0; i < store.entities.Size(); ++i)
+	{
+		Entity * entity = store.entities[i];
+		if (entity->physics->state & CollisionState::SLEEPING)
+			continue;
+		float velocity[3] = {store.velocityX[i], store.velocityY[i], store.velocityZ[i]};
+		AddBody(entity, velocity, 0.f, timeInSeconds);
+	}
+	if (bodies.Size() == 0)
+		return;
+
+	/// Connect bodies touching each other. Bodies touching something that may move on its own (kinematic, or not able to sleep) can not sleep either.
+	for (int i = 0; i < collisions.Size(); ++i)
+	{
+		Collision & c = collisions[i];
+		int one = c.one->physics->islandIndex, two = c.two->physics->islandIndex;
+		if (one >= 0 && two >= 0)
+			Union(one, two);
+		else if (one >= 0 && c.two->physics->type == PhysicsType::KINEMATIC)
+			canSleep[Find(one)] = false;
+		else if (two >= 0 && c.one->physics->type == PhysicsType::KINEMATIC)
+			canSleep[Find(two)] = false;
+	}
+	/// Islands sleep only if all of their bodies are ready.
+	for (int i = 0; i < bodies.Size(); ++i)
+	{
+		int root = Find(i);
+		if (!canSleep[i])
+			canSleep[root] = false;
+	}
+	rootIsland.Clear();
+	for (int i = 0; i < bodies.Size(); ++i)
+		rootIsland.AddItem(NULL);
+	for (int i = 0; i < bodies.Size(); ++i)
+	{
+		bodies[i]->physics->islandIndex = -1;
+		int root = Find(i);
+		if (!canSleep[root])
+			continue;
+		PhysicsIsland *& island = rootIsland[root];
+		if (island == NULL)
+		{
+			island = new PhysicsIsland();
+			islands.AddItem(island);
+		}
+		island->entities.AddItem(bodies[i]);
+	}
+}
+
+/// Adds a body to the union-find structure, or marks it as unable to sleep.
+void ContactGraph::AddBody(Entity * entity, const float * velocity, float angularSpeedSq, float timeInSeconds)
+{
+	PhysicsProperty * pp = entity->physics;
+	float linearSpeedSq = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+	if (linearSpeedSq > sleepLinearVelocity * sleepLinearVelocity || angularSpeedSq > sleepAngularVelocity * sleepAngularVelocity)
+		pp->lowVelocityTime = 0;
+	else 
+		pp->lowVelocityTime += timeInSeconds;
+	/// Bodies with forces, estimators or disabled simulation are driven by something other than collisions, so keep them awake.
+	bool ready = pp->canSleep && pp->lowVelocityTime >= timeToSleep && !pp->useForces && pp->estimators.Size() == 0 && pp->simulationEnabled && !pp->paused;
+	pp->islandIndex = bodies.Size();
+	bodies.AddItem(entity);
+	parent.AddItem(pp->islandIndex);
+	canSleep.AddItem(ready);
+}
+
+/// Union-find, with path halving.
+int ContactGraph::Find(int index)
+{
+	int * p = parent.GetArray();
+	while (p[index] != index)
+	{
+		p[index] = p[p[index]];
+		index = p[index];
+	}
+	return index;
+}
+
+void ContactGraph::Union(int one, int two)
+{
+	one = Find(one);
+	two = Find(two);
+	if (one == two)
+		return;
+	/// Keep the lower index as root, so that the result does not depend on the order of the collisions.
+	if (one < two)
+		parent[two] = one;
+	else
+		parent[one] = two;
+}
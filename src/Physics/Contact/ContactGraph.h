@@ -0,0 +1,59 @@
+/// Emil Hedemalm
+/// 2016-08-19
+/// Groups touching bodies into islands, which are put to sleep and woken as a whole.
+
+#ifndef CONTACT_GRAPH_H
+#define CONTACT_GRAPH_H
+
+#include "List/List.h"
+
+class Entity;
+class PhysicsStore;
+struct Collision;
+
+/// A group of dynamic bodies resting on each other, put to sleep together. Static and kinematic entities are never part of one.
+struct PhysicsIsland 
+{
+	List<Entity*> entities;
+	/// Index in the PhysicsManager's list of sleeping islands.
+	int index;
+};
+
+/** Tracks how long each awake dynamic body has been moving slowly, and connects bodies colliding with each other during a step into islands.
+	Islands where all bodies have stayed below the velocity thresholds for timeToSleep seconds may then be put to sleep,
+	excluding them from integration, sweep sorting and collision detection until they are woken.
+*/
+class ContactGraph 
+{
+public:
+	ContactGraph();
+
+	/** Call once per physics step after collisions have been resolved. Updates the low-velocity timers of all awake bodies, 
+		which are those in given list as well as the non-sleeping ones of the store, and connects those touching in the collisions.
+		Islands ready to sleep are added to the list, and their entities to the island's. Ownership of the islands goes to the caller.
+	*/
+	void FindSleepingIslands(List<Entity*> & bodies, PhysicsStore & store, List<Collision> & collisions, float timeInSeconds, List<PhysicsIsland*> & islands);
+
+	/// Units per second.
+	float sleepLinearVelocity;
+	/// Radians per second.
+	float sleepAngularVelocity;
+	/// Seconds a whole island must stay below the velocity thresholds before it is put to sleep.
+	float timeToSleep;
+private:
+	/// Adds a body to the union-find structure, or marks it as unable to sleep.
+	void AddBody(Entity * entity, const float * velocity, float angularSpeedSq, float timeInSeconds);
+	/// Union-find, with path halving.
+	int Find(int index);
+	void Union(int one, int two);
+
+	/// Scratch, kept between steps to avoid re-allocation. Indexed by PhysicsProperty::islandIndex.
+	List<Entity*> bodies;
+	List<int> parent;
+	/// Per root, if the island is slow enough to sleep.
+	List<bool> canSleep;
+	/// Per root, the island being built.
+	List<PhysicsIsland*> rootIsland;
+};
+
+#endif
@@ -33,9 +33,8 @@ void PhysicsManager::DetectCollisions()
                 e->physics->collissionState = AABB_IDLE;
             }
 
-            List<EntityPair> pairs;
-            pairs.Clear();
-            pairs = aabbSweeper->Sweep();
+            List<EntityPair> & pairs = broadPhasePairs;
+            aabbSweeper->Sweep(pairs);
 //               aabbSweeper->PrintSortedList();
     //           std::cout<<"\nBroad phase AABB sweep pairs: "<<pairs.Size();
             for (int i = 0; i < pairs.Size(); ++i)
@@ -5,6 +5,7 @@
 #include "Integrator.h"
 #include "Physics/Springs/Spring.h"
 #include "Timer/Timer.h"
+#include "Physics/PhysicsStore.h"
 
 Integrator::Integrator()
 {
@@ -17,6 +18,12 @@ void Integrator::IsGood()
 	// std::cout<<"\nAll is well.. o.o";
 }
 
+/// Integrates the lightweight bodies, which have no rotation and no forces, only operating on the store's arrays.
+void Integrator::IntegrateStore(PhysicsStore & store, float timeInSeconds)
+{
+	store.Integrate(gravity, timeInSeconds);
+}
+
 void Integrator::CalculateForces(List< Entity* > & entities)
 {
 	for (int i = 0; i < entities.Size(); ++i)
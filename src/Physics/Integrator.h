@@ -8,6 +8,8 @@
 #include "Physics/PhysicsProperty.h"
 #include "Entity/Entity.h"
 
+class PhysicsStore;
+
 void RecalculateMatrices(List< Entity* > entities);
 
 class Integrator 
@@ -24,6 +26,10 @@ public:
 		If not subclassed, the standard IntegrateEntities is called.
 	*/
 	virtual void IntegrateKinematicEntities(List< Entity* > & kinematicEntities, float timeInSeconds) = 0;
+	/** Integrates the lightweight bodies, which have no rotation and no forces, only operating on the store's arrays.
+		By default calls PhysicsStore::Integrate with this integrator's gravity. Subclass for e.g. 2D constraints.
+	*/
+	virtual void IntegrateStore(PhysicsStore & store, float timeInSeconds);
 	
 	/// -9.82 y by default
 	Vector3f gravity;
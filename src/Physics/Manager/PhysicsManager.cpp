@@ -27,6 +27,9 @@
 #include "File/LogFile.h"
 #include "Mesh/Mesh.h"
 #include "Graphics/FrameStatistics.h"
+#include "Thread/JobPool.h"
+#include "Physics/PhysicsStore.h"
+#include "Physics/Contact/ContactGraph.h"
 
 #include <ctime>
 
@@ -34,7 +37,6 @@ PhysicsManager * PhysicsManager::physicsManager = NULL;
 
 List<PhysicsMessage*> requeuedMessages;
 
-// static const int MAX_REGISTERED_ENTITIES = 2048;
 /// Allocate
 void PhysicsManager::Allocate(){
 	assert(physicsManager == NULL);
@@ -65,7 +67,18 @@ PhysicsManager::PhysicsManager()
 	gravitation[1] = -DEFAULT_GRAVITY; // Sets default gravitation (corresponds to 9.82 m/s^2 in real life, if 1 unit is 1 meter in-game.
 
 	physicsMessageQueueMutex.Create("physicsMessageQueueMutex");
+	jobPool = new JobPool();
 	aabbSweeper = new AABBSweeper();
+	aabbSweeper->jobPool = jobPool;
+	bodyStore = new PhysicsStore();
+	contactGraph = new ContactGraph();
+	sleepingEnabled = true;
+	fixedTimeStep = false;
+	fixedStepMs = 10;
+	maxSubSteps = 8;
+	timeAccumulated = 0;
+	interpolationAlpha = 1.f;
+	physicsSteps = 0;
 	checkType = AABB_SWEEP;
 
 	pauseOnCollision = false;
@@ -89,6 +102,10 @@ PhysicsManager::~PhysicsManager()
 	requeuedMessages.ClearAndDelete(); // Also the queued ones.
 
 	SAFE_DELETE(aabbSweeper);
+	SAFE_DELETE(jobPool);
+	SAFE_DELETE(bodyStore);
+	SAFE_DELETE(contactGraph);
+	sleepingIslands.ClearAndDelete();
 	SAFE_DELETE(entityCollisionOctree);
 	CLEAR_AND_DELETE(physicsMeshes);
 	physicsMeshes.ClearAndDelete();
@@ -513,7 +530,9 @@ Entities PhysicsManager::GetEntities(){
 	return Entities(physicalEntities);
 }
 List< Entity* > PhysicsManager::GetDynamicEntities(){
-	return dynamicEntities;
+	List< Entity* > entities = dynamicEntities;
+	entities.Add(bodyStore->entities);
+	return entities;
 }
 
 /// Loads physics mesh if not already loaded.
@@ -590,24 +609,6 @@ void PhysicsManager::RecalculatePhysicsMesh(Mesh * mesh)
 	}
 }
 
-/*
-private:
-	/// If calculations should pause.
-	bool paused;
-	/// Time in milliseconds that last physics update was performed.
-	long lastUpdate;
-
-	/// Array with pointers to all registered objects.
-	Entity* Entity[MAX_REGISTERED_ENTITIES];
-	/// Amount of currently registered objects.
-	int registeredEntities;
-
-	/// Gravitation vector, may be altered with functions later if wished.
-	Vector3f gravitation;
-	/// Density of air.
-	float airDensity;
-	*/
-
 /** Recalculates physical properties for the selected entities. */
 void PhysicsManager::RecalculatePhysicsProperties(){
     /// This should be handled elsewhere as it's probably a bit of a time-sink?
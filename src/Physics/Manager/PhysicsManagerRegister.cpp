@@ -3,6 +3,8 @@
 #include "../PhysicsProperty.h"
 #include "../PhysicsManager.h"
 #include "PhysicsLib/AABBSweeper.h"
+#include "../PhysicsStore.h"
+#include "../Contact/ContactGraph.h"
 
 #include "PhysicsLib/Shapes/OBB.h"
 #include "Pathfinding/PathfindingProperty.h"
@@ -10,7 +12,7 @@
 #include "Entity/EntityManager.h"
 
 /** Registers an Entity to take part in physics calculations. This requires that the Entity has the physics attribute attached.
-	Returns 0 upon success, 1 if it's lacking a physics attribute, 2 if the Entity array has been filled and 3 if the dynamic entity array has been filled.
+	Returns 0 upon success. There is no limit on the amount of registered entities.
 */
 int PhysicsManager::RegisterEntity(Entity* newEntity)
 {
@@ -23,12 +25,6 @@ int PhysicsManager::RegisterEntity(Entity* newEntity)
 	int entitiesInOctree = entityCollisionOctree->RegisteredEntities();
 	int physicalEntitiesNum = physicalEntities.Size();
 //	int aabbSweeperNodes = aabbSweeper->Nodes();
-	int collidingEntities = 0;
-	for (int i = 0; i < physicalEntities.Size(); ++i){
-        if (physicalEntities[i]->physics->collisionsEnabled){
-            ++collidingEntities;
-        }
-    }
 
 	/// Create AABB.. unless model is missing.
 	if (newEntity->model)
@@ -48,12 +44,12 @@ int PhysicsManager::RegisterEntity(Entity* newEntity)
 	//	assert(false && "WARNING: Entity already registered for physics in PhysicsManager::RegisterEntity");
 		return 0;
 	}
-	assert(!physicalEntities.Exists(newEntity) && "Entity already registered for Physics!");
-	if (physicalEntities.Exists(newEntity))
-		return 4;
-	physicalEntities.Add(newEntity);
+	/// registeredForPhysics guards against duplicates, so skip the linear search through all entities.
+	physicalEntities.AddItem(newEntity);
 
 	PhysicsProperty * pp = newEntity->physics;
+	/// Lightweight bodies go into the store instead of the dynamic entity lists. Children need their parents' transforms, so not them.
+	bool lightweight = pp->type == PhysicsType::DYNAMIC && pp->lightweight && newEntity->parent == NULL;
 	if (!pp->obb)
 		pp->obb = new OBB();
 
@@ -86,9 +82,14 @@ int PhysicsManager::RegisterEntity(Entity* newEntity)
 	{
 		case PhysicsType::DYNAMIC:
 		{
+			newEntity->physics->state = 0;
+			if (lightweight)
+			{
+				bodyStore->Add(newEntity);
+				break;
+			}
 			assert(!dynamicEntities.Exists(newEntity) && "Entity already registered for dynamic calculations!");
 			dynamicEntities.Add(newEntity);
-			newEntity->physics->state = 0;
 			break;
 		}
 		case PhysicsType::KINEMATIC:
@@ -111,28 +112,19 @@ int PhysicsManager::RegisterEntity(Entity* newEntity)
 	{
 		case PhysicsType::DYNAMIC:
 		case PhysicsType::KINEMATIC:
+			if (lightweight)
+				break;
 			if (pp->fullyDynamic) 
 				fullyDynamicEntities.Add(newEntity);
 			else 
 				semiDynamicEntities.Add(newEntity); 
 	}
 
-	if (pp->useForces)
+	if (pp->useForces && !lightweight)
 		forceBasedEntities.Add(newEntity);
 	
 	Physics.EnsurePhysicsMeshIfNeeded(newEntity);
 
-	entitiesInOctree = entityCollisionOctree->RegisteredEntities();
-	physicalEntitiesNum = physicalEntities.Size();
-//	aabbSweeperNodes = aabbSweeper->Nodes();
-	collidingEntities = 0;
-	for (int i = 0; i < physicalEntities.Size(); ++i){
-        if (physicalEntities[i]->physics->collisionsEnabled){
-            ++collidingEntities;
-        }
-    }
-
-
 	/// Recalculate AABB/OBB-data.
 	if (newEntity->model)
 	{
@@ -174,12 +166,6 @@ int PhysicsManager::UnregisterEntity(Entity* entityToRemove)
 	int physicalEntitiesNum = physicalEntities.Size();
 //	int aabbSweeperNodes = aabbSweeper->Nodes();
 	assert(entitiesInOctree <= physicalEntitiesNum);
-	int collidingEntities = 0;
-	for (int i = 0; i < physicalEntities.Size(); ++i){
-        if (physicalEntities[i]->physics->collisionsEnabled){
-            ++collidingEntities;
-        }
-    }
 
 	// Remove from physical entities list
 	bool removedResult = physicalEntities.Remove(entityToRemove) ;
@@ -192,7 +178,13 @@ int PhysicsManager::UnregisterEntity(Entity* entityToRemove)
 	// pp o.o
 	PhysicsProperty * pp = entityToRemove->physics;
 
-	if (pp->useForces)
+	bool lightweight = pp->storeIndex >= 0;
+	/// Sleeping entities have already been removed from the dynamic lists.
+	bool sleeping = pp->island != NULL;
+	RemoveFromIsland(entityToRemove);
+	if (lightweight)
+		bodyStore->Remove(entityToRemove);
+	else if (pp->useForces)
 		forceBasedEntities.Remove(entityToRemove);
 
 
@@ -211,12 +203,17 @@ int PhysicsManager::UnregisterEntity(Entity* entityToRemove)
 	{
 		case PhysicsType::DYNAMIC:
 		{
-			assert(dynamicEntities.Remove(entityToRemove) && "Trying to unregister entity that has not been previously registered for dynamic calculations!");
+			if (lightweight || sleeping)
+				break;
+			/// Removal kept outside the assertion, so that it still happens when they are compiled out.
+			bool removed = dynamicEntities.Remove(entityToRemove);
+			assert(removed && "Trying to unregister entity that has not been previously registered for dynamic calculations!");
 			break;
 		}
 		case PhysicsType::KINEMATIC:
 		{
-			assert(kinematicEntities.Remove(entityToRemove) && "Trying to unregister entity that has not been previously registered for dynamic calculations!");
+			bool removed = kinematicEntities.Remove(entityToRemove);
+			assert(removed && "Trying to unregister entity that has not been previously registered for dynamic calculations!");
 			break;
 		}
 	}
@@ -224,6 +221,8 @@ int PhysicsManager::UnregisterEntity(Entity* entityToRemove)
 	{
 		case PhysicsType::DYNAMIC:
 		case PhysicsType::KINEMATIC:
+			if (lightweight || sleeping)
+				break;
 			if (pp->fullyDynamic) 
 				fullyDynamicEntities.Remove(entityToRemove);
 			else 
@@ -233,15 +232,6 @@ int PhysicsManager::UnregisterEntity(Entity* entityToRemove)
 	/// Mark as not registerd for physics anymore.
 	entityToRemove->registeredForPhysics = false;
 
-	entitiesInOctree = entityCollisionOctree->RegisteredEntities();
-	physicalEntitiesNum = physicalEntities.Size();
-	collidingEntities = 0;
-	for (int i = 0; i < physicalEntities.Size(); ++i)
-	{
-        if (physicalEntities[i]->physics->collisionsEnabled){
-            ++collidingEntities;
-        }
-    }
 	if (entityToRemove->pathfindingProperty)
 	{
 		delete entityToRemove->pathfindingProperty;
@@ -269,13 +259,17 @@ int PhysicsManager::UnregisterAllEntities()
 	for (int i = 0; i < physicalEntities.Size(); ++i)
 	{
 		physicalEntities[i]->registeredForPhysics = false;
+		physicalEntities[i]->physics->island = NULL;
+		physicalEntities[i]->physics->state &= ~CollisionState::SLEEPING;
 	}
+	sleepingIslands.ClearAndDelete();
 	physicalEntities.Clear();
 	dynamicEntities.Clear();
 	kinematicEntities.Clear();
 	fullyDynamicEntities.Clear();
 	semiDynamicEntities.Clear();
 	forceBasedEntities.Clear();
+	bodyStore->Clear();
 	if (aabbSweeper)
 		aabbSweeper->Clear();
 	if (entityCollisionOctree)
@@ -31,6 +31,7 @@ PMSet::PMSet(int target, float fValue)
 	switch(target)
 	{
 		case PT_SIMULATION_SPEED:
+		case PT_FIXED_STEP_RATE:
 		case PT_AIR_DENSITY:
 		case PT_GRAVITY:
 		case PT_DEFAULT_DENSITY:
@@ -46,6 +47,7 @@ PMSet::PMSet(int target, bool bValue)
 {
 	switch(target){
 		case PT_PAUSE_ON_COLLISSION:
+		case PT_FIXED_TIME_STEP:
 			break;
 		default:
 			assert(false && "Invalid target in PMSet");
@@ -75,6 +77,12 @@ void PMSet::Process()
 		case PT_SIMULATION_SPEED:
 			Physics.simulationSpeed = floatValue;
 			break;
+		case PT_FIXED_TIME_STEP:
+			Physics.fixedTimeStep = bValue;
+			break;
+		case PT_FIXED_STEP_RATE:
+			Physics.SetFixedStepRate(floatValue);
+			break;
 		case PT_AIR_DENSITY:
 			Physics.airDensity = floatValue;
 			break;
@@ -133,6 +141,8 @@ void PMSet::Process()
 				delete physics.collisionDetector;
 			LogPhysics("Setting new collision detector", INFO);
 			physics.collisionDetector = cd;
+			if (cd)
+				cd->jobPool = physics.jobPool;
 			break;
 		}
 	}
@@ -147,6 +157,7 @@ PMSeti::PMSeti(int target, int iValue)
 		case PT_AABB_SWEEPER_DIVISIONS:
 			break;
 		case PT_INTEGRATOR_TYPE:
+		case PT_MAX_SUB_STEPS:
 			break;
 		case PT_PHYSICS_INTEGRATOR:
 		case PT_COLLISION_DETECTOR:
@@ -173,6 +184,9 @@ void PMSeti::Process()
 		case PT_INTEGRATOR_TYPE:
 			Physics.integratorType = iValue;
 			break;
+		case PT_MAX_SUB_STEPS:
+			physics.maxSubSteps = iValue;
+			break;
 		case PT_PHYSICS_INTEGRATOR: 
 		{
 			// Same. Skip.
@@ -244,6 +244,9 @@ void PMSetEntity::Process()
 		PhysicsProperty * physics = entity->physics;
 		PhysicsProperty * pp = physics;
 		PathfindingProperty * pathProp = entity->pathfindingProperty;
+		/// Any change may set it in motion again.
+		if (pp->state & CollisionState::SLEEPING)
+			Physics.Wake(entity);
 		switch(target)
 		{
 			case PT_INHERIT_POSITION_ONLY:
@@ -4,6 +4,7 @@
 
 #include "PhysicsMessage.h"
 #include "Physics/PhysicsProperty.h"
+#include "Physics/PhysicsManager.h"
 
 #include "PhysicsLib/EstimatorFloat.h"
 
@@ -34,6 +35,8 @@ void PMSlideEntity::Process()
 		}
 		PhysicsProperty * physics = entity->physics;
 		assert(physics);
+		if (physics->state & CollisionState::SLEEPING)
+			Physics.Wake(entity);
 		// Create the slider (estimator)
 		if (!estimatorFloat)
 		{
@@ -59,6 +59,9 @@ enum physicsTargets{
 
 	// Global stuff
 	PT_SIMULATION_SPEED,
+	PT_FIXED_TIME_STEP, // Bool, see PhysicsManager::fixedTimeStep.
+	PT_FIXED_STEP_RATE, // Float, fixed steps per second.
+	PT_MAX_SUB_STEPS, // Int, max fixed steps per frame.
 
 	/// Main collision-detector setups
 	PT_AABB_SWEEPER_DIVISIONS,
@@ -11,12 +11,19 @@
 #include "Messages/PhysicsMessage.h"
 #include <Util.h>
 #include <Mutex/Mutex.h>
+#include <mutex>
+#include <atomic>
 
 class CollisionDetector;
 class Integrator;
 class CollisionResolver;
 class PhysicsMessage;
 class AABBSweeper;
+class JobPool;
+class PhysicsStore;
+class ContactGraph;
+struct PhysicsIsland;
+struct EntityPair;
 class Mesh;
 struct Contact;
 class Spring;
@@ -122,11 +129,6 @@ public:
 	/// Initializes the vfcOctree to the specified bounds.
 	void InitOctree(float leftBound, float rightBound, float topBound, float bottomBound, float nearBound, float farBound);
 
-#define MAX_PHYSICAL_ENTITIES Physics::MAX_REGISTERED_ENTITIES
-
-	static const int MAX_REGISTERED_ENTITIES = 2048;
-	static const int MAX_DYNAMIC_ENTITIES = 256;
-
 	// Enters a message into the message queue
 	void QueueMessage(PhysicsMessage * msg);
 	// Enters a message into the message queue
@@ -147,6 +149,31 @@ public:
 	List< Entity* > GetDynamicEntities();
 	const Vector3f Gravity() const { return gravitation; };
 
+	/// Wakes the entity's sleeping island, if any. Only to be called from the physics thread.
+	void Wake(Entity * entity);
+	/// Default true. Puts islands of resting dynamic bodies to sleep, excluding them from simulation until woken.
+	bool sleepingEnabled;
+	/// Finds the islands, and holds the thresholds for when to put them to sleep.
+	ContactGraph * contactGraph;
+
+	/** Default false, in which case step sizes vary between 5 and 15 ms to match the frame times.
+		If true, the simulation only advances in steps of exactly fixedStepMs, making it reproducible regardless of frame rate, 
+		and rendering interpolates positions between the last two steps, see InterpolatedPosition.
+	*/
+	bool fixedTimeStep;
+	/// Step size when using fixed time steps. Default 10 ms (100 Hz).
+	int fixedStepMs;
+	/// Sets fixedStepMs from given steps per second, rounded to whole milliseconds.
+	void SetFixedStepRate(float stepsPerSecond);
+	/// Max steps per frame when using fixed time steps, default 8. Time beyond that is dropped, slowing down the simulation instead of the frame rate.
+	int maxSubSteps;
+	/// Fraction of a fixed step accumulated but not yet simulated, 0 to 1. Always 1 when not using fixed time steps.
+	float InterpolationAlpha() const { return interpolationAlpha; };
+	/** Sets position to where the entity should be rendered, between its positions before and after the last fixed step.
+		Returns false if its current transform should be used as is, e.g. if not using fixed time steps, or if it did not move during the last step.
+	*/
+	bool InterpolatedPosition(Entity * entity, Vector3f & position);
+
 	/// Numeric statistics
 	inline float GetPhysicsMeshCollisionChecks() const { return physicsMeshCollisionChecks; };
 
@@ -164,8 +191,8 @@ public:
 	/// In kg per m^3
 	float defaultDensity;
 
-	/// Numeric statistics
-	float physicsMeshCollisionChecks;
+	/// Numeric statistics. Atomic as the narrow phase may run on several threads.
+	std::atomic<int> physicsMeshCollisionChecks;
 
 	Vector3f GetGravitation() { return gravitation; };
 
@@ -199,6 +226,8 @@ private:
 
 	/// List of triangles active in collissions. Cleared each frame.
 	List<Triangle> activeTriangles;
+	/// For adding to the above from the narrow phase.
+	std::mutex activeTrianglesMutex;
 
 	/// Mutex to be used for accessing the message queue.
 	Mutex physicsMessageQueueMutex;
@@ -224,8 +253,7 @@ private:
 	void SetPhysicsShape(List< Entity* > targetEntities, int type);
 
 	/** Registers an Entity to take part in physics calculations. This requires that the Entity has the physics attribute attached.
-		Returns 0 upon success, 1 if it's lacking a physics attribute, 2 if the Entity array has been filled and 3 if the dynamic entity array has been filled.
-		4 if it's already registered.
+		Returns 0 upon success. There is no limit on the amount of registered entities.
 	*/
 	int RegisterEntity(Entity* Entity);
 	/** Registers a selection of entities to take part in physics calculations. This requires that the entities have physics attributes attached.
@@ -251,6 +279,33 @@ private:
 	/// Physics collission octree for minimizing amount of collission detection checks.
 	PhysicsOctree * entityCollisionOctree;
 	AABBSweeper * aabbSweeper;
+	/// Worker threads for parallel parts of the physics pipeline, such as the AABB sweep.
+	JobPool * jobPool;
+	/// Pairs from the broad phase. Kept between frames to avoid re-allocation.
+	List<EntityPair> broadPhasePairs;
+	/// Lightweight dynamic bodies (see PhysicsProperty::lightweight), integrated in bulk instead of via the dynamic entity lists.
+	PhysicsStore * bodyStore;
+
+	/// Puts islands which have come to rest during the last step to sleep.
+	void UpdateSleepingIslands(List<Collision> & collisions, float timeInSeconds);
+	/// Wakes sleeping islands touched by awake entities in the collisions, before they are resolved.
+	void WakeTouchedIslands(List<Collision> & collisions);
+	/// Removes the entity from its sleeping island without waking the rest, when unregistering it.
+	void RemoveFromIsland(Entity * entity);
+	/// Removes entities flagged as sleeping from the list, retaining order.
+	void RemoveSleeping(List<Entity*> & entities);
+	/// Islands currently sleeping. Each knows its index here.
+	List<PhysicsIsland*> sleepingIslands;
+	/// Scratch for UpdateSleepingIslands.
+	List<PhysicsIsland*> newSleepingIslands;
+
+	/// Saves positions of all moving entities before the last step of a frame, see InterpolatedPosition.
+	void SavePreviousPositions();
+	/// Simulation time carried over to the next frame, in seconds.
+	float timeAccumulated;
+	float interpolationAlpha;
+	/// Physics steps taken in total.
+	int64 physicsSteps;
 
 	/// If calculations should pause.
 	bool paused;
@@ -268,17 +323,6 @@ private:
 		kinematicEntities,
 		fullyDynamicEntities, // Most non-static ones?
 		semiDynamicEntities;  // Those entities which are KINEMATIC or DYNAMIC but have the fullyDynamic flag set to false.
-/*	/// Old manual list implementation~~
-	/// Array with pointers to all registered objects.
-	Entity* physicalEntity[MAX_REGISTERED_ENTITIES];
-	/// Amount of currently registered objects.
-	int physicalEntities;
-
-	/// Array with pointers to all registered dynamic objects.
-	Entity* dynamicEntity[MAX_DYNAMIC_ENTITIES];
-	/// Amount of currently registered dynamic entities.
-	int dynamicEntities;
-*/
 
 	/// Gravitation vector, may be altered with functions later if wished.
 	Vector3f gravitation;
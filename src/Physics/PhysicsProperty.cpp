@@ -3,6 +3,7 @@
 
 #include "PhysicsOctree.h"
 #include "PhysicsProperty.h"
+#include "PhysicsManager.h"
 #include "CompactPhysics.h"
 #include "Model/Model.h"
 #include "Contact/Contact.h"
@@ -65,6 +66,8 @@ PhysicsProperty::PhysicsProperty(const PhysicsProperty& other)
 	collisionsEnabled = other.collisionsEnabled;
 	noCollisionResolutions = other.noCollisionResolutions;
 	physicsMesh = other.physicsMesh;
+	lightweight = other.lightweight;
+	canSleep = other.canSleep;
 }
 
 PhysicsProperty::PhysicsProperty(const CompactPhysics * compactPhysics)
@@ -110,6 +113,13 @@ void PhysicsProperty::Nullify()
 	elasticity = 0.9f; // Retain 90% energy off of collisions by default?
 	recalculatePhysicalRadius = true;
 	fullyDynamic = true;
+	lightweight = false;
+	storeIndex = -1;
+	canSleep = true;
+	lowVelocityTime = 0;
+	island = NULL;
+	islandIndex = -1;
+	previousPositionStep = -1;
 	useForces = false;
 	faceVelocityDirection = false;
 	obb = 0;
@@ -236,6 +246,8 @@ void PhysicsProperty::ApplyImpulse(const Vector3f & impulse, const Vector3f & po
 	/// Static objects don't apply anything anyway.
 	if (inverseMass == 0)
 		return;
+	if (state & CollisionState::SLEEPING)
+		Physics.Wake(owner);
 	// Remove IN_REST flag.
 	state &= ~CollisionState::IN_REST;
 	/// Give it an increase to the linear momentum.
@@ -18,6 +18,7 @@ struct Contact;
 class Spring;
 class EntityPhysicsEstimator;
 class AABB;
+struct PhysicsIsland;
 class OBB;
 class Force;
 class Entity;
@@ -39,6 +40,10 @@ namespace CollisionState {
 #define AT_REST IN_REST
 	/** Colliding, applied if a collission occurs. This is reset if no collissions occur next iteration. */
 	const int COLLIDING = 0x00000002;
+	/** Sleeping, part of a PhysicsIsland which has come to rest. Sleeping entities are not integrated, sorted or collision-tested 
+		until woken by an impulse, a PMSetEntity message or a collision with an awake entity. See ContactGraph.
+	*/
+	const int SLEEPING	= 0x00000004;
 };
 
 /// For the locks (PhysicsProperty::locks)
@@ -92,6 +97,29 @@ public:
 	*/
 	bool fullyDynamic;
 
+	/** Default false. Set before registration for large numbers of simple DYNAMIC bodies, such as projectiles and debris.
+		These only get linear motion (no rotation, forces, springs or estimators), integrated in bulk by the PhysicsStore, 
+		and have their matrices updated once at the end of all physics simulation. Ignored for entities with a parent.
+		They go through Integrator::IntegrateStore instead of the active integrator's regular path, so only set it where the two agree.
+	*/
+	bool lightweight;
+	/// Index in PhysicsManager's PhysicsStore, or -1 if not in it.
+	int storeIndex;
+
+	/// Default true. If false, the entity is never put to sleep, e.g. for player-controlled entities.
+	bool canSleep;
+	/// Seconds the entity has been below the ContactGraph's velocity thresholds.
+	float lowVelocityTime;
+	/// The sleeping island this entity belongs to, or NULL if awake.
+	PhysicsIsland * island;
+	/// Used by the ContactGraph while finding islands.
+	int islandIndex;
+
+	/// World position before the last physics step of a frame, saved when using fixed time steps so that rendering can interpolate.
+	Vector3f previousPosition;
+	/// Physics step previousPosition was saved for. Only valid if it matches the PhysicsManager's last step.
+	int64 previousPositionStep;
+
 	/** Minimum amount of time between one collision being resolved to the next. Added as an alternative to sorting 
 		collisions, and will also help with applying friction over time (maybe). Hmm.. Default.. 5 ms?
 	*/
@@ -0,0 +1,226 @@
+/// Emil Hedemalm
+/// 2016-08-18
+/// Contiguous structure-of-arrays storage of the linear state of lightweight bodies, such as projectiles and debris.
+
+#include "PhysicsStore.h"
+#include "PhysicsProperty.h"
+#include "Entity/Entity.h"
+#include "PhysicsLib/Shapes/AABB.h"
+#include <cmath>
+
+PhysicsStore::PhysicsStore()
+{
+}
+
+/// Adds the entity, saving its index in PhysicsProperty::storeIndex. O(1).
+void PhysicsStore::Add(Entity * entity)
+{
+	PhysicsProperty * pp = entity->physics;
+	assert(pp->storeIndex == -1);
+	pp->storeIndex = entities.Size();
+	entities.AddItem(entity);
+	aabbs.AddItem(NULL);
+	Grow();
+	Load(pp->storeIndex);
+}
+
+/// Adds a default value to each array.
+void PhysicsStore::Grow()
+{
+	positionX.AddItem(0); positionY.AddItem(0); positionZ.AddItem(0);
+	velocityX.AddItem(0); velocityY.AddItem(0); velocityZ.AddItem(0);
+	accelerationX.AddItem(0); accelerationY.AddItem(0); accelerationZ.AddItem(0);
+	gravityMultiplier.AddItem(0);
+	linearDamping.AddItem(1);
+	flags.AddItem(0);
+}
+
+/// Removes the entity, moving the last body into its place. O(1).
+void PhysicsStore::Remove(Entity * entity)
+{
+	PhysicsProperty * pp = entity->physics;
+	int index = pp->storeIndex;
+	if (index < 0 || index >= entities.Size() || entities[index] != entity)
+		return;
+	/// Keep whatever was simulated since the last Gather.
+	Store(index);
+	int last = entities.Size() - 1;
+	if (index != last)
+	{
+		entities[index] = entities[last];
+		aabbs[index] = aabbs[last];
+		positionX[index] = positionX[last]; positionY[index] = positionY[last]; positionZ[index] = positionZ[last];
+		velocityX[index] = velocityX[last]; velocityY[index] = velocityY[last]; velocityZ[index] = velocityZ[last];
+		accelerationX[index] = accelerationX[last]; accelerationY[index] = accelerationY[last]; accelerationZ[index] = accelerationZ[last];
+		gravityMultiplier[index] = gravityMultiplier[last];
+		linearDamping[index] = linearDamping[last];
+		flags[index] = flags[last];
+		entities[index]->physics->storeIndex = index;
+	}
+	entities.RemoveLast();
+	aabbs.RemoveLast();
+	positionX.RemoveLast(); positionY.RemoveLast(); positionZ.RemoveLast();
+	velocityX.RemoveLast(); velocityY.RemoveLast(); velocityZ.RemoveLast();
+	accelerationX.RemoveLast(); accelerationY.RemoveLast(); accelerationZ.RemoveLast();
+	gravityMultiplier.RemoveLast();
+	linearDamping.RemoveLast();
+	flags.RemoveLast();
+	pp->storeIndex = -1;
+}
+
+void PhysicsStore::Clear()
+{
+	for (int i = 0; i < entities.Size(); ++i)
+		entities[i]->physics->storeIndex = -1;
+	entities.Clear();
+	aabbs.Clear();
+	positionX.Clear(); positionY.Clear(); positionZ.Clear();
+	velocityX.Clear(); velocityY.Clear(); velocityZ.Clear();
+	accelerationX.Clear(); accelerationY.Clear(); accelerationZ.Clear();
+	gravityMultiplier.Clear();
+	linearDamping.Clear();
+	flags.Clear();
+}
+
+/// Copies state in from all entities. Call once per frame before simulating.
+void PhysicsStore::Gather()
+{
+	for (int i = 0; i < entities.Size(); ++i)
+		Load(i);
+}
+
+/// Writes state back to all entities and updates their transforms. Call once per frame after simulating.
+void PhysicsStore::Scatter()
+{
+	for (int i = 0; i < entities.Size(); ++i)
+		Store(i);
+}
+
+/// Saves the current position of each active body as its PhysicsProperty::previousPosition, for given physics step.
+void PhysicsStore::SavePreviousPositions(int64 step)
+{
+	for (int i = 0; i < entities.Size(); ++i)
+	{
+		if (!(flags[i] & ACTIVE))
+			continue;
+		PhysicsProperty * pp = entities[i]->physics;
+		pp->previousPosition = Vector3f(positionX[i], positionY[i], positionZ[i]);
+		pp->previousPositionStep = step;
+	}
+}
+
+/// Writes state back to those entities of the pairs which are in this store, so that collision detection and resolution see up to date values.
+void PhysicsStore::WriteBack(const List<EntityPair> & pairs)
+{
+	for (int i = 0; i < pairs.Size(); ++i)
+	{
+		const EntityPair & pair = pairs[i];
+		if (pair.one->physics->storeIndex >= 0)
+			Store(pair.one->physics->storeIndex);
+		if (pair.two->physics->storeIndex >= 0)
+			Store(pair.two->physics->storeIndex);
+	}
+}
+
+/// Re-loads state from those entities of the pairs which are in this store, after collision resolution may have changed them.
+void PhysicsStore::Reload(const List<EntityPair> & pairs)
+{
+	for (int i = 0; i < pairs.Size(); ++i)
+	{
+		const EntityPair & pair = pairs[i];
+		if (pair.one->physics->storeIndex >= 0)
+			Load(pair.one->physics->storeIndex);
+		if (pair.two->physics->storeIndex >= 0)
+			Load(pair.two->physics->storeIndex);
+	}
+}
+
+/// Writes back and stops simulating the entity's body when it falls asleep, or re-loads it when woken. Set CollisionState::SLEEPING before calling.
+void PhysicsStore::UpdateSleeping(Entity * entity)
+{
+	int index = entity->physics->storeIndex;
+	if (index < 0)
+		return;
+	Store(index);
+	Load(index);
+}
+
+/** Semi-implicit Euler integration of all bodies: velocity += (acceleration + gravity * gravityMultiplier) * dt, 
+	velocity *= linearDamping ^ dt, position += velocity * dt. AABBs of colliding bodies are moved along, for the broad phase.
+*/
+void PhysicsStore::Integrate(const Vector3f & gravity, float timeInSeconds)
+{
+	int numBodies = entities.Size();
+	if (numBodies == 0)
+		return;
+	float * px = positionX.GetArray(), * py = positionY.GetArray(), * pz = positionZ.GetArray();
+	float * vx = velocityX.GetArray(), * vy = velocityY.GetArray(), * vz = velocityZ.GetArray();
+	const float * ax = accelerationX.GetArray(), * ay = accelerationY.GetArray(), * az = accelerationZ.GetArray();
+	const float * gm = gravityMultiplier.GetArray(), * damping = linearDamping.GetArray();
+	unsigned char * flag = flags.GetArray();
+	const float gx = gravity.x, gy = gravity.y, gz = gravity.z;
+	/// Most bodies share the same damping, so only re-calculate the per-step factor when it changes.
+	float lastDamping = 1.f, dampingFactor = 1.f;
+	for (int i = 0; i < numBodies; ++i)
+	{
+		if (!(flag[i] & ACTIVE))
+			continue;
+		flag[i] &= ~SYNCED;
+		float g = (flag[i] & RESTING)? 0.f : gm[i];
+		if (damping[i] != lastDamping)
+		{
+			lastDamping = damping[i];
+			dampingFactor = pow(lastDamping, timeInSeconds);
+		}
+		vx[i] = (vx[i] + (ax[i] + gx * g) * timeInSeconds) * dampingFactor;
+		vy[i] = (vy[i] + (ay[i] + gy * g) * timeInSeconds) * dampingFactor;
+		vz[i] = (vz[i] + (az[i] + gz * g) * timeInSeconds) * dampingFactor;
+		px[i] += vx[i] * timeInSeconds;
+		py[i] += vy[i] * timeInSeconds;
+		pz[i] += vz[i] * timeInSeconds;
+	}
+	/// Move the AABBs along in a separate pass, keeping the loop above on the arrays only.
+	AABB ** aabb = aabbs.GetArray();
+	for (int i = 0; i < numBodies; ++i)
+	{
+		if (!aabb[i] || !(flag[i] & ACTIVE))
+			continue;
+		Vector3f offset = Vector3f(px[i], py[i], pz[i]) - aabb[i]->position;
+		aabb[i]->position += offset;
+		aabb[i]->min += offset;
+		aabb[i]->max += offset;
+	}
+}
+
+/// Copies state in from the entity at given index.
+void PhysicsStore::Load(int index)
+{
+	Entity * entity = entities[index];
+	PhysicsProperty * pp = entity->physics;
+	const Vector3f & position = entity->localPosition;
+	positionX[index] = position.x; positionY[index] = position.y; positionZ[index] = position.z;
+	velocityX[index] = pp->velocity.x; velocityY[index] = pp->velocity.y; velocityZ[index] = pp->velocity.z;
+	accelerationX[index] = pp->acceleration.x; accelerationY[index] = pp->acceleration.y; accelerationZ[index] = pp->acceleration.z;
+	gravityMultiplier[index] = pp->gravityMultiplier;
+	linearDamping[index] = pp->linearDamping;
+	unsigned char flag = SYNCED;
+	if (pp->simulationEnabled && !pp->paused && !(pp->state & CollisionState::SLEEPING))
+		flag |= ACTIVE;
+	if (pp->state & CollisionState::IN_REST)
+		flag |= RESTING;
+	flags[index] = flag;
+	aabbs[index] = pp->collisionsEnabled? entity->aabb : NULL;
+}
+
+/// Writes state out to the entity at given index, updating its transform.
+void PhysicsStore::Store(int index)
+{
+	if (flags[index] & SYNCED)
+		return;
+	flags[index] |= SYNCED;
+	Entity * entity = entities[index];
+	PhysicsProperty * pp = entity->physics;
+	entity->localPosition = Vector3f(positionX[index], positionY[index], positionZ[index]);
+	pp->velocity = pp->currentVelocity = Vector3f(velocityX[index], velocityY[index], velocityZ[index]);
+	entity->RecalculateMatrix(Entity::TRANSLATION_ONLY, true);
+}
@@ -0,0 +1,79 @@
+/// Emil Hedemalm
+/// 2016-08-18
+/// Contiguous structure-of-arrays storage of the linear state of lightweight bodies, such as projectiles and debris.
+
+#ifndef PHYSICS_STORE_H
+#define PHYSICS_STORE_H
+
+#include "List/List.h"
+#include "MathLib.h"
+
+class Entity;
+class AABB;
+struct EntityPair;
+
+/** Keeps position, velocity, acceleration, gravity and damping of bodies flagged PhysicsProperty::lightweight in separate arrays,
+	so that integrating tens of thousands of them only streams through a few floats per body instead of whole Entity and PhysicsProperty objects.
+
+	Per frame, Gather copies the state in from the entities, after which any number of physics steps operate on the arrays only,
+	and Scatter writes it back and updates the entities' transforms once. Bodies involved in collisions are written back and re-loaded
+	individually around the narrow phase, see WriteBack and Reload.
+*/
+class PhysicsStore 
+{
+public:
+	PhysicsStore();
+
+	/// Adds the entity, saving its index in PhysicsProperty::storeIndex. O(1).
+	void Add(Entity * entity);
+	/// Removes the entity, moving the last body into its place. O(1).
+	void Remove(Entity * entity);
+	void Clear();
+	int Size() const { return entities.Size(); };
+
+	/// Copies state in from all entities. Call once per frame before simulating.
+	void Gather();
+	/// Writes state back to all entities and updates their transforms. Call once per frame after simulating.
+	void Scatter();
+	/// Writes state back to those entities of the pairs which are in this store, so that collision detection and resolution see up to date values.
+	void WriteBack(const List<EntityPair> & pairs);
+	/// Re-loads state from those entities of the pairs which are in this store, after collision resolution may have changed them.
+	void Reload(const List<EntityPair> & pairs);
+	/// Writes back and stops simulating the entity's body when it falls asleep, or re-loads it when woken. Set CollisionState::SLEEPING before calling.
+	void UpdateSleeping(Entity * entity);
+	/// Saves the current position of each active body as its PhysicsProperty::previousPosition, for given physics step.
+	void SavePreviousPositions(int64 step);
+
+	/** Semi-implicit Euler integration of all bodies: velocity += (acceleration + gravity * gravityMultiplier) * dt, 
+		velocity *= linearDamping ^ dt, position += velocity * dt. AABBs of colliding bodies are moved along, for the broad phase.
+	*/
+	void Integrate(const Vector3f & gravity, float timeInSeconds);
+
+	/// Flags per body.
+	enum {
+		/// Simulation enabled, not paused and not sleeping.
+		ACTIVE = 1,
+		/// IN_REST, no gravity applied.
+		RESTING = 2,
+		/// Entity matches the arrays, set by Load and Store and cleared by Integrate, so that bodies in several pairs are only written back once.
+		SYNCED = 4,
+	};
+
+	/// The arrays, all indexed by store index.
+	List<Entity*> entities;
+	/// AABB of each entity, or NULL if collisions are disabled for it.
+	List<AABB*> aabbs;
+	List<float> positionX, positionY, positionZ;
+	List<float> velocityX, velocityY, velocityZ;
+	List<float> accelerationX, accelerationY, accelerationZ;
+	List<float> gravityMultiplier, linearDamping;
+	List<unsigned char> flags;
+private:
+	/// Copies state in from/out to the entity at given index.
+	void Load(int index);
+	void Store(int index);
+	/// Adds a default value to each array.
+	void Grow();
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "Physics/PhysicsProperty.h"
 #include "Physics/Calc/EntityPhysicsEstimator.h"
 #include "Physics/Integrator.h"
+#include "Physics/PhysicsStore.h"
 
 #include "PhysicsLib/Shapes/AABB.h"
 #include "PhysicsLib/Shapes/OBB.h"
@@ -40,6 +41,10 @@ void PhysicsManager::Integrate(float timeInSecondsSinceLastUpdate)
 		physicsIntegrator->RecalculateMatrices(fullyDynamicEntities);
 		FrameStats.physicsIntegration += physicsIntegrator->integrationTimeMs;
 		FrameStats.physicsIntegrationRecalcMatrices += physicsIntegrator->entityMatrixRecalcMs;
+		timer.Start();
+		physicsIntegrator->IntegrateStore(*bodyStore, timeInSecondsSinceLastUpdate);
+		timer.Stop();
+		FrameStats.physicsIntegration += timer.GetMs();
 	}
 	// Old integrators built into the physics-manager.
 	else 
@@ -93,6 +98,7 @@ void PhysicsManager::Integrate(float timeInSecondsSinceLastUpdate)
 			// Recalculate the matrix!
 			dynamicEntity->RecalculateMatrix();
 		}
+		bodyStore->Integrate(gravitation, timeSinceLastUpdate);
 		timer.Stop();
 		int64 ms = timer.GetMs();
 		FrameStats.physicsIntegration += ms;
@@ -0,0 +1,53 @@
+/// Emil Hedemalm
+/// 2016-08-20
+/// Fixed time steps, and interpolating render positions between them.
+
+#include "Physics/PhysicsManager.h"
+#include "Physics/PhysicsProperty.h"
+#include "Physics/PhysicsStore.h"
+
+/// Sets fixedStepMs from given steps per second, rounded to whole milliseconds.
+void PhysicsManager::SetFixedStepRate(float stepsPerSecond)
+{
+	assert(stepsPerSecond > 0);
+	fixedStepMs = int(1000.f / stepsPerSecond + 0.5f);
+	if (fixedStepMs < 1)
+		fixedStepMs = 1;
+}
+
+/// Saves positions of all moving entities before the last step of a frame, see InterpolatedPosition.
+void PhysicsManager::SavePreviousPositions()
+{
+	for (int i = 0; i < dynamicEntities.Size(); ++i)
+	{
+		Entity * entity = dynamicEntities[i];
+		entity->physics->previousPosition = entity->worldPosition;
+		entity->physics->previousPositionStep = physicsSteps;
+	}
+	for (int i = 0; i < kinematicEntities.Size(); ++i)
+	{
+		Entity * entity = kinematicEntities[i];
+		entity->physics->previousPosition = entity->worldPosition;
+		entity->physics->previousPositionStep = physicsSteps;
+	}
+	/// The store's entities are only updated after all steps, so take their positions from the arrays.
+	bodyStore->SavePreviousPositions(physicsSteps);
+}
+
+/** Sets position to where the entity should be rendered, between its positions before and after the last fixed step.
+	Returns false if its current transform should be used as is, e.g. if not using fixed time steps, or if it did not move during the last step.
+*/
+bool PhysicsManager::InterpolatedPosition(Entity * entity, Vector3f & position)
+{
+	if (!fixedTimeStep)
+		return false;
+	PhysicsProperty * pp = entity->physics;
+	/// Positions of children are relative to their parents, so leave them be.
+	if (pp == NULL || entity->parent)
+		return false;
+	/// Not moved during the last step, or was registered since.
+	if (pp->previousPositionStep != physicsSteps)
+		return false;
+	position = pp->previousPosition + (entity->worldPosition - pp->previousPosition) * interpolationAlpha;
+	return true;
+}
@@ -10,6 +10,7 @@
 #include "Physics/CollisionResolver.h"
 #include "Physics/CollisionDetector.h"
 #include "Physics/Integrator.h"
+#include "Physics/PhysicsStore.h"
 
 #include "Physics/Messages/CollisionCallback.h"
 #include "PhysicsLib/AABBSweeper.h"
@@ -80,37 +81,68 @@ void PhysicsManager::ProcessPhysics()
 	float timeDiff = dt;
 	float timeInSecondsSinceLastUpdate = dt;
 
-	static float timeRemainingFromLastIteration = 0.f;
-	/// Add time from last iteration that wasn't spent (since only evaluating one physics step at a time, 10 ms default).
-	float timeToIterate = totalTimeSinceLastUpdate + timeRemainingFromLastIteration;
-	float stepSize = 0.010f;
-	int steps = timeToIterate / stepSize + 0.5f;
-
-	/// Use a new step size based on the amount of steps. This will hopefully vary between 5.0 and 15.0 then.
-	float newStepSize = timeToIterate / steps;
-	int newStepSizeMs = newStepSize * 1000;
-	newStepSize = newStepSizeMs * 0.001f;
-	if (newStepSize < 0.005f || newStepSize > 0.015f)
+	int steps;
+	float newStepSize;
+	int newStepSizeMs;
+	if (fixedTimeStep)
 	{
-		LogPhysics("Step size out of good range: "+String(newStepSize), WARNING);
-		if (newStepSize < 0.f)
-			return;
-//		assert(False)
+		/// Only simulate whole steps, carrying the rest over to the next frame. Rendering interpolates by the part carried over.
+		newStepSizeMs = fixedStepMs;
+		newStepSize = newStepSizeMs * 0.001f;
+		timeAccumulated += totalTimeSinceLastUpdate;
+		steps = int(timeAccumulated / newStepSize);
+		if (steps > maxSubSteps)
+		{
+			/// Can't keep up. Drop the time, or the extra steps would make the next frame even slower.
+			LogPhysics("Dropping "+String(timeAccumulated - maxSubSteps * newStepSize)+" seconds of simulation time.", INFO);
+			steps = maxSubSteps;
+			timeAccumulated = steps * newStepSize;
+		}
+		timeAccumulated -= steps * newStepSize;
+		if (timeAccumulated < 0.f)
+			timeAccumulated = 0.f;
+		interpolationAlpha = timeAccumulated / newStepSize;
+	}
+	else 
+	{
+		/// Add time from last iteration that wasn't spent (since only evaluating one physics step at a time, 10 ms default).
+		float timeToIterate = totalTimeSinceLastUpdate + timeAccumulated;
+		float stepSize = 0.010f;
+		steps = timeToIterate / stepSize + 0.5f;
+
+		/// Use a new step size based on the amount of steps. This will hopefully vary between 5.0 and 15.0 then.
+		newStepSize = timeToIterate / steps;
+		newStepSizeMs = newStepSize * 1000;
+		newStepSize = newStepSizeMs * 0.001f;
+		if (newStepSize < 0.005f || newStepSize > 0.015f)
+		{
+			LogPhysics("Step size out of good range: "+String(newStepSize), WARNING);
+			if (newStepSize < 0.f)
+				return;
+	//		assert(False)
+		}
+	//	assert(newStepSize > 0.005f && newStepSize < 0.015f);
+		
+
+	//	if (steps < 1) // At least 1 physics simulation per frame, yo. Otherwise you get a 'stuttering' effect when some frames have movement and some don't.
+	//		steps = 1;
+		float timeLeft = timeToIterate - steps * newStepSizeMs * 0.001f;
+		/// Store time we won't simulate now.
+		timeAccumulated = timeLeft;
+		interpolationAlpha = 1.f;
 	}
-//	assert(newStepSize > 0.005f && newStepSize < 0.015f);
-	
-
-//	if (steps < 1) // At least 1 physics simulation per frame, yo. Otherwise you get a 'stuttering' effect when some frames have movement and some don't.
-//		steps = 1;
-	float timeLeft = timeToIterate - steps * newStepSizeMs * 0.001f;
-	/// Store time we won't simulate now.
-	timeRemainingFromLastIteration = timeLeft;
 //	std::cout<<"\nSteps: "<<steps;
 
+	/// Lightweight bodies are simulated on the store's arrays only, and written back to their entities after all steps.
+	bodyStore->Gather();
 	for(int i = 0; i < steps; ++i)
 	{
 		/// Set current time in physics for this frame. This time is not the same as real time.
 		physicsNowMs += newStepSizeMs;
+		++physicsSteps;
+		/// Remember where everything was before the last step, to render in-between.
+		if (fixedTimeStep && i == steps - 1)
+			SavePreviousPositions();
 			
 		/// Process estimators (if any) within all registered entities?
 		int milliseconds = newStepSizeMs;
@@ -156,10 +188,13 @@ void PhysicsManager::ProcessPhysics()
 		Timer sweepTimer;
 		sweepTimer.Start();
 		// Generate pair of possible collissions via some optimized way (AABB-sorting or Octree).
-		List<EntityPair> pairs = this->aabbSweeper->Sweep();
+		List<EntityPair> & pairs = broadPhasePairs;
+		this->aabbSweeper->Sweep(pairs);
 		sweepTimer.Stop();
 		int sweepDur = sweepTimer.GetMs();
 		FrameStats.physicsCollisionDetectionAABBSweep += sweepDur;
+		/// Lightweight bodies about to collide need their entities up to date.
+		bodyStore->WriteBack(pairs);
 //		std::cout<<"\nAABB sweep pairs: "<<pairs.Size()<<" with "<<physicalEntities.Size()<<" entities";
 		Timer detectorTimer;
 		detectorTimer.Start();
@@ -180,6 +215,8 @@ void PhysicsManager::ProcessPhysics()
 		FrameStats.physicsCollisionDetection += thisFrame;
 
 		timer.Start();
+		/// Wake any sleeping islands that awake entities ran into, so that both sides are resolved.
+		WakeTouchedIslands(collisions);
 		/// And resolve them.
 		if (collisionResolver)
 			collisionResolver->ResolveCollisions(collisions);
@@ -215,6 +252,12 @@ void PhysicsManager::ProcessPhysics()
 			MesMan.QueueMessages(messages);
 		timer.Stop();
 		FrameStats.physicsCollisionCallback += timer.GetMs();
+		/// Pick up any changes made to the lightweight bodies by the resolver and callbacks.
+		bodyStore->Reload(pairs);
+
+		/// Put islands which have come to rest to sleep.
+		if (sleepingEnabled)
+			UpdateSleepingIslands(collisions, newStepSize);
 
 		collisionTimer.Stop();
 		FrameStats.physicsCollisions += collisionTimer.GetMs();
@@ -225,6 +268,7 @@ void PhysicsManager::ProcessPhysics()
 			break; // Break the loop. Simulate more next time if it's already being slow.
 		}
 	}
+	bodyStore->Scatter();
 	// Recalc matrices for the semi-dynamic ones.
 	if (physicsIntegrator)
 		physicsIntegrator->RecalculateMatrices(semiDynamicEntities);
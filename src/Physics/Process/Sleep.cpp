@@ -0,0 +1,120 @@
+/// Emil Hedemalm
+/// 2016-08-19
+/// Putting islands of resting bodies to sleep, and waking them again.
+
+#include "Physics/PhysicsManager.h"
+#include "Physics/PhysicsProperty.h"
+#include "Physics/PhysicsStore.h"
+#include "Physics/Contact/ContactGraph.h"
+
+/// Puts islands which have come to rest during the last step to sleep.
+void PhysicsManager::UpdateSleepingIslands(List<Collision> & collisions, float timeInSeconds)
+{
+	newSleepingIslands.Clear();
+	contactGraph->FindSleepingIslands(dynamicEntities, *bodyStore, collisions, timeInSeconds, newSleepingIslands);
+	if (newSleepingIslands.Size() == 0)
+		return;
+	for (int i = 0; i < newSleepingIslands.Size(); ++i)
+	{
+		PhysicsIsland * island = newSleepingIslands[i];
+		island->index = sleepingIslands.Size();
+		sleepingIslands.AddItem(island);
+		for (int j = 0; j < island->entities.Size(); ++j)
+		{
+			Entity * entity = island->entities[j];
+			PhysicsProperty * pp = entity->physics;
+			pp->state |= CollisionState::SLEEPING;
+			pp->island = island;
+			bodyStore->UpdateSleeping(entity);
+			pp->velocity = pp->currentVelocity = Vector3f();
+			pp->angularVelocity = Vector3f();
+		}
+	}
+	/// Remove them all in one pass, instead of searching the lists for each entity.
+	RemoveSleeping(dynamicEntities);
+	RemoveSleeping(fullyDynamicEntities);
+	RemoveSleeping(semiDynamicEntities);
+}
+
+/// Removes entities flagged as sleeping from the list, retaining order.
+void PhysicsManager::RemoveSleeping(List<Entity*> & entities)
+{
+	Entity ** arr = entities.GetArray();
+	int kept = 0;
+	for (int i = 0; i < entities.Size(); ++i)
+	{
+		if (arr[i]->physics->state & CollisionState::SLEEPING)
+			continue;
+		arr[kept++] = arr[i];
+	}
+	while (entities.Size() > kept)
+		entities.RemoveLast();
+}
+
+/// Wakes the entity's sleeping island, if any. Only to be called from the physics thread.
+void PhysicsManager::Wake(Entity * entity)
+{
+	PhysicsIsland * island = entity->physics? entity->physics->island : NULL;
+	if (!island)
+		return;
+	for (int i = 0; i < island->entities.Size(); ++i)
+	{
+		Entity * member = island->entities[i];
+		PhysicsProperty * pp = member->physics;
+		pp->state &= ~CollisionState::SLEEPING;
+		pp->island = NULL;
+		pp->lowVelocityTime = 0;
+		if (pp->storeIndex >= 0)
+		{
+			bodyStore->UpdateSleeping(member);
+			continue;
+		}
+		dynamicEntities.AddItem(member);
+		if (pp->fullyDynamic)
+			fullyDynamicEntities.AddItem(member);
+		else 
+			semiDynamicEntities.AddItem(member);
+	}
+	/// Swap-remove the island.
+	PhysicsIsland * last = sleepingIslands.Last();
+	sleepingIslands[island->index] = last;
+	last->index = island->index;
+	sleepingIslands.RemoveLast();
+	delete island;
+}
+
+/// Wakes sleeping islands touched by awake entities in the collisions, before they are resolved.
+void PhysicsManager::WakeTouchedIslands(List<Collision> & collisions)
+{
+	if (sleepingIslands.Size() == 0)
+		return;
+	for (int i = 0; i < collisions.Size(); ++i)
+	{
+		Collision & c = collisions[i];
+		PhysicsProperty * one = c.one->physics, * two = c.two->physics;
+		bool oneSleeping = (one->state & CollisionState::SLEEPING) != 0, twoSleeping = (two->state & CollisionState::SLEEPING) != 0;
+		if (oneSleeping && !twoSleeping && two->type != PhysicsType::STATIC)
+			Wake(c.one);
+		else if (twoSleeping && !oneSleeping && one->type != PhysicsType::STATIC)
+			Wake(c.two);
+	}
+}
+
+/// Removes the entity from its sleeping island without waking the rest, when unregistering it.
+void PhysicsManager::RemoveFromIsland(Entity * entity)
+{
+	PhysicsProperty * pp = entity->physics;
+	PhysicsIsland * island = pp->island;
+	if (!island)
+		return;
+	island->entities.RemoveItemUnsorted(entity);
+	pp->island = NULL;
+	pp->state &= ~CollisionState::SLEEPING;
+	if (island->entities.Size())
+		return;
+	PhysicsIsland * last = sleepingIslands.Last();
+	sleepingIslands[island->index] = last;
+	last->index = island->index;
+	sleepingIslands.RemoveLast();
+	delete island;
+}
@@ -9,6 +9,8 @@
 #include "Timer/Timer.h"
 #include "AABBSweeper/AABBSweepAxis.h"
 #include "File/LogFile.h"
+#include "Thread/JobPool.h"
+#include <cfloat>
 
 extern int debug;
 
@@ -23,6 +25,19 @@ EntityPair::EntityPair(Entity* one, Entity* two)
 }
 
 
+size_t EntityPairHash::operator()(const EntityPair & pair) const
+{
+	/// Order-independent, as the sweep may report either entity first.
+	size_t one = (size_t) pair.one, two = (size_t) pair.two;
+	if (one > two)
+		std::swap(one, two);
+	return one * 31 + (two >> 4);
+}
+bool EntityPairEqual::operator()(const EntityPair & one, const EntityPair & two) const
+{
+	return (one.one == two.one && one.two == two.two) || (one.one == two.two && one.two == two.one);
+}
+
 void EntityPair::PrintDetailed()
 {
     std::cout<<"\nComparing pair: "<<one<<" "<<one->worldPosition<<" & "<<two<<" "<<two->worldPosition;
@@ -35,6 +50,8 @@ AABBSweeper::AABBSweeper()
 {
 //	int subdivisionsZ = 8; // 8 used in the TIFS project. 1 for SpaceShooter
 	divisions = 8;
+	trackPairChanges = false;
+	jobPool = NULL;
 	// Create a given amount of subdivisions in Z, that we later on sort in X. :)
 	subdivisionLinesZ.AddItem(0.f);
 
@@ -57,10 +74,11 @@ void AABBSweeper::CreateAxes()
 	float minZ = -400, maxZ = 400;
 	float range = maxZ - minZ;
 	float rangePerSubdivision = range / divisions;
+	/// The outermost subdivisions are open-ended in Z, so that every Z value belongs to exactly one of them, see AABBSweepAxis::OwnsZ.
 	for (int i = 0; i < divisions; ++i)
 	{
 		axes.AddItem(
-			new AABBSweepAxis(X_AXIS, Vector3f(-LARGE,-LARGE, i == 0? -LARGE : minZ + rangePerSubdivision * i), Vector3f(LARGE,LARGE, i == (divisions - 1)? LARGE : minZ + rangePerSubdivision * (i + 1)))
+			new AABBSweepAxis(X_AXIS, Vector3f(-LARGE,-LARGE, i == 0? -FLT_MAX : minZ + rangePerSubdivision * i), Vector3f(LARGE,LARGE, i == (divisions - 1)? FLT_MAX : minZ + rangePerSubdivision * (i + 1)))
 		);
 	}
 }
@@ -117,6 +135,21 @@ void AABBSweeper::UnregisterEntity(Entity* entity)
 	if (entity->physics->type != PhysicsType::STATIC)
 		movingEntities.RemoveItemUnsorted(entity);
 
+	/// Report its pairs as removed in the next sweep already, as the entity may be deleted before then.
+	if (trackPairChanges)
+	{
+		for (auto it = currentPairs.begin(); it != currentPairs.end(); )
+		{
+			if (it->one == entity || it->two == entity)
+			{
+				unregisteredPairs.AddItem(*it);
+				it = currentPairs.erase(it);
+			}
+			else 
+				++it;
+		}
+	}
+
 	// Check that all nodes with this entity have surely been discarded.
 	for (int i = 0; i < axes.Size(); ++i)
 	{
@@ -137,6 +170,11 @@ void AABBSweeper::Clear()
 		axes[i]->Clear();
 	}
 	movingEntities.Clear();
+	currentPairs.clear();
+	previousPairs.clear();
+	addedPairs.Clear();
+	removedPairs.Clear();
+	unregisteredPairs.Clear();
 }
 
 /// Returns the amount of nodes currently registered. Should always be registeredEntities * 2.
@@ -152,9 +190,12 @@ int AABBSweeper::Nodes()
     return numNodes;
 }
 
-/// Performs the sweep (including sort) and returns a list of all entity pairs whose AABBs are intersecting.
-/// Should be called once per physics frame if in use.
-List<EntityPair> AABBSweeper::Sweep()
+/** Performs the sweep (including sort), storing all entity pairs whose AABBs are intersecting in the given list, which is cleared first.
+	Re-use the same list between frames to avoid re-allocations. Each pair is reported once, even if the entities share several subdivisions.
+	The subdivisions are sorted and swept in parallel if a job pool has been set.
+	Should be called once per physics frame if in use.
+*/
+void AABBSweeper::Sweep(List<EntityPair> & entityPairs)
 {
 	// Primary sorting, X.
 	Timer timer;
@@ -194,67 +235,58 @@ List<EntityPair> AABBSweeper::Sweep()
 			if (!existsWithin)
 				axis->AddEntity(entity);
 		}
-
-		/*
-		List<AABBSweepAxis*> currentAxes;
-		List<AABBSweepAxis*> otherAxes = axes;
-		// Check current placements?
-		for (int k = 0; k < movingEntity->physics->aabbSweepNodes.Size(); ++k)
-		{
-			AABBSweepNode * node = movingEntity->physics->aabbSweepNodes[k];
-			AABBSweepAxis * axis = node->axis;
-			bool shouldBeHere = axis->ShouldBeHere(movingEntity);
-			if (shouldBeHere)
-			{
-				currentAxes.Add(axis);
-				otherAxes.RemoveItemUnsorted(axis);
-			}
-			else {
-				axis->RemoveEntity(movingEntity);
-				otherAxes.RemoveItemUnsorted(axis);
-				k -= 1;
-			}
-		}
-
-		// Check if we should enter any other axis.
-		for (int j = 0; j < otherAxes.Size(); ++j)
-		{
-			AABBSweepAxis * axis = otherAxes[j];
-			if (axis->ShouldBeHere(movingEntity))
-				axis->AddEntity(movingEntity);
-		}
-		*/
 	}
 	timer.Stop();
 	int movingAround = timer.GetMs();
 
+	/// Sort and sweep each axis on its own, they share no data.
 	timer.Start();
-	// Sort all axises.
-	for (int i = 0; i < axes.Size(); ++i)
+	if (jobPool)
+		jobPool->ParallelFor(axes.Size(), SweepAxis, this);
+	else 
 	{
-		AABBSweepAxis * axis = axes[i];
-		axis->Sort();
+		for (int i = 0; i < axes.Size(); ++i)
+			SweepAxis(i, this);
 	}
 	timer.Stop();
-	int sorting = (int) timer.GetMs();
+	int sortingAndSweeping = (int) timer.GetMs();
 
-	// o.o
-	timer.Start();
-    /// Sweepty sweep. Static so re-allocation aren't performed in vain every physics-frame.
-	static List< Entity* > activeEntities;
-	activeEntities.Clear();
-    static List<EntityPair> entityPairs;
+	/// Gather in axis order, so the result does not depend on which thread finished first.
 	entityPairs.Clear();
 	for (int i = 0; i < axes.Size(); ++i)
-	{
-		AABBSweepAxis * axis = axes[i];
-		axis->GetPairs(entityPairs);		
-	}
+		entityPairs.Add(axes[i]->pairs);
 
-//    std::cout<<"\nPairs after sweep: "<<entityPairs.Size();
-	timer.Stop();
-	int filtering = timer.GetMs();
- //   std::cout<<"\nAA-AABB pairs after examining the remaining two axes: "<<entityPairs.Size();
-    return entityPairs;
+	if (trackPairChanges)
+		UpdatePairChanges(entityPairs);
+}
+
+/// Job function, sorts and sweeps one axis.
+void AABBSweeper::SweepAxis(int index, void * sweeper)
+{
+	AABBSweepAxis * axis = ((AABBSweeper*) sweeper)->axes[index];
+	axis->Sort();
+	axis->pairs.Clear();
+	axis->GetPairs(axis->pairs);
 }
 
+/// Compares the pairs with those of the last sweep, see trackPairChanges.
+void AABBSweeper::UpdatePairChanges(const List<EntityPair> & pairs)
+{
+	std::swap(previousPairs, currentPairs);
+	currentPairs.clear();
+	addedPairs.Clear();
+	/// Those removed by UnregisterEntity since the last sweep first.
+	removedPairs = unregisteredPairs;
+	unregisteredPairs.Clear();
+	for (int i = 0; i < pairs.Size(); ++i)
+	{
+		const EntityPair & pair = pairs[i];
+		currentPairs.insert(pair);
+		if (previousPairs.erase(pair) == 0)
+			addedPairs.AddItem(pair);
+	}
+	/// Whatever is left did not overlap anymore.
+	for (auto it = previousPairs.begin(); it != previousPairs.end(); ++it)
+		removedPairs.AddItem(*it);
+	previousPairs.clear();
+}
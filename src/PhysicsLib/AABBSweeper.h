@@ -7,9 +7,21 @@
 
 #include "PhysicsLib/Shapes/AABB.h"
 #include "List/List.h"
+#include <unordered_set>
 
 class AABBSweepNode;
 class AABBSweepAxis;
+class JobPool;
+
+/// Hashing of unordered entity pairs, for tracking pair changes between sweeps.
+struct EntityPairHash 
+{
+	size_t operator()(const EntityPair & pair) const;
+};
+struct EntityPairEqual 
+{
+	bool operator()(const EntityPair & one, const EntityPair & two) const;
+};
 
 class AABBSweeper {
 public:
@@ -26,9 +38,24 @@ public:
 	/// Clear all internal nodes and references to entities.
 	void Clear();
 
-    /// Performs the sweep (including sort) and returns a list of all entity pairs whose AABBs are intersecting.
-    /// Should be called once per physics frame if in use.
-    List<EntityPair> Sweep();
+    /** Performs the sweep (including sort), storing all entity pairs whose AABBs are intersecting in the given list, which is cleared first.
+		Re-use the same list between frames to avoid re-allocations. Each pair is reported once, even if the entities share several subdivisions.
+		The subdivisions are sorted and swept in parallel if a job pool has been set.
+		Should be called once per physics frame if in use.
+	*/
+    void Sweep(List<EntityPair> & pairs);
+
+	/** If true, each Sweep also compares the pairs with those of the previous Sweep, see AddedPairs and RemovedPairs. Default false.
+		Useful for contact caching, where only starting and ending overlaps are of interest.
+	*/
+	bool trackPairChanges;
+	/// Pairs which started overlapping in the last Sweep. Only updated if trackPairChanges is set.
+	const List<EntityPair> & AddedPairs() const { return addedPairs; };
+	/// Pairs which stopped overlapping in the last Sweep, or whose entities were unregistered since. Only updated if trackPairChanges is set.
+	const List<EntityPair> & RemovedPairs() const { return removedPairs; };
+
+	/// Pool to sort and sweep the subdivisions on. NULL (default) to do it all on the calling thread.
+	JobPool * jobPool;
 
 	int AxesToWorkWith() {return axesToWorkWith;};
 
@@ -52,9 +79,20 @@ protected:
 	/// o.o
     List<AABBSweepAxis*> axes;
 private:
+	/// Job function, sorts and sweeps one axis.
+	static void SweepAxis(int index, void * sweeper);
+	/// Compares the pairs with those of the last sweep, see trackPairChanges.
+	void UpdatePairChanges(const List<EntityPair> & pairs);
+
 	List<float> subdivisionLinesZ;
 	/// For updating entities in the various subdivided axes.
 	List< Entity* > movingEntities;
+
+	/// Pairs of the last sweep and the one before that, swapped each sweep.
+	std::unordered_set<EntityPair, EntityPairHash, EntityPairEqual> currentPairs, previousPairs;
+	List<EntityPair> addedPairs, removedPairs;
+	/// Pairs removed by UnregisterEntity, reported as removed by the next sweep.
+	List<EntityPair> unregisteredPairs;
 };
 
 #endif // AABBSWEEPER_H
@@ -30,9 +30,9 @@ AABBSweepNode * AABBSweepNode::New()
 {
 	if (freeNodes.Size())
 	{
-		AABBSweepNode * first = freeNodes[0];
-		freeNodes.RemoveIndex(0);
-		return first;
+		AABBSweepNode * last = freeNodes.Last();
+		freeNodes.RemoveLast();
+		return last;
 	}
 	return new AABBSweepNode();
 }
@@ -181,8 +181,9 @@ void AABBSweepAxis::Sort()
         /// Grab current node, starting from index 0 and moving towards the end.
         currentNode = listArray[i];
 		skip = false;
-		/// If static, Check if initially sorted. No need to look at this more then.
-		if (currentNode->entity->physics->type == PhysicsType::STATIC && currentNode->sortedOnce)
+		/// If static or sleeping, Check if initially sorted. No need to look at this more then.
+		bool stationary = currentNode->entity->physics->type == PhysicsType::STATIC || (currentNode->entity->physics->state & CollisionState::SLEEPING);
+		if (stationary && currentNode->sortedOnce)
 			skip = true;
 		if (sortedLastIteration)
 			skip = false;
@@ -191,7 +192,7 @@ void AABBSweepAxis::Sort()
 		// Set default.
 		sortedLastIteration = false;
 		// But in the case of dynamic entities, make sure those after check for sorting with it.
-		if (currentNode->entity->physics->type != PhysicsType::STATIC)
+		if (!stationary)
 			sortedLastIteration = true;
 
 		/// Mark this index as empty for the time being.
@@ -266,7 +267,6 @@ bool AABBSweepAxis::FindPairsLinearPlusSearch(List<EntityPair> & entityPairs)
 	Entity* entity;
 	AABB * oneab, * twoab;
 
-	static List< Entity* > activeEntities;
 	/// Clear the active entities list.
     activeEntities.Clear();
     for (j = 0; j < nodes.Size(); ++j)
@@ -308,6 +308,10 @@ bool AABBSweepAxis::FindPairsLinearPlusSearch(List<EntityPair> & entityPairs)
 				if (node->entity->physics->type != PhysicsType::DYNAMIC &&
 					entity->physics->type != PhysicsType::DYNAMIC)
 					continue; // Irrelevant.
+				/// Neither can move, if both are static or sleeping.
+				if ((node->entity->physics->type == PhysicsType::STATIC || node->entity->physics->state & CollisionState::SLEEPING) &&
+					(entity->physics->type == PhysicsType::STATIC || entity->physics->state & CollisionState::SLEEPING))
+					continue;
 				// Check other axes straight away.
 				oneab = node->aabb;
 				twoab = entity->aabb;
@@ -318,6 +322,10 @@ bool AABBSweepAxis::FindPairsLinearPlusSearch(List<EntityPair> & entityPairs)
 				{
 					continue;
 				}
+				/// Entities spanning several subdivisions are swept in each of them, so only report the pair 
+				/// in the subdivision where their overlap in Z starts.
+				if (!OwnsZ(oneab->min.z > twoab->min.z? oneab->min.z : twoab->min.z))
+					continue;
 
 				EntityPair ep;
                 /// Sort them by address (hopefully it works)
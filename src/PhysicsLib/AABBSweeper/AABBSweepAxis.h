@@ -62,8 +62,12 @@ public:
 
 	void Sort();
 	bool GetPairs(List<EntityPair> & pairList);
+	/// If given Z value lies within this axis' subdivision. Each Z value belongs to exactly one subdivision.
+	bool OwnsZ(float z) const { return z >= min.z && z < max.z; };
 
 	List<AABBSweepNode*> nodes;
+	/// Pairs found by the last sweep of this axis, see AABBSweeper::Sweep.
+	List<EntityPair> pairs;
 private:
 	int axis;
 	Vector3f min, max;
@@ -73,6 +77,8 @@ private:
 
 	/// Stored internally for optimized pairing of entities.
 	List< Entity* > dynamicEntities;
+	/// Entities whose start but not stop node has been passed during the sweep. Per axis, so that axes may be swept in parallel.
+	List< Entity* > activeEntities;
 };
 
 
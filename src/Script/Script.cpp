@@ -61,6 +61,7 @@ Script::Script(const Script & base)
 	flags = base.flags;
 	/// Copy loaded data too.
 	lines = base.lines;
+	program = base.program;
 	pausesExecution = base.pausesExecution;
 }
 
@@ -153,9 +154,20 @@ bool Script::Load(String fromFile)
 		loaded = false;
 		Reset();
 		lines.Clear();
+		program.reset();
 	}
 //	std::cout<<"\nSaving source path...";
 	name = source = fromFile;
+	/// Scripts of the same source share the compiled program, so the file is only read once. Call ScriptProgram::ClearCache to re-read changed files.
+	program = ScriptProgram::Cached(fromFile);
+	if (program)
+	{
+		name = program->name;
+		triggerCondition = program->triggerCondition;
+		lines = program->lines;
+		loaded = true;
+		return true;
+	}
 	/// Parsley parse, yes?
 	/// Add root event dir if not already included (could be)
 	/// Assure that at least the data/ dir is included. Any path with it can be assumed to be completely relative!
@@ -211,6 +223,10 @@ bool Script::Load(String fromFile)
 	}
 	/// Save source, without the dir dir please!
 	this->source = fromFile;
+	program = ScriptProgram::Compile(lines, functionEvaluators);
+	program->name = name;
+	program->triggerCondition = triggerCondition;
+	ScriptProgram::Cache(fromFile, program);
 	loaded = true;
 	std::cout<<"\nScript loaded.";
 //	SleepThread(100);
@@ -229,19 +245,19 @@ void Script::Process(int timeInMs)
 {
 	if (paused)
 		return;
-	if (currentLine < 0 || currentLine >= lines.Size())
+	/// Lines set directly, e.g. by ScriptManager::NewScript, are compiled when first processed.
+	if (!program)
+		program = ScriptProgram::Compile(lines, functionEvaluators);
+	List<ScriptInstruction> & instructions = program->instructions;
+	if (currentLine < 0 || currentLine >= instructions.Size())
 	{
 		std::cout<<"\nScript::Process: Line "<<currentLine<<" out of scope. Aborting";
 		scriptState = ENDED;
 		return;
 	}
-	String & line = lines[currentLine];
-	int p = 2;
-	if (p == 3)
-		for (int i = 0; i < lines.Size(); ++i){std::cout<<"\nLines "<<i<<": "<<lines[i];}
-	line.RemoveSurroundingWhitespaces();
-	// Skip one-line comments if any remain.
-	if (line.StartsWith("//"))
+	const ScriptInstruction & instruction = instructions[currentLine];
+	// Skip empty lines and one-line comments if any remain.
+	if (instruction.command == ScriptInstruction::COMMENT)
 	{
 		++currentLine;
 		return;
@@ -253,7 +269,7 @@ void Script::Process(int timeInMs)
 	{
 		/// Evaluate the current line, look if we have to check for line-finishing conditions or not.
 		lineFinished = false;
-		EvaluateLine(line);
+		EvaluateInstruction(instruction);
 	}
 
 	/// Check if the current line is finished? If not, wait until it is finished.
@@ -263,7 +279,7 @@ void Script::Process(int timeInMs)
 	/// If it is finished, check for next line
 	++currentLine;
 	/// If we finished the last line, flag this event as ending...!
-	if (currentLine >= lines.Size()){
+	if (currentLine >= instructions.Size()){
 		scriptState = ENDING;
 		return;
 	}
@@ -339,371 +355,329 @@ void Script::EndCutscene(bool endingPrematurely /*= false*/)
 }
 
 
-void Script::EvaluateLine(String & line)
+void Script::EvaluateInstruction(const ScriptInstruction & instruction)
 {
 	/// Default line processed once?
 	lineProcessed = true;
 
-	line.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+	String line = instruction.line;
+	const List<String> & arguments = instruction.arguments;
 	// "80Gray50Alpha.png"
 #define DEFAULT_TEXTURE_SOURCE	"black50Alpha.png"
 #define DEFAULT_TEXT_SIZE_RATIO	0.3f
 	
-	/// Some state began, take not of it?
-	if (line.Contains("Wait("))
-	{
-		WaitScript * wait = new WaitScript(line, this);
-		wait->SetDeleteOnEnd(true);
-		ScriptMan.PlayScript(wait);
-	}
-	else if (line.StartsWith("Key:"))
-	{
-		String keyStr = line.Tokenize(":")[1];
-		keyStr.RemoveSurroundingWhitespaces();
-		int keyCode = GetKeyForString(keyStr);
-		assert(keyCode != 0);
-		InputMan.KeyDown(MainWindow(), keyCode, false);
-		InputMan.KeyUp(MainWindow(), keyCode);
-		lineFinished = true;
-	}
-	else if (line.Contains("PlayScript("))
+	switch(instruction.command)
 	{
-		List<String> tokens = line.Tokenize("(),");
-		// Source of script within the parenthesis.
-		String source = tokens[1];
-		bool wait = true;
-		Script * scriptParent = this;
-		if (tokens.Size() >= 3)
+		/// Some state began, take not of it?
+		case ScriptInstruction::WAIT:
+		{
+			WaitScript * wait = new WaitScript(line, this);
+			wait->SetDeleteOnEnd(true);
+			ScriptMan.PlayScript(wait);
+			break;
+		}
+		case ScriptInstruction::KEY:
 		{
-			wait = tokens[2].ParseBool();
-			if (!wait)
+			int keyCode = GetKeyForString(arguments[0]);
+			assert(keyCode != 0);
+			InputMan.KeyDown(MainWindow(), keyCode, false);
+			InputMan.KeyUp(MainWindow(), keyCode);
+			lineFinished = true;
+			break;
+		}
+		case ScriptInstruction::PLAY_SCRIPT:
+		{
+			// Source of script within the parenthesis.
+			String source = arguments[0];
+			bool wait = true;
+			Script * scriptParent = this;
+			if (arguments.Size() >= 2)
 			{
-				scriptParent = NULL;
-				this->lineFinished = true;
+				String waitArgument = arguments[1];
+				wait = waitArgument.ParseBool();
+				if (!wait)
+				{
+					scriptParent = NULL;
+					this->lineFinished = true;
+				}
 			}
+			Script * script = new Script(source, scriptParent);
+			script->source = source;
+			bool loaded = script->Load();
+			assert(loaded);
+			ScriptMan.PlayScript(script);
+			break;
 		}
-		Script * script = new Script(source, scriptParent);
-		script->source = source;
-		bool loaded = script->Load();
-		assert(loaded);
-		ScriptMan.PlayScript(script);
-	}
-	else if (line == "DisableActiveUI")
-	{
-		InputMan.DisableActiveUI();
-		lineFinished = true;
-		uiDisabled = true;
-	}
-	else if (line == "EnableActiveUI")
-	{
-		InputMan.EnableActiveUI();
-		lineFinished = true;
-	}
-	else if (line.Contains("PreloadTexturesInDirectory("))
-	{
-		// Fetch the stuff, do the buff
-		String dir = line.Tokenize("()")[1];
-		List<String> files;
-		int num = GetFilesInDirectory(dir, files);
-		for (int i = 0; i < files.Size(); ++i)
+		case ScriptInstruction::DISABLE_ACTIVE_UI:
+			InputMan.DisableActiveUI();
+			lineFinished = true;
+			uiDisabled = true;
+			break;
+		case ScriptInstruction::ENABLE_ACTIVE_UI:
+			InputMan.EnableActiveUI();
+			lineFinished = true;
+			break;
+		case ScriptInstruction::PRELOAD_TEXTURES:
 		{
-			String path = dir + "/" + files[i];
-			Texture * tex = TexMan.LoadTexture(path);
-			Graphics.QueueMessage(new GMBufferTexture(tex));
+			// Fetch the stuff, do the buff
+			String dir = arguments[0];
+			List<String> files;
+			int num = GetFilesInDirectory(dir, files);
+			for (int i = 0; i < files.Size(); ++i)
+			{
+				String path = dir + "/" + files[i];
+				Texture * tex = TexMan.LoadTexture(path);
+				Graphics.QueueMessage(new GMBufferTexture(tex));
+			}
+			lineFinished = true;
+			break;
 		}
-		lineFinished = true;
-	}
-	else if (line.Contains("Begin("))
-	{
-		String stateBeginning = line.Tokenize("()")[1];
-		if (stateBeginning == "Cutscene")
+		case ScriptInstruction::BEGIN:
+			if (arguments[0] == "Cutscene")
+			{
+				BeginCutscene();
+			}
+			lineFinished = true;
+			break;
+		case ScriptInstruction::END:
+			if (arguments[0] == "Cutscene")
+			{
+				EndCutscene();
+			}
+			lineFinished = true;
+			break;
+		case ScriptInstruction::END_SCRIPT:
+			// End it.
+			scriptState = ENDING;
+			break;
+		case ScriptInstruction::ENTER_GAME_STATE:
 		{
-			BeginCutscene();
+			StateChanger * changer = new StateChanger(line, this);
+			ScriptMan.PlayScript(changer);
+			break;
 		}
-		lineFinished = true;
-	}
-	else if (line.Contains("End("))
-	{
-		String stateEnding = line.Tokenize("()")[1];
-		if (stateEnding == "Cutscene")
+		case ScriptInstruction::FADE_IN:
 		{
-			EndCutscene();
+			FadeInEffect * fade = new FadeInEffect(line, this);
+			ScriptMan.PlayScript(fade);
+			break;
 		}
-		lineFinished = true;
-	}
-	else if (line.Contains("EndScript"))
-	{
-		// End it.
-		scriptState = ENDING;
-	}
-	else if (line.Contains("EnterGameState("))
-	{
-		String name = line.Tokenize("()")[1];		
-		StateChanger * changer = new StateChanger(line, this);
-		ScriptMan.PlayScript(changer);
-	}
-	else if (line.Contains("FadeTo(") || line.Contains("FadeIn("))
-	{
-		FadeInEffect * fade = new FadeInEffect(line, this);
-		ScriptMan.PlayScript(fade);
-	}
-	else if (line.Contains("FadeInBackground("))
-	{
-		FadeInBackground * fade = new FadeInBackground(line, this);
-		ScriptMan.PlayScript(fade);
-	}
-	else if (line.Contains("FadeOutBackground("))
-	{
-		FadeOutBackground * fade = new FadeOutBackground(line, this);
-		ScriptMan.PlayScript(fade);
-	}
-	else if (line.Contains("FadeOut"))
-	{
-		FadeOutEffect * fade = new FadeOutEffect(line, this);
-		ScriptMan.PlayScript(fade);
-	}
-	else if (line.Contains("FadeText("))
-	{
-		FadeTextEffect * text = new FadeTextEffect(line, this);
-		ScriptMan.PlayScript(text);
-		lineFinished = true;
-	}
-	else if (line.Contains("PlaySong("))
-	{
-		// Just play it.
-		String song = line.Tokenize("()")[1];
-		TrackMan.PlayTrack(song);
-		// Line finished straight away.
-		lineFinished = true;
-	}
-	else if (line.Contains("Dialogue")){
-		/// If raw string, output it straight away! (should later be queued to some kind of dialogue-manager?)
-		if (line.Contains("\"")){
+		case ScriptInstruction::FADE_IN_BACKGROUND:
+		{
+			FadeInBackground * fade = new FadeInBackground(line, this);
+			ScriptMan.PlayScript(fade);
+			break;
+		}
+		case ScriptInstruction::FADE_OUT_BACKGROUND:
+		{
+			FadeOutBackground * fade = new FadeOutBackground(line, this);
+			ScriptMan.PlayScript(fade);
+			break;
+		}
+		case ScriptInstruction::FADE_OUT:
+		{
+			FadeOutEffect * fade = new FadeOutEffect(line, this);
+			ScriptMan.PlayScript(fade);
+			break;
+		}
+		case ScriptInstruction::FADE_TEXT:
+		{
+			FadeTextEffect * text = new FadeTextEffect(line, this);
+			ScriptMan.PlayScript(text);
+			lineFinished = true;
+			break;
+		}
+		case ScriptInstruction::PLAY_SONG:
+			// Just play it.
+			TrackMan.PlayTrack(arguments[0]);
+			// Line finished straight away.
+			lineFinished = true;
+			break;
+		case ScriptInstruction::DIALOGUE:
+			/// If raw string, output it straight away! (should later be queued to some kind of dialogue-manager?)
+			if (arguments.Size()){
+				/// Create dialogue UI and append it to the current UI!
+				String text = arguments[0];
+				std::cout<<"\n"<<text;
+				UIButton * dialogue = new UIButton("Dialogue");
+				dialogue->interaction.exitable = false;
+				dialogue->SetText(text);
+				dialogue->activationMessage = "PopFromStack(this)&Remove(this)&ContinueEvent("+this->name+")";
+				dialogue->layout.sizeRatioY = 0.3f;
+				dialogue->layout.alignmentY = 0.15f;
+				dialogue->AddState(nullptr, UIState::DIALOGUE);  // Flag the dialogue-state flag to signify importance!
+				Graphics.QueueMessage(new GMAddUI(dialogue, "root"));
+				Graphics.QueueMessage(GMPushUI::ToUI("Dialogue", ActiveUI()));
+			}
+			/// If no quotes, load the specified dialogue-file and begin processing that instead, waiting until it is finished.!
+			else {
+				/// Give the npc a dialogue?
+			//	assert(false);
+				// Send it tot he state too, to attach to the appropriate thingymajig.
+				Message * message = new Message(line);
+				/// Set this event as
+				message->scriptOrigin = this;
+				MesMan.QueueMessage(message);
+				/// Instant thingies.
+				lineFinished = true;
+			}
+			break;
+		case ScriptInstruction::ANSWER:
+			///  Go to EndAnswers..!
+			lineFinished = true;
+			assert(instruction.next >= 0 && "No EndAnswers found? No good, jaow ;___;");
+			if (instruction.next >= 0)
+				currentLine = instruction.next;
+			break;
+		case ScriptInstruction::BEGIN_ALTERNATIVES:
+		{
 			/// Create dialogue UI and append it to the current UI!
-			String text = line.Tokenize("\"")[1];
+			String text = arguments[0];
 			std::cout<<"\n"<<text;
-			UIButton * dialogue = new UIButton("Dialogue");
+			UIElement * dialogue = new UIElement();
 			dialogue->interaction.exitable = false;
-			dialogue->SetText(text);
-			dialogue->activationMessage = "PopFromStack(this)&Remove(this)&ContinueEvent("+this->name+")";
+			dialogue->name = "AlternativesDialogue";
+		//	dialogue->activationMessage = "Remove(this)&ContinueEvent("+this->name+")";
 			dialogue->layout.sizeRatioY = 0.3f;
 			dialogue->layout.alignmentY = 0.15f;
 			dialogue->AddState(nullptr, UIState::DIALOGUE);  // Flag the dialogue-state flag to signify importance!
+
+			UILabel * dialogueText = new UILabel();
+			dialogueText->SetText(text);
+			dialogueText->layout.sizeRatioX = 0.5f;
+			dialogueText->layout.alignmentX = 0.25f;
+			dialogue->AddChild(nullptr, dialogueText);
+
+			UIList * dialogueAnswerList = new UIList();
+			dialogueAnswerList->layout.sizeRatioX = 0.5f;
+			dialogueAnswerList->layout.alignmentX = 0.75f;
+			dialogue->AddChild(nullptr, dialogueAnswerList);
+
+			int answers = 0;
+			List<UIElement*> answerList;
+			// Parse and add answers
+			for (int i = currentLine+1; i < lines.Size(); ++i){
+				String l = lines[i];
+				l.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+				List<String> tokens = l.Tokenize(" ");
+				String token1 = tokens[0];
+				token1.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+
+				if (token1 == "text"){
+					l.Remove(token1);
+					Text text = l;
+					text.RemoveInitialWhitespaces();
+					text.Remove("\"");
+					text.Remove("\"");
+					dialogueText->SetText(text);
+				}
+				else if (l.Contains("Answer")){
+					++answers;
+					UIButton * answerButton = new UIButton();
+					answerButton->name = token1;
+					l.Remove("Answer");
+					l.RemoveInitialWhitespaces();
+					l.Remove("\"");
+					l.Remove("\"");
+					answerButton->SetText(l);
+					answerButton->layout.sizeRatioY = 0.2f;
+					answerButton->activationMessage = "ActivateDialogueAlternative("+name+","+answerButton->name+")&PopFromStack("+dialogue->name+")&Remove("+dialogue->name+")";
+					answerList.Add(answerButton);
+				}
+				else if (l.Contains("EndAlternatives")){
+					// Donelir. o-o
+					break;
+				}
+				else {
+					assert(false && "Bad line! Should only be Answer before EndAlternatives!");
+				}
+			}
+			assert(answers);
+			float sizeRatioY = 0.95f / answers;
+			for (int i = 0; i < answers; ++i){
+				UIElement * ans = answerList[i];
+			//	ans->layout.sizeRatioY = sizeRatioY; // Stupid to set the sizeRatioY to be this dynamic, yo.
+				dialogueAnswerList->AddChild(nullptr, ans);
+			}
+			isInAlternativeDialogue = true;
 			Graphics.QueueMessage(new GMAddUI(dialogue, "root"));
-			Graphics.QueueMessage(GMPushUI::ToUI("Dialogue", ActiveUI()));
-		}
-		/// If no quotes, load the specified dialogue-file and begin processing that instead, waiting until it is finished.!
-		else {
-			/// Give the npc a dialogue?
-		//	assert(false);
-			// Send it tot he state too, to attach to the appropriate thingymajig.
-			Message * message = new Message(line);
-			/// Set this event as
-			message->scriptOrigin = this;
-			MesMan.QueueMessage(message);
-			/// Instant thingies.
-			lineFinished = true;
+			Graphics.QueueMessage(GMPushUI::ToUI(dialogue, ActiveUI()));
+			break;
 		}
-	}
-	else if (line.Contains("Answer")){
-		///  Go to EndAnswers..!
-		lineFinished = true;
-		for (int i = currentLine; i < lines.Size(); ++i){
-			String line = lines[i];
-			if (line.Contains("EndAnswers")){
-				currentLine = i;
-				lineFinished = true;
+		case ScriptInstruction::ELSIF:
+		{
+			/// Should be in an if-stack, check if we already evaluated.
+			ScriptLevel sl = stack.Last();
+			assert(sl.type == ScriptLevel::IF_CLAUSE);
+			/// If already evaluated, jump to endif.
+			if (sl.evaluatedAtLine > 0)
+			{
+				// Jump to endif.
+				JumpToEndif(instruction);
 				return;
 			}
+			/// If not, handle the conditional first.
+			HandleConditional(instruction);
+			break;
 		}
-		assert(false && "No EndAnswers found? No good, jaow ;___;");
-	}
-	else if (line.Contains("BeginAlternatives") || line.Contains("BeginQuestion")){
-		/// Create dialogue UI and append it to the current UI!
-		String text = line.Tokenize("\"")[1];
-		std::cout<<"\n"<<text;
-		UIElement * dialogue = new UIElement();
-		dialogue->interaction.exitable = false;
-		dialogue->name = "AlternativesDialogue";
-	//	dialogue->activationMessage = "Remove(this)&ContinueEvent("+this->name+")";
-		dialogue->layout.sizeRatioY = 0.3f;
-		dialogue->layout.alignmentY = 0.15f;
-		dialogue->AddState(nullptr, UIState::DIALOGUE);  // Flag the dialogue-state flag to signify importance!
-
-		UILabel * dialogueText = new UILabel();
-		dialogueText->SetText(text);
-		dialogueText->layout.sizeRatioX = 0.5f;
-		dialogueText->layout.alignmentX = 0.25f;
-		dialogue->AddChild(nullptr, dialogueText);
-
-		UIList * dialogueAnswerList = new UIList();
-		dialogueAnswerList->layout.sizeRatioX = 0.5f;
-		dialogueAnswerList->layout.alignmentX = 0.75f;
-		dialogue->AddChild(nullptr, dialogueAnswerList);
-
-		int answers = 0;
-		List<UIElement*> answerList;
-		// Parse and add answers
-		for (int i = currentLine+1; i < lines.Size(); ++i){
-			String l = lines[i];
-			l.SetComparisonMode(String::NOT_CASE_SENSITIVE);
-			List<String> tokens = l.Tokenize(" ");
-			String token1 = tokens[0];
-			token1.SetComparisonMode(String::NOT_CASE_SENSITIVE);
-
-			if (token1 == "text"){
-				l.Remove(token1);
-				Text text = l;
-				text.RemoveInitialWhitespaces();
-				text.Remove("\"");
-				text.Remove("\"");
-				dialogueText->SetText(text);
-			}
-			else if (l.Contains("Answer")){
-				++answers;
-				UIButton * answerButton = new UIButton();
-				answerButton->name = token1;
-				l.Remove("Answer");
-				l.RemoveInitialWhitespaces();
-				l.Remove("\"");
-				l.Remove("\"");
-				answerButton->SetText(l);
-				answerButton->layout.sizeRatioY = 0.2f;
-				answerButton->activationMessage = "ActivateDialogueAlternative("+name+","+answerButton->name+")&PopFromStack("+dialogue->name+")&Remove("+dialogue->name+")";
-				answerList.Add(answerButton);
-			}
-			else if (l.Contains("EndAlternatives")){
-				// Donelir. o-o
-				break;
-			}
-			else {
-				assert(false && "Bad line! Should only be Answer before EndAlternatives!");
+		case ScriptInstruction::IF:
+			// Add to stack.
+			stack.AddItem(ScriptLevel(ScriptLevel::IF_CLAUSE, currentLine));
+			HandleConditional(instruction);
+			break;
+		case ScriptInstruction::ELSE:
+		{
+			ScriptLevel sl = stack.Last();
+			assert(sl.type == ScriptLevel::IF_CLAUSE);
+			if (sl.evaluatedAtLine > 0)
+			{
+				JumpToEndif(instruction);
+				return;
 			}
+			lineFinished = true;
+			break;
 		}
-		assert(answers);
-		float sizeRatioY = 0.95f / answers;
-		for (int i = 0; i < answers; ++i){
-			UIElement * ans = answerList[i];
-		//	ans->layout.sizeRatioY = sizeRatioY; // Stupid to set the sizeRatioY to be this dynamic, yo.
-			dialogueAnswerList->AddChild(nullptr, ans);
-		}
-		isInAlternativeDialogue = true;
-		Graphics.QueueMessage(new GMAddUI(dialogue, "root"));
-		Graphics.QueueMessage(GMPushUI::ToUI(dialogue, ActiveUI()));
-	}
-	else if (line.Contains("elsif") || line.Contains("elseif") || line.Contains("else if"))
-	{
-		/// Should be in an if-stack, check if we already evaluated.
-		ScriptLevel sl = stack.Last();
-		assert(sl.type == ScriptLevel::IF_CLAUSE);
-		/// If already evaluated, jump to endif.
-		if (sl.evaluatedAtLine > 0)
+		case ScriptInstruction::ENDIF:
 		{
-			// Jump to endif.
-			JumpToEndif();
-			return;
+			ScriptLevel sl = stack.Last();
+			assert(sl.type == ScriptLevel::IF_CLAUSE);
+			stack.RemoveLast();
+			lineFinished = true;
+			break;
 		}
-		/// If not, handle the conditional first.
-		HandleConditional(line);
-	}
-	else if (line.Contains("if(") || line.Contains("if ("))
-	{
-		// Add to stack.
-		stack.AddItem(ScriptLevel(ScriptLevel::IF_CLAUSE, currentLine));
-		HandleConditional(line);
-	}
-	else if (line.Contains("else"))
-	{
-//		if (ifProcessed)
-		//	JumpToEndif();
-		ScriptLevel sl = stack.Last();
-		assert(sl.type == ScriptLevel::IF_CLAUSE);
-		if (sl.evaluatedAtLine > 0)
+		case ScriptInstruction::ENDWHILE:
 		{
-			JumpToEndif();
-			return;
+			// Go to start!
+			ScriptLevel sl = stack.Last();
+			assert(sl.type == ScriptLevel::WHILE_LOOP);
+			currentLine = instruction.next >= 0? instruction.next : sl.evaluatedAtLine;
+			HandleConditional(program->instructions[currentLine]);
+			break;
 		}
-		lineFinished = true;
-		return;
-	}
-	else if (line.Contains("endif"))
-	{
-		ScriptLevel sl = stack.Last();
-		assert(sl.type == ScriptLevel::IF_CLAUSE);
-		stack.RemoveLast();
-		lineFinished = true;
-	}
-	else if (line.Contains("endwhile"))
-	{
-		// Go to start!
-		ScriptLevel sl = stack.Last();
-		assert(sl.type == ScriptLevel::WHILE_LOOP);
-		currentLine = sl.evaluatedAtLine;
-		String startLine = lines[currentLine];
-		HandleConditional(startLine);
-//		lineFinished = true;
-		// Evaluate?
-//		stack.RemoveLast();
-	}
-	else if (line.Contains("while"))
-	{
-		stack.AddItem(ScriptLevel(ScriptLevel::WHILE_LOOP, currentLine));
-		HandleConditional(line);
-	}
-/*	else if (line.Contains("CreateInt")){
-		List<String> tokens = line.Tokenize(" \t");
-		String varName = tokens[1];
-		int initialValue = 0;
-		if (tokens.Size() >= 3)
-			initialValue = tokens[2].ParseInt();
-		if (!GameVars.Get(varName)){
-			GameVars.CreateInt(varName, initialValue);
+		case ScriptInstruction::WHILE:
+			stack.AddItem(ScriptLevel(ScriptLevel::WHILE_LOOP, currentLine));
+			HandleConditional(instruction);
+			break;
+		case ScriptInstruction::REPEATABLE:
+			/// Flag the event as repeatable.
+			repeatable = true;
+			lineFinished = true;
+			break;
+		// Consider just making an else-clause for all remaining events to be processed by the specific game instead?
+		case ScriptInstruction::GAME_MESSAGE:
+		{
+			Message * message = new Message(line);
+			/// Set this event as
+			message->scriptOrigin = this;
+			MesMan.QueueMessage(message);
+			/// Instant thingies.
+			lineFinished = true;
+			break;
 		}
-		lineFinished = true;
-	}
-	/*
-	else if (line.Contains("SetInt ")){
-		List<String> tokens = line.Tokenize(" \t");
-		String varName = tokens[1];
-		int value = tokens[2].ParseInt();
-		GameVars.SetInt(varName, value);
-		lineFinished = true;
-	}*/
-	else if (line.Contains("Repeatable")){
-		/// Flag the event as repeatable.
-		repeatable = true;
-		lineFinished = true;
-	}
-	// Consider just making an else-clause for all remaining events to be processed by the specific game instead?
-	else if (
-		line.Contains("SpawnEntity") ||
-		line.Contains("OnApproach") ||
-		line.Contains("OnInteract") ||
-		line.Contains("DisableMovement") ||
-		line.Contains("EnableMovement") ||
-		line.Contains("Zone(") ||
-		line.Contains("PlacePlayer(") ||
-		line.Contains("TrackPlayer")
-		)
-	{
-		Message * message = new Message(line);
-		/// Set this event as
-		message->scriptOrigin = this;
-		MesMan.QueueMessage(message);
-		/// Instant thingies.
-		lineFinished = true;
-	}
-	else {
-		/// Try evaluate it as an expression.
-		Expression exp;
-		List<Variable> allVars = GameVars.GetAllExpressionVariables() + variables;
-		exp.functionEvaluators = functionEvaluators; // Set evaluators.
-		bool parseOK = exp.ParseExpression(line);
-		if (line.Contains("SetMovementPattern"))
-			int p = 4;;
-		if (parseOK)
+		case ScriptInstruction::EXPRESSION:
 		{
-			ExpressionResult res = exp.Evaluate(allVars);
+			/// Try evaluate it as an expression, parsed when the script was compiled.
+			ExpressionResult res = program->Evaluate(instruction.expression, variables, functionEvaluators);
 			/// Continue until it returns true! o.o
 			if (res.type != DataType::NO_TYPE)
 			{
@@ -713,17 +687,13 @@ void Script::EvaluateLine(String & line)
 					return;
 				}
 			}
+			Message * message = new Message(line);
+			/// Set this event as source of it.
+			message->scriptOrigin = this;
+			MesMan.QueueMessage(message);
+			lineFinished = true;
+			break;
 		}
-
-
-//		std::cout<<"\nUndefined event command: "<<line;
-//		std::cout<<"\nPassing it as a custom command to the game states for further processing.";
-		Message * message = new Message(line);
-		/// Set this event as source of it.
-		message->scriptOrigin = this;
-		MesMan.QueueMessage(message);
-		lineFinished = true;
-	//	assert(false && "Undefined event command!");
 	};
 }
 
@@ -779,6 +749,7 @@ bool Script::ReadFrom(std::fstream & file){
 
 	/// Clear previous lines and reset variables.
 	lines.Clear();
+	program.reset();
 	Reset();
 	return true;
 }
@@ -793,23 +764,16 @@ void Script::SetDeleteOnEnd(bool value){
 }
 
 
-/// For if- and elsif- statements.
-void Script::HandleConditional(String line)
+/// For if-, elsif- and while-statements.
+void Script::HandleConditional(const ScriptInstruction & instruction)
 {
-	// Remove first part until (
-	int index = line.Find('(');
-	line = line.Part(index);
-	/// Use expressions from the MathLib. First parse for functions to provide their values? Or...
-	Expression exp;
-	List<Variable> allVars = GameVars.GetAllExpressionVariables() + variables;
-	exp.functionEvaluators = functionEvaluators; // Set evaluators.
-	bool parseOK = exp.ParseExpression(line);
-	if (!parseOK)
+	/// Use expressions from the MathLib, parsed and compiled along with the script.
+	if (!program->IsParsed(instruction.expression))
 	{
-		std::cout<<"\nParse error in expression "<<line;
+		std::cout<<"\nParse error in expression "<<instruction.line;
 		return;
 	}
-	ExpressionResult res = exp.Evaluate(allVars);
+	ExpressionResult res = program->Evaluate(instruction.expression, variables, functionEvaluators);
 	bool statementTrue = res.GetBool();
 	/// If statement is true, sign this row as finished.
 	if (statementTrue)
@@ -822,39 +786,14 @@ void Script::HandleConditional(String line)
 	}
 	else 
 	{
-		// Check stuff.
+		// If the statement is not true, go to the next elsif, else or endif block, as found when compiling.
 		ScriptLevel & sl = stack.Last();
-		int newRow = -1;
-		int ifStack = 0;
-		// If the statement is not true, find an else or endif block..!
-		for (int i = currentLine+1; i < lines.Size(); ++i)
+		int newRow = instruction.next;
+		if (sl.type == ScriptLevel::WHILE_LOOP && newRow >= 0)
 		{
-			String l = lines[i];
-			if (sl.type == ScriptLevel::WHILE_LOOP)
-			{
-				if (l.Contains("endwhile"))
-				{
-					// Jump to next after, as regular stopping on endwhile will reboot the loop
-					newRow = i + 1;
-					stack.RemoveLast();
-					break; 
-				}
-			}
-			if (sl.type == ScriptLevel::IF_CLAUSE)
-			{
-				if (l.Contains("elsif") || l.Contains("else") || l.Contains("endif"))
-				{
-					if (ifStack == 0)
-					{
-						newRow = i; 
-						break;
-					}
-					if (l.Contains("endif"))
-						--ifStack;
-				}
-				else if (l.Contains("if"))
-					++ifStack;
-			}
+			// Jump to next after the endwhile, as regular stopping on endwhile will reboot the loop
+			++newRow;
+			stack.RemoveLast();
 		}
 		assert(newRow > 0);
 		// Process it next iteration.
@@ -868,52 +807,14 @@ void Script::HandleConditional(String line)
 		assert(false && "Line not finished? Something is missing in the if/else/endif block!");	
 }
 
-void Script::JumpToNextConditional()
+void Script::JumpToEndif(const ScriptInstruction & instruction)
 {
-	// If the statement is not true, find an else or endif block..!
-	for (int i = currentLine; i < lines.Size(); ++i){
-		String l = lines[i];
-		if (l.Contains("elsif"))
-		{
-			std::cout<<"\nJumpToNextConditional: "<<l;
-			currentLine = i;
-			// Call this function again?
-			EvaluateLine(lines[i]);
-			return;
-		}
-		else if (l.Contains("else"))
-		{
-			/// Jump to this row ^^
-			currentLine = i;
-			lineFinished = true;
-			return;
-		}
-		else if (l.Contains("endif")){
-			currentLine = i;
-			lineFinished = true;
-			return;
-		}
-	}
-}
-
-
-void Script::JumpToEndif()
-{
-	// If the statement is not true, find an else or endif block..!
-	for (int i = currentLine; i < lines.Size(); ++i)
+	if (instruction.end < 0)
 	{
-		String l = lines[i];
-		if (l.Contains("endif"))
-		{
-			std::cout<<"\nJumpToEndif: "+l+" from: "+lines[currentLine];
-			currentLine = i;
-			lineProcessed = false;
-	//		lineFinished = true;
-			return;
-		}
+		std::cout<<"\nERROR: No Endif found D:";
+		return;
 	}
-	std::cout<<"\nERROR: No Endif found D:";
+	currentLine = instruction.end;
+	lineProcessed = false;
 }
 
-
-
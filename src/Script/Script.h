@@ -8,6 +8,8 @@
 #include "MathLib/Vector3f.h"
 #include "MathLib/Variable.h"
 #include "Entity/Entity.h"
+#include "ScriptProgram.h"
+#include <memory>
 
 /// Compact saveable version of the event
 struct CompactEvent{};
@@ -63,8 +65,8 @@ public:
 	virtual void Process(int timeInMs);
 	virtual void OnEnd();
 
-	/// Sub-class for handling game-specific blocking script-lines.
-	virtual void EvaluateLine(String & line);
+	/// Evaluates the instruction at the current line. Sub-class for handling game-specific blocking script-lines.
+	virtual void EvaluateInstruction(const ScriptInstruction & instruction);
 
 //	virtual void EvaluateFunction(String function, List<String> arguments);
 
@@ -148,6 +150,8 @@ public:
 
 	/// All that should happen when the event triggers..!
 	List<String> lines;
+	/// The lines compiled into instructions, shared by all scripts loaded from the same source. Compiled on first Process if lines were set directly.
+	std::shared_ptr<ScriptProgram> program;
 	/// For checking that whatever the line wanted to do got finished.
 	bool lineFinished;
 	/// If the line has been processed.
@@ -167,10 +171,9 @@ private:
 	/// Stack, e.g. an IF_CLAUSE in a WHILE_LOOP., While_LOOP will be index 0.
 	List<ScriptLevel> stack;
 
-	/// For if- and elsif- statements.
-	void HandleConditional(String line);
-	void JumpToNextConditional();
-	void JumpToEndif();
+	/// For if-, elsif- and while-statements.
+	void HandleConditional(const ScriptInstruction & instruction);
+	void JumpToEndif(const ScriptInstruction & instruction);
 
 	/// Flag to true once it processes any if-case-thingy?
 //	bool ifProcessed;
@@ -26,6 +26,7 @@ ScriptManager::~ScriptManager()
 	*/
 	// Kill old scripts?
 	endedScripts.ClearAndDelete();
+	ScriptProgram::ClearCache();
 }
 ScriptManager * ScriptManager::eventManager = NULL;
 ScriptManager * ScriptManager::Instance(){
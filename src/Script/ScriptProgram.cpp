@@ -0,0 +1,372 @@
+/// Emil Hedemalm
+/// 2016-08-24
+/// Script lines pre-parsed into instructions, shared by all scripts loaded from the same source.
+
+#include "ScriptProgram.h"
+#include "MathLib/CompiledExpression.h"
+#include "Game/GameVariableManager.h"
+#include <iostream>
+
+ScriptInstruction::ScriptInstruction()
+: command(COMMENT), expression(-1), next(-1), end(-1)
+{
+}
+
+ScriptExpression::ScriptExpression(String text)
+: text(text), parsed(NULL), compiled(NULL)
+{
+}
+
+ScriptExpression::~ScriptExpression()
+{
+	delete parsed;
+	delete compiled;
+}
+
+std::mutex ScriptProgram::cacheMutex;
+std::unordered_map<std::string, std::shared_ptr<ScriptProgram>> ScriptProgram::cache;
+
+ScriptProgram::ScriptProgram()
+: triggerCondition(0)
+{
+}
+
+ScriptProgram::~ScriptProgram()
+{
+	expressions.ClearAndDelete();
+}
+
+/// Compiles given lines, one instruction per line. Expressions are parsed using the given function evaluators.
+std::shared_ptr<ScriptProgram> ScriptProgram::Compile(const List<String> & lines, const List<FunctionEvaluator*> & functionEvaluators)
+{
+	std::shared_ptr<ScriptProgram> program(new ScriptProgram());
+	program->lines = lines;
+	program->functionEvaluators = functionEvaluators;
+	for (int i = 0; i < lines.Size(); ++i)
+		program->instructions.AddItem(program->Parse(lines[i]));
+	program->Link();
+	return program;
+}
+
+/// Returns the program previously cached for given source, or an empty pointer.
+std::shared_ptr<ScriptProgram> ScriptProgram::Cached(String source)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = cache.find(source.c_str());
+	if (it == cache.end())
+		return std::shared_ptr<ScriptProgram>();
+	return it->second;
+}
+
+/// Caches the program for given source, replacing any older one. Scripts still running the old one keep it until they are done.
+void ScriptProgram::Cache(String source, std::shared_ptr<ScriptProgram> program)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache[source.c_str()] = program;
+}
+
+/// Drops all cached programs, e.g. to reload scripts from file.
+void ScriptProgram::ClearCache()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
+
+/** Evaluates the expression at given index. Variables are looked up among the game variables first and then among the given ones,
+	as when evaluating with GameVars.GetAllExpressionVariables() + variables. If the function evaluators differ from the ones it was compiled with,
+	the text is parsed and evaluated anew. Returns a result of type NO_TYPE if it could not be evaluated.
+*/
+ExpressionResult ScriptProgram::Evaluate(int expressionIndex, const List<Variable> & variables, const List<FunctionEvaluator*> & evaluators)
+{
+	ScriptExpression * exp = expressions[expressionIndex];
+	bool sameEvaluators = evaluators.Size() == functionEvaluators.Size();
+	for (int i = 0; i < evaluators.Size() && sameEvaluators; ++i)
+		sameEvaluators = evaluators[i] == functionEvaluators[i];
+	/// Function names are identified while parsing, so parse it anew for other evaluators.
+	if (!sameEvaluators)
+	{
+		Expression expression;
+		expression.functionEvaluators = evaluators;
+		if (!expression.ParseExpression(exp->text))
+			return ExpressionResult::Error("Parse error in expression "+exp->text);
+		return expression.Evaluate(GameVars.GetAllExpressionVariables() + variables);
+	}
+	if (!exp->parsed)
+		return ExpressionResult::Error("Parse error in expression "+exp->text);
+	if (!exp->compiled)
+		return exp->parsed->Evaluate(GameVars.GetAllExpressionVariables() + variables);
+	for (int i = 0; i < exp->variableNames.Size(); ++i)
+	{
+		if (!FetchVariable(exp->variableNames[i], variables, exp->slots[i]))
+			return ExpressionResult::Error("Undefined variable \'"+exp->variableNames[i]+"\'");
+	}
+	return exp->compiled->Evaluate(exp->slots);
+}
+
+/// If the expression at given index could be parsed.
+bool ScriptProgram::IsParsed(int expressionIndex) const
+{
+	if (expressionIndex < 0 || expressionIndex >= expressions.Size())
+		return false;
+	return expressions[expressionIndex]->parsed != NULL;
+}
+
+/// Identifies the line's command and splits its arguments.
+ScriptInstruction ScriptProgram::Parse(const String & fromLine)
+{
+	ScriptInstruction instruction;
+	String line = fromLine;
+	line.RemoveSurroundingWhitespaces();
+	line.SetComparisonMode(String::NOT_CASE_SENSITIVE);
+	instruction.line = line;
+	List<String> & arguments = instruction.arguments;
+	int & command = instruction.command;
+	/// String arguments, as on a non-const line a literal matches StartsWith(const String&) and StartsWith(const char*) const equally well.
+	if (line.Length() == 0 || line.StartsWith(String("//")))
+		command = ScriptInstruction::COMMENT;
+	else if (line.Contains("Wait("))
+		command = ScriptInstruction::WAIT;
+	else if (line.StartsWith(String("Key:")))
+	{
+		command = ScriptInstruction::KEY;
+		List<String> tokens = line.Tokenize(":");
+		if (tokens.Size() > 1)
+			arguments.AddItem(tokens[1]);
+	}
+	else if (line.Contains("PlayScript("))
+	{
+		command = ScriptInstruction::PLAY_SCRIPT;
+		arguments = line.Tokenize("(),");
+		/// Skip the command name.
+		if (arguments.Size())
+			arguments.RemoveIndex(0, ListOption::RETAIN_ORDER);
+	}
+	else if (line == "DisableActiveUI")
+		command = ScriptInstruction::DISABLE_ACTIVE_UI;
+	else if (line == "EnableActiveUI")
+		command = ScriptInstruction::ENABLE_ACTIVE_UI;
+	else if (line.Contains("PreloadTexturesInDirectory("))
+		command = ScriptInstruction::PRELOAD_TEXTURES;
+	else if (line.Contains("Begin("))
+		command = ScriptInstruction::BEGIN;
+	else if (line.Contains("End("))
+		command = ScriptInstruction::END;
+	else if (line.Contains("EndScript"))
+		command = ScriptInstruction::END_SCRIPT;
+	else if (line.Contains("EnterGameState("))
+		command = ScriptInstruction::ENTER_GAME_STATE;
+	else if (line.Contains("FadeTo(") || line.Contains("FadeIn("))
+		command = ScriptInstruction::FADE_IN;
+	else if (line.Contains("FadeInBackground("))
+		command = ScriptInstruction::FADE_IN_BACKGROUND;
+	else if (line.Contains("FadeOutBackground("))
+		command = ScriptInstruction::FADE_OUT_BACKGROUND;
+	else if (line.Contains("FadeOut"))
+		command = ScriptInstruction::FADE_OUT;
+	else if (line.Contains("FadeText("))
+		command = ScriptInstruction::FADE_TEXT;
+	else if (line.Contains("PlaySong("))
+		command = ScriptInstruction::PLAY_SONG;
+	else if (line.Contains("Dialogue"))
+	{
+		command = ScriptInstruction::DIALOGUE;
+		List<String> tokens = line.Tokenize("\"");
+		if (line.Contains("\"") && tokens.Size() > 1)
+			arguments.AddItem(tokens[1]);
+	}
+	else if (line.Contains("Answer"))
+		command = ScriptInstruction::ANSWER;
+	else if (line.Contains("BeginAlternatives") || line.Contains("BeginQuestion"))
+	{
+		command = ScriptInstruction::BEGIN_ALTERNATIVES;
+		List<String> tokens = line.Tokenize("\"");
+		if (tokens.Size() > 1)
+			arguments.AddItem(tokens[1]);
+	}
+	else if (line.Contains("elsif") || line.Contains("elseif") || line.Contains("else if"))
+		command = ScriptInstruction::ELSIF;
+	else if (line.Contains("if(") || line.Contains("if ("))
+		command = ScriptInstruction::IF;
+	else if (line.Contains("else"))
+		command = ScriptInstruction::ELSE;
+	else if (line.Contains("endif"))
+		command = ScriptInstruction::ENDIF;
+	else if (line.Contains("endwhile"))
+		command = ScriptInstruction::ENDWHILE;
+	else if (line.Contains("while"))
+		command = ScriptInstruction::WHILE;
+	else if (line.Contains("Repeatable"))
+		command = ScriptInstruction::REPEATABLE;
+	else if (
+		line.Contains("SpawnEntity") ||
+		line.Contains("OnApproach") ||
+		line.Contains("OnInteract") ||
+		line.Contains("DisableMovement") ||
+		line.Contains("EnableMovement") ||
+		line.Contains("Zone(") ||
+		line.Contains("PlacePlayer(") ||
+		line.Contains("TrackPlayer")
+		)
+		command = ScriptInstruction::GAME_MESSAGE;
+	else
+	{
+		command = ScriptInstruction::EXPRESSION;
+		instruction.expression = AddExpression(line);
+	}
+
+	switch(command)
+	{
+		/// Commands taking the text within the parenthesis.
+		case ScriptInstruction::PRELOAD_TEXTURES:
+		case ScriptInstruction::BEGIN:
+		case ScriptInstruction::END:
+		case ScriptInstruction::ENTER_GAME_STATE:
+		case ScriptInstruction::PLAY_SONG:
+		{
+			List<String> tokens = line.Tokenize("()");
+			if (tokens.Size() > 1)
+				arguments.AddItem(tokens[1]);
+			break;
+		}
+		/// Conditions, from the first parenthesis onward.
+		case ScriptInstruction::IF:
+		case ScriptInstruction::ELSIF:
+		case ScriptInstruction::WHILE:
+		{
+			int index = line.Find('(');
+			instruction.expression = AddExpression(index >= 0? line.Part(index) : line);
+			break;
+		}
+	}
+	for (int i = 0; i < arguments.Size(); ++i)
+	{
+		arguments[i].RemoveSurroundingWhitespaces();
+		arguments[i].SetComparisonMode(String::NOT_CASE_SENSITIVE);
+	}
+	return instruction;
+}
+
+/// Parses and compiles an expression, returning its index.
+int ScriptProgram::AddExpression(String text)
+{
+	ScriptExpression * exp = new ScriptExpression(text);
+	Expression * parsed = new Expression();
+	parsed->functionEvaluators = functionEvaluators;
+	if (parsed->ParseExpression(text))
+	{
+		exp->parsed = parsed;
+		exp->variableNames = CompiledExpression::RequiredVariables(*parsed);
+		CompiledExpression * compiled = new CompiledExpression();
+		if (compiled->Compile(*parsed, exp->variableNames))
+		{
+			exp->compiled = compiled;
+			for (int i = 0; i < exp->variableNames.Size(); ++i)
+				exp->slots.AddItem(Variable(exp->variableNames[i]));
+		}
+		else
+			delete compiled;
+	}
+	else
+		delete parsed;
+	expressions.AddItem(exp);
+	return expressions.Size() - 1;
+}
+
+/// Resolves jump targets of conditionals, loops and answers.
+void ScriptProgram::Link()
+{
+	/// Open if- and while-blocks, and for each the latest if, elsif or else in it, to be linked to the next one.
+	List<int> blocks, latest;
+	for (int i = 0; i < instructions.Size(); ++i)
+	{
+		ScriptInstruction & instruction = instructions[i];
+		switch(instruction.command)
+		{
+			case ScriptInstruction::IF:
+			case ScriptInstruction::WHILE:
+				blocks.AddItem(i);
+				latest.AddItem(i);
+				break;
+			case ScriptInstruction::ELSIF:
+			case ScriptInstruction::ELSE:
+				if (blocks.Size() == 0 || instructions[blocks.Last()].command != ScriptInstruction::IF)
+				{
+					std::cout<<"\nScriptProgram: "<<instruction.line<<" outside if-block at line "<<i;
+					break;
+				}
+				instructions[latest.Last()].next = i;
+				latest.Last() = i;
+				break;
+			case ScriptInstruction::ENDIF:
+			{
+				if (blocks.Size() == 0 || instructions[blocks.Last()].command != ScriptInstruction::IF)
+				{
+					std::cout<<"\nScriptProgram: endif outside if-block at line "<<i;
+					break;
+				}
+				instructions[latest.Last()].next = i;
+				for (int j = blocks.Last(); j != i; j = instructions[j].next)
+					instructions[j].end = i;
+				blocks.RemoveLast();
+				latest.RemoveLast();
+				break;
+			}
+			case ScriptInstruction::ENDWHILE:
+				if (blocks.Size() == 0 || instructions[blocks.Last()].command != ScriptInstruction::WHILE)
+				{
+					std::cout<<"\nScriptProgram: endwhile outside while-loop at line "<<i;
+					break;
+				}
+				instructions[blocks.Last()].next = i;
+				instruction.next = blocks.Last();
+				blocks.RemoveLast();
+				latest.RemoveLast();
+				break;
+			case ScriptInstruction::ANSWER:
+				/// The EndAnswers line is itself an Answer, and jumps to itself.
+				for (int j = i; j < instructions.Size(); ++j)
+				{
+					if (instructions[j].line.Contains("EndAnswers"))
+					{
+						instruction.next = j;
+						break;
+					}
+				}
+				break;
+		}
+	}
+	for (int i = 0; i < blocks.Size(); ++i)
+		std::cout<<"\nScriptProgram: Unterminated "<<instructions[blocks[i]].line<<" at line "<<blocks[i];
+}
+
+/// Fetches a variable by name into the slot, returning false if not found.
+bool ScriptProgram::FetchVariable(const String & name, const List<Variable> & variables, Variable & slot)
+{
+	GameVar * gameVar = GameVars.Get(name);
+	if (gameVar)
+	{
+		switch(gameVar->Type())
+		{
+			case GameVariable::INTEGER:
+				slot.type = DataType::INTEGER;
+				slot.iValue = gameVar->GetInt();
+				return true;
+			case GameVariable::FLOAT:
+				slot.type = DataType::FLOAT;
+				slot.fValue = gameVar->fValue;
+				return true;
+		}
+	}
+	for (int i = 0; i < variables.Size(); ++i)
+	{
+		const Variable & var = variables[i];
+		if (name == var.name)
+		{
+			slot.type = var.type;
+			slot.iValue = var.iValue;
+			slot.fValue = var.fValue;
+			return true;
+		}
+	}
+	return false;
+}
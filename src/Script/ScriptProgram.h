@@ -0,0 +1,142 @@
+/// Emil Hedemalm
+/// 2016-08-24
+/// Script lines pre-parsed into instructions, shared by all scripts loaded from the same source.
+
+#ifndef SCRIPT_PROGRAM_H
+#define SCRIPT_PROGRAM_H
+
+#include "String/AEString.h"
+#include "List/List.h"
+#include "MathLib/Variable.h"
+#include "MathLib/Expression.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <string>
+
+class FunctionEvaluator;
+class CompiledExpression;
+
+/// One line of a script, with its command identified and arguments split up front, so that Script::Process does no searching in the text.
+class ScriptInstruction
+{
+public:
+	ScriptInstruction();
+	/// Commands, in the order Script checks for them. A line matching several (e.g. containing both "Dialogue" and "if(") takes the first.
+	enum commands {
+		COMMENT, // Empty lines or comments, skipped.
+		WAIT,
+		KEY,
+		PLAY_SCRIPT,
+		DISABLE_ACTIVE_UI,
+		ENABLE_ACTIVE_UI,
+		PRELOAD_TEXTURES,
+		BEGIN,
+		END,
+		END_SCRIPT,
+		ENTER_GAME_STATE,
+		FADE_IN,
+		FADE_IN_BACKGROUND,
+		FADE_OUT_BACKGROUND,
+		FADE_OUT,
+		FADE_TEXT,
+		PLAY_SONG,
+		DIALOGUE,
+		ANSWER,
+		BEGIN_ALTERNATIVES,
+		ELSIF,
+		IF,
+		ELSE,
+		ENDIF,
+		ENDWHILE,
+		WHILE,
+		REPEATABLE,
+		/// Game-specific commands, passed on as messages.
+		GAME_MESSAGE,
+		/// Anything else, evaluated as an expression until true, or passed on as a message if it can not be evaluated.
+		EXPRESSION,
+	};
+	int command;
+	/// The whole line, not case-sensitive. Passed to scripts and messages created by the command.
+	String line;
+	/** Pre-split arguments. For most commands the text within the parenthesis, for PlayScript each comma-separated argument,
+		for Key the key name, and for Dialogue and alternatives the quoted text.
+	*/
+	List<String> arguments;
+	/// Index of the condition or expression in the program, or -1.
+	int expression;
+	/** Jump targets. For if, elsif and else the next elsif, else or endif of the same block.
+		For while the matching endwhile, and vice versa. For Answer the following EndAnswers. -1 if there is none.
+	*/
+	int next;
+	/// For if, elsif and else, the endif closing the block. -1 if there is none.
+	int end;
+};
+
+/// Expression of a script line or condition, parsed and compiled once.
+class ScriptExpression
+{
+public:
+	ScriptExpression(String text);
+	~ScriptExpression();
+	String text;
+	/// NULL if it could not be parsed.
+	Expression * parsed;
+	/// NULL if it could not be compiled, e.g. due to containing strings, in which case the parsed expression is evaluated instead.
+	CompiledExpression * compiled;
+	/// Names of the variables the compiled expression reads, and the array of their values filled in before each evaluation.
+	List<String> variableNames;
+	List<Variable> slots;
+};
+
+/** A script's lines compiled into instructions, with jump targets for if/elsif/else/endif and while/endwhile resolved,
+	and conditions parsed and compiled. Programs loaded from files are cached by source, so that all scripts running the same file share one.
+	Not thread-safe apart from the cache; scripts are expected to be processed on the state thread only.
+*/
+class ScriptProgram
+{
+	ScriptProgram();
+public:
+	~ScriptProgram();
+	/// Compiles given lines, one instruction per line. Expressions are parsed using the given function evaluators.
+	static std::shared_ptr<ScriptProgram> Compile(const List<String> & lines, const List<FunctionEvaluator*> & functionEvaluators);
+
+	/// Returns the program previously cached for given source, or an empty pointer.
+	static std::shared_ptr<ScriptProgram> Cached(String source);
+	/// Caches the program for given source, replacing any older one. Scripts still running the old one keep it until they are done.
+	static void Cache(String source, std::shared_ptr<ScriptProgram> program);
+	/// Drops all cached programs, e.g. to reload scripts from file.
+	static void ClearCache();
+
+	/** Evaluates the expression at given index. Variables are looked up among the game variables first and then among the given ones,
+		as when evaluating with GameVars.GetAllExpressionVariables() + variables. If the function evaluators differ from the ones it was compiled with,
+		the text is parsed and evaluated anew. Returns a result of type NO_TYPE if it could not be evaluated.
+	*/
+	ExpressionResult Evaluate(int expressionIndex, const List<Variable> & variables, const List<FunctionEvaluator*> & functionEvaluators);
+	/// If the expression at given index could be parsed.
+	bool IsParsed(int expressionIndex) const;
+
+	List<ScriptInstruction> instructions;
+	/// Lines compiled, so that scripts may be loaded from the cache.
+	List<String> lines;
+	/// Name and trigger condition as read from the file, if any. See Script.
+	String name;
+	int triggerCondition;
+private:
+	/// Identifies the line's command and splits its arguments.
+	ScriptInstruction Parse(const String & line);
+	/// Parses and compiles an expression, returning its index.
+	int AddExpression(String text);
+	/// Resolves jump targets of conditionals, loops and answers.
+	void Link();
+	/// Fetches a variable by name into the slot, returning false if not found.
+	static bool FetchVariable(const String & name, const List<Variable> & variables, Variable & slot);
+
+	List<ScriptExpression*> expressions;
+	List<FunctionEvaluator*> functionEvaluators;
+
+	static std::mutex cacheMutex;
+	static std::unordered_map<std::string, std::shared_ptr<ScriptProgram>> cache;
+};
+
+#endif
@@ -92,7 +92,9 @@ void * StateManager::StateProcessor(void * vArgs){
 					WindowMan.ProcessMessages();
 					/// Process network packets if applicable
 					MesMan.ProcessPackets();
-					PathMan.Process(timeDiffInMs);
+					PathMan.Process();
+					/// Hand over textures and models loaded in the background.
+					AssetLoad.Process();
 				
 				}
 
@@ -20,6 +20,8 @@ struct MemoryStatus
 	#include <windows.h>
 	MEMORYSTATUSEX memoryStatusWin32;
 #endif
+#include <cstdlib>
+#include <cstdint>
 
 
 
@@ -67,12 +69,34 @@ void * AllocateAligned(int numBytes, int alignment, bool * ok /*= NULL*/)
 	void * memory = NULL;
 #ifdef WINDOWS
 	memory = _aligned_malloc(numBytes, alignment);
-#elif defined LINUX
-	int result = posix_memalign(&memory, alignment, numBytes);
-	if (ok)
+#elif defined LINUX | defined OSX
+	if (posix_memalign(&memory, alignment, numBytes) != 0)
+		memory = NULL;
+#else
+	/// Over-allocate, keeping the pointer from malloc just before the aligned block for FreeAligned.
+	char * allocated = (char*) malloc(numBytes + alignment + sizeof(void*));
+	if (allocated)
 	{
-		*ok = (result == 0);
+		uintptr_t aligned = ((uintptr_t) (allocated + sizeof(void*)) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+		((void**) aligned)[-1] = allocated;
+		memory = (void*) aligned;
 	}
 #endif	
+	if (ok)
+		*ok = memory != NULL;
 	return memory;
 }
+
+/// Frees memory allocated using AllocateAligned.
+void FreeAligned(void * memory)
+{
+	if (memory == NULL)
+		return;
+#ifdef WINDOWS
+	_aligned_free(memory);
+#elif defined LINUX | defined OSX
+	free(memory);
+#else
+	free(((void**) memory)[-1]);
+#endif
+}
@@ -27,10 +27,12 @@ int MemoryLoad();
 #define NULL 0
 #endif
 
-/// For aligned memory allocation, OS-specific
-/// Allocates numBytes, using alignment of specified bytes. Returns pointer to allocated memory.
+/// For aligned memory allocation, OS-specific, with a portable fallback on other platforms. Alignment must be a power of two.
+/// Allocates numBytes, using alignment of specified bytes. Returns pointer to allocated memory, or NULL if out of memory.
 /// If ok is specified as non-null, the success of the operation will be stored there.
 void * AllocateAligned(int numBytes, int alignment, bool * ok = NULL);
+/// Frees memory allocated using AllocateAligned.
+void FreeAligned(void * memory);
 /// Allocates memory for a given object.
 #define AllocAligned(a) (a*) AllocateAligned(1 * sizeof(a), 16)
 
@@ -51,6 +51,8 @@ Texture::Texture()
 
 	isDepthTexture = false;
 	bufferized = false;
+	evicted = false;
+	lastUsedMs = creationDate;
 }
 
 Texture::~Texture()
@@ -607,6 +609,11 @@ bool Texture::Bufferize(bool force /* = false*/)
 //		std::cout<<"\nTexture \""<<source<<"\" already bufferized! Skipping.";
 		return false;
 	}
+	/// Released by the TextureManager to stay within its memory budget, so read it again.
+	if (evicted && !data)
+		LoadFromFile();
+	evicted = false;
+	lastUsedMs = Timer::GetCurrentTimeMs();
 	if (size.GeometricSum() == 0)
 	{
 		// nothing to buferize..
@@ -724,6 +731,28 @@ bool Texture::Bufferize(bool force /* = false*/)
 	if (!dynamic)
 		std::cout<<"\nTexture "<<name<<" bufferized.";
 	bufferized = true;
+	return true;
+}
+
+/// Bytes used by the CPU-side data buffer, 0 if released.
+int64 Texture::CPUBytes()
+{
+	if (!data)
+		return 0;
+	return dataBufferSize;
+}
+
+/// Estimated bytes of video memory, including mip-maps, 0 if not bufferized.
+int64 Texture::GPUBytes()
+{
+	if (glid == -1)
+		return 0;
+	/// Always uploaded as RGBA, see Bufferize.
+	int64 bytes = int64(size.x) * size.y * 4 * BytesPerChannel();
+	/// The mip-map chain adds a third.
+	if (mipmappingEnabled)
+		bytes += bytes / 3;
+	return bytes;
 }
 
 void Texture::SetSource(String str)
@@ -38,6 +38,7 @@ class Texture
 {
 	// Require usage of the texture manager to allocate textures.
 	friend class TextureManager;
+	friend class AssetLoader;
 	Texture();
 public:
 	~Texture();
@@ -88,6 +89,10 @@ public:
 	bool MakeRed();
 	/// Bufferizes into GL. Should only be called from the render-thread!
 	bool Bufferize(bool force = false);
+	/// Bytes used by the CPU-side data buffer, 0 if released.
+	int64 CPUBytes();
+	/// Estimated bytes of video memory, including mip-maps, 0 if not bufferized.
+	int64 GPUBytes();
 
 	/// Sets source of the texture.
 	void SetSource(String str);
@@ -138,6 +143,8 @@ public:
 	int64 creationDate;
 	/// For updating when painting in it.
 	long long lastUpdate;
+	/// When last bufferized or marked as used by TextureManager::MarkUsed, for evicting the least recently used textures.
+	int64 lastUsedMs;
 	
 	enum formats{
 		NULL_FORMAT,
@@ -257,6 +264,8 @@ private:
 
 	/// Flaged after re-loading from some source.
 	bool bufferized;
+	/// Set when released by the TextureManager to stay within its memory budget, so that it is read from its source again when next bufferized.
+	bool evicted;
 	// Consider including other relevant info if using this class for image manipulation, mipmapping or whatever.
 };
 
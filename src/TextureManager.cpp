@@ -13,10 +13,12 @@
 #include "File/FileUtil.h"
 #include "Graphics/Messages/GraphicsMessage.h"
 #include "Graphics/GraphicsManager.h"
+#include "File/AssetLoader.h"
 
 #include "OS/Sleep.h"
 
 #include <vector>
+#include <algorithm>
 #include "Globals.h"
 #include "Color.h"
 
@@ -41,7 +43,14 @@ void TextureManager::Deallocate()
 	texMan = NULL;
 }
 
-TextureManager::TextureManager(){}
+TextureManager::TextureManager()
+{
+	cpuBudget = gpuBudget = 0;
+	cpuBytes = gpuBytes = 0;
+	residencyTimeMs = lastResidencyUpdateMs = 0;
+	minIdleMs = 5000;
+	residencyIntervalMs = 1000;
+}
 
 TextureManager::~TextureManager()
 {
@@ -120,13 +129,9 @@ Texture * TextureManager::GetTextureByName(String name)
 	if (name.Length() == 0)
 		return NULL;
 	name = FilePath::MakeRelative(name);
-	int queriedLength = name.Length();
-	for (int i = 0; i < textures.Size(); ++i)
-	{
-		String texName = textures[i]->name;
-		if (texName == name)
-			return textures[i];
-	}
+	Texture * tex = FindByName(name);
+	if (tex)
+		return tex;
 	/// Check if the name has a file-ending. If not, assume it's a general color!
 	if (name == "Black")
 		return GenerateTexture("Black", Vector4f(0,0,0,1));
@@ -167,25 +172,116 @@ Texture * TextureManager::GetTextureBySource(String source)
 	if (source == 0)
 		return NULL;
 	source = FilePath::MakeRelative(source);
-	for (int i = 0; i < textures.Size(); ++i){
-		Texture * tex = textures[i];
-		if (tex->source.Contains(source) ||
-			source.Contains(tex->source)){
-				return tex;
-		}
-	}
+	Texture * tex = GetLoadedTexture(source);
+	if (tex)
+		return tex;
 //	std::cout<<"\nTexture not loaded, attempting to load it.";
 	return LoadTexture(source);
 }
 
 /// For buffering
 Texture * TextureManager::GetTextureByID(int glid){
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		auto it = texturesByGLID.find(glid);
+		if (it != texturesByGLID.end() && it->second->glid == glid)
+			return it->second;
+	}
+	/// Not indexed yet, since IDs are assigned when bufferizing.
 	for (int i = 0; i < textures.Size(); ++i)
+	{
 		if (textures[i]->glid == glid)
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			texturesByGLID[glid] = textures[i];
 			return textures[i];
+		}
+	}
 	return NULL;
 }
 
+/** Memory budgets for all textures in bytes, 0 for no limit, which is the default.
+	When exceeded, UpdateResidency releases the least recently used textures which can be read from file again.
+*/
+void TextureManager::SetMemoryBudget(int64 cpuBytes, int64 gpuBytes)
+{
+	cpuBudget = cpuBytes;
+	gpuBudget = gpuBytes;
+}
+
+/// For sorting eviction candidates, least recently used first.
+static bool UsedEarlier(Texture * one, Texture * other)
+{
+	return one->lastUsedMs < other->lastUsedMs;
+}
+
+/** Accounts the memory of all textures and evicts the least recently used ones until within budget. Call once per frame from the render-thread.
+	Only textures which are not dynamic, have no users, have been bufferized, have a file source and have not been used for minIdleMs are evicted.
+	Their video memory and/or data is released, and they are read from file again the next time they are bufferized.
+*/
+void TextureManager::UpdateResidency()
+{
+	residencyTimeMs = Timer::GetCurrentTimeMs();
+	if (residencyTimeMs - lastResidencyUpdateMs < residencyIntervalMs)
+		return;
+	lastResidencyUpdateMs = residencyTimeMs;
+
+	cpuBytes = gpuBytes = 0;
+	List<Texture*> candidates;
+	for (int i = 0; i < textures.Size(); ++i)
+	{
+		Texture * texture = textures[i];
+		cpuBytes += texture->CPUBytes();
+		gpuBytes += texture->GPUBytes();
+		if (IsEvictable(texture))
+			candidates.AddItem(texture);
+	}
+	bool overCPU = cpuBudget > 0 && cpuBytes > cpuBudget;
+	bool overGPU = gpuBudget > 0 && gpuBytes > gpuBudget;
+	if (!overCPU && !overGPU)
+		return;
+
+	std::sort(candidates.GetArray(), candidates.GetArray() + candidates.Size(), UsedEarlier);
+	int evicted = 0;
+	for (int i = 0; i < candidates.Size() && (overCPU || overGPU); ++i)
+	{
+		Texture * texture = candidates[i];
+		/// Can't read it back in.
+		if (!FileExists(texture->source))
+			continue;
+		int64 gpu = texture->GPUBytes(), cpu = texture->CPUBytes();
+		if (overGPU && gpu)
+		{
+			glDeleteTextures(1, &texture->glid);
+			texture->glid = -1;
+			gpuBytes -= gpu;
+			texture->evicted = true;
+		}
+		if (overCPU && cpu)
+		{
+			texture->Deallocate();
+			cpuBytes -= cpu;
+			texture->evicted = true;
+		}
+		if (texture->evicted)
+			++evicted;
+		overCPU = cpuBudget > 0 && cpuBytes > cpuBudget;
+		overGPU = gpuBudget > 0 && gpuBytes > gpuBudget;
+	}
+	LogGraphics("Evicted "+String(evicted)+" textures, now using "+String(cpuBytes / 1024)+" kB CPU and "+String(gpuBytes / 1024)+" kB GPU memory", INFO);
+}
+
+/// If the texture may be released by UpdateResidency.
+bool TextureManager::IsEvictable(Texture * texture)
+{
+	if (texture->dynamic || texture->users > 0 || !texture->bufferized)
+		return false;
+	/// Generated or filled in by code, nothing to reload it from.
+	if (texture->source.Length() == 0 || texture->source == "Generated")
+		return false;
+	return residencyTimeMs - texture->lastUsedMs >= minIdleMs;
+}
+
 /// Frees the GL allocated IDs/memory of all textures.
 void TextureManager::FreeTextures()
 {
@@ -208,7 +304,7 @@ void TextureManager::FreeTextures()
 Texture * TextureManager::New()
 {
 	Texture * tex = new Texture();
-	textures.Add(tex);
+	Register(tex);
 	tex->format = Texture::RGBA;
 //	tex->bpp = 4;
 	return tex;
@@ -226,6 +322,7 @@ Texture * TextureManager::NewDynamic()
 void TextureManager::DeleteTexture(Texture * texture)
 {
 	textures.Remove(texture);
+	Unindex(texture);
 	delete texture;
 }
 
@@ -268,6 +365,17 @@ int TextureManager::LoadTextures(List<String> & texturesToLoad){
 	return failed;
 }
 
+/** Queues all textures in the provided source/name list for loading on the AssetLoader's workers, returning their requests straight away.
+	Sources which are already loaded get finished requests.
+*/
+List<AssetRequest*> TextureManager::LoadTexturesAsync(List<String> & texturesToLoad)
+{
+	List<AssetRequest*> requests;
+	for (int i = 0; i < texturesToLoad.Size(); ++i)
+		requests.AddItem(LoadTextureAsync(texturesToLoad[i]));
+	return requests;
+}
+
 /// Generates a texture with automatic name and given color. The texture will be exactly 1 or 2x2 pixels, simply for the color!
 Texture * TextureManager::GenerateTexture(const Color & andColor)
 {
@@ -280,12 +388,9 @@ Texture * TextureManager::GenerateTexture(const Color & andColor)
 Texture * TextureManager::GenerateTexture(String withName, const Color & andColor)
 {
 	/// Check that we don't already have one with the same name, it should be correct if so.
-	for (int i = 0; i < textures.Size(); ++i)
-	{
-		Texture * tex = textures[i];
-		if (tex->name == withName)
-			return tex;
-	}
+	Texture * tex = FindByName(withName);
+	if (tex)
+		return tex;
 	Texture * newTex = new Texture();
 	newTex->size = Vector2i(1, 1);
 	newTex->format = Texture::RGBA;
@@ -295,7 +400,7 @@ Texture * TextureManager::GenerateTexture(String withName, const Color & andColo
 	newTex->source = "Generated";
 
 
-	textures.Add(newTex);
+	Register(newTex);
 	return newTex;
 }
 
@@ -316,48 +421,13 @@ bool TextureManager::BufferizeTextures(List<Texture*> textures)
 Texture * TextureManager::LoadTexture(String source, bool noPathAdditions)
 {
 	source = FilePath::MakeRelative(source);
-	for (int i = 0; i < textures.Size(); ++i){
-		if (textures[i]->source.Contains(source) ||
-			source.Contains(textures[i]->source)){
-//			std::cout<<"\nTexture \""<<source<<"\" already loaded, skipping.";
-			return textures[i];
-		}
-	}
-	if (!noPathAdditions)
+	Texture * loaded = GetLoadedTexture(source);
+	if (loaded)
 	{
-		if (!(source.Contains("img/") || source.Contains("img\\")
-			|| source.Contains("anim/") || source.Contains("anim\\")
-			|| source.Contains(":\\") || source.Contains(":/")))
-			source = "img/" + source;
+//		std::cout<<"\nTexture \""<<source<<"\" already loaded, skipping.";
+		return loaded;
 	}
-	if (!source.Contains("."))
-		source = source + ".png";
-    source.Replace('\\', '/');
-    if (source.Contains("/bin")){
-        std::cout<<"\nSource contains \"GameEngine\" string. Remove it and all before it~";
-        std::cout<<"\nFrom: "<<source<<" ";
-        List<String> tokens = source.Tokenize("/");
-        std::cout<<"\nTokens: "<<tokens.Size();
-        for (int i = 0; i < tokens.Size(); ++i){
-            std::cout<<"\nToken "<<i<<": "<<tokens[i];
-            if (tokens[i] == "bin"){
-                // Rebuild
-                std::cout<<"\nBeginning rebuild..";
-                source = "";
-                for (int j = i+1; j < tokens.Size(); ++j){
-                    std::cout<<"\nAdding "<<tokens[j];
-                    source += tokens[j];
-                    std::cout<<"\nSource: "<<source;
-                    if (j < tokens.Size()-1){
-                        source += "/";
-                        std::cout<<"\nAdding folder /";
-                    }
-                }
-                break; // n break loop
-            }
-        }
-        std::cout<<": "<<source;
-    }
+	source = ResolveSource(source, noPathAdditions);
 
 	LogMain("Loading texture \""+source+"\"...", DEBUG);
 
@@ -396,7 +466,7 @@ Texture * TextureManager::LoadTexture(String source, bool noPathAdditions)
 	texture->SetName(source);
 	std::cout<<" done.";
 
-	textures.Add(texture);
+	Register(texture);
 
 	LogMain("Loading texture \""+source+"\"... done", EXTENSIVE_DEBUG);
 
@@ -406,6 +476,163 @@ Texture * TextureManager::LoadTexture(String source, bool noPathAdditions)
 	return texture;
 }
 
+/** Queues target texture for loading on the AssetLoader's workers, returning its request straight away.
+	The texture is registered and queued for bufferization once AssetLoader::Process has handed it over.
+	If it is already loaded the request is finished at once, and if a request is already pending for it that one is returned.
+*/
+AssetRequest * TextureManager::LoadTextureAsync(String source, bool noPathAdditions, AssetCallback callback, void * callbackData)
+{
+	assert(AssetLoader::Instance());
+	source = FilePath::MakeRelative(source);
+	Texture * loaded = GetLoadedTexture(source);
+	if (loaded)
+		return AssetLoad.Loaded(loaded, callback, callbackData);
+	return AssetLoad.LoadTexture(ResolveSource(source, noPathAdditions), callback, callbackData);
+}
+
+/** Registers a texture loaded elsewhere, e.g. by the AssetLoader.
+	If a texture with the same source was loaded meanwhile the given one is deleted and the existing one is returned.
+*/
+Texture * TextureManager::AddTexture(Texture * texture)
+{
+	Texture * loaded = GetLoadedTexture(texture->source);
+	if (loaded && loaded != texture)
+	{
+		delete texture;
+		return loaded;
+	}
+	if (!loaded)
+		Register(texture);
+	return texture;
+}
+
+/// Returns a loaded texture whose source matches given (relative) source, or NULL.
+Texture * TextureManager::GetLoadedTexture(String source)
+{
+	if (source.Length() == 0)
+		return NULL;
+	std::string key = SourceKey(source);
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		auto it = texturesBySource.find(key);
+		if (it != texturesBySource.end() && SourceMatches(it->second, source))
+			return it->second;
+	}
+	/// Partial sources, or sources changed after loading. Remember the result so the next query is direct.
+	for (int i = 0; i < textures.Size(); ++i){
+		if (SourceMatches(textures[i], source))
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			texturesBySource[key] = textures[i];
+			return textures[i];
+		}
+	}
+	return NULL;
+}
+
+/// Returns a texture with exactly given name, or NULL.
+Texture * TextureManager::FindByName(String name)
+{
+	std::string key = name.c_str();
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		auto it = texturesByName.find(key);
+		if (it != texturesByName.end() && it->second->name == name)
+			return it->second;
+	}
+	/// Names are often set after creation, so they may not have been indexed yet.
+	for (int i = 0; i < textures.Size(); ++i)
+	{
+		if (textures[i]->name == name)
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			texturesByName[key] = textures[i];
+			return textures[i];
+		}
+	}
+	return NULL;
+}
+
+/// Adds the texture to the list and indexes it.
+void TextureManager::Register(Texture * texture)
+{
+	textures.Add(texture);
+	std::lock_guard<std::mutex> lock(indexMutex);
+	if (texture->name.Length())
+		texturesByName.insert(std::make_pair(std::string(texture->name.c_str()), texture));
+	if (texture->source.Length())
+		texturesBySource.insert(std::make_pair(SourceKey(texture->source), texture));
+	if (texture->glid != -1)
+		texturesByGLID.insert(std::make_pair(texture->glid, texture));
+}
+
+/// Removes all index entries pointing to the texture, under whichever keys they were made.
+void TextureManager::Unindex(Texture * texture)
+{
+	std::lock_guard<std::mutex> lock(indexMutex);
+	for (auto it = texturesByName.begin(); it != texturesByName.end(); )
+		it = it->second == texture ? texturesByName.erase(it) : ++it;
+	for (auto it = texturesBySource.begin(); it != texturesBySource.end(); )
+		it = it->second == texture ? texturesBySource.erase(it) : ++it;
+	for (auto it = texturesByGLID.begin(); it != texturesByGLID.end(); )
+		it = it->second == texture ? texturesByGLID.erase(it) : ++it;
+}
+
+/// Key for the source index, with uniform folder slashes.
+std::string TextureManager::SourceKey(String source)
+{
+	source.Replace('\\', '/');
+	return source.c_str();
+}
+
+/// Same partial matching as has always been used for sources, so "img/Foo" finds "img/Foo.png".
+bool TextureManager::SourceMatches(Texture * texture, String & source)
+{
+	return texture->source.Contains(source) || source.Contains(texture->source);
+}
+
+/// Adds the img/ folder and .png extension to a relative source where needed, as done by LoadTexture.
+String TextureManager::ResolveSource(String source, bool noPathAdditions)
+{
+	if (!noPathAdditions)
+	{
+		if (!(source.Contains("img/") || source.Contains("img\\")
+			|| source.Contains("anim/") || source.Contains("anim\\")
+			|| source.Contains(":\\") || source.Contains(":/")))
+			source = "img/" + source;
+	}
+	if (!source.Contains("."))
+		source = source + ".png";
+    source.Replace('\\', '/');
+    if (source.Contains("/bin")){
+        std::cout<<"\nSource contains \"GameEngine\" string. Remove it and all before it~";
+        std::cout<<"\nFrom: "<<source<<" ";
+        List<String> tokens = source.Tokenize("/");
+        std::cout<<"\nTokens: "<<tokens.Size();
+        for (int i = 0; i < tokens.Size(); ++i){
+            std::cout<<"\nToken "<<i<<": "<<tokens[i];
+            if (tokens[i] == "bin"){
+                // Rebuild
+                std::cout<<"\nBeginning rebuild..";
+                source = "";
+                for (int j = i+1; j < tokens.Size(); ++j){
+                    std::cout<<"\nAdding "<<tokens[j];
+                    source += tokens[j];
+                    std::cout<<"\nSource: "<<source;
+                    if (j < tokens.Size()-1){
+                        source += "/";
+                        std::cout<<"\nAdding folder /";
+                    }
+                }
+                break; // n break loop
+            }
+        }
+        std::cout<<": "<<source;
+    }
+
+	return source;
+}
+
 
 
 /// Checks if target image is supported for loading by the game engine.
@@ -8,8 +8,13 @@
 #include <Util.h>
 #include "Texture.h"
 #include "Color.h"
+#include <unordered_map>
+#include <string>
+#include <mutex>
 
 class Entity;
+class AssetRequest;
+typedef void (*AssetCallback)(AssetRequest * request, void * data);
 
 
 #define TexMan		(*TextureManager::Instance())
@@ -50,6 +55,21 @@ public:
 		By default textures are assumed to be located in the /img/ directory. If some other path is requested noPathAdditions should be set to true.
 	*/
 	Texture * LoadTexture(String source, bool noPathAdditions = false);
+	/** Queues all textures in the provided source/name list for loading on the AssetLoader's workers, returning their requests straight away.
+		Sources which are already loaded get finished requests.
+	*/
+	List<AssetRequest*> LoadTexturesAsync(List<String> & texturesToLoad);
+	/** Queues target texture for loading on the AssetLoader's workers, returning its request straight away.
+		The texture is registered and queued for bufferization once AssetLoader::Process has handed it over, after which the callback, if any, is called.
+		If it is already loaded the request is finished at once, and if a request is already pending for it that one is returned.
+	*/
+	AssetRequest * LoadTextureAsync(String source, bool noPathAdditions = false, AssetCallback callback = NULL, void * callbackData = NULL);
+	/** Registers a texture loaded elsewhere, e.g. by the AssetLoader.
+		If a texture with the same source was loaded meanwhile the given one is deleted and the existing one is returned.
+	*/
+	Texture * AddTexture(Texture * texture);
+	/// Adds the img/ folder and .png extension to a relative source where needed, as done by LoadTexture.
+	static String ResolveSource(String source, bool noPathAdditions = false);
 	/// Loads all required textures for the specified state into memory.   WHAT.. I don't even
 	bool LoadTextures(int state);
 	/// Loads all textures required by target Entity.
@@ -95,6 +115,27 @@ public:
 	/// For buffering
 	Texture * GetTextureByID(int glid);
 
+	/** Memory budgets for all textures in bytes, 0 for no limit, which is the default.
+		When exceeded, UpdateResidency releases the least recently used textures which can be read from file again.
+	*/
+	void SetMemoryBudget(int64 cpuBytes, int64 gpuBytes);
+	/// Memory used by all textures as of the last UpdateResidency.
+	int64 CPUBytes() const { return cpuBytes; };
+	int64 GPUBytes() const { return gpuBytes; };
+	/** Marks the texture as used this frame, so that it is not evicted.
+		Textures referenced by entities are kept by their users count, but others, e.g. for UI and fonts, should be marked when bound.
+	*/
+	void MarkUsed(Texture * texture) { texture->lastUsedMs = residencyTimeMs; };
+	/** Accounts the memory of all textures and evicts the least recently used ones until within budget. Call once per frame from the render-thread.
+		Only textures which are not dynamic, have no users, have been bufferized, have a file source and have not been used for minIdleMs are evicted.
+		Their video memory and/or data is released, and they are read from file again the next time they are bufferized.
+	*/
+	void UpdateResidency();
+	/// Time since a texture was last used before it may be evicted. Default 5000 ms.
+	int minIdleMs;
+	/// Time between each accounting in UpdateResidency. Default 1000 ms.
+	int residencyIntervalMs;
+
 	/// Frees the GL allocated IDs/memory of all textures.
 	void FreeTextures();
 
@@ -102,13 +143,40 @@ public:
 	bool SupportedImageFileType(String fileName);
 
 private:
+	/// Returns a loaded texture whose source matches given (relative) source, or NULL.
+	Texture * GetLoadedTexture(String source);
+	/// Returns a texture with exactly given name, or NULL.
+	Texture * FindByName(String name);
+	/// Adds the texture to the list and indexes it.
+	void Register(Texture * texture);
+	/// Removes all index entries pointing to the texture, under whichever keys they were made.
+	void Unindex(Texture * texture);
+	/// Key for the source index, with uniform folder slashes.
+	static std::string SourceKey(String source);
+	/// Same partial matching as has always been used for sources, so "img/Foo" finds "img/Foo.png".
+	static bool SourceMatches(Texture * texture, String & source);
 	/// Attempts to load a texture using OpenCV imread.
 	bool LoadTextureOpenCV(String source, Texture * texture);
 	/// Attempts to load a texture using LodePNG library.
 	bool LoadTextureLodePNG(String source, Texture * texture);
 
+	/// If the texture may be released by UpdateResidency.
+	bool IsEvictable(Texture * texture);
+
 	/// Textures used by the manager
 	List<Texture*> textures;
+	/// Budgets and usage in bytes, see SetMemoryBudget.
+	int64 cpuBudget, gpuBudget;
+	int64 cpuBytes, gpuBytes;
+	int64 residencyTimeMs, lastResidencyUpdateMs;
+	/** Lookup indices, so that the UI may query textures every frame without searching the whole list.
+		Names, sources and GL IDs may change after a texture is added, so entries are verified on lookup,
+		and a full search is used (and its result indexed) when they are missing or out of date.
+	*/
+	std::unordered_map<std::string, Texture*> texturesByName, texturesBySource;
+	std::unordered_map<int, Texture*> texturesByGLID;
+	/// The graphics thread looks up textures as well.
+	std::mutex indexMutex;
 };
 
 #endif
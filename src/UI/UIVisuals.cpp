@@ -104,11 +104,13 @@ bool UIVisuals::FetchBindAndBufferizeTexture() {
 	/// Grab texture?
 	bool validTexture = false;
 	// Set texture
-	if (texture && texture->glid) {
+	if (texture && texture->glid != -1) {
 		glBindTexture(GL_TEXTURE_2D, texture->glid);
 	}
 	else if (texture) {
+		/// Evicted to stay within the texture memory budget, so buffer it again.
 		TexMan.BufferizeTexture(texture);
+		glBindTexture(GL_TEXTURE_2D, texture->glid);
 	}
 	else if (textureSource.Length() > 0) {
 		texture = TexMan.GetTexture(textureSource);
@@ -138,6 +140,7 @@ bool UIVisuals::FetchBindAndBufferizeTexture() {
 	}
 	if (!texture)
 		return false;
+	TexMan.MarkUsed(texture);
 	return true;
 }
 
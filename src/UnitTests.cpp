@@ -9,8 +9,17 @@ extern bool TrigonometryTests();
 
 #include "MathLib/Function.h"
 #include "MathLib/FunctionEvaluator.h"
+#include "MathLib/CompiledExpression.h"
 #include "Thread/Thread.h"
 #include "UI/UIElement.h"
+#include "ObjReader.h"
+#include "Pathfinding/PathManager.h"
+#include "Network/Sync/SnapshotReceiver.h"
+#include "Network/Udp/UdpTransport.h"
+#include "Audio/AudioMixer.h"
+#include "File/FileUtil.h"
+#include "String/StringBenchmark.h"
+#include "Network/Sync/SnapshotBenchmark.h"
 
 bool UnitTests()
 {
@@ -33,6 +42,10 @@ bool UnitTests()
 	Matrix4f::UnitTest();
 	Vector4f::UnitTest();
 	UIElement::UnitTest();
+	ObjReader::UnitTest();
+	PathManager::UnitTest();
+	CompiledExpression::UnitTest();
+	String::UnitTest();
 
 //	Angle::UnitTest();
 
@@ -40,4 +53,31 @@ bool UnitTests()
 	return false;
 }
 
+/** Tests which open sockets or simulate seconds of networking or audio, too slow or intrusive for every start. 
+	Only run when the program is started with the "tests" argument. Asserts on failure.
+*/
+void IntegrationTests()
+{
+	SnapshotReceiver::UnitTest();
+	UdpTransport::UnitTest();
+	AudioMixer::UnitTest();
+}
+
+/** Times parts of the engine against the implementations they replaced, printing the results. 
+	Too slow for every start, so only run when the program is started with the "benchmark" argument. Returns false if any results differed.
+*/
+bool Benchmarks()
+{
+	bool ok = true;
+	String objPath = GetTemporaryFolder() + "ObjReaderBenchmark.obj";
+	ok &= ObjReader::Benchmark(objPath.c_str());
+	List<Variable> variables;
+	variables.Add(Variable("x", 3), Variable("y", 1.5f));
+	ok &= CompiledExpression::Benchmark("x*2+y*(x+y)/3", variables);
+	ok &= CompiledExpression::Benchmark("y*y-x", variables);
+	ok &= BenchmarkStrings();
+	ok &= BenchmarkSnapshots();
+	return ok;
+}
+
 
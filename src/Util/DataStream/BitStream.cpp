@@ -0,0 +1,131 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Writing and reading values of arbitrary bit-lengths, for compact binary network data.
+
+#include "BitStream.h"
+#include <cassert>
+
+BitWriter::BitWriter()
+: bits(0)
+{
+}
+
+/// Writes the lowest bits of value. bits must be 0 to 32.
+void BitWriter::Write(uint32 value, int numBits)
+{
+	assert(numBits >= 0 && numBits <= 32);
+	while (numBits > 0)
+	{
+		int bitInByte = bits % 8;
+		if (bitInByte == 0)
+			bytes.AddItem(0);
+		/// Fill up the current byte as much as possible.
+		int bitsNow = 8 - bitInByte;
+		if (bitsNow > numBits)
+			bitsNow = numBits;
+		uchar part = (uchar) (value & ((1u << bitsNow) - 1));
+		bytes.Last() |= (uchar) (part << bitInByte);
+		value = bitsNow < 32 ? value >> bitsNow : 0;
+		numBits -= bitsNow;
+		bits += bitsNow;
+	}
+}
+
+void BitWriter::WriteBool(bool value)
+{
+	Write(value ? 1 : 0, 1);
+}
+
+/// Writes bits of a signed value, which must fit within them (e.g. -128 to 127 for 8 bits).
+void BitWriter::WriteSigned(int value, int numBits)
+{
+	Write((uint32) value, numBits);
+}
+
+/// Writes a value in groups of 7 bits, each followed by a bit telling if more follow. Small values thus take less space.
+void BitWriter::WriteVariable(uint32 value)
+{
+	while (true)
+	{
+		Write(value & 0x7F, 7);
+		value >>= 7;
+		WriteBool(value != 0);
+		if (value == 0)
+			break;
+	}
+}
+
+/// Appends all bits written to another writer.
+void BitWriter::Write(const BitWriter & other)
+{
+	const uchar * otherData = other.Data();
+	int bitsLeft = other.bits;
+	for (int i = 0; bitsLeft > 0; ++i)
+	{
+		int bitsNow = bitsLeft < 8 ? bitsLeft : 8;
+		Write(otherData[i], bitsNow);
+		bitsLeft -= bitsNow;
+	}
+}
+
+void BitWriter::Clear()
+{
+	bytes.Clear();
+	bits = 0;
+}
+
+BitReader::BitReader(const uchar * data, int bytes)
+: data(data), totalBits(bytes * 8), position(0), overflowed(false)
+{
+}
+
+uint32 BitReader::Read(int numBits)
+{
+	assert(numBits >= 0 && numBits <= 32);
+	if (position + numBits > totalBits)
+	{
+		overflowed = true;
+		position = totalBits;
+		return 0;
+	}
+	uint32 value = 0;
+	int bitsRead = 0;
+	while (bitsRead < numBits)
+	{
+		int bitInByte = position % 8;
+		int bitsNow = 8 - bitInByte;
+		if (bitsNow > numBits - bitsRead)
+			bitsNow = numBits - bitsRead;
+		uint32 part = (data[position / 8] >> bitInByte) & ((1u << bitsNow) - 1);
+		value |= part << bitsRead;
+		bitsRead += bitsNow;
+		position += bitsNow;
+	}
+	return value;
+}
+
+bool BitReader::ReadBool()
+{
+	return Read(1) != 0;
+}
+
+int BitReader::ReadSigned(int numBits)
+{
+	uint32 value = Read(numBits);
+	/// Extend the sign bit.
+	if (numBits > 0 && numBits < 32 && (value & (1u << (numBits - 1))))
+		value |= ~((1u << numBits) - 1);
+	return (int) value;
+}
+
+uint32 BitReader::ReadVariable()
+{
+	uint32 value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		value |= Read(7) << shift;
+		if (!ReadBool())
+			break;
+	}
+	return value;
+}
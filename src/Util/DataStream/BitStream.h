@@ -0,0 +1,59 @@
+/// Emil Hedemalm
+/// 2016-08-26
+/// Writing and reading values of arbitrary bit-lengths, for compact binary network data.
+
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include "System/DataTypes.h"
+#include "List/List.h"
+
+/// Packs values of given bit-lengths tightly into bytes, least significant bit first.
+class BitWriter
+{
+public:
+	BitWriter();
+	/// Writes the lowest bits of value. bits must be 0 to 32.
+	void Write(uint32 value, int bits);
+	void WriteBool(bool value);
+	/// Writes bits of a signed value, which must fit within them (e.g. -128 to 127 for 8 bits).
+	void WriteSigned(int value, int bits);
+	/// Writes a value in groups of 7 bits, each followed by a bit telling if more follow. Small values thus take less space.
+	void WriteVariable(uint32 value);
+	/// Appends all bits written to another writer.
+	void Write(const BitWriter & other);
+
+	/// Bits written so far.
+	int Bits() const { return bits; };
+	/// Bytes needed to hold the bits written.
+	int Bytes() const { return bytes.Size(); };
+	/// The written bytes. Unused bits of the last byte are zero.
+	const uchar * Data() const { return bytes.GetArray(); };
+	void Clear();
+private:
+	List<uchar> bytes;
+	int bits;
+};
+
+/// Reads values written by a BitWriter. Reading beyond the end gives zeroes and flags the reader as overflowed, so the data may be discarded.
+class BitReader
+{
+public:
+	BitReader(const uchar * data, int bytes);
+	uint32 Read(int bits);
+	bool ReadBool();
+	int ReadSigned(int bits);
+	uint32 ReadVariable();
+
+	/// If trying to read beyond the end of the data.
+	bool Overflowed() const { return overflowed; };
+	/// Bits left to read.
+	int BitsLeft() const { return totalBits - position; };
+private:
+	const uchar * data;
+	int totalBits;
+	int position;
+	bool overflowed;
+};
+
+#endif
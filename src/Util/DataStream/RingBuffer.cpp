@@ -0,0 +1,148 @@
+/// Emil Hedemalm
+/// 2016-08-27
+/// Growable circular byte buffer, e.g. for data received or waiting to be sent on a socket.
+
+#include "RingBuffer.h"
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+RingBuffer::RingBuffer(int initialCapacity /*= 4096*/)
+{
+	capacity = 16;
+	while (capacity < initialCapacity)
+		capacity *= 2;
+	buffer = new uchar[capacity];
+	head = size = 0;
+}
+
+RingBuffer::~RingBuffer()
+{
+	delete[] buffer;
+}
+
+/// Grows, if needed, so that at least given amount of bytes may be written without growing.
+void RingBuffer::Reserve(int freeBytes)
+{
+	if (Free() >= freeBytes)
+		return;
+	int newCapacity = capacity;
+	while (newCapacity - size < freeBytes)
+		newCapacity *= 2;
+	uchar * newBuffer = new uchar[newCapacity];
+	/// Move the stored bytes to the start, in order.
+	int first;
+	const uchar * data = ReadPointer(first);
+	memcpy(newBuffer, data, first);
+	if (first < size)
+		memcpy(newBuffer + first, buffer, size - first);
+	delete[] buffer;
+	buffer = newBuffer;
+	capacity = newCapacity;
+	head = 0;
+}
+
+/// Appends bytes, growing if needed.
+void RingBuffer::Write(const uchar * data, int bytes)
+{
+	Reserve(bytes);
+	while (bytes > 0)
+	{
+		int contiguous;
+		uchar * to = WritePointer(contiguous);
+		if (contiguous > bytes)
+			contiguous = bytes;
+		memcpy(to, data, contiguous);
+		Commit(contiguous);
+		data += contiguous;
+		bytes -= contiguous;
+	}
+}
+
+/// Returns where to write directly, e.g. with recv, and how many contiguous bytes may be written there. Call Commit after.
+uchar * RingBuffer::WritePointer(int & contiguousBytes)
+{
+	int tail = (head + size) & (capacity - 1);
+	contiguousBytes = capacity - tail;
+	if (contiguousBytes > Free())
+		contiguousBytes = Free();
+	return buffer + tail;
+}
+
+/// Adds bytes written to the WritePointer.
+void RingBuffer::Commit(int bytes)
+{
+	assert(bytes >= 0 && bytes <= Free());
+	size += bytes;
+}
+
+/// Copies and removes up to maxBytes. Returns bytes read.
+int RingBuffer::Read(uchar * into, int maxBytes)
+{
+	int bytes = maxBytes < size ? maxBytes : size;
+	Peek(into, bytes);
+	Consume(bytes);
+	return bytes;
+}
+
+/// Copies bytes starting at offset without removing them. Returns false if not that many are stored.
+bool RingBuffer::Peek(uchar * into, int bytes, int offset /*= 0*/) const
+{
+	if (offset + bytes > size)
+		return false;
+	while (bytes > 0)
+	{
+		int contiguous;
+		const uchar * from = ReadPointer(contiguous, offset);
+		if (contiguous > bytes)
+			contiguous = bytes;
+		memcpy(into, from, contiguous);
+		into += contiguous;
+		offset += contiguous;
+		bytes -= contiguous;
+	}
+	return true;
+}
+
+/** Returns the stored bytes starting at offset, and how many of them are contiguous.
+	ReadPointer(n1, 0) followed by ReadPointer(n2, n1) thus gives all stored bytes.
+*/
+const uchar * RingBuffer::ReadPointer(int & contiguousBytes, int offset /*= 0*/) const
+{
+	assert(offset >= 0 && offset <= size);
+	int start = (head + offset) & (capacity - 1);
+	contiguousBytes = capacity - start;
+	if (contiguousBytes > size - offset)
+		contiguousBytes = size - offset;
+	return buffer + start;
+}
+
+/** Returns the first bytes stored as one contiguous region, moving the stored bytes if they wrap around within it.
+	For parsing e.g. a packet in place. bytes must not exceed Size().
+*/
+const uchar * RingBuffer::Contiguous(int bytes)
+{
+	assert(bytes >= 0 && bytes <= size);
+	int contiguous;
+	const uchar * data = ReadPointer(contiguous);
+	if (contiguous >= bytes)
+		return data;
+	/// Rotate so that the stored bytes start at the beginning, which leaves them all contiguous. Rare, as Consume starts over when empty.
+	std::rotate(buffer, buffer + head, buffer + capacity);
+	head = 0;
+	return buffer;
+}
+
+/// Removes bytes from the start.
+void RingBuffer::Consume(int bytes)
+{
+	assert(bytes >= 0 && bytes <= size);
+	size -= bytes;
+	/// Start over at the beginning when empty, so that following data is more likely contiguous.
+	head = size ? (head + bytes) & (capacity - 1) : 0;
+}
+
+void RingBuffer::Clear()
+{
+	head = size = 0;
+}
@@ -0,0 +1,63 @@
+/// Emil Hedemalm
+/// 2016-08-27
+/// Growable circular byte buffer, e.g. for data received or waiting to be sent on a socket.
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "System/DataTypes.h"
+
+/** Bytes are written at the end and read from the start, without moving the rest.
+	The stored bytes occupy at most two contiguous regions, accessible through ReadPointer, so that they may be
+	sent or parsed without copying. Capacity is a power of two, doubling when needed.
+*/
+class RingBuffer
+{
+public:
+	RingBuffer(int initialCapacity = 4096);
+	~RingBuffer();
+
+	/// Bytes stored.
+	int Size() const { return size; };
+	int Capacity() const { return capacity; };
+	/// Bytes which can be written without growing.
+	int Free() const { return capacity - size; };
+	bool IsEmpty() const { return size == 0; };
+
+	/// Grows, if needed, so that at least given amount of bytes may be written without growing.
+	void Reserve(int freeBytes);
+	/// Appends bytes, growing if needed.
+	void Write(const uchar * data, int bytes);
+	/// Returns where to write directly, e.g. with recv, and how many contiguous bytes may be written there. Call Commit after.
+	uchar * WritePointer(int & contiguousBytes);
+	/// Adds bytes written to the WritePointer.
+	void Commit(int bytes);
+
+	/// Copies and removes up to maxBytes. Returns bytes read.
+	int Read(uchar * into, int maxBytes);
+	/// Copies bytes starting at offset without removing them. Returns false if not that many are stored.
+	bool Peek(uchar * into, int bytes, int offset = 0) const;
+	/** Returns the stored bytes starting at offset, and how many of them are contiguous.
+		ReadPointer(n1, 0) followed by ReadPointer(n2, n1) thus gives all stored bytes.
+	*/
+	const uchar * ReadPointer(int & contiguousBytes, int offset = 0) const;
+	/** Returns the first bytes stored as one contiguous region, moving the stored bytes if they wrap around within it.
+		For parsing e.g. a packet in place. bytes must not exceed Size().
+	*/
+	const uchar * Contiguous(int bytes);
+	/// Removes bytes from the start.
+	void Consume(int bytes);
+	void Clear();
+private:
+	/// Not copyable, as it owns its buffer.
+	RingBuffer(const RingBuffer & other);
+	void operator = (const RingBuffer & other);
+
+	uchar * buffer;
+	int capacity;
+	/// Index of the first stored byte.
+	int head;
+	int size;
+};
+
+#endif
@@ -6,6 +6,11 @@
 
 #include <cstdlib>
 #include <cstdarg>
+#include <cstring>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 #define CLEAR_AND_DELETE(p) {for(int i = 0; i < p.Size(); ++i) delete p[i]; p.Clear();}
 #define DELETE_LIST_IF_VALID(p) {if(p) CLEAR_AND_DELETE((*p)); delete p; p = NULL;}
@@ -19,14 +24,19 @@ namespace ListOption {
 };
 
 
-/// Align all allocation in the List class to 16 byte intervals, in order to support SSE/SIMD?
-/// 	_arr2 = (float*) _aligned_malloc(ARRAY_SIZE * sizeof(float), 16);
-///	_aligned_free(_arr2);
+/** Alignment in bytes of the arrays allocated by the List class, so that lists of e.g. floats or vectors may be processed using SSE/SIMD.
+	Types requiring larger alignment get theirs. Define as 1 when building to use the default alignment of new instead.
+*/
+#ifndef LIST_ALIGNMENT
+#define LIST_ALIGNMENT 16
+#endif
 
 
 /** A custom list class for handling arbitrary amounts of objects easily!
 	It is implemented as a dynamic array.
 	The items stored need to have = operator overloaded as well as base constructors!
+	All items up to the allocated size are constructed, as they may be accessed by index and SetFull. Items are copied using memcpy/memmove
+	for trivially copyable types, and moved instead of copied where possible for other types. Arrays of types with a trivial constructor are left uninitialized, as with new[].
 */
 template <class T>
 class List
@@ -36,6 +46,8 @@ public:
 
 	List();
 	List(const List &otherList);
+	/// Move constructor, taking over the array of the other list, leaving it empty.
+	List(List && otherList);
 	List(const T & initialItem);
 	/// Creates a new list of specific amount of items.
 	List(const T & item, const T & item2) { Nullify(); AddItem(item); AddItem(item2); };
@@ -54,14 +66,16 @@ public:
 //	operator bool() const { return currentItems? true : false; }; // <- Was causing loads of shitty errors
 	/// Assignment operator overloading
 	const List<T> & operator = (const List &otherList);
+	/// Move assignment, taking over the array of the other list, leaving it empty.
+	const List<T> & operator = (List && otherList);
 	const List * operator += (const List &otherList);
-	const List operator += (const T &newItem);
-	const List operator -= (const T &itemToRemove);
+	const List<T> & operator += (const T &newItem);
+	const List<T> & operator -= (const T &itemToRemove);
 	/// Const-operator overloads
-	const List operator + (const List &otherList) const;
-	const List operator - (const List &otherList) const;
-	const List operator + (const T &newItem) const;
-	const List operator - (const T &itemToRemove) const;
+	List operator + (const List &otherList) const;
+	List operator - (const List &otherList) const;
+	List operator + (const T &newItem) const;
+	List operator - (const T &itemToRemove) const;
 
 	/** Extraction operator for when the list has 1 element (similar but inverted relationship of when creating a list from a single element of class T)
 		Will throw errors or assertions if the list has any number of elements except 1.
@@ -84,8 +98,16 @@ public:
 	bool Insert(const value_type & item, int atIndex);
 	/// Adds an item to the list
 	bool AddItem(const value_type & item);
+	/// Adds an item to the list, moving it in.
+	bool AddItem(value_type && item);
+	/// Adds an item to the list
+	bool Add(const value_type & item) { return AddItem(item); };
+	bool Add(value_type && item) { return AddItem(std::move(item)); };
 	/// Adds an item to the list
 	bool Add(const List<value_type> & item);
+	/// Constructs an item at the end of the list using given constructor arguments, returning it. E.g. list.Emplace(x, y, z) on a list of vectors.
+	template <class ... Args>
+	value_type & Emplace(Args && ... arguments);
 	/// Adds an item to the list at the requested index, pushing along the rest. Used for keeping them sorted or stuff.
 //	bool Add(const value_type & item, int requestedIndex);
 	void Add(const T & item, const T & item2) { AddItem(item); AddItem(item2);};
@@ -122,10 +144,13 @@ public:
 
     /// Resizes the array. Recommended to use before filling it to avoid re-sizings later which might slow down the system if used repetitively.
     void Allocate(int newSize, bool setFull = false);
+	/// Makes sure there is room for at least numItems, growing the array geometrically if not, so that repeated adding does not re-allocate each time.
+	void Reserve(int numItems);
 	/// Deallocates the array. Use in destructors. If items stored within are allocated on the heap, it is recommended to call ClearAndDelete() first.
 	void Deallocate();
 
 	value_type * GetArray() { return arr; };
+	const value_type * GetArray() const { return arr; };
 	/// Returns size of the list
 	const int & Size() const;
 
@@ -154,6 +179,37 @@ public:
 protected:
 	/// Resizing function
 	void Resize(int newSize);
+
+	/// Alignment of allocated arrays. See LIST_ALIGNMENT. A function, as lists may be declared with incomplete types.
+	static size_t ArrayAlignment() { return alignof(T) > LIST_ALIGNMENT ? alignof(T) : LIST_ALIGNMENT; };
+	/// Allocates and frees memory for arrays, without constructing or destroying anything.
+	static T * AllocateStorage(int size);
+	static void FreeStorage(T * storage);
+	/** Helpers for constructing, destroying and copying items in arrays, using memcpy/memmove or skipping the work where the type allows.
+		Copy and Shift assign to constructed items, while the Construct-functions construct in uninitialized memory.
+		Shift moves items within the same array, where the ranges may overlap.
+	*/
+	static void ConstructDefault(T * items, int count) { ConstructDefault(items, count, std::is_trivially_default_constructible<T>()); };
+	static void ConstructCopies(T * to, const T * from, int count) { ConstructCopies(to, from, count, std::is_trivially_copyable<T>()); };
+	static void ConstructMoved(T * to, T * from, int count) { ConstructMoved(to, from, count, std::is_trivially_copyable<T>()); };
+	static void Destroy(T * items, int count) { Destroy(items, count, std::is_trivially_destructible<T>()); };
+	static void Copy(T * to, const T * from, int count) { Copy(to, from, count, std::is_trivially_copyable<T>()); };
+	static void Shift(T * to, T * from, int count) { Shift(to, from, count, std::is_trivially_copyable<T>()); };
+	static void ConstructDefault(T * items, int count, std::true_type trivial) {};
+	static void ConstructDefault(T * items, int count, std::false_type trivial);
+	static void ConstructCopies(T * to, const T * from, int count, std::true_type trivial);
+	static void ConstructCopies(T * to, const T * from, int count, std::false_type trivial);
+	static void ConstructMoved(T * to, T * from, int count, std::true_type trivial);
+	static void ConstructMoved(T * to, T * from, int count, std::false_type trivial);
+	static void Destroy(T * items, int count, std::true_type trivial) {};
+	static void Destroy(T * items, int count, std::false_type trivial);
+	static void Copy(T * to, const T * from, int count, std::true_type trivial);
+	static void Copy(T * to, const T * from, int count, std::false_type trivial);
+	static void Shift(T * to, T * from, int count, std::true_type trivial);
+	static void Shift(T * to, T * from, int count, std::false_type trivial);
+	/// If item refers to one within the array, which would be invalidated when re-allocating.
+	bool InArray(const T & item) const { return &item >= arr && &item < arr + arrLength; };
+
 	/// Array.
 	value_type * arr;
 	/// Number of current items.
@@ -196,15 +252,25 @@ List<T>::List()
 template <class T>
 List<T>::List(const List & otherList)
 {
+	Nullify();
 	arrLength = otherList.arrLength;
 
-	arr = AllocateArray(arrLength);
+	arr = AllocateStorage(arrLength);
 
 	currentItems = otherList.currentItems;
-	/// Transfer items
-	for (int i = 0; i < currentItems; ++i){
-		arr[i] = otherList.arr[i];
-	}
+	/// Transfer items, constructing copies directly instead of assigning to default-constructed ones.
+	ConstructCopies(arr, otherList.arr, currentItems);
+	ConstructDefault(arr + currentItems, arrLength - currentItems);
+}
+/// Move constructor
+template <class T>
+List<T>::List(List && otherList)
+{
+	arr = otherList.arr;
+	arrLength = otherList.arrLength;
+	currentItems = otherList.currentItems;
+	inUse = false;
+	otherList.Nullify();
 }
 
 template <class T>
@@ -246,58 +312,67 @@ void List<T>::SetFull()
 template <class T>
 const List<T> & List<T>::operator = (const List &otherList)
 {
-	// Re-allocate if needed only.
-	if (arrLength < otherList.arrLength)
+	if (this == &otherList)
+		return *this;
+	// Re-allocate if needed only. Nothing needs to be kept.
+	if (arrLength < otherList.currentItems)
 	{
+		currentItems = 0;
 		Resize(otherList.currentItems);
 	}
 	assert(otherList.arrLength >= otherList.currentItems);
 	// Copy the items.
-	for (int i = 0; i < otherList.currentItems; ++i)
-	{
-		arr[i] = otherList.arr[i];
-	}
+	Copy(arr, otherList.arr, otherList.currentItems);
 	currentItems = otherList.currentItems;
 	return *this;
 }
 
+/// Move assignment
+template <class T>
+const List<T> & List<T>::operator = (List && otherList)
+{
+	if (this == &otherList)
+		return *this;
+	Deallocate();
+	arr = otherList.arr;
+	arrLength = otherList.arrLength;
+	currentItems = otherList.currentItems;
+	otherList.Nullify();
+	return *this;
+}
+
 template <class T>
 const List<T> * List<T>::operator += (const List<T> &otherList) 
 {
 	/// Check if resizing is needed
-	if (currentItems + otherList.currentItems > arrLength)
-		Resize(currentItems + otherList.currentItems);
+	Reserve(currentItems + otherList.currentItems);
 	// Ship over stuff
-	for (int i = 0; i < otherList.currentItems; ++i){
-		AddItem(otherList.arr[i]);
-	}
+	Copy(arr + currentItems, otherList.arr, otherList.currentItems);
+	currentItems += otherList.currentItems;
 	return this;
 }
 template <class T>
-const List<T> List<T>::operator += (const T &newItem)
+const List<T> & List<T>::operator += (const T &newItem)
 {
-	if (currentItems + 1 > arrLength)
-		Resize(currentItems * 2 + 1);
 	AddItem(newItem);
 	return *this;
 }
 template <class T>
-const List<T> List<T>::operator -= (const T &itemToRemove)
+const List<T> & List<T>::operator -= (const T &itemToRemove)
 {
 	Remove(itemToRemove);
-	List<T> newList;
-	newList += *this;
-	return newList;
+	return *this;
 }
 template <class T>
-const List<T> List<T>::operator + (const List<T> &otherList) const {
+List<T> List<T>::operator + (const List<T> &otherList) const {
 	List<T> newList;
+	newList.Reserve(currentItems + otherList.currentItems);
 	newList += *this;
 	newList += otherList;
 	return newList;
 }
 template <class T>
-const List<T> List<T>::operator - (const List<T> &otherList) const 
+List<T> List<T>::operator - (const List<T> &otherList) const 
 {
 	List<T> newList;
 	newList += *this;
@@ -307,9 +382,10 @@ const List<T> List<T>::operator - (const List<T> &otherList) const
 	return newList;
 }
 template <class T>
-const List<T> List<T>::operator + (const T &newItem) const 
+List<T> List<T>::operator + (const T &newItem) const 
 {
 	List<T> newList;
+	newList.Reserve(currentItems + 1);
 	newList += *this;
 	newList.AddItem(newItem);
 	return newList;
@@ -369,21 +445,20 @@ bool List<T>::RemoveLast()
 template <class T>
 bool List<T>::Insert(const T & item, int atIndex)
 {
-	if (currentItems == arrLength){
-		try {
-			Resize(currentItems*2);
-		} catch (...){
-			std::cout << "\nUnable to allocate larger size array!";
-			return false;
-		}
+	/// Copy it first if it is in the list, as it may be moved or re-allocated below.
+	if (InArray(item))
+	{
+		T copy(item);
+		return Insert(copy, atIndex);
+	}
+	try {
+		Reserve(currentItems + 1);
+	} catch (...){
+		std::cout << "\nUnable to allocate larger size array!";
+		return false;
 	}
-	if (arrLength == 0)
-		Resize(1);
 	/// Move everything back 1 step.
-	for (int i = currentItems; i > atIndex; --i)
-	{
-		arr[i] = arr[i-1];
-	} 
+	Shift(arr + atIndex + 1, arr + atIndex, currentItems - atIndex);
 	/// Insert it.
 	arr[atIndex] = item;
 	++currentItems;
@@ -396,8 +471,14 @@ bool List<T>::AddItem(const T & item)
 {
 	if (currentItems == arrLength)
 	{
+		/// Items within the list would be invalidated when re-allocating, so copy those first.
+		if (InArray(item))
+		{
+			T copy(item);
+			return AddItem(std::move(copy));
+		}
 		try {
-			Resize(currentItems * 2 + 1);
+			Reserve(currentItems + 1);
 		} catch (...){
 			std::cout << "\nUnable to allocate larger size array!";
 			return false;
@@ -408,31 +489,66 @@ bool List<T>::AddItem(const T & item)
 	return true;
 }
 
+/// Adds an item to the list, moving it in.
+template <class T>
+bool List<T>::AddItem(T && item) 
+{
+	if (currentItems == arrLength)
+	{
+		if (InArray(item))
+		{
+			T moved(std::move(item));
+			return AddItem(std::move(moved));
+		}
+		try {
+			Reserve(currentItems + 1);
+		} catch (...){
+			std::cout << "\nUnable to allocate larger size array!";
+			return false;
+		}
+	}
+	arr[currentItems] = std::move(item);
+	++currentItems;
+	return true;
+}
+
 /// Adds an item to the list
 template <class T>
 bool List<T>::Add(const List<T> & items)
 {
 	// Resize as needed.
-	Resize(currentItems + items.Size());
+	Reserve(currentItems + items.Size());
 	// And add 'em.
-	for (int i = 0; i < items.Size(); ++i)
-	{
-		arr[currentItems + i] = items[i];
-	}
+	Copy(arr + currentItems, items.arr, items.currentItems);
 	currentItems = currentItems + items.Size();
 	return true;
 }
+
+/// Constructs an item at the end of the list using given constructor arguments, returning it.
+template <class T>
+template <class ... Args>
+T & List<T>::Emplace(Args && ... arguments)
+{
+	if (currentItems == arrLength)
+	{
+		/// Construct it before re-allocating, as the arguments may refer to items in the list.
+		AddItem(T(std::forward<Args>(arguments)...));
+		return Last();
+	}
+	/// Replace the default-constructed item at the end.
+	Destroy(arr + currentItems, 1);
+	new ((void*)(arr + currentItems)) T(std::forward<Args>(arguments)...);
+	++currentItems;
+	return Last();
+}
 	
 template <class T>
 bool List<T>::AddArray(int numItems, T * itemArray) 
 {
 	// Resize as needed.
-	Resize(currentItems + numItems);
+	Reserve(currentItems + numItems);
 	// And add 'em.
-	for (int i = 0; i < numItems; ++i)
-	{
-		arr[currentItems + i] = itemArray[i];
-	}
+	Copy(arr + currentItems, itemArray, numItems);
 	currentItems = currentItems + numItems;
 	return true;
 	/*
@@ -491,7 +607,8 @@ bool List<T>::RemoveItemUnsorted(const T & item)
 		if (arr[i] == item)
 		{
 			currentItems--;
-			arr[i] = arr[currentItems];
+			if (i != currentItems)
+				arr[i] = std::move(arr[currentItems]);
 			return true;
 		}
 	}
@@ -508,10 +625,7 @@ bool List<T>::RemoveItem(const T & item)
 		if (arr[i] == item)
 		{
 		    /// Move down the remaining objects.
-		    for (int j = i+1; j < currentItems; ++j)
-			{
-                arr[j-1] = arr[j];
-		    }
+			Shift(arr + i, arr + i + 1, currentItems - i - 1);
 			currentItems--;
 			return true;
 		}
@@ -530,7 +644,8 @@ int List<T>::RemoveUnsorted(const List<T> & subListToRemove)
 		if (subListToRemove.Exists(arr[i]))
 		{
 			currentItems--;
-			arr[i] = arr[currentItems];
+			if (i != currentItems)
+				arr[i] = std::move(arr[currentItems]);
 			--i;
 			++removed;
 		}
@@ -542,21 +657,19 @@ int List<T>::RemoveUnsorted(const List<T> & subListToRemove)
 template <class T>
 int List<T>::Remove(const List<T> & subListToRemove)
 {  
-	int removed = 0;
+	/// Move down the remaining objects in one pass, instead of shifting all following ones for each removed item.
+	int kept = 0;
 	for (int i = 0; i < currentItems; ++i)
 	{
 		/// found it?
 		if (subListToRemove.Exists(arr[i]))
-		{
-		    /// Move down the remaining objects.
-		    for (int j = i+1; j < currentItems; ++j){
-                arr[j-1] = arr[j];
-		    }
-			--currentItems;
-			--i;
-			++removed;
-		}
+			continue;
+		if (kept != i)
+			arr[kept] = std::move(arr[i]);
+		++kept;
 	}
+	int removed = currentItems - kept;
+	currentItems = kept;
 	return removed;
 }
 	
@@ -567,7 +680,8 @@ bool List<T>::RemoveIndex(int index){
 	if (index >= currentItems)
 		return false;
 	currentItems--;
-    arr[index] = arr[currentItems];
+	if (index != currentItems)
+		arr[index] = std::move(arr[currentItems]);
 	return true;
 }
 
@@ -581,9 +695,7 @@ bool List<T>::RemoveIndex(int index, int removeOption)
     assert(removeOption == ListOption::RETAIN_ORDER);
 
     /// Move down the remaining objects.
-	for (int i = index; i < currentItems - 1; ++i){
-		arr[i] = arr[i+1];
-	}
+	Shift(arr + index, arr + index + 1, currentItems - index - 1);
 	--currentItems;
 	return true;
 }
@@ -618,10 +730,12 @@ List<T> List<T>::Part(int startIndex, int stopIndex) const
 	List<T> partList;
 	if (stopIndex == -1)
 		stopIndex = currentItems - 1;
-	for (int i = startIndex; i <= stopIndex; ++i)
-	{
-		partList.AddItem(arr[i]);
-	}
+	int numItems = stopIndex - startIndex + 1;
+	if (numItems <= 0)
+		return partList;
+	partList.Allocate(numItems);
+	Copy(partList.arr, arr + startIndex, numItems);
+	partList.currentItems = numItems;
 	return partList;
 }
 
@@ -632,10 +746,7 @@ int List<T>::RemovePart(int fromIndex, int toIndex)
 	/// Move down the list, retaining order by default.
 	int itemsRemoved = toIndex - fromIndex + 1;
 	/// Move back the ENTIRE array. Nost just the same amount as removed...
-	for (int j = fromIndex; j < currentItems - itemsRemoved; ++j)
-	{
-		arr[j] = arr[j + itemsRemoved];
-	}
+	Shift(arr + fromIndex, arr + fromIndex + itemsRemoved, currentItems - itemsRemoved - fromIndex);
 	currentItems -= itemsRemoved;
 	return itemsRemoved;
 }	
@@ -647,9 +758,9 @@ bool List<T>::Swap(int index, int otherIndex)
 	if (index < 0 || otherIndex < 0 ||
 		index > currentItems || otherIndex >= currentItems)
 		return false;
-	T tmp = arr[index];
-	arr[index] = arr[otherIndex];
-	arr[otherIndex] = tmp;
+	T tmp = std::move(arr[index]);
+	arr[index] = std::move(arr[otherIndex]);
+	arr[otherIndex] = std::move(tmp);
 	return true;
 }
 
@@ -756,11 +867,24 @@ void List<T>::Allocate(int newSize, bool setFull)
 		currentItems = newSize;
 }
 
+/// Makes sure there is room for at least numItems, growing the array geometrically if not, so that repeated adding does not re-allocate each time.
+template <class T>
+void List<T>::Reserve(int numItems)
+{
+	if (numItems <= arrLength)
+		return;
+	int newSize = arrLength * 2 + 1;
+	if (newSize < numItems)
+		newSize = numItems;
+	Resize(newSize);
+}
+
 /// Deallocates the array. Use in destructors. If items stored within are allocated on the heap, it is recommended to call ClearAndDelete() first.
 template <class T>
 void List<T>::Deallocate()
 {
 	DeleteArray(arr, arrLength);
+	arr = NULL;
 	arrLength = 0;
 	currentItems = 0;
 }
@@ -770,26 +894,25 @@ void List<T>::Deallocate()
 template <class T>
 void List<T>::Resize(int newSize)
 {
-	// If same size, return. Already got the full length. Waste of time to delete and re-allocate.
-	if (newSize == arrLength)
-		return;
 	// Just remove if 0.
 	if (newSize == 0)
 	{
 		newSize = 8;
 	}
-	T * newArr = AllocateArray(newSize);
-	// If new array is larger, copy over old items.
-	if (newSize >= currentItems)
-	{
-		for (int i = 0; i < currentItems; ++i)
-			newArr[i] = arr[i];
-	}
+	// If same size, return. Already got the full length. Waste of time to delete and re-allocate.
+	if (newSize == arrLength)
+		return;
+	T * newArr = AllocateStorage(newSize);
+	// Move over the old items that fit, and default-construct the rest.
+	int itemsKept = currentItems < newSize ? currentItems : newSize;
+	ConstructMoved(newArr, arr, itemsKept);
+	ConstructDefault(newArr + itemsKept, newSize - itemsKept);
 	// Delete old array.
 	DeleteArray(arr, arrLength);
 	// Paste in the new one.
 	arr = newArr;
 	arrLength = newSize;
+	currentItems = itemsKept;
 }
 
 #include "System/Memory.h"
@@ -797,16 +920,9 @@ void List<T>::Resize(int newSize)
 template <class T>
 T * List<T>::AllocateArray(int num)
 {
-#ifdef USE_SSE
-	T * newArr = (T*) AllocateAligned(num * sizeof(T), 16);
-//	T * newArr = (T*) _aligned_malloc(num * sizeof(T), 16);
-	// Run constructor on the new objects?
-	for (int i = 0; i < num; ++i)
-		new((void*)&newArr[i]) T();
+	T * newArr = AllocateStorage(num);
+	ConstructDefault(newArr, num);
 	return newArr;
-#else
-	return new T[num];
-#endif
 }
 
 /// Deletes the array and calls the destructor on all objects. Does NOT set currentItems nor arrLength to 0! Deallocate does that.
@@ -815,14 +931,116 @@ void List<T>::DeleteArray(T * arr, int arrLength)
 {
 	if (arr)
 	{
-#ifdef USE_SSE
-		for (int i = 0; i < arrLength; ++i)
-			arr[i].~T();
-		_aligned_free(arr);
-#else
-		delete[] arr;
-#endif
-		arr = 0;
+		Destroy(arr, arrLength);
+		FreeStorage(arr);
+	}
+}
+
+/// Allocates memory for an array, aligned to ArrayAlignment(), without constructing anything.
+template <class T>
+T * List<T>::AllocateStorage(int size)
+{
+	if (size <= 0)
+		return NULL;
+	size_t bytes = size * sizeof(T);
+	// Only ask for aligned memory when new does not already guarantee it.
+	if (ArrayAlignment() > alignof(std::max_align_t))
+	{
+		void * storage = AllocateAligned((int) bytes, (int) ArrayAlignment());
+		if (storage == NULL)
+			throw std::bad_alloc();
+		return (T*) storage;
+	}
+	return (T*) ::operator new(bytes);
+}
+
+template <class T>
+void List<T>::FreeStorage(T * storage)
+{
+	if (ArrayAlignment() > alignof(std::max_align_t))
+		FreeAligned(storage);
+	else
+		::operator delete((void*) storage);
+}
+
+template <class T>
+void List<T>::ConstructDefault(T * items, int count, std::false_type trivial)
+{
+	for (int i = 0; i < count; ++i)
+		new ((void*)(items + i)) T;
+}
+
+template <class T>
+void List<T>::ConstructCopies(T * to, const T * from, int count, std::true_type trivial)
+{
+	if (count > 0)
+		memcpy((void*) to, (const void*) from, count * sizeof(T));
+}
+
+template <class T>
+void List<T>::ConstructCopies(T * to, const T * from, int count, std::false_type trivial)
+{
+	for (int i = 0; i < count; ++i)
+		new ((void*)(to + i)) T(from[i]);
+}
+
+template <class T>
+void List<T>::ConstructMoved(T * to, T * from, int count, std::true_type trivial)
+{
+	if (count > 0)
+		memcpy((void*) to, (const void*) from, count * sizeof(T));
+}
+
+template <class T>
+void List<T>::ConstructMoved(T * to, T * from, int count, std::false_type trivial)
+{
+	for (int i = 0; i < count; ++i)
+		new ((void*)(to + i)) T(std::move(from[i]));
+}
+
+template <class T>
+void List<T>::Destroy(T * items, int count, std::false_type trivial)
+{
+	for (int i = 0; i < count; ++i)
+		items[i].~T();
+}
+
+template <class T>
+void List<T>::Copy(T * to, const T * from, int count, std::true_type trivial)
+{
+	if (count > 0)
+		memcpy((void*) to, (const void*) from, count * sizeof(T));
+}
+
+template <class T>
+void List<T>::Copy(T * to, const T * from, int count, std::false_type trivial)
+{
+	for (int i = 0; i < count; ++i)
+		to[i] = from[i];
+}
+
+template <class T>
+void List<T>::Shift(T * to, T * from, int count, std::true_type trivial)
+{
+	if (count > 0)
+		memmove((void*) to, (const void*) from, count * sizeof(T));
+}
+
+template <class T>
+void List<T>::Shift(T * to, T * from, int count, std::false_type trivial)
+{
+	if (count <= 0 || to == from)
+		return;
+	// Go in the direction that does not overwrite items before they are moved.
+	if (to < from)
+	{
+		for (int i = 0; i < count; ++i)
+			to[i] = std::move(from[i]);
+	}
+	else 
+	{
+		for (int i = count - 1; i >= 0; --i)
+			to[i] = std::move(from[i]);
 	}
 }
 
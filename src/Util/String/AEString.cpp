@@ -255,6 +255,14 @@ String::String(const char * from, const char * to){
 	strncpy(arr, from, length);
 	arr[length] = '\0';
 }
+String::String(const StringView & view){
+	Nullify();
+	type = String::CHAR;
+	int length = view.Length();
+	Reallocate(length+1);
+	memcpy(arr, view.Data(), length);
+	arr[length] = '\0';
+}
 
 String::String(const wchar_t * string){
 	Nullify();
@@ -272,7 +280,7 @@ bool String::Allocate(int numberOfCharacters, char initialValue)
 {
 	Delete();
 	type = CHAR;
-	arr = new char[numberOfCharacters];
+	arr = AllocateChars(numberOfCharacters);
 	memset(arr, initialValue, numberOfCharacters);
 	arraySize = numberOfCharacters;
 	return true;
@@ -353,9 +361,9 @@ String::operator const char * () {
 		return NULL;
 	if (type != CHAR){
 		if (arr)
-			delete[] arr;
+			FreeChars(arr);
 		assert(arraySize > 0);
-		arr = new char[arraySize];
+		arr = AllocateChars(arraySize);
 		wcstombs(arr, warr, arraySize);
 	}
 	else if (type == NULL_TYPE)
@@ -837,6 +845,26 @@ bool String::Equals(const String & otherString) const {
 	return false;
 }
 
+/// Compares with the characters of the view, without copying them. Uses the comparison mode as Equals(String).
+bool String::Equals(const StringView & view) const
+{
+	switch(type)
+	{
+		case CHAR:
+			return View().Equals(view, comparisonMode != NOT_CASE_SENSITIVE);
+		case WIDE_CHAR:
+			return Equals(String(view));
+		default:
+			return view.IsEmpty();
+	}
+}
+
+/// Returns a view of the characters. The string must be of type CHAR, or empty, and not be modified while the view is in use.
+StringView String::View() const
+{
+	return StringView(*this);
+}
+
 bool String::ContainsChar(char c) const{
 	if (type == CHAR){
 		for (int i = 0; i < arraySize; ++i)
@@ -871,6 +899,14 @@ bool String::Contains(const String & subString) const
 		return true;
 	return false;
 }
+bool String::Contains(const char * subString) const
+{
+	return Find(StringView(subString)) >= 0;
+}
+bool String::Contains(const StringView & subString) const
+{
+	return Find(subString) >= 0;
+}
 
 /// Search with index as return value. -1 if it could not be found.
 int String::Find(const String & subString) const
@@ -894,33 +930,22 @@ int String::Find(const String & subString) const
 		return -1;
 
 	assert(arr);
-	char * tempArray = NULL;
-	String findString = subString;
-	// If needed, convert the sub string to char before continuing
-	if (subString.type == String::WIDE_CHAR)
-	{
-		findString.ConvertToChar();
-	}
-	else if (subString.arr == NULL)
+	if (subString.arr == NULL)
 		return -1;
-
-	// Not case-senstitive.. do some more work..!
-	if (comparisonMode == NOT_CASE_SENSITIVE)
-	{
-		String temp = arr;
-		String temp2 = findString;
-		temp.ToUpperCase();
-		temp2.ToUpperCase();
-		return temp.Find(temp2);
-	}
-	// Case-sensitive
-	char * result = strstr(arr, subString.arr);
-    if (result)
-	{
-		int index = result - arr;
-		return index;
-	}
-	return -1;
+	return Find(subString.View());
+}
+int String::Find(const char * subString) const
+{
+	return Find(StringView(subString));
+}
+/// Searches the characters directly, also when not case-sensitive, instead of searching upper-case copies.
+int String::Find(const StringView & subString) const
+{
+	if (type == NULL_TYPE || subString.IsEmpty())
+		return -1;
+	if (type == WIDE_CHAR)
+		return Find(String(subString));
+	return View().Find(subString, comparisonMode != NOT_CASE_SENSITIVE);
 }
 
 /** Search with index as return value. 
@@ -981,6 +1006,26 @@ bool String::StartsWith(const String & subString)
 		return true;
 	return false;
 }
+bool String::StartsWith(const char * subString) const
+{
+	return StartsWith(StringView(subString));
+}
+bool String::StartsWith(const StringView & subString) const
+{
+	switch(type)
+	{
+		case CHAR:
+			return View().StartsWith(subString);
+		case WIDE_CHAR:
+		{
+			String cVersion = this;
+			cVersion.ConvertToChar();
+			return cVersion.View().StartsWith(subString);
+		}
+		default:
+			return false;
+	}
+}
 
 /// Removes string subpart, returns true if it found and successfully removed it, false if not. Works recursively if all is true.
 bool String::Remove(const String & subString, bool all /*= false*/)
@@ -1107,7 +1152,7 @@ void String::Add(const wchar_t c) {
 		break;
 	case WIDE_CHAR:
 		if (length + 2 > arraySize)
-			Reallocate(length + length);
+			Reallocate(length + length + 2);
 		warr[length] = c;
 		warr[length + 1] = L'\0';
 		break;
@@ -1331,16 +1376,11 @@ float String::ParseFloat()
 		return 0.f;
 	}
 	if (this->type == WIDE_CHAR){
-		arr = new char[arraySize];
+		if (arr)
+			FreeChars(arr);
+		arr = AllocateChars(arraySize);
 		wcstombs(arr, warr, arraySize);
 	}
-//	std::cout<<"\nArr:" <<arr;
-    float f = (float)atof(arr);
-    for (int i = 0; i < (int)strlen(arr); ++i){
-        char c = arr[i];
-  //      std::cout<<"\nc: (int)"<<(int)c<<" char: "<<c;
-    }
-//    std::cout<<"\nReturning float: "<<f;
 	return (float)atof(arr);
 }
 double String::ParseDouble(){
@@ -1482,65 +1522,19 @@ List<String> String::GetLines() const
 
 
     /// Search how many occurences of \n we got.
-    int newLines = 0;
-    for (int i = 0; i < arraySize; ++i){
-        if (arr[i] == '\n')
-            ++newLines;
-    }
- //   std::cout<<"\nNewlines: "<<newLines;
+    int newLines = Count('\n');
     list.Allocate(newLines+5);
 
-	assert(this->arr && this->arraySize);
-	char * stringStart = arr, * stringEnd = NULL;
-    const int BUFFER_SIZE = 1024;
-	char buf[BUFFER_SIZE];
-	int i;
-	bool lastOne = false;
-
-    for (i = 0; i < arraySize; ++i){
-		memset(buf, 0, 1024);
-
-        if (arr[i] == '\n' || arr[i] == '\0'){
-			if (arr[i] == '\0'){
-	//		    std::cout<<"\nLast line found at row "<<list.Size();
-				lastOne = true;
-            }
-
-            // Token found, tokenize
-            stringEnd = &arr[i];
-            int stringLength = stringEnd - stringStart;
-            assert(stringLength < BUFFER_SIZE);
-            strncpy(buf, stringStart, stringLength);
-            stringStart = stringEnd+1;
-
-            String token(buf);
-//            token.PrintData();
-            token.Remove("\r", true);
-            token.Remove("\n", true);
-  //          token.PrintData();
-            list.AddItem(token);
-
-            // Break will only break the inner loop, make sure to flag the outside for-loop's index too!
-			if (lastOne){
-			    i = arraySize;
-				break;
-            }
-			memset(buf, 0, BUFFER_SIZE);
-
-			/*
-            if (list.Size() >= 30000){
-                std::cout<<"\nReturning "<<list.Size()<<" lines.";
-                for (int i = 0; i < list.Size(); ++i){
-                    std::cout<<"Line "<<i<<": "<<list[i].c_str();
-
-                }
-                return list;
-            }
-			*/
-
-
-        }
-    }
+	/// Split using views, copying each line once (and no longer limited in length).
+	StringTokenizer tokenizer(View(), "\n", true);
+	StringView line;
+	while (tokenizer.Next(line))
+	{
+		String token(line);
+		if (line.Find('\r') >= 0)
+			token.Remove("\r", true);
+		list.AddItem(token);
+	}
 	return list;
 }
 
@@ -1572,8 +1566,8 @@ const char * String::c_str()
 	if (type == WIDE_CHAR){
 		// Convert
 		if (arr)
-			delete[] arr;
-		arr = new char[arraySize];
+			FreeChars(arr);
+		arr = AllocateChars(arraySize);
 		wcstombs(arr, warr, arraySize);
 	}
 	return arr;
@@ -1638,13 +1632,8 @@ void String::ConvertToChar(){
 	if (type == WIDE_CHAR){
 		type = CHAR;
 		if (arr)
-#ifdef USE_BLOCK_ALLOCATOR
-			stringAllocator.Deallocate(arr);
-		arr = stringAllocator.AllocateNewArray<char>(arraySize);
-#else
-			delete[] arr;
-		arr = new char [arraySize];
-#endif
+			FreeChars(arr);
+		arr = AllocateChars(arraySize);
 		assert(warr);
 		assert(arraySize > 0);
 		wcstombs(arr, warr, arraySize);
@@ -1896,11 +1885,7 @@ void String::Nullify()
 void String::Delete()
 {
 	if (arr)
-#ifdef USE_BLOCK_ALLOCATOR
-		stringAllocator.Deallocate(arr);
-#else
-		delete[] arr;
-#endif
+		FreeChars(arr);
 	if (warr)
 #ifdef USE_BLOCK_ALLOCATOR
 		
@@ -1920,26 +1905,28 @@ void String::Reallocate(int size)
 	bool debug = false;
 	switch(type){
 		case CHAR: {
+			/// Keep the previous contents, as much as fits.
+			int copySize = 0;
 			if (arr && arraySize > 0)
+				copySize = size < arraySize? size : arraySize;
+			char * newArr = AllocateChars(size);
+			if (newArr == arr)
 			{
-				/// Allocate temp array for holding stuffs if need be
-				char * tmp = new char[arraySize];
-				int copySize = size < arraySize? size : arraySize;
-				strncpy(tmp, arr, copySize);
-				/// And delete the previous array too, yo.
-				delete[] arr;
-				arr = new char [size];
-				memset(arr, 0, size);
-				strncpy(arr, tmp, copySize);
-				/// Delete it too, yo.
-				delete[] tmp;
+				/// Still fits inline, so just clear anything after the contents.
+				int kept = 0;
+				while (kept < copySize && arr[kept] != '\0')
+					++kept;
+				memset(arr + kept, 0, size - kept);
 			}
-			else if (arr == 0){
-				arr = new char [size];
-				memset(arr, 0, size);
-				strcpy(arr, "");
+			else 
+			{
+				memset(newArr, 0, size);
+				if (copySize > 0)
+					strncpy(newArr, arr, copySize);
+				if (arr)
+					FreeChars(arr);
+				arr = newArr;
 			}
-
 			break;
 		}
 		case WIDE_CHAR: 
@@ -1973,10 +1960,10 @@ void String::Reallocate(int size)
 		default: {
 			// Allocate both
 			if (arr)
-				delete[] arr;
+				FreeChars(arr);
 			if (warr)
 				delete[] warr;
-			arr = new char[size];
+			arr = AllocateChars(size);
 			warr = new wchar_t[size];
 			strcpy(arr, "");
 			wcscpy(warr, L"");
@@ -2011,6 +1998,31 @@ void String::Copy(const String & fromTargetString, int ofType)
 	}
 }
 
+/// Returns inlineChars if size fits within it, or a newly allocated array.
+char * String::AllocateChars(int size)
+{
+	assert(size > 0);
+	if (size <= STRING_INLINE_CHARS)
+		return inlineChars;
+#ifdef USE_BLOCK_ALLOCATOR
+	return stringAllocator.AllocateNewArray<char>(size);
+#else
+	return new char[size];
+#endif
+}
+
+/// Frees an array returned by AllocateChars.
+void String::FreeChars(char * chars)
+{
+	if (chars == inlineChars)
+		return;
+#ifdef USE_BLOCK_ALLOCATOR
+	stringAllocator.Deallocate(chars);
+#else
+	delete[] chars;
+#endif
+}
+
 
 /// Concatenation operators, left-hand-string and right-hand-strings respectively
 //String operator + (const String & lhs, const char * rhs);	// char*
@@ -2021,7 +2033,9 @@ String operator + (const String & lhs, const String & rhs){
 }
 
 String operator + (const String & lhs, const char * rhs){
-	String string = lhs + String(rhs);
+	String string(lhs);
+	if (rhs && rhs[0] != '\0')
+		string.Add(rhs);
 	return string;
 }
 
@@ -2038,11 +2052,11 @@ bool operator == (const String & lhs, const String & rhs){
 	return lhs.Equals(rhs);
 }
 bool operator == (const String & lhs, const char * rhs){
-	return lhs.Equals(String(rhs));
+	return lhs.Equals(StringView(rhs));
 }
 /// Char * first
 bool operator == (const char * lhs, const String & rhs){
-	return rhs.Equals(String(lhs));
+	return rhs.Equals(StringView(lhs));
 }
 /*
 	// char*
@@ -2061,8 +2075,8 @@ bool operator != (const String & lhs, const String & rhs){
 	return ! rhs.Equals(lhs);
 }
 bool operator != (const char * lhs, const String & rhs){
-	return ! rhs.Equals(String(lhs));
+	return ! rhs.Equals(StringView(lhs));
 }
 bool operator != (const String & lhs, const char * rhs){
-	return ! lhs.Equals(String(rhs));
+	return ! lhs.Equals(StringView(rhs));
 }
@@ -10,17 +10,25 @@
 #include "../List/List.h"
 #include "System/DataTypes.h"
 #include "Sorting/Sortable.h"
+#include "StringView.h"
 
 #if PLATFORM == PLATFORM_WINDOWS
 	//#define snprintf(a,b,c,d) _snprintf(a,b,c,d)
 #endif
 
+/** Size of the array within each String used for short char-strings (including the null-character), instead of allocating one.
+	Most names, keys and message tokens fit, at the cost of making each String this much larger.
+*/
+#define STRING_INLINE_CHARS	24
+
 /// A custom string class that handles dynamic allocation as well as single-/multi-byte conversions as needed.
 class String : public Sortable
 {
 public:
 	/// Initializes block allocator to be used with strings.
 	static void InitializeAllocator();
+	/// Copies and assigns strings across the inline storage, asserting on the results. See StringTests.cpp
+	static void UnitTest();
 	String();
 	virtual ~String();
 	/// Copy constructor and..
@@ -35,6 +43,7 @@ public:
 	/// -1 will make the float be printed with default amount (as needed). Use String::SCIENTIFIC_NOTATION if that is desired.
 	String(const float fValue, int decimalsAfterZeroAndNotation = 0);
 	String(const wchar_t * string);
+	String(const StringView & view);
 
 	// For printing floats in various formats
 	enum {
@@ -101,17 +110,25 @@ public:
 
 	/// Quering functions
 	bool Equals(const String & otherString) const;
+	/// Compares with the characters of the view, without copying them. Uses the comparison mode as Equals(String).
+	bool Equals(const StringView & view) const;
+	/// Returns a view of the characters. The string must be of type CHAR, or empty, and not be modified while the view is in use.
+	StringView View() const;
 	bool ContainsChar(char c) const;
 	/// Counts occurences of target character in the string.
 	int Count(char c) const;
 	
 	/// Search with boolean answer.
 	bool Contains(const String & subString) const;
+	bool Contains(const char * subString) const;
+	bool Contains(const StringView & subString) const;
 	/** Search with index as return value. 
 		Returns index of first character of the found substring within this strng.
 		-1 if it could not be found.
 	*/
 	int Find(const String & subString) const;
+	int Find(const char * subString) const;
+	int Find(const StringView & subString) const;
 	/** Search with index as return value. 
 		Returns index of first character of the found substring within this strng.
 		-1 if it could not be found.
@@ -121,6 +138,9 @@ public:
 	bool EndsWith(wchar_t c) const;
 	/// Similar to Contains but works only on the beginning of the string.
 	bool StartsWith(const String & subString);
+	/// Case-sensitive, as StartsWith(String), but without copying any part of the string.
+	bool StartsWith(const char * subString) const;
+	bool StartsWith(const StringView & subString) const;
 	/// Removes string subpart, returns true if it found and successfully removed it, false if not. Works recursively if all is true.
 	bool Remove(const String & subString, bool all = false);
 	/// Concatenates strings
@@ -216,6 +236,10 @@ protected:
 	void Reallocate(int size);
 	/// Copies data from other string, using method determined by ofType.
 	void Copy(const String & fromTargetString, int ofType);
+	/// Returns inlineChars if size fits within it, or a newly allocated array.
+	char * AllocateChars(int size);
+	/// Frees an array returned by AllocateChars.
+	void FreeChars(char * chars);
 
 	/// Regular char array
 	char * arr;
@@ -231,6 +255,8 @@ protected:
 	int type;
 	/// Mode used for == operations
 	char comparisonMode;
+	/// Storage for short char-strings, used as arr when it fits. See STRING_INLINE_CHARS.
+	char inlineChars[STRING_INLINE_CHARS];
 };
 
 /// Concatenation operators, left-hand-string and right-hand-strings respectively
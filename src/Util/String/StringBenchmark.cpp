@@ -0,0 +1,149 @@
+/// Emil Hedemalm
+/// 2016-08-25
+/// Micro-benchmarks of common string work, comparing String copies against StringView and StringTokenizer.
+
+#include "StringBenchmark.h"
+#include "AEString.h"
+#include "Timer/Timer.h"
+
+/// Prints the time taken both ways.
+static void PrintResult(const char * name, int iterations, int64 stringMs, int64 viewMs)
+{
+	std::cout<<"\nBenchmarkStrings: "<<name<<" x"<<iterations<<": String "<<stringMs<<" ms, StringView "<<viewMs<<" ms";
+}
+
+/// Message as sent by UI and scripts, split into its function name and arguments. Returns the sum of argument lengths, to compare results.
+static int ParseMessageWithStrings(const String & message)
+{
+	int sum = 0;
+	if (!message.Contains(String("(")))
+		return sum;
+	List<String> parts = message.Tokenize("(),");
+	String function = parts[0];
+	if (!(function == String("SetText")))
+		return sum;
+	for (int i = 1; i < parts.Size(); ++i)
+	{
+		String argument = parts[i];
+		argument.RemoveSurroundingWhitespaces();
+		sum += argument.Length();
+	}
+	return sum;
+}
+static int ParseMessageWithViews(const String & message)
+{
+	int sum = 0;
+	if (!message.Contains("("))
+		return sum;
+	StringTokenizer tokenizer(message, "(),");
+	StringView part;
+	if (!tokenizer.Next(part) || part != "SetText")
+		return sum;
+	while (tokenizer.Next(part))
+		sum += part.Trimmed().Length();
+	return sum;
+}
+
+/// Line of a UI definition file: a keyword followed by numbers.
+static float ParseUILineWithStrings(const String & line)
+{
+	List<String> tokens = line.Tokenize(" \t");
+	if (tokens.Size() < 3 || !(tokens[0] == String("sizeRatioXY")))
+		return 0;
+	return tokens[1].ParseFloat() + tokens[2].ParseFloat();
+}
+static float ParseUILineWithViews(const String & line)
+{
+	StringTokenizer tokenizer(line, " \t");
+	StringView keyword, x, y;
+	if (!tokenizer.Next(keyword) || !tokenizer.Next(x) || !tokenizer.Next(y) || keyword != "sizeRatioXY")
+		return 0;
+	return x.ParseFloat() + y.ParseFloat();
+}
+
+/// Path of a texture by name, checking its folder and extension as when looking them up.
+static int CheckPathWithStrings(const String & name)
+{
+	String path = String("img/") + name + String(".png");
+	int result = 0;
+	if (path.StartsWith(String("img/")))
+		++result;
+	if (path.Contains(String(".png")))
+		++result;
+	if (path.Find(String("/")) == 3)
+		++result;
+	return result;
+}
+static int CheckPathWithViews(const String & name)
+{
+	String path = "img/" + name + ".png";
+	StringView view = path;
+	int result = 0;
+	if (view.StartsWith("img/"))
+		++result;
+	if (view.EndsWith(".png"))
+		++result;
+	if (view.Find('/') == 3)
+		++result;
+	return result;
+}
+
+/** Times parsing of messages (e.g. "SetText(Label, Hello)"), UI definition lines (e.g. "sizeRatioXY 0.5 0.25")
+	and building and searching file paths, first using Tokenize, Part and String temporaries, then using views.
+	Prints the time taken by each, and returns false if the two ways give different results.
+*/
+bool BenchmarkStrings(int iterations /*= 100000*/)
+{
+	bool same = true;
+	Timer timer;
+	int64 stringMs, viewMs;
+
+	String message = "SetText(MainMenuTitle, Hello world)";
+	int stringSum = 0, viewSum = 0;
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		stringSum += ParseMessageWithStrings(message);
+	timer.Stop();
+	stringMs = timer.GetMs();
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		viewSum += ParseMessageWithViews(message);
+	timer.Stop();
+	viewMs = timer.GetMs();
+	PrintResult("message parsing", iterations, stringMs, viewMs);
+	same = same && stringSum == viewSum;
+
+	String uiLine = "sizeRatioXY\t0.5 0.25";
+	float stringTotal = 0, viewTotal = 0;
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		stringTotal += ParseUILineWithStrings(uiLine);
+	timer.Stop();
+	stringMs = timer.GetMs();
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		viewTotal += ParseUILineWithViews(uiLine);
+	timer.Stop();
+	viewMs = timer.GetMs();
+	PrintResult("UI line parsing", iterations, stringMs, viewMs);
+	same = same && stringTotal == viewTotal;
+
+	String textureName = "Button";
+	stringSum = viewSum = 0;
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		stringSum += CheckPathWithStrings(textureName);
+	timer.Stop();
+	stringMs = timer.GetMs();
+	timer.Start();
+	for (int i = 0; i < iterations; ++i)
+		viewSum += CheckPathWithViews(textureName);
+	timer.Stop();
+	viewMs = timer.GetMs();
+	PrintResult("file paths", iterations, stringMs, viewMs);
+	same = same && stringSum == viewSum;
+
+	if (!same)
+		std::cout<<"\nBenchmarkStrings: Results differ.";
+	return same;
+}
@@ -0,0 +1,14 @@
+/// Emil Hedemalm
+/// 2016-08-25
+/// Micro-benchmarks of common string work, comparing String copies against StringView and StringTokenizer.
+
+#ifndef STRING_BENCHMARK_H
+#define STRING_BENCHMARK_H
+
+/** Times parsing of messages (e.g. "SetText(Label, Hello)"), UI definition lines (e.g. "sizeRatioXY 0.5 0.25")
+	and building and searching file paths, first using Tokenize, Part and String temporaries, then using views.
+	Prints the time taken by each, and returns false if the two ways give different results. Not run by UnitTests, see Benchmarks.
+*/
+bool BenchmarkStrings(int iterations = 100000);
+
+#endif
@@ -0,0 +1,141 @@
+/// Emil Hedemalm
+/// 2016-08-25
+/// Tests of String copies and assignments across the inline storage, and of StringView against the String functions it replaces.
+
+#include "AEString.h"
+#include <cstring>
+
+/// Message as sent by UI and scripts, split into its function name and arguments. Returns the sum of argument lengths, to compare results.
+static int ParseMessageWithStrings(const String & message)
+{
+	int sum = 0;
+	if (!message.Contains(String("(")))
+		return sum;
+	List<String> parts = message.Tokenize("(),");
+	String function = parts[0];
+	if (!(function == String("SetText")))
+		return sum;
+	for (int i = 1; i < parts.Size(); ++i)
+	{
+		String argument = parts[i];
+		argument.RemoveSurroundingWhitespaces();
+		sum += argument.Length();
+	}
+	return sum;
+}
+static int ParseMessageWithViews(const String & message)
+{
+	int sum = 0;
+	if (!message.Contains("("))
+		return sum;
+	StringTokenizer tokenizer(message, "(),");
+	StringView part;
+	if (!tokenizer.Next(part) || part != "SetText")
+		return sum;
+	while (tokenizer.Next(part))
+		sum += part.Trimmed().Length();
+	return sum;
+}
+
+/// Line of a UI definition file: a keyword followed by numbers.
+static float ParseUILineWithStrings(const String & line)
+{
+	List<String> tokens = line.Tokenize(" \t");
+	if (tokens.Size() < 3 || !(tokens[0] == String("sizeRatioXY")))
+		return 0;
+	return tokens[1].ParseFloat() + tokens[2].ParseFloat();
+}
+static float ParseUILineWithViews(const String & line)
+{
+	StringTokenizer tokenizer(line, " \t");
+	StringView keyword, x, y;
+	if (!tokenizer.Next(keyword) || !tokenizer.Next(x) || !tokenizer.Next(y) || keyword != "sizeRatioXY")
+		return 0;
+	return x.ParseFloat() + y.ParseFloat();
+}
+
+/// Path of a texture by name, checking its folder and extension as when looking them up.
+static int CheckPathWithStrings(const String & name)
+{
+	String path = String("img/") + name + String(".png");
+	int result = 0;
+	if (path.StartsWith(String("img/")))
+		++result;
+	if (path.Contains(String(".png")))
+		++result;
+	if (path.Find(String("/")) == 3)
+		++result;
+	return result;
+}
+static int CheckPathWithViews(const String & name)
+{
+	String path = "img/" + name + ".png";
+	StringView view = path;
+	int result = 0;
+	if (view.StartsWith("img/"))
+		++result;
+	if (view.EndsWith(".png"))
+		++result;
+	if (view.Find('/') == 3)
+		++result;
+	return result;
+}
+
+/// Copies, assignments and growth across the inline storage (see STRING_INLINE_CHARS), and views against the String functions they replace.
+void String::UnitTest()
+{
+	const char * shortText = "Short";
+	/// 23 characters and the null-character fill the inline storage exactly.
+	const char * longestInline = "abcdefghijklmnopqrstuvw";
+	const char * shortestHeap = "abcdefghijklmnopqrstuvwx";
+	const char * longText = "A name long enough to never fit inline";
+	assert(strlen(longestInline) + 1 == STRING_INLINE_CHARS);
+
+	/// Copying, inline and heap strings.
+	String inlineString(shortText), boundaryString(longestInline), heapString(shortestHeap), longString(longText);
+	assert(inlineString.arr == inlineString.inlineChars && boundaryString.arr == boundaryString.inlineChars);
+	assert(heapString.arr != heapString.inlineChars && longString.arr != longString.inlineChars);
+	String inlineCopy(inlineString), heapCopy(longString);
+	assert(inlineCopy.arr == inlineCopy.inlineChars && inlineCopy == shortText);
+	assert(heapCopy.arr != heapCopy.inlineChars && heapCopy.arr != longString.arr && heapCopy == longText);
+	/// Copies do not share storage with the original.
+	inlineString += "er";
+	longString += "!";
+	assert(inlineCopy == shortText && inlineString == "Shorter");
+	assert(heapCopy == longText && longString.Length() == strlen(longText) + 1);
+
+	/// Assignment across the inline boundary, both ways.
+	String assigned(shortText);
+	assigned = heapCopy;
+	assert(assigned.arr != assigned.inlineChars && assigned.arr != heapCopy.arr && assigned == longText);
+	assigned = inlineCopy;
+	assert(assigned.arr == assigned.inlineChars && assigned == shortText);
+	assigned = shortestHeap;
+	assert(assigned.arr != assigned.inlineChars && assigned == shortestHeap);
+	assigned = longestInline;
+	assert(assigned.arr == assigned.inlineChars && assigned == longestInline);
+	assigned = String();
+	assert(assigned.Length() == 0);
+	assigned = shortText;
+	assert(assigned.arr == assigned.inlineChars && assigned == shortText);
+
+	/// Growing from inline to heap storage keeps the contents, as does converting to wide characters and back.
+	String growing(longestInline);
+	growing += "x";
+	assert(growing.arr != growing.inlineChars && growing == shortestHeap);
+	for (int i = 0; i < 10; ++i)
+		growing += longText;
+	assert(growing.Length() == strlen(shortestHeap) + 10 * strlen(longText));
+	assert(strncmp(growing.c_str(), shortestHeap, strlen(shortestHeap)) == 0);
+	String twoChars = String('<') + '=';
+	assert(twoChars.Length() == 2 && strcmp(twoChars.c_str(), "<=") == 0);
+	String wide = String(longestInline) + 'x';
+	assert(strcmp(wide.c_str(), shortestHeap) == 0);
+
+	/// StringView and StringTokenizer give the same results as the String functions they replace.
+	String message = "SetText(MainMenuTitle, Hello world)";
+	assert(ParseMessageWithStrings(message) == ParseMessageWithViews(message) && ParseMessageWithViews(message) == 24);
+	String uiLine = "sizeRatioXY\t0.5 0.25";
+	assert(ParseUILineWithStrings(uiLine) == ParseUILineWithViews(uiLine) && ParseUILineWithViews(uiLine) == 0.75f);
+	assert(CheckPathWithStrings("Button") == 3 && CheckPathWithViews("Button") == 3);
+}
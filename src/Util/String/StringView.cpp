@@ -0,0 +1,205 @@
+/// Emil Hedemalm
+/// 2016-08-25
+/// Non-owning views of characters and tokenizing without allocating new strings.
+
+#include "StringView.h"
+#include "AEString.h"
+#include <cstring>
+#include <cctype>
+
+StringView::StringView()
+	: characters(""), length(0)
+{
+}
+
+StringView::StringView(const char * cString)
+	: characters(cString ? cString : ""), length(cString ? (int) strlen(cString) : 0)
+{
+}
+
+StringView::StringView(const char * characters, int length)
+	: characters(characters), length(length)
+{
+	assert(length >= 0);
+	if (this->characters == NULL)
+	{
+		this->characters = "";
+		this->length = 0;
+	}
+}
+
+StringView::StringView(const String & string)
+	: characters(""), length(0)
+{
+	if (string.Type() == String::NULL_TYPE)
+		return;
+	assert(string.Type() == String::CHAR && "Convert to char before viewing.");
+	const char * cString = string;
+	if (cString == NULL)
+		return;
+	characters = cString;
+	length = string.Length();
+}
+
+char StringView::operator[](int index) const
+{
+	assert(index >= 0 && index < length);
+	return characters[index];
+}
+
+/** Returns the view [fromIndex, toIndex[, -1 signifying the end. Same as String::Part, but without copying.
+*/
+StringView StringView::Part(int fromIndex /*= 0*/, int toIndex /*= -1*/) const
+{
+	if (fromIndex < 0)
+		fromIndex = 0;
+	if (toIndex <= -1 || toIndex > length)
+		toIndex = length;
+	if (toIndex <= fromIndex)
+		return StringView();
+	return StringView(characters + fromIndex, toIndex - fromIndex);
+}
+
+/// Returns the view without surrounding whitespaces.
+StringView StringView::Trimmed() const
+{
+	int from = 0, to = length;
+	while (from < to && isspace((unsigned char) characters[from]))
+		++from;
+	while (to > from && isspace((unsigned char) characters[to - 1]))
+		--to;
+	return StringView(characters + from, to - from);
+}
+
+/// Index of the first occurence of c at or after fromIndex, or -1.
+int StringView::Find(char c, int fromIndex /*= 0*/) const
+{
+	for (int i = fromIndex < 0 ? 0 : fromIndex; i < length; ++i)
+	{
+		if (characters[i] == c)
+			return i;
+	}
+	return -1;
+}
+
+/// Index of the first occurence of subString, or -1 if not found or empty.
+int StringView::Find(const StringView & subString, bool caseSensitive /*= true*/) const
+{
+	if (subString.length == 0)
+		return -1;
+	int last = length - subString.length;
+	for (int i = 0; i <= last; ++i)
+	{
+		if (Part(i, i + subString.length).Equals(subString, caseSensitive))
+			return i;
+	}
+	return -1;
+}
+
+bool StringView::Contains(const StringView & subString, bool caseSensitive /*= true*/) const
+{
+	return Find(subString, caseSensitive) >= 0;
+}
+
+bool StringView::StartsWith(const StringView & prefix, bool caseSensitive /*= true*/) const
+{
+	if (prefix.length == 0 || prefix.length > length)
+		return false;
+	return Part(0, prefix.length).Equals(prefix, caseSensitive);
+}
+
+bool StringView::EndsWith(const StringView & suffix, bool caseSensitive /*= true*/) const
+{
+	if (suffix.length == 0 || suffix.length > length)
+		return false;
+	return Part(length - suffix.length).Equals(suffix, caseSensitive);
+}
+
+bool StringView::Equals(const StringView & other, bool caseSensitive /*= true*/) const
+{
+	if (length != other.length)
+		return false;
+	if (caseSensitive)
+		return memcmp(characters, other.characters, length) == 0;
+	for (int i = 0; i < length; ++i)
+	{
+		if (toupper((unsigned char) characters[i]) != toupper((unsigned char) other.characters[i]))
+			return false;
+	}
+	return true;
+}
+
+/// Parses as String::ParseInt, ignoring any characters other than digits and '-'.
+int StringView::ParseInt() const
+{
+	// Numbers never need more, so parse from a local copy instead of allocating one.
+	const int BUFFER_SIZE = 64;
+	char buf[BUFFER_SIZE];
+	int count = length < BUFFER_SIZE - 1 ? length : BUFFER_SIZE - 1;
+	for (int i = 0; i < count; ++i)
+	{
+		char c = characters[i];
+		buf[i] = (isdigit((unsigned char) c) || c == '-') ? c : ' ';
+	}
+	buf[count] = '\0';
+	return atoi(buf);
+}
+
+float StringView::ParseFloat() const
+{
+	const int BUFFER_SIZE = 64;
+	char buf[BUFFER_SIZE];
+	int count = length < BUFFER_SIZE - 1 ? length : BUFFER_SIZE - 1;
+	memcpy(buf, characters, count);
+	buf[count] = '\0';
+	return (float) atof(buf);
+}
+
+/// Copies the characters into a new String.
+String StringView::ToString() const
+{
+	return String(characters, characters + length);
+}
+
+StringTokenizer::StringTokenizer(const StringView & text, const StringView & separators, bool keepEmptyStrings /*= false*/)
+	: text(text), separators(separators), keepEmptyStrings(keepEmptyStrings), position(0)
+{
+}
+
+/// Fetches the next token, returning false once there are no more.
+bool StringTokenizer::Next(StringView & token)
+{
+	while (position >= 0)
+	{
+		int start = position;
+		int end = start;
+		while (end < text.Length() && !IsSeparator(text[end]))
+			++end;
+		// Continue after the separator, or stop if the end of the text was reached.
+		position = end < text.Length() ? end + 1 : -1;
+		if (end == start && !keepEmptyStrings)
+			continue;
+		token = text.Part(start, end);
+		return true;
+	}
+	return false;
+}
+
+/// Returns the text after the last token fetched, e.g. for commands followed by free text.
+StringView StringTokenizer::Remainder() const
+{
+	if (position < 0)
+		return StringView();
+	return text.Part(position);
+}
+
+/// Starts over from the beginning.
+void StringTokenizer::Reset()
+{
+	position = 0;
+}
+
+bool StringTokenizer::IsSeparator(char c) const
+{
+	return separators.Find(c) >= 0;
+}
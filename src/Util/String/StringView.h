@@ -0,0 +1,84 @@
+/// Emil Hedemalm
+/// 2016-08-25
+/// Non-owning views of characters and tokenizing without allocating new strings.
+
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+class String;
+
+/** Non-owning, read-only view of characters, e.g. of a whole String, a part of one or a literal.
+	The characters must outlive the view, and a viewed String must not be modified meanwhile.
+	Only single-byte (char) strings may be viewed.
+*/
+class StringView
+{
+public:
+	StringView();
+	StringView(const char * cString);
+	StringView(const char * characters, int length);
+	/// Views the string's characters. The string must be of type CHAR, or empty.
+	StringView(const String & string);
+
+	const char * Data() const { return characters; };
+	int Length() const { return length; };
+	bool IsEmpty() const { return length == 0; };
+	char operator[](int index) const;
+
+	/** Returns the view [fromIndex, toIndex[, -1 signifying the end. Same as String::Part, but without copying.
+	*/
+	StringView Part(int fromIndex = 0, int toIndex = -1) const;
+	/// Returns the view without surrounding whitespaces.
+	StringView Trimmed() const;
+
+	/// Index of the first occurence of c at or after fromIndex, or -1.
+	int Find(char c, int fromIndex = 0) const;
+	/// Index of the first occurence of subString, or -1 if not found or empty.
+	int Find(const StringView & subString, bool caseSensitive = true) const;
+	bool Contains(const StringView & subString, bool caseSensitive = true) const;
+	bool StartsWith(const StringView & prefix, bool caseSensitive = true) const;
+	bool EndsWith(const StringView & suffix, bool caseSensitive = true) const;
+	bool Equals(const StringView & other, bool caseSensitive = true) const;
+	bool operator == (const StringView & other) const { return Equals(other); };
+	bool operator != (const StringView & other) const { return !Equals(other); };
+	bool operator == (const char * cString) const { return Equals(StringView(cString)); };
+	bool operator != (const char * cString) const { return !Equals(StringView(cString)); };
+
+	/// Parses as String::ParseInt, ignoring any characters other than digits and '-'.
+	int ParseInt() const;
+	float ParseFloat() const;
+	/// Copies the characters into a new String.
+	String ToString() const;
+
+private:
+	const char * characters;
+	int length;
+};
+
+/** Splits text at any of the given separator characters, returning one token at a time as views into the text.
+	Use instead of String::Tokenize where the tokens are only inspected, e.g.
+		StringTokenizer tokenizer(line, " \t");
+		StringView token;
+		while (tokenizer.Next(token))
+			...
+	With keepEmptyStrings, separators next to each other or at the ends give empty tokens, so that splitting at "\n" gives the lines as String::GetLines does.
+*/
+class StringTokenizer
+{
+public:
+	StringTokenizer(const StringView & text, const StringView & separators, bool keepEmptyStrings = false);
+	/// Fetches the next token, returning false once there are no more.
+	bool Next(StringView & token);
+	/// Returns the text after the last token fetched, e.g. for commands followed by free text.
+	StringView Remainder() const;
+	/// Starts over from the beginning.
+	void Reset();
+private:
+	bool IsSeparator(char c) const;
+	StringView text, separators;
+	bool keepEmptyStrings;
+	/// Index to continue from, or -1 once all tokens have been fetched.
+	int position;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/// Emil Hedemalm
+/// 2016-08-17
+/// Fixed pool of worker threads for splitting data-parallel work, such as the physics broad and narrow phase, across all cores.
+
+#include "JobPool.h"
+
+/// Starts given amount of workers. A negative number uses one per hardware thread, minus one for the calling thread.
+JobPool::JobPool(int numWorkers)
+: stopWorkers(false), batchID(0), job(NULL), jobData(NULL), jobCount(0), jobsFinished(0), activeWorkers(0), nextJob(0)
+{
+	if (numWorkers < 0)
+		numWorkers = (int) std::thread::hardware_concurrency() - 1;
+	for (int i = 0; i < numWorkers; ++i)
+		workers.AddItem(new std::thread(&JobPool::WorkerLoop, this));
+}
+
+/// Waits for the workers to exit.
+JobPool::~JobPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopWorkers = true;
+	}
+	batchStarted.notify_all();
+	for (int i = 0; i < workers.Size(); ++i)
+	{
+		workers[i]->join();
+		delete workers[i];
+	}
+	workers.Clear();
+}
+
+/** Calls job(i, data) for every i in [0, count), spread across the workers and the calling thread, and returns once all have finished.
+	Jobs are handed out in order but may finish in any order, so each should write only to its own output.
+*/
+void JobPool::ParallelFor(int count, JobFunction function, void * data)
+{
+	if (count <= 0)
+		return;
+	/// Not worth waking anyone up.
+	if (count == 1 || workers.Size() == 0)
+	{
+		for (int i = 0; i < count; ++i)
+			function(i, data);
+		return;
+	}
+	std::lock_guard<std::mutex> batchLock(batchMutex);
+	{
+		std::unique_lock<std::mutex> lock(stateMutex);
+		/// Workers that woke up late for the previous batch may still be on their way out.
+		while (activeWorkers > 0)
+			batchFinished.wait(lock);
+		job = function;
+		jobData = data;
+		jobCount = count;
+		jobsFinished = 0;
+		nextJob = 0;
+		++batchID;
+	}
+	batchStarted.notify_all();
+	/// Help out while waiting.
+	int finished = RunJobs();
+	std::unique_lock<std::mutex> lock(stateMutex);
+	jobsFinished += finished;
+	while (jobsFinished < jobCount || activeWorkers > 0)
+		batchFinished.wait(lock);
+	job = NULL;
+	jobData = NULL;
+}
+
+void JobPool::WorkerLoop()
+{
+	unsigned int lastBatch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			while (!stopWorkers && batchID == lastBatch)
+				batchStarted.wait(lock);
+			if (stopWorkers)
+				return;
+			lastBatch = batchID;
+			++activeWorkers;
+		}
+		int finished = RunJobs();
+		{
+			std::lock_guard<std::mutex> lock(stateMutex);
+			jobsFinished += finished;
+			--activeWorkers;
+		}
+		batchFinished.notify_all();
+	}
+}
+
+/// Runs jobs of the current batch until there are none left. Returns amount of jobs run.
+int JobPool::RunJobs()
+{
+	int finished = 0;
+	while (true)
+	{
+		int index = nextJob++;
+		if (index >= jobCount)
+			break;
+		job(index, jobData);
+		++finished;
+	}
+	return finished;
+}
@@ -0,0 +1,60 @@
+/// Emil Hedemalm
+/// 2016-08-17
+/// Fixed pool of worker threads for splitting data-parallel work, such as the physics broad and narrow phase, across all cores.
+
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include "List/List.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/** Runs batches of independent jobs on a set of persistent worker threads.
+	Unlike Thread, which starts one OS thread per task, the workers are started once and then sleep between batches,
+	so it is cheap enough to use several times per physics frame.
+*/
+class JobPool 
+{
+public:
+	/// Job function, called once per index with the data given to ParallelFor.
+	typedef void (*JobFunction)(int index, void * data);
+
+	/// Starts given amount of workers. A negative number uses one per hardware thread, minus one for the calling thread.
+	JobPool(int numWorkers = -1);
+	/// Waits for the workers to exit.
+	~JobPool();
+
+	/** Calls job(i, data) for every i in [0, count), spread across the workers and the calling thread, and returns once all have finished.
+		Jobs are handed out in order but may finish in any order, so each should write only to its own output.
+		Batches from several threads are run one at a time. Do not call from within a job.
+	*/
+	void ParallelFor(int count, JobFunction job, void * data);
+
+	/// Amount of worker threads, excluding the caller.
+	int Workers() const { return workers.Size(); };
+private:
+	void WorkerLoop();
+	/// Runs jobs of the current batch until there are none left. Returns amount of jobs run.
+	int RunJobs();
+
+	List<std::thread*> workers;
+	/// Only one batch at a time.
+	std::mutex batchMutex;
+	/// Guards the batch state below.
+	std::mutex stateMutex;
+	std::condition_variable batchStarted, batchFinished;
+	bool stopWorkers;
+	/// Incremented for each batch, so that workers know when a new one has started.
+	unsigned int batchID;
+	JobFunction job;
+	void * jobData;
+	int jobCount, jobsFinished;
+	/// Workers currently running jobs of the batch. The next batch may not be set up until they are done.
+	int activeWorkers;
+	/// Next job index to hand out.
+	std::atomic<int> nextJob;
+};
+
+#endif
@@ -90,6 +90,8 @@ extern THREAD_HANDLE deallocatorThread;
 #include "File/LogFile.h"
 
 extern bool UnitTests();
+extern void IntegrationTests();
+extern bool Benchmarks();
 // void SIMDTest();
 
 /// Kept in GraphicsProcessor.
@@ -295,6 +297,14 @@ int main(int argc, char **argv)
 	// Unit tests here if wanted.
 	if (UnitTests())
 		return 0;
+	/// Slower tests and benchmarks only if asked for on the command-line, exiting afterwards.
+	if (CommandLine::args.Exists("tests"))
+	{
+		IntegrationTests();
+		return 0;
+	}
+	if (CommandLine::args.Exists("benchmark"))
+		return Benchmarks() ? 0 : 1;
 
     // Register AppWindow pre-stuffs.
 	// Create the AppWindow manager.
@@ -385,6 +395,7 @@ int main(int argc, char **argv)
 	PhysicsManager::Allocate();
 	InputManager::Allocate();
 	ModelManager::Allocate();
+	AssetLoader::Allocate();
 	EntityManager::Allocate();
 	PathManager::Allocate();
 	WaypointManager::Allocate();
@@ -484,6 +495,7 @@ int main(int argc, char **argv)
 	timeStart = clock();
 
 	// Deallocate all managers
+	AssetLoader::Deallocate();
 	GridObjectTypeManager::Deallocate();
 	MultimediaManager::Deallocate();
 	TrackManager::Deallocate();